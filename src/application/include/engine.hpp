@@ -1,16 +1,28 @@
 #pragma once
 
 #include "camera.hpp"
+#include "camera_sensor_system.hpp"
 #include "camera_system.hpp"
+#include "frame_allocator.hpp"
+#include "frame_pacer.hpp"
 #include "input_controller.hpp"
+#include "lane_graph.hpp"
+#include "lidar_system.hpp"
+#include "light_system.hpp"
 #include "render_system.hpp"
+#include "render_thread.hpp"
 #include "renderer.hpp"
+#include "traffic_system.hpp"
 #include "world.hpp"
+#include "world_streamer.hpp"
 
 #include <algorithm>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include <memory>
 #include <optional>
+#include <span>
+#include <string>
 #include <vector>
 
 #ifndef GLFW_INCLUDE_NONE
@@ -18,21 +30,83 @@
 #endif
 #include <GLFW/glfw3.h>
 
+struct EngineConfig
+{
+    FramePacerConfig pacing{};
+    // 도로를 달리는 차량 수
+    std::size_t traffic_agents = 2000;
+    // 128채널 LiDAR를 지붕에 다는 차량 수 (먼저 생성된 차량부터)
+    std::size_t lidar_sensors = 4;
+    // 앞쪽을 보는 카메라 센서를 다는 차량 수
+    std::size_t camera_sensors = 2;
+    // 화면 entity id 버퍼로 클릭/드래그 선택과 hover를 처리한다. false면 클릭만 CPU 광선 검사로 고른다
+    bool gpu_picking = true;
+    // 장면 앞쪽에 한 줄로 놓을 메시 파일 (.obj / .glb). 워커에서 읽고 LOD를 만든 뒤 업로드되면 보인다
+    std::vector<std::string> mesh_files;
+};
+
 struct Runtime
 {
     float last_frame_time = 0.0f;
+    // LOD 선택의 화면 크기 계산과 렌더 스레드 viewport용
+    int framebuffer_width = 1;
+    int framebuffer_height = 1;
+
+    // RenderQueue 등 프레임 단위 임시 데이터용
+    FrameAllocator frame_allocator{4 * 1024 * 1024};
+    std::uint64_t heap_allocations_last_frame = 0;
+    double last_allocation_report_time = 0.0;
+    double last_frame_stats_report_time = 0.0;
+    // trace 저장 키의 직전 상태 (눌린 순간에만 저장)
+    bool trace_key_down = false;
+    bool pacing_key_down = false;
+
+    FramePacer frame_pacer;
+
+    InputEventQueue input_events;
+    std::uint64_t dropped_input_events = 0;
+    std::uint32_t input_events_this_frame = 0;
+    // 아직 packet에 실리지 않은 클릭의 timestamp (없으면 -1). 렌더 스레드가 swap 후 지연을 잰다
+    std::int64_t pending_click_ns = -1;
+    // 카운터와 pacer에 이미 반영한 렌더 스레드 결과
+    std::uint64_t last_result_frame = 0;
+
+    // 화면 entity id 버퍼 피킹. 질의 id는 1부터 쓰고 0은 진행 중인 질의가 없다는 뜻
+    bool gpu_picking = true;
+    // RendererConfig::shadows. 꺼져 있으면 컬링된 shadow caster를 큐에 남기지 않는다
+    bool shadows = true;
+    std::uint64_t next_pick_id = 1;
+    std::uint64_t hover_pick_id = 0;
+    std::uint64_t selection_pick_id = 0;
+    // 왼쪽 버튼이 눌린 위치 (창 좌표). 놓을 때 클릭인지 드래그 사각형인지 가른다
+    bool selection_drag = false;
+    double press_x = 0.0;
+    double press_y = 0.0;
+    // 마지막 커서 위치 (창 좌표). 아직 없으면 음수
+    double cursor_x = -1.0;
+    double cursor_y = -1.0;
+    // 다음 packet에 실을 질의와 렌더 스레드에서 받은 결과. 용량을 재사용한다
+    std::vector<EntityPickQuery> pick_queries;
+    EntityPickResults pick_results;
 };
 
 struct Scene
 {
     std::unique_ptr<World> world;
-    entity_id ground_id{};
-    std::optional<entity_id> selected_entity{};
+    // 지면과 건물은 카메라 pivot 주변 타일만 World에 올라온다
+    std::unique_ptr<WorldStreamer> world_streamer;
+    // 도시 도로의 차로 그래프. TrafficSystem이 참조한다
+    std::unique_ptr<LaneGraph> road_network;
+    // 선택은 SelectedComponent로도 표시된다
+    std::vector<entity_id> selected_entities;
+    std::optional<entity_id> hovered_entity{};
 };
 
 struct ViewContext
 {
     std::unique_ptr<Renderer> renderer;
+    // run() 동안 GL context를 소유한다. Renderer보다 먼저 소멸해야 한다
+    std::unique_ptr<RenderThread> render_thread;
     GLFWwindow *window = nullptr;
     std::unique_ptr<Camera> camera;
     std::unique_ptr<InputController> input_controller;
@@ -42,6 +116,11 @@ struct SystemsContext
 {
     std::unique_ptr<CameraSystem> camera_system;
     std::unique_ptr<RenderSystem> render_system;
+    std::unique_ptr<LightingSystem> lighting_system;
+    std::unique_ptr<OcclusionCuller> occlusion_culler;
+    std::unique_ptr<TrafficSystem> traffic_system;
+    std::unique_ptr<LidarSystem> lidar_system;
+    std::unique_ptr<CameraSensorSystem> camera_sensor_system;
 };
 
 struct RenderContext
@@ -53,25 +132,46 @@ struct RenderContext
 class Engine
 {
 public:
-    Engine();
+    explicit Engine(const EngineConfig &config = {});
     ~Engine() = default;
 
     void run();
 
-    // GLFW callbacks
-    void handleWindowResize(int width, int height);
-    void handleMouseMove(double pos_x, double pos_y);
-    void handleMouseScroll(double offset_x, double offset_y);
-    void handleMouseButton(int button, int action);
+    // GLFW 콜백에서 호출. 큐가 가득 차면 버린다
+    void enqueueInput(const InputEvent &event);
 
 private:
     void init();
     void setupCallback();
     void loadAssets();
+    void spawnTraffic(std::size_t agent_count, std::size_t lidar_count, std::size_t camera_count);
+    void spawnMeshFiles(const std::vector<std::string> &paths);
+    // pacer 모드를 바꾸고 swap interval을 맞춘다
+    void applyFramePacing(const FramePacerConfig &config);
+
+    // 큐에 쌓인 입력을 처리한다. 프레임 시작과 late latch에서만 호출
+    void drainInput();
+    // 카메라 행렬을 만들기 직전에 이벤트를 한 번 더 받아 최신 마우스 상태를 카메라에 반영한다
+    void lateLatchInput();
+    void handleWindowResize(int width, int height);
+    void handleMouseMove(double pos_x, double pos_y);
+    void handleMouseScroll(double offset_x, double offset_y);
+    void handleMouseButton(int button, int action, double cursor_x, double cursor_y);
+    // SelectableComponent마다 커서 광선과 pick bounds를 검사한다 (gpu_picking이 꺼졌을 때)
+    void pickWithRays(double cursor_x, double cursor_y);
+    // 창 좌표(왼쪽 위 원점)를 framebuffer 픽셀(왼쪽 아래 원점)로 바꾼다
+    glm::ivec2 toFramebufferPixel(double cursor_x, double cursor_y) const;
+    // 진행 중인 hover 질의가 없으면 커서 아래 픽셀 질의를 넣는다
+    void queueHoverPick();
+    // 렌더 스레드가 끝낸 피킹 결과를 hover와 선택에 반영한다
+    void applyPickResults();
+    void setSelection(std::span<const std::uint32_t> entities);
 
     void proccessInput(float delta_time);
     void update(float delta_time);
     void render();
+    void reportFrameAllocations();
+    void reportFrameStats();
 
     Runtime runtime_;
     Scene scene_;
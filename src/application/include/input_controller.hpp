@@ -1,10 +1,36 @@
 #pragma once
 
+#include "spsc_ring.hpp"
+#include <cstdint>
 #include <glm/glm.hpp>
 
 class Camera;
 class CameraSystem;
 
+// GLFW 콜백이 기록하는 원시 입력. 콜백은 큐에 넣기만 하고 처리는 프레임의 정해진 지점에서 한다
+struct InputEvent
+{
+    enum class Type : std::uint8_t
+    {
+        MouseMove,
+        MouseButton,
+        Scroll,
+        Key,
+        FramebufferResize,
+    };
+
+    Type type = Type::MouseMove;
+    std::int64_t timestamp_ns = 0; // Profiler::now()
+    // MouseMove/MouseButton: 커서 위치, Scroll: offset, FramebufferResize: 크기, Key: 쓰지 않음
+    double x = 0.0;
+    double y = 0.0;
+    int button = 0;
+    int action = 0;
+};
+
+// 생산자는 GLFW 콜백(glfwPollEvents를 부르는 스레드), 소비자는 Engine 프레임 루프
+using InputEventQueue = SpscRing<InputEvent, 256>;
+
 class InputController
 {
 public:
@@ -13,6 +39,8 @@ public:
     void onMouseMove(double xpos, double ypos);
     void onKey(int key, int action);
     void onScroll(double yoffset);
+    // false면 마우스 이동으로 시점을 돌리지 않는다 (드래그 선택 중)
+    void setMouseLook(bool enabled) { mouse_look_ = enabled; }
     bool onMouseClick(double cursor_x,
                       double cursor_y,
                       int viewport_w,
@@ -34,6 +62,7 @@ private:
     } input_;
 
     bool first_mouse_ = true;
+    bool mouse_look_ = true;
     double last_x_ = 0.0;
     double last_y_ = 0.0;
     float mouse_dx_ = 0.0f;
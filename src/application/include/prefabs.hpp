@@ -2,7 +2,17 @@
 
 #include "world.hpp"
 
+#include <cstdint>
+#include <glm/glm.hpp>
+
+struct VehicleEntities
+{
+    entity_id body;
+    entity_id roof;
+};
+
 namespace Prefabs
 {
-entity_id createGround(World &world, int mesh_id, float size);
+// 선택 가능한 차체 + 지붕. position은 차체 중심
+VehicleEntities createVehicle(World &world, int mesh_id, std::uint32_t material_id, const glm::vec3 &position, const glm::vec3 &scale);
 } // namespace Prefabs
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "tile_source.hpp"
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// 존재하는 타일만 담는 quadtree. 빈 사분면은 노드를 만들지 않으므로 듬성듬성한 지도도 크기가 타일 수에 비례한다
+class TileQuadtree
+{
+public:
+    void build(const std::vector<TileCoord> &tiles, float tile_size);
+
+    // xz 평면의 원과 겹치는 타일을 out 뒤에 붙인다
+    void query(const glm::vec2 &center, float radius, std::vector<TileCoord> &out) const;
+
+    // 점에서 타일 영역까지의 xz 거리 (안이면 0)
+    static float distanceToTile(const glm::vec2 &point, TileCoord coord, float tile_size);
+
+    std::size_t tileCount() const { return tile_count_; }
+
+private:
+    static constexpr std::int32_t kNoNode = -1;
+
+    // 타일 좌표 [min, min + size) 정사각 영역. size가 1이면 leaf
+    struct Node
+    {
+        std::int32_t min_x = 0;
+        std::int32_t min_z = 0;
+        std::int32_t size = 1;
+        std::array<std::int32_t, 4> children{kNoNode, kNoNode, kNoNode, kNoNode};
+    };
+
+    std::int32_t buildNode(std::vector<TileCoord> &tiles, std::size_t begin, std::size_t end,
+                           std::int32_t min_x, std::int32_t min_z, std::int32_t size);
+
+    std::vector<Node> nodes_;
+    float tile_size_ = 1.0f;
+    std::size_t tile_count_ = 0;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "component.hpp"
+
+#include <cstdint>
+#include <vector>
+
+// 지도는 tile_size 크기의 정사각 타일로 나뉜다. 타일 (x, z)는 월드 xz 평면의
+// [x * tile_size, (x + 1) * tile_size) x [z * tile_size, (z + 1) * tile_size) 영역
+struct TileCoord
+{
+    std::int32_t x = 0;
+    std::int32_t z = 0;
+
+    bool operator==(const TileCoord &other) const { return x == other.x && z == other.z; }
+};
+
+// 타일 하나를 World에 만들 때 필요한 entity 하나 분량의 데이터
+struct TileEntity
+{
+    TransformComponent transform;
+    RenderableComponent renderable;
+};
+
+struct TileData
+{
+    TileCoord coord;
+    std::vector<TileEntity> entities;
+};
+
+// 타일 데이터 공급원. loadTile은 백그라운드 스레드에서 여러 타일이 동시에 불리므로 const이고 스레드 안전해야 한다
+class TileSource
+{
+public:
+    virtual ~TileSource() = default;
+
+    virtual float tileSize() const = 0;
+    // 지도에 있는 모든 타일. WorldStreamer가 quadtree를 만들 때 한 번 부른다
+    virtual std::vector<TileCoord> tiles() const = 0;
+    virtual TileData loadTile(TileCoord coord) const = 0;
+};
+
+struct CityTileConfig
+{
+    // 지도는 원점을 중심으로 한 tiles_per_side x tiles_per_side 타일
+    std::int32_t tiles_per_side = 64;
+    float tile_size = 48.0f;
+    // 타일 한 변에 놓이는 블록 수
+    std::int32_t blocks_per_side = 4;
+    int ground_mesh_id = 0;
+    int building_mesh_id = 0;
+    std::uint32_t ground_material = 0;
+    std::vector<std::uint32_t> building_materials;
+    // 원점 주변 (-plaza_tiles..plaza_tiles-1) 타일에는 건물을 두지 않는다
+    std::int32_t plaza_tiles = 1;
+};
+
+// 타일 좌표를 시드로 건물 블록을 만드는 절차적 도시. 같은 타일은 언제 불러도 같은 결과다
+class CityTileSource : public TileSource
+{
+public:
+    explicit CityTileSource(CityTileConfig config);
+
+    float tileSize() const override { return config_.tile_size; }
+    std::vector<TileCoord> tiles() const override;
+    TileData loadTile(TileCoord coord) const override;
+
+private:
+    CityTileConfig config_;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "thread_pool.hpp"
+#include "tile_quadtree.hpp"
+#include "tile_source.hpp"
+#include "world.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct WorldStreamerConfig
+{
+    // pivot에서 이 거리 안에 걸치는 타일을 불러온다
+    float load_radius = 160.0f;
+    // 이 거리 밖의 타일은 내린다. load_radius보다 커야 경계에서 타일이 깜빡이지 않는다
+    float unload_radius = 220.0f;
+    // 동시에 백그라운드에서 불러오는 타일 수
+    std::size_t max_pending_loads = 4;
+    // 프레임당 World에 entity를 만들고 지우는 데 쓸 수 있는 시간
+    double commit_budget_ms = 1.0;
+};
+
+struct WorldStreamerStats
+{
+    std::size_t resident_tiles = 0;
+    // 백그라운드 로드 중이거나 커밋을 기다리는 타일
+    std::size_t pending_tiles = 0;
+    std::size_t created_this_frame = 0;
+    std::size_t destroyed_this_frame = 0;
+    std::size_t streamed_entities = 0;
+};
+
+// pivot 주변 타일을 백그라운드 스레드에서 불러와 프레임 예산 안에서 World에 커밋하고, 먼 타일은 내린다.
+// 타일 데이터는 커밋이 끝나면 버리므로 메모리에는 반경 안의 타일만 남는다.
+// update와 소멸은 메인 스레드에서만 한다
+class WorldStreamer
+{
+public:
+    explicit WorldStreamer(std::shared_ptr<const TileSource> source,
+                           const WorldStreamerConfig &config = {},
+                           ThreadPool &pool = ThreadPool::instance());
+    ~WorldStreamer();
+
+    WorldStreamer(const WorldStreamer &) = delete;
+    WorldStreamer &operator=(const WorldStreamer &) = delete;
+
+    void update(World &world, const glm::vec3 &pivot);
+
+    const WorldStreamerStats &stats() const { return stats_; }
+
+private:
+    enum class TileState
+    {
+        Loading,    // 백그라운드 로드 중
+        Committing, // 데이터가 도착해 entity를 나눠 만드는 중
+        Resident,
+    };
+
+    struct TileSlot
+    {
+        TileCoord coord;
+        TileState state = TileState::Loading;
+        TileData data;
+        std::size_t committed = 0;
+        std::vector<entity_id> entities;
+    };
+
+    // 백그라운드 작업이 끝난 타일을 넣는 곳. 스트리머가 먼저 사라져도 작업이 안전하도록 shared_ptr로 나눠 갖는다
+    struct Inbox
+    {
+        std::mutex mutex;
+        std::vector<TileData> tiles;
+    };
+
+    static std::uint64_t tileKey(TileCoord coord);
+
+    void receiveLoadedTiles();
+    void requestTiles(const glm::vec2 &center);
+    void releaseFarTiles(const glm::vec2 &center);
+    void commit(World &world, const glm::vec2 &center);
+
+    std::shared_ptr<const TileSource> source_;
+    WorldStreamerConfig config_;
+    ThreadPool &pool_;
+    TileQuadtree quadtree_;
+
+    std::unordered_map<std::uint64_t, TileSlot> tiles_;
+    std::shared_ptr<Inbox> inbox_;
+    std::size_t pending_loads_ = 0;
+    // 내린 타일의 아직 지우지 못한 entity
+    std::vector<entity_id> pending_destroy_;
+
+    std::vector<TileCoord> query_scratch_;
+    std::vector<TileSlot *> commit_scratch_;
+    std::vector<TileData> inbox_scratch_;
+    WorldStreamerStats stats_;
+};
@@ -1,10 +1,12 @@
 #include "input_controller.hpp"
 #include <algorithm>
+#include <cmath>
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
+#include <utility>
 
 #ifndef GLFW_INCLUDE_NONE
 #define GLFW_INCLUDE_NONE
@@ -13,7 +15,11 @@
 #include "component.hpp"
 #include "engine.hpp"
 #include "prefabs.hpp"
+#include "primitives.hpp"
+#include "profiler.hpp"
 #include "render_data.hpp"
+#include "road_network.hpp"
+#include "tile_source.hpp"
 #include <GLFW/glfw3.h>
 
 namespace
@@ -21,39 +27,101 @@ namespace
 constexpr float kWidth = 1280;
 constexpr float kHeight = 720;
 constexpr auto kTitle = "Autonomous Driving Simulation";
+constexpr std::uint64_t kAllocationWarmupFrames = 120;
+constexpr double kAllocationReportInterval = 5.0;
+// 프레임당 메시 GPU 업로드에 쓸 수 있는 시간
+constexpr double kMeshUploadBudgetMs = 2.0;
+const glm::vec3 kAmbientLight{0.25f, 0.25f, 0.3f};
+constexpr double kFrameStatsInterval = 5.0;
+constexpr auto kTracePath = "frame_trace.json";
+// 스트리밍 도시 지도: 64 x 64 타일, 타일 한 변 48m
+constexpr std::int32_t kCityTilesPerSide = 64;
+constexpr float kCityTileSize = 48.0f;
+// 도로망은 원점 주변 정사각 블록 격자. 블록 경계가 도시 타일의 건물 블록 경계와 맞는다
+constexpr int kMinRoadBlocks = 32;
+constexpr float kRoadBlockSize = 12.0f;
+const glm::vec3 kVehicleScale{1.6f, 1.0f, 3.2f};
+// LiDAR는 지붕 윗면보다 조금 위에 단다
+constexpr float kLidarMountClearance = 0.15f;
+// 카메라는 차체 앞면 위쪽에서 앞을 본다
+constexpr float kCameraMountForward = 0.05f;
+// 누른 곳에서 이만큼(framebuffer 픽셀) 움직이고 놓으면 사각형 선택
+constexpr int kMarqueeMinPixels = 4;
+// --mesh로 불러온 메시를 놓는 줄의 시작점과 간격
+const glm::vec3 kMeshFileOrigin{0.0f, 0.0f, -12.0f};
+constexpr float kMeshFileSpacing = 6.0f;
+
+std::vector<glm::vec3> meshPositions(const MeshData &mesh)
+{
+    std::vector<glm::vec3> positions;
+    positions.reserve(mesh.vertices.size());
+    for (const Vertex &vertex : mesh.vertices)
+        positions.push_back(vertex.position);
+    return positions;
+}
 
-void frambuffer_size_callback(GLFWwindow *window_ptr, int width, int height)
+const char *framePacingName(FramePacing mode)
 {
-    Engine *engine_ptr = static_cast<Engine *>(glfwGetWindowUserPointer(window_ptr));
-    if (engine_ptr)
+    switch (mode)
     {
-        engine_ptr->handleWindowResize(width, height);
+    case FramePacing::Vsync:
+        return "vsync";
+    case FramePacing::Uncapped:
+        return "uncapped";
+    case FramePacing::Capped:
+        return "capped";
+    case FramePacing::LowLatency:
+        return "low-latency";
     }
+    return "unknown";
 }
 
-void mouse_callback(GLFWwindow *window_ptr, double pos_x, double pos_y)
+// 콜백은 이벤트를 기록해 큐에 넣기만 한다
+void pushInput(GLFWwindow *window_ptr, InputEvent::Type type, double x, double y, int button = 0, int action = 0)
 {
     Engine *engine_ptr = static_cast<Engine *>(glfwGetWindowUserPointer(window_ptr));
-    if (engine_ptr)
-    {
-        engine_ptr->handleMouseMove(pos_x, pos_y);
-    }
+    if (!engine_ptr)
+        return;
+
+    InputEvent event;
+    event.type = type;
+    event.timestamp_ns = Profiler::now();
+    event.x = x;
+    event.y = y;
+    event.button = button;
+    event.action = action;
+    engine_ptr->enqueueInput(event);
+}
+
+void frambuffer_size_callback(GLFWwindow *window_ptr, int width, int height)
+{
+    pushInput(window_ptr, InputEvent::Type::FramebufferResize, width, height);
+}
+
+void mouse_callback(GLFWwindow *window_ptr, double pos_x, double pos_y)
+{
+    pushInput(window_ptr, InputEvent::Type::MouseMove, pos_x, pos_y);
 }
 
 void mouse_button_callback(GLFWwindow *window_ptr, int button, int action, int /*mods*/)
 {
-    Engine *engine_ptr = static_cast<Engine *>(glfwGetWindowUserPointer(window_ptr));
-    if (engine_ptr)
-        engine_ptr->handleMouseButton(button, action);
+    // 클릭 위치는 눌린 순간의 커서 위치 (GLFW가 캐시한 값이라 비용이 없다)
+    double cursor_x = 0.0;
+    double cursor_y = 0.0;
+    glfwGetCursorPos(window_ptr, &cursor_x, &cursor_y);
+    pushInput(window_ptr, InputEvent::Type::MouseButton, cursor_x, cursor_y, button, action);
 }
 
 void scroll_callback(GLFWwindow *window_ptr, double offset_x, double offset_y)
 {
-    Engine *engine_ptr = static_cast<Engine *>(glfwGetWindowUserPointer(window_ptr));
-    if (engine_ptr)
-    {
-        engine_ptr->handleMouseScroll(offset_x, offset_y);
-    }
+    pushInput(window_ptr, InputEvent::Type::Scroll, offset_x, offset_y);
+}
+
+void key_callback(GLFWwindow *window_ptr, int key, int /*scancode*/, int action, int /*mods*/)
+{
+    if (action == GLFW_REPEAT)
+        return;
+    pushInput(window_ptr, InputEvent::Type::Key, 0.0, 0.0, key, action);
 }
 
 void error_callback(int error_code, const char *description)
@@ -63,26 +131,124 @@ void error_callback(int error_code, const char *description)
 
 } // namespace
 
-Engine::Engine()
+Engine::Engine(const EngineConfig &config)
 {
     this->init();
     this->setupCallback();
     this->loadAssets();
+    this->spawnMeshFiles(config.mesh_files);
+    this->spawnTraffic(config.traffic_agents, config.lidar_sensors, config.camera_sensors);
+    this->applyFramePacing(config.pacing);
+
+    // 렌더 스레드가 뜨기 전이라 직접 바꾼다. material이 모두 등록된 뒤라 variant도 여기서 미리 만든다
+    runtime_.gpu_picking = config.gpu_picking;
+    RendererConfig renderer_config = render_ctx_.view.renderer->getConfig();
+    renderer_config.entity_ids = config.gpu_picking;
+    render_ctx_.view.renderer->setConfig(renderer_config);
+    runtime_.shadows = renderer_config.shadows;
 }
 
 void Engine::run()
 {
+    Profiler &profiler = Profiler::instance();
+    profiler.setThreadName("main");
+    // 여기서부터 GL 호출은 렌더 스레드에서만 한다
+    render_ctx_.view.render_thread = std::make_unique<RenderThread>(*render_ctx_.view.renderer);
     while (!render_ctx_.view.renderer->windowShouldClose())
     {
+        // 대기는 프레임 시간에 넣지 않는다. pacing은 프레임 시작 간격 통계로 본다
+        runtime_.frame_pacer.waitForFrameStart();
+        profiler.beginFrame();
         const float current_frame_time = static_cast<float>(glfwGetTime());
         const float delta_time = current_frame_time - runtime_.last_frame_time;
         runtime_.last_frame_time = current_frame_time;
 
+        runtime_.frame_allocator.beginFrame();
+        const std::uint64_t heap_allocations_before = HeapStats::allocationCount();
+
+        render_ctx_.view.renderer->pollEvents();
         this->proccessInput(delta_time);
         this->update(delta_time);
         this->render();
-        render_ctx_.view.renderer->swapBuffers();
-        render_ctx_.view.renderer->pollEvents();
+        runtime_.frame_pacer.endFrame();
+
+        runtime_.heap_allocations_last_frame = HeapStats::allocationCount() - heap_allocations_before;
+        this->reportFrameAllocations();
+
+        profiler.endFrame();
+        this->reportFrameStats();
+    }
+    render_ctx_.view.render_thread.reset();
+}
+
+void Engine::applyFramePacing(const FramePacerConfig &config)
+{
+    runtime_.frame_pacer.setConfig(config);
+    const int swap_interval = runtime_.frame_pacer.usesVsync() ? 1 : 0;
+    // 렌더 스레드가 돌고 있으면 context는 그쪽에 있다
+    if (render_ctx_.view.render_thread)
+    {
+        render_ctx_.view.render_thread->post([swap_interval](Renderer &renderer)
+                                             { renderer.setSwapInterval(swap_interval); });
+    }
+    else
+    {
+        render_ctx_.view.renderer->setSwapInterval(swap_interval);
+    }
+    std::clog << "[engine] frame pacing " << framePacingName(config.mode);
+    if (config.mode == FramePacing::Capped || config.mode == FramePacing::LowLatency)
+        std::clog << " (" << runtime_.frame_pacer.config().target_fps << " fps)";
+    std::clog << std::endl;
+}
+
+void Engine::enqueueInput(const InputEvent &event)
+{
+    if (!runtime_.input_events.tryPush(event))
+        ++runtime_.dropped_input_events;
+}
+
+void Engine::drainInput()
+{
+    PROFILE_SCOPE("Engine::drainInput");
+    InputEvent event;
+    while (runtime_.input_events.tryPop(event))
+    {
+        ++runtime_.input_events_this_frame;
+        switch (event.type)
+        {
+        case InputEvent::Type::MouseMove:
+            handleMouseMove(event.x, event.y);
+            break;
+        case InputEvent::Type::MouseButton:
+            if (event.action == GLFW_PRESS && runtime_.pending_click_ns < 0)
+                runtime_.pending_click_ns = event.timestamp_ns;
+            handleMouseButton(event.button, event.action, event.x, event.y);
+            break;
+        case InputEvent::Type::Scroll:
+            handleMouseScroll(event.x, event.y);
+            break;
+        case InputEvent::Type::Key:
+            if (render_ctx_.view.input_controller)
+                render_ctx_.view.input_controller->onKey(event.button, event.action);
+            break;
+        case InputEvent::Type::FramebufferResize:
+            handleWindowResize(static_cast<int>(event.x), static_cast<int>(event.y));
+            break;
+        }
+    }
+}
+
+void Engine::lateLatchInput()
+{
+    PROFILE_SCOPE("Engine::lateLatchInput");
+    render_ctx_.view.renderer->pollEvents();
+    drainInput();
+    if (render_ctx_.view.input_controller && render_ctx_.systems.camera_system && render_ctx_.view.camera)
+    {
+        // 시간 기반 이동은 update에서 끝났으므로 delta_time 0으로 마우스/스크롤 누적분만 반영한다
+        render_ctx_.view.input_controller->cameraUpdate(0.0f,
+                                                        *render_ctx_.systems.camera_system,
+                                                        *render_ctx_.view.camera);
     }
 }
 
@@ -90,7 +256,9 @@ void Engine::handleWindowResize(int width, int height)
 {
     const int clamped_width = std::max(width, 1);
     const int clamped_height = std::max(height, 1);
-    glViewport(0, 0, clamped_width, clamped_height);
+    // viewport는 다음 frame packet으로 렌더 스레드가 바꾼다
+    runtime_.framebuffer_width = clamped_width;
+    runtime_.framebuffer_height = clamped_height;
     if (render_ctx_.view.camera)
     {
         render_ctx_.view.camera->setAspectRatio(static_cast<float>(clamped_width) / static_cast<float>(clamped_height));
@@ -99,6 +267,8 @@ void Engine::handleWindowResize(int width, int height)
 
 void Engine::handleMouseMove(double xpos, double ypos)
 {
+    runtime_.cursor_x = xpos;
+    runtime_.cursor_y = ypos;
     if (render_ctx_.view.input_controller)
     {
         render_ctx_.view.input_controller->onMouseMove(xpos, ypos);
@@ -113,16 +283,62 @@ void Engine::handleMouseScroll(double /* offset_x */, double offset_y)
     }
 }
 
-void Engine::handleMouseButton(int button, int action)
+void Engine::handleMouseButton(int button, int action, double cursor_x, double cursor_y)
 {
-    if (action != GLFW_PRESS || button != GLFW_MOUSE_BUTTON_LEFT)
+    if (button != GLFW_MOUSE_BUTTON_LEFT || !scene_.world)
         return;
-    if (!render_ctx_.view.input_controller || !render_ctx_.view.camera || !render_ctx_.view.window || !scene_.world)
+    if (!runtime_.gpu_picking)
+    {
+        if (action == GLFW_PRESS)
+            pickWithRays(cursor_x, cursor_y);
         return;
+    }
 
-    double cursor_x = 0.0;
-    double cursor_y = 0.0;
-    glfwGetCursorPos(render_ctx_.view.window, &cursor_x, &cursor_y);
+    InputController *input_controller = render_ctx_.view.input_controller.get();
+    if (action == GLFW_PRESS)
+    {
+        runtime_.selection_drag = true;
+        runtime_.press_x = cursor_x;
+        runtime_.press_y = cursor_y;
+        // 드래그 중에 시점이 돌면 사각형이 장면과 어긋난다
+        if (input_controller)
+            input_controller->setMouseLook(false);
+        return;
+    }
+    if (action != GLFW_RELEASE || !runtime_.selection_drag)
+        return;
+    runtime_.selection_drag = false;
+    if (input_controller)
+        input_controller->setMouseLook(true);
+
+    // 조금 움직인 것은 클릭으로 보고 놓은 위치 한 픽셀만 읽는다
+    const glm::ivec2 press = toFramebufferPixel(runtime_.press_x, runtime_.press_y);
+    const glm::ivec2 release = toFramebufferPixel(cursor_x, cursor_y);
+    const glm::ivec2 extent = glm::abs(release - press);
+    EntityPickQuery query;
+    query.id = runtime_.next_pick_id++;
+    if (std::max(extent.x, extent.y) < kMarqueeMinPixels)
+    {
+        query.x = release.x;
+        query.y = release.y;
+    }
+    else
+    {
+        const glm::ivec2 low = glm::min(press, release);
+        query.x = low.x;
+        query.y = low.y;
+        query.width = extent.x + 1;
+        query.height = extent.y + 1;
+    }
+    // 늦게 끝난 이전 선택 결과는 버린다
+    runtime_.selection_pick_id = query.id;
+    runtime_.pick_queries.push_back(query);
+}
+
+void Engine::pickWithRays(double cursor_x, double cursor_y)
+{
+    if (!render_ctx_.view.input_controller || !render_ctx_.view.camera || !render_ctx_.view.window)
+        return;
 
     int window_width = 0;
     int window_height = 0;
@@ -131,13 +347,7 @@ void Engine::handleMouseButton(int button, int action)
     const glm::mat4 view = render_ctx_.view.camera->getViewMatrix();
     const glm::mat4 proj = render_ctx_.view.camera->getProjectionMatrix();
 
-    if (scene_.selected_entity)
-    {
-        scene_.world->removeComponent<SelectedComponent>(*scene_.selected_entity);
-        scene_.selected_entity.reset();
-    }
-
-    bool hit = false;
+    std::optional<entity_id> hit;
     scene_.world->forEachComponent<SelectableComponent>(
         [&](entity_id entity, SelectableComponent &)
         {
@@ -165,12 +375,105 @@ void Engine::handleMouseButton(int button, int action)
                                                                 view, proj, bounds_center,
                                                                 half_extents))
             {
-                scene_.world->addComponent<SelectedComponent>(entity, SelectedComponent{});
-                scene_.selected_entity = entity;
-                std::cerr << "[input] selected entity " << entity << std::endl;
-                hit = true;
+                hit = entity;
             }
         });
+
+    if (hit)
+    {
+        const std::uint32_t entity = *hit;
+        setSelection(std::span<const std::uint32_t>(&entity, 1));
+    }
+    else
+    {
+        setSelection({});
+    }
+}
+
+glm::ivec2 Engine::toFramebufferPixel(double cursor_x, double cursor_y) const
+{
+    int window_width = 0;
+    int window_height = 0;
+    glfwGetWindowSize(render_ctx_.view.window, &window_width, &window_height);
+    // HiDPI에서는 framebuffer가 창 좌표보다 크다
+    const double scale_x = static_cast<double>(runtime_.framebuffer_width) / static_cast<double>(std::max(window_width, 1));
+    const double scale_y = static_cast<double>(runtime_.framebuffer_height) / static_cast<double>(std::max(window_height, 1));
+    const int x = static_cast<int>(std::floor(cursor_x * scale_x));
+    const int y = runtime_.framebuffer_height - 1 - static_cast<int>(std::floor(cursor_y * scale_y));
+    return {std::clamp(x, 0, runtime_.framebuffer_width - 1), std::clamp(y, 0, runtime_.framebuffer_height - 1)};
+}
+
+void Engine::queueHoverPick()
+{
+    // 결과가 오기 전에는 새로 묻지 않아 readback 칸을 하나만 쓴다
+    if (runtime_.hover_pick_id != 0 || runtime_.selection_drag || runtime_.cursor_x < 0.0 || runtime_.cursor_y < 0.0)
+        return;
+    int window_width = 0;
+    int window_height = 0;
+    glfwGetWindowSize(render_ctx_.view.window, &window_width, &window_height);
+    if (runtime_.cursor_x >= window_width || runtime_.cursor_y >= window_height)
+    {
+        scene_.hovered_entity.reset();
+        return;
+    }
+
+    const glm::ivec2 pixel = toFramebufferPixel(runtime_.cursor_x, runtime_.cursor_y);
+    EntityPickQuery query;
+    query.id = runtime_.next_pick_id++;
+    query.x = pixel.x;
+    query.y = pixel.y;
+    runtime_.hover_pick_id = query.id;
+    runtime_.pick_queries.push_back(query);
+}
+
+void Engine::applyPickResults()
+{
+    PROFILE_SCOPE("Engine::applyPickResults");
+    EntityPickResults &picks = runtime_.pick_results;
+    render_ctx_.view.render_thread->takePickResults(picks);
+    for (const EntityPickResult &result : picks.results)
+    {
+        if (result.id == runtime_.hover_pick_id)
+        {
+            runtime_.hover_pick_id = 0;
+            scene_.hovered_entity.reset();
+            // 그 사이 지워진 entity일 수 있으므로 지금 선택 가능한지 다시 본다
+            if (result.ok && result.center != kNoRenderEntity &&
+                scene_.world->getComponent<SelectableComponent>(result.center))
+            {
+                scene_.hovered_entity = result.center;
+            }
+        }
+        else if (result.id == runtime_.selection_pick_id)
+        {
+            runtime_.selection_pick_id = 0;
+            if (!result.ok)
+            {
+                std::cerr << "[input] selection pick failed" << std::endl;
+                continue;
+            }
+            setSelection(picks.entitiesOf(result));
+        }
+    }
+}
+
+void Engine::setSelection(std::span<const std::uint32_t> entities)
+{
+    for (entity_id entity : scene_.selected_entities)
+        scene_.world->removeComponent<SelectedComponent>(entity);
+    scene_.selected_entities.clear();
+
+    for (std::uint32_t entity : entities)
+    {
+        if (!scene_.world->getComponent<SelectableComponent>(entity))
+            continue;
+        scene_.world->addComponent<SelectedComponent>(entity, SelectedComponent{});
+        scene_.selected_entities.push_back(entity);
+    }
+    if (scene_.selected_entities.size() == 1)
+        std::cerr << "[input] selected entity " << scene_.selected_entities.front() << std::endl;
+    else if (!scene_.selected_entities.empty())
+        std::cerr << "[input] selected " << scene_.selected_entities.size() << " entities" << std::endl;
 }
 
 void Engine::init()
@@ -185,11 +488,53 @@ void Engine::init()
     }
 
     render_ctx_.view.window = render_ctx_.view.renderer->getWindowPtr();
+    glfwGetFramebufferSize(render_ctx_.view.window, &runtime_.framebuffer_width, &runtime_.framebuffer_height);
+    runtime_.framebuffer_width = std::max(runtime_.framebuffer_width, 1);
+    runtime_.framebuffer_height = std::max(runtime_.framebuffer_height, 1);
 
     scene_.world = std::make_unique<World>();
     render_ctx_.systems.render_system = std::make_unique<RenderSystem>();
+    render_ctx_.systems.lighting_system = std::make_unique<LightingSystem>();
+    render_ctx_.systems.occlusion_culler = std::make_unique<OcclusionCuller>();
+
+    // 기본 메시는 상자라 차로를 따라 달리는 차량도 AABB로 충분하고, 비스듬히 돈 경우만 삼각형으로 잡힌다
+    render_ctx_.systems.lidar_system = std::make_unique<LidarSystem>();
+    for (const auto &[mesh_id, mesh] : {std::pair{MeshId::Cube, Primitives::createCube()},
+                                        std::pair{MeshId::Plane, Primitives::createPlane(1.0f, 1.0f)}})
+    {
+        const std::vector<glm::vec3> positions = meshPositions(mesh);
+        render_ctx_.systems.lidar_system->setMeshTriangles(static_cast<int>(mesh_id), positions, mesh.indices, true);
+    }
 
-    scene_.ground_id = Prefabs::createGround(*scene_.world, static_cast<int>(MeshId::Plane), 50.0f);
+    render_ctx_.systems.camera_sensor_system = std::make_unique<CameraSensorSystem>();
+
+    // 그림자를 만드는 태양광
+    const entity_id sun = scene_.world->newEntity();
+    LightComponent sun_light{};
+    sun_light.type = LightType::Directional;
+    sun_light.direction = glm::normalize(glm::vec3{-0.4f, -1.0f, -0.3f});
+    sun_light.color = {1.0f, 0.97f, 0.9f};
+    sun_light.intensity = 0.85f;
+    scene_.world->addComponent<LightComponent>(sun, std::move(sun_light));
+
+    Material ground_material;
+    ground_material.base_color = {0.22f, 0.22f, 0.24f};
+    ground_material.use_grid = true;
+
+    // material은 렌더 스레드가 뜨기 전에 등록해 둔다. 타일 로드는 handle만 쓴다
+    CityTileConfig city;
+    city.tiles_per_side = kCityTilesPerSide;
+    city.tile_size = kCityTileSize;
+    city.ground_mesh_id = static_cast<int>(MeshId::Plane);
+    city.building_mesh_id = static_cast<int>(MeshId::Cube);
+    city.ground_material = render_ctx_.view.renderer->registerMaterial(ground_material);
+    for (const glm::vec3 &color : {glm::vec3{0.55f, 0.53f, 0.5f}, glm::vec3{0.45f, 0.47f, 0.52f}, glm::vec3{0.6f, 0.56f, 0.48f}})
+    {
+        Material building_material;
+        building_material.base_color = color;
+        city.building_materials.push_back(render_ctx_.view.renderer->registerMaterial(building_material));
+    }
+    scene_.world_streamer = std::make_unique<WorldStreamer>(std::make_shared<CityTileSource>(std::move(city)));
 
     CameraConfig camera_config;
     camera_config.aspect_ratio = static_cast<float>(kWidth) / static_cast<float>(kHeight);
@@ -206,64 +551,162 @@ void Engine::setupCallback()
     glfwSetCursorPosCallback(render_ctx_.view.window, mouse_callback);
     glfwSetMouseButtonCallback(render_ctx_.view.window, mouse_button_callback);
     glfwSetScrollCallback(render_ctx_.view.window, scroll_callback);
+    glfwSetKeyCallback(render_ctx_.view.window, key_callback);
     glfwSetInputMode(render_ctx_.view.window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
 }
 
 void Engine::loadAssets()
 {
     // TODO(jyan): MVP는 일단 임시로 이렇게.. 나중에 수정 필요
-    auto spawn_vehicle = [&](const glm::vec3 &position,
-                             const glm::vec3 &color,
-                             const glm::vec3 &scale) -> entity_id
-    {
-        entity_id body = scene_.world->newEntity();
-        scene_.world->addComponent<TransformComponent>(body, TransformComponent{position, {}, scale});
-        scene_.world->addComponent<RenderableComponent>(body, RenderableComponent{static_cast<int>(MeshId::Cube), color, false});
-        scene_.world->addComponent<SelectableComponent>(body, SelectableComponent{});
-        const glm::vec3 body_half_extents = scale * 0.5f;
-        scene_.world->addComponent<PickBoundsComponent>(body, PickBoundsComponent{body_half_extents, {}});
-
-        // roof
-        const glm::vec3 roof_scale = glm::vec3(scale.x * 0.6f, scale.y * 0.5f, scale.z * 0.6f);
-        const glm::vec3 roof_pos = position + glm::vec3(0.0f, (scale.y + roof_scale.y) * 0.5f, 0.0f);
-        entity_id roof = scene_.world->newEntity();
-        scene_.world->addComponent<TransformComponent>(roof, TransformComponent{roof_pos, {}, roof_scale});
-        scene_.world->addComponent<RenderableComponent>(roof, RenderableComponent{static_cast<int>(MeshId::Cube), color, false});
-
-        return body;
+    auto make_material = [&](const glm::vec3 &color) -> MaterialHandle
+    {
+        Material material;
+        material.base_color = color;
+        return render_ctx_.view.renderer->registerMaterial(material);
     };
 
     auto spawn_traffic_light = [&](const glm::vec3 &position,
-                                   const glm::vec3 &color,
+                                   MaterialHandle material,
                                    const glm::vec3 &scale) -> entity_id
     {
         entity_id cube = scene_.world->newEntity();
         const glm::vec3 grounded_pos = position + glm::vec3(0.0f, scale.y * 0.5f, 0.0f);
         scene_.world->addComponent<TransformComponent>(cube, TransformComponent{grounded_pos, {}, scale});
-        scene_.world->addComponent<RenderableComponent>(cube, RenderableComponent{static_cast<int>(MeshId::Cube), color, false});
+        RenderableComponent renderable{static_cast<int>(MeshId::Cube), material};
+        renderable.is_static = true;
+        scene_.world->addComponent<RenderableComponent>(cube, std::move(renderable));
         scene_.world->addComponent<SelectableComponent>(cube, SelectableComponent{});
         const glm::vec3 half_extents = scale * 0.5f;
         scene_.world->addComponent<PickBoundsComponent>(cube, PickBoundsComponent{half_extents, {}});
         return cube;
     };
 
-    spawn_vehicle({-4.0f, 1.0f, -5.0f},
-                  {0.7f, 0.3f, 0.3f},
-                  {1.6f, 1.0f, 3.2f});
+    Prefabs::createVehicle(*scene_.world, static_cast<int>(MeshId::Cube), make_material({0.7f, 0.3f, 0.3f}),
+                           {-4.0f, 1.0f, -5.0f}, kVehicleScale);
 
     spawn_traffic_light({4.0f, 0.0f, -3.0f},
-                        {0.3f, 0.6f, 1.0f},
+                        make_material({0.3f, 0.6f, 1.0f}),
                         {0.35f, 3.0f, 0.35f});
 }
 
+void Engine::spawnMeshFiles(const std::vector<std::string> &paths)
+{
+    if (paths.empty())
+        return;
+
+    Material material;
+    material.base_color = glm::vec3(0.75f, 0.75f, 0.7f);
+    const MaterialHandle material_handle = render_ctx_.view.renderer->registerMaterial(material);
+    for (std::size_t i = 0; i < paths.size(); ++i)
+    {
+        // 렌더 스레드가 뜨기 전이라 직접 등록한다. 파싱과 LOD 생성은 워커에서, 업로드는 렌더 스레드의
+        // processUploads에서 끝나며 그 전까지 이 entity는 그려지지 않는다
+        const int mesh_id = render_ctx_.view.renderer->registerMesh(paths[i]);
+        const entity_id entity = scene_.world->newEntity();
+        const glm::vec3 position = kMeshFileOrigin + glm::vec3(static_cast<float>(i) * kMeshFileSpacing, 0.0f, 0.0f);
+        scene_.world->addComponent<TransformComponent>(entity, TransformComponent{position, {}, glm::vec3(1.0f)});
+        RenderableComponent renderable{mesh_id, material_handle};
+        renderable.is_static = true;
+        scene_.world->addComponent<RenderableComponent>(entity, std::move(renderable));
+        std::clog << "[engine] loading mesh " << paths[i] << " (id=" << mesh_id << ")" << std::endl;
+    }
+}
+
+void Engine::spawnTraffic(std::size_t agent_count, std::size_t lidar_count, std::size_t camera_count)
+{
+    if (agent_count == 0)
+        return;
+
+    // 블록 하나에 차로가 약 4개이므로 차로당 한 대 정도가 되도록 넓히되 도시 지도를 넘지 않는다
+    const int max_blocks = static_cast<int>(kCityTilesPerSide * kCityTileSize / kRoadBlockSize);
+    int blocks = std::clamp(static_cast<int>(std::ceil(std::sqrt(static_cast<double>(agent_count) / 4.0))),
+                            kMinRoadBlocks, max_blocks);
+    // 원점이 블록 경계에 오도록 짝수로 맞춘다
+    blocks -= blocks % 2;
+    GridRoadConfig road;
+    road.blocks_x = blocks;
+    road.blocks_z = blocks;
+    road.block_size = kRoadBlockSize;
+    road.origin = glm::vec3(-0.5f * static_cast<float>(blocks) * kRoadBlockSize, 0.0f, -0.5f * static_cast<float>(blocks) * kRoadBlockSize);
+    scene_.road_network = std::make_unique<LaneGraph>(buildGridRoadNetwork(road));
+    render_ctx_.systems.traffic_system = std::make_unique<TrafficSystem>(*scene_.road_network);
+
+    std::vector<MaterialHandle> materials;
+    for (const glm::vec3 &color : {glm::vec3{0.7f, 0.3f, 0.3f}, glm::vec3{0.25f, 0.45f, 0.75f}, glm::vec3{0.85f, 0.8f, 0.75f}, glm::vec3{0.2f, 0.2f, 0.22f}})
+    {
+        Material material;
+        material.base_color = color;
+        materials.push_back(render_ctx_.view.renderer->registerMaterial(material));
+    }
+
+    // 차로마다 차량 길이의 두 배 간격으로 채워 나간다
+    const LaneGraph &graph = *scene_.road_network;
+    const float spacing = kVehicleScale.z * 2.0f;
+    const std::size_t lane_count = graph.laneCount();
+    for (std::size_t i = 0; i < agent_count; ++i)
+    {
+        const auto lane = static_cast<lane_id>(i % lane_count);
+        const float offset = static_cast<float>(i / lane_count) * spacing;
+        if (offset > graph.laneLength(lane))
+            break;
+        const glm::vec3 position = graph.pointAt(lane, offset) + glm::vec3(0.0f, kVehicleScale.y * 0.5f, 0.0f);
+        const VehicleEntities vehicle = Prefabs::createVehicle(*scene_.world, static_cast<int>(MeshId::Cube),
+                                                               materials[i % materials.size()], position, kVehicleScale);
+        const entity_id parts[] = {vehicle.body, vehicle.roof};
+        if (i < lidar_count)
+        {
+            LidarComponent lidar;
+            lidar.mount_offset = glm::vec3(0.0f, kVehicleScale.y * 0.25f + kLidarMountClearance, 0.0f);
+            scene_.world->addComponent<LidarComponent>(vehicle.roof, std::move(lidar));
+        }
+        if (i < camera_count)
+        {
+            CameraSensorComponent camera;
+            camera.mount_offset = glm::vec3(0.0f, kVehicleScale.y * 0.25f, kVehicleScale.z * 0.5f + kCameraMountForward);
+            scene_.world->addComponent<CameraSensorComponent>(vehicle.body, std::move(camera));
+        }
+        // 도심 주행 속도 30~50 km/h
+        const float desired_speed = 8.0f + static_cast<float>((i * 2654435761u) % 1000u) * 0.006f;
+        render_ctx_.systems.traffic_system->addVehicle(*scene_.world, parts, lane, offset, desired_speed);
+    }
+    std::clog << "[engine] traffic: " << render_ctx_.systems.traffic_system->model().agentCount() << " vehicles on "
+              << lane_count << " lanes" << std::endl;
+}
+
 void Engine::proccessInput(float delta_time)
 {
+    PROFILE_SCOPE("Engine::proccessInput");
+    runtime_.input_events_this_frame = 0;
+    drainInput();
+
     if (glfwGetKey(render_ctx_.view.window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
         glfwSetWindowShouldClose(render_ctx_.view.window, true);
+
+    // F12: 최근 프레임들의 CPU/GPU trace 저장
+    const bool trace_key_down = glfwGetKey(render_ctx_.view.window, GLFW_KEY_F12) == GLFW_PRESS;
+    if (trace_key_down && !runtime_.trace_key_down)
+    {
+        if (Profiler::instance().writeChromeTrace(kTracePath))
+            std::clog << "[profiler] chrome trace written: " << kTracePath << std::endl;
+        else
+            std::cerr << "[profiler] failed to write " << kTracePath << "\n";
+    }
+    runtime_.trace_key_down = trace_key_down;
+
+    // F11: pacing 모드 순환 (vsync -> uncapped -> capped -> low-latency)
+    const bool pacing_key_down = glfwGetKey(render_ctx_.view.window, GLFW_KEY_F11) == GLFW_PRESS;
+    if (pacing_key_down && !runtime_.pacing_key_down)
+    {
+        FramePacerConfig config = runtime_.frame_pacer.config();
+        config.mode = static_cast<FramePacing>((static_cast<int>(config.mode) + 1) % kFramePacingCount);
+        this->applyFramePacing(config);
+    }
+    runtime_.pacing_key_down = pacing_key_down;
 }
 
 void Engine::update(float delta_time)
 {
+    PROFILE_SCOPE("Engine::update");
     if (!scene_.world || !render_ctx_.view.camera || !render_ctx_.systems.camera_system)
         return;
 
@@ -273,13 +716,167 @@ void Engine::update(float delta_time)
                                                         *render_ctx_.systems.camera_system,
                                                         *render_ctx_.view.camera);
     }
+
+    if (render_ctx_.systems.traffic_system)
+        render_ctx_.systems.traffic_system->update(*scene_.world, delta_time);
+
+    // 차량이 움직인 뒤의 장면을 스캔한다. 메시 AABB는 렌더 스레드 표의 사본에서 읽는다
+    if (render_ctx_.systems.lidar_system && render_ctx_.view.render_thread)
+    {
+        render_ctx_.systems.lidar_system->update(*scene_.world, delta_time,
+                                                 render_ctx_.view.render_thread->meshLodTable());
+    }
+
+    if (render_ctx_.systems.camera_sensor_system)
+        render_ctx_.systems.camera_sensor_system->update(*scene_.world, delta_time);
+
+    if (scene_.world_streamer)
+        scene_.world_streamer->update(*scene_.world, render_ctx_.systems.camera_system->getPivot());
 }
 
 void Engine::render()
 {
-    RenderQueue render_queue;
-    render_ctx_.systems.render_system->buildRenderQueue(*scene_.world, render_queue);
-    const glm::mat4 view = render_ctx_.view.camera->getViewMatrix();
-    const glm::mat4 projection = render_ctx_.view.camera->getProjectionMatrix();
-    render_ctx_.view.renderer->draw(render_queue, view, projection);
+    PROFILE_SCOPE("Engine::render");
+    RenderThread &render_thread = *render_ctx_.view.render_thread;
+    FramePacket packet(&runtime_.frame_allocator.current());
+    packet.upload_budget_ms = kMeshUploadBudgetMs;
+    packet.viewport_width = runtime_.framebuffer_width;
+    packet.viewport_height = runtime_.framebuffer_height;
+
+    // 첫 번째 방향광이 그림자와 조명을 맡는다
+    render_ctx_.systems.lighting_system->update(*scene_.world, runtime_.frame_allocator.current());
+    for (const GpuLight &light : render_ctx_.systems.lighting_system->getGpuLights())
+    {
+        if (static_cast<LightType>(static_cast<int>(light.position.w)) != LightType::Directional)
+            continue;
+        packet.has_directional_light = true;
+        packet.light_direction = glm::vec3(light.direction);
+        packet.light_color = glm::vec3(light.color) * light.color.w;
+        packet.ambient_color = kAmbientLight;
+        break;
+    }
+
+    // 카메라 행렬은 여기서 처음 읽으므로 그 직전에 입력을 다시 받는다
+    lateLatchInput();
+    if (runtime_.gpu_picking)
+    {
+        applyPickResults();
+        queueHoverPick();
+    }
+    packet.pick_queries.assign(runtime_.pick_queries.begin(), runtime_.pick_queries.end());
+    runtime_.pick_queries.clear();
+    packet.highlight_entity = scene_.hovered_entity.value_or(kNoRenderEntity);
+
+    const Camera &camera = *render_ctx_.view.camera;
+    RenderView render_view;
+    render_view.camera_position = camera.getPosition();
+    render_view.pixels_per_unit = static_cast<float>(runtime_.framebuffer_height) /
+                                  (2.0f * std::tan(glm::radians(camera.getFov()) * 0.5f));
+    render_view.mesh_lods = &render_thread.meshLodTable();
+    render_view.material_variants = &render_thread.materialVariants();
+    packet.view = camera.getViewMatrix();
+    packet.projection = camera.getProjectionMatrix();
+    render_view.view_projection = packet.projection * packet.view;
+    render_view.frustum_culling = true;
+    render_view.occlusion = render_ctx_.systems.occlusion_culler.get();
+    render_view.shadow_casters = runtime_.shadows && packet.has_directional_light;
+    if (render_view.shadow_casters)
+    {
+        const ShadowCasterBounds bounds = CascadedShadowMap::casterBounds(packet.projection);
+        render_view.light_direction = glm::normalize(packet.light_direction);
+        render_view.shadow_radius = bounds.radius;
+        render_view.shadow_depth = bounds.depth;
+    }
+
+    render_ctx_.systems.render_system->buildRenderQueue(*scene_.world, render_view, packet.queue);
+    const std::size_t render_items = packet.queue.opaque.size() + packet.queue.transparent.size();
+    // 카메라 센서는 화면을 그린 뒤 같은 packet으로 렌더 스레드에서 찍는다
+    if (render_ctx_.systems.camera_sensor_system)
+    {
+        render_ctx_.systems.camera_sensor_system->buildViews(*scene_.world, render_view, packet.camera_sensors,
+                                                             &runtime_.frame_allocator.current());
+    }
+    packet.input_timestamp_ns = runtime_.pending_click_ns;
+    runtime_.pending_click_ns = -1;
+    // 렌더 스레드가 두 프레임 뒤처져 있을 때만 블록한다
+    render_thread.submit(std::move(packet));
+
+    // 통계는 렌더 스레드가 마지막으로 끝낸 프레임 기준
+    Profiler &profiler = Profiler::instance();
+    const FrameResult result = render_thread.lastResult();
+    profiler.setCounter("draw calls", static_cast<double>(result.render.draw_calls));
+    profiler.setCounter("instances", static_cast<double>(result.render.instances));
+    profiler.setCounter("triangles", static_cast<double>(result.render.triangles));
+    profiler.setCounter("GL state changes", static_cast<double>(result.state.issued));
+    profiler.setCounter("render items", static_cast<double>(render_items));
+    if (result.frame != runtime_.last_result_frame)
+    {
+        if (result.input_to_swap_ms >= 0.0)
+            profiler.setCounter("click to swap ms", result.input_to_swap_ms);
+        runtime_.frame_pacer.onPresent(result.present_ns, result.render_work_ns);
+    }
+    runtime_.last_result_frame = result.frame;
+    profiler.setCounter("pacing wait ms", runtime_.frame_pacer.lastWaitMs());
+    if (scene_.world_streamer)
+    {
+        const WorldStreamerStats &stream_stats = scene_.world_streamer->stats();
+        profiler.setCounter("streamed tiles", static_cast<double>(stream_stats.resident_tiles));
+        profiler.setCounter("streamed entities", static_cast<double>(stream_stats.streamed_entities));
+    }
+    const RenderSystem::CullStats &cull_stats = render_ctx_.systems.render_system->getCullStats();
+    profiler.setCounter("frustum culled", static_cast<double>(cull_stats.frustum_culled));
+    profiler.setCounter("occlusion culled", static_cast<double>(cull_stats.occlusion_culled));
+    profiler.setCounter("occluders", static_cast<double>(cull_stats.occluders));
+    profiler.setCounter("input events", static_cast<double>(runtime_.input_events_this_frame));
+    profiler.setCounter("input dropped", static_cast<double>(runtime_.dropped_input_events));
+}
+
+void Engine::reportFrameStats()
+{
+    const double now = glfwGetTime();
+    if (now - runtime_.last_frame_stats_report_time < kFrameStatsInterval)
+        return;
+    runtime_.last_frame_stats_report_time = now;
+
+    const FrameTimeStats stats = Profiler::instance().frameTimeStats();
+    if (stats.frame_count == 0)
+        return;
+    const RenderStats render_stats = render_ctx_.view.render_thread->lastResult().render;
+    std::clog << "[profiler] frame time p50 " << stats.p50_ms << " ms, p99 " << stats.p99_ms << " ms, mean "
+              << stats.mean_ms << " ms, stddev " << stats.stddev_ms << " ms (" << stats.frame_count
+              << " frames) | interval " << stats.interval_mean_ms << " +/- " << stats.interval_stddev_ms << " ms ("
+              << framePacingName(runtime_.frame_pacer.config().mode) << ") | draws " << render_stats.draw_calls
+              << ", triangles " << render_stats.triangles << std::endl;
+    if (render_ctx_.systems.lidar_system && render_ctx_.systems.lidar_system->sensorCount() > 0)
+    {
+        const LidarSystem &lidar = *render_ctx_.systems.lidar_system;
+        std::clog << "[lidar] " << lidar.sensorCount() << " sensors, " << lidar.raysLastUpdate() << " rays last frame, bvh "
+                  << lidar.bvh().primitiveCount() << " primitives" << std::endl;
+    }
+    const CameraSensorStats camera_stats = render_ctx_.view.render_thread->lastResult().camera;
+    if (camera_stats.sensors > 0)
+    {
+        std::clog << "[camera] " << camera_stats.sensors << " sensors, " << camera_stats.rendered << " images rendered, "
+                  << camera_stats.delivered << " delivered, " << camera_stats.dropped << " dropped, "
+                  << camera_stats.pending_readbacks << " readbacks in flight" << std::endl;
+    }
+}
+
+void Engine::reportFrameAllocations()
+{
+    // 워밍업 이후에도 프레임 안에서 힙 할당이 생기면 주기적으로 알린다
+    if (!HeapStats::enabled() || runtime_.heap_allocations_last_frame == 0)
+        return;
+    if (runtime_.frame_allocator.frameNumber() < kAllocationWarmupFrames)
+        return;
+
+    const double now = glfwGetTime();
+    if (now - runtime_.last_allocation_report_time < kAllocationReportInterval)
+        return;
+    runtime_.last_allocation_report_time = now;
+
+    const LinearArena &arena = runtime_.frame_allocator.current();
+    std::clog << "[engine] " << runtime_.heap_allocations_last_frame << " heap allocations in frame "
+              << runtime_.frame_allocator.frameNumber() << " (frame arena " << arena.used() << "/"
+              << arena.capacity() << " bytes, overflows " << arena.overflowCount() << ")" << std::endl;
 }
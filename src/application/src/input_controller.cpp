@@ -1,6 +1,7 @@
 #include "input_controller.hpp"
 #include "camera.hpp"
 #include "camera_system.hpp"
+#include "ray_bvh.hpp"
 #define GLFW_INCLUDE_NONE
 #include <GLFW/glfw3.h>
 #include <algorithm>
@@ -8,6 +9,12 @@
 #include <glm/gtc/matrix_inverse.hpp>
 #include <limits>
 
+namespace
+{
+// W/A/S/D로 pivot을 옮기는 속도 (m/s)
+constexpr float kPivotPanSpeed = 20.0f;
+} // namespace
+
 void InputController::onMouseMove(double xpos, double ypos)
 {
     if (first_mouse_)
@@ -22,6 +29,8 @@ void InputController::onMouseMove(double xpos, double ypos)
     const double d_y = last_y_ - ypos;
     last_x_ = xpos;
     last_y_ = ypos;
+    if (!mouse_look_)
+        return;
 
     mouse_dx_ += static_cast<float>(d_x);
     mouse_dy_ += static_cast<float>(d_y);
@@ -60,6 +69,22 @@ void InputController::onScroll(double yoffset)
 
 void InputController::cameraUpdate(float delta_time, CameraSystem &camera_system, Camera &camera)
 {
+    const float forward_input = (input_.w ? 1.0f : 0.0f) - (input_.s ? 1.0f : 0.0f);
+    const float right_input = (input_.d ? 1.0f : 0.0f) - (input_.a ? 1.0f : 0.0f);
+    if ((forward_input != 0.0f || right_input != 0.0f) && delta_time > 0.0f)
+    {
+        // 바라보는 방향을 지면에 투영해 이동 방향으로 쓴다
+        glm::vec3 forward = camera.getOrientation() * glm::vec3(0.0f, 0.0f, -1.0f);
+        forward.y = 0.0f;
+        if (glm::dot(forward, forward) > 1e-6f)
+        {
+            forward = glm::normalize(forward);
+            const glm::vec3 right = glm::normalize(glm::cross(forward, glm::vec3(0.0f, 1.0f, 0.0f)));
+            const glm::vec3 direction = glm::normalize(forward * forward_input + right * right_input);
+            camera_system.setPivot(camera_system.getPivot() + direction * kPivotPanSpeed * delta_time);
+        }
+    }
+
     camera_system.update(mouse_dx_,
                          mouse_dy_,
                          scroll_y_,
@@ -103,34 +128,8 @@ bool InputController::rayIntersectsAABB(const glm::vec3 &ray_origin,
                                         const glm::vec3 &aabb_min,
                                         const glm::vec3 &aabb_max)
 {
-    float tmin = -std::numeric_limits<float>::infinity();
-    float tmax = std::numeric_limits<float>::infinity();
-
-    for (int axis = 0; axis < 3; ++axis)
-    {
-        const float origin = ray_origin[axis];
-        const float dir = ray_dir[axis];
-        const float minv = aabb_min[axis];
-        const float maxv = aabb_max[axis];
-
-        if (std::abs(dir) < 1e-6f)
-        {
-            if (origin < minv || origin > maxv)
-                return false;
-            continue;
-        }
-
-        const float inv_dir = 1.0f / dir;
-        float t1 = (minv - origin) * inv_dir;
-        float t2 = (maxv - origin) * inv_dir;
-        if (t1 > t2)
-            std::swap(t1, t2);
-
-        tmin = std::max(tmin, t1);
-        tmax = std::min(tmax, t2);
-        if (tmax < tmin)
-            return false;
-    }
-
-    return tmax >= 0.0f;
+    // 원점이 상자 안이어도 맞은 것으로 본다
+    float t_enter = 0.0f;
+    return intersectRayAabb(ray_origin, safeInverseDirection(ray_dir), aabb_min, aabb_max,
+                            0.0f, std::numeric_limits<float>::infinity(), t_enter);
 }
\ No newline at end of file
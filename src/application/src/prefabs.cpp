@@ -5,20 +5,21 @@
 
 namespace Prefabs
 {
-entity_id createGround(World &world, int mesh_id, float size)
+VehicleEntities createVehicle(World &world, int mesh_id, std::uint32_t material_id, const glm::vec3 &position, const glm::vec3 &scale)
 {
-    entity_id entity = world.newEntity();
+    const entity_id body = world.newEntity();
+    world.addComponent<TransformComponent>(body, TransformComponent{position, {}, scale});
+    world.addComponent<RenderableComponent>(body, RenderableComponent{mesh_id, material_id});
+    world.addComponent<SelectableComponent>(body, SelectableComponent{});
+    world.addComponent<PickBoundsComponent>(body, PickBoundsComponent{scale * 0.5f, {}});
 
-    TransformComponent transform{};
-    transform.scale = glm::vec3(size, 1.0f, size); // 평면을 원하는 크기로 확장
-    world.addComponent<TransformComponent>(entity, std::move(transform));
+    const glm::vec3 roof_scale = glm::vec3(scale.x * 0.6f, scale.y * 0.5f, scale.z * 0.6f);
+    const glm::vec3 roof_position = position + glm::vec3(0.0f, (scale.y + roof_scale.y) * 0.5f, 0.0f);
+    const entity_id roof = world.newEntity();
+    world.addComponent<TransformComponent>(roof, TransformComponent{roof_position, {}, roof_scale});
+    world.addComponent<RenderableComponent>(roof, RenderableComponent{mesh_id, material_id});
+    world.addComponent<PartOfComponent>(roof, PartOfComponent{body});
 
-    RenderableComponent renderable{};
-    renderable.mesh_id = mesh_id;
-    renderable.color = {0.22f, 0.22f, 0.24f};
-    renderable.use_grid = true; // 그리드 패턴 표시
-    world.addComponent<RenderableComponent>(entity, std::move(renderable));
-
-    return entity;
+    return VehicleEntities{body, roof};
 }
 } // namespace Prefabs
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "tile_quadtree.hpp"
+
+#include <algorithm>
+
+namespace
+{
+float distanceToRect(const glm::vec2 &point, const glm::vec2 &rect_min, const glm::vec2 &rect_max)
+{
+    const glm::vec2 closest = glm::clamp(point, rect_min, rect_max);
+    return glm::length(point - closest);
+}
+} // namespace
+
+void TileQuadtree::build(const std::vector<TileCoord> &tiles, float tile_size)
+{
+    nodes_.clear();
+    tile_size_ = tile_size;
+    tile_count_ = 0;
+    if (tiles.empty())
+        return;
+
+    std::vector<TileCoord> sorted = tiles;
+    std::sort(sorted.begin(), sorted.end(), [](const TileCoord &a, const TileCoord &b)
+              { return a.z != b.z ? a.z < b.z : a.x < b.x; });
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    tile_count_ = sorted.size();
+
+    std::int32_t min_x = sorted.front().x;
+    std::int32_t max_x = min_x;
+    std::int32_t min_z = sorted.front().z;
+    std::int32_t max_z = min_z;
+    for (const TileCoord &coord : sorted)
+    {
+        min_x = std::min(min_x, coord.x);
+        max_x = std::max(max_x, coord.x);
+        min_z = std::min(min_z, coord.z);
+        max_z = std::max(max_z, coord.z);
+    }
+    // 사분면이 정확히 나뉘도록 루트는 2의 거듭제곱 크기
+    std::int32_t size = 1;
+    while (size < max_x - min_x + 1 || size < max_z - min_z + 1)
+        size *= 2;
+
+    nodes_.reserve(tile_count_ * 2);
+    buildNode(sorted, 0, sorted.size(), min_x, min_z, size);
+}
+
+std::int32_t TileQuadtree::buildNode(std::vector<TileCoord> &tiles, std::size_t begin, std::size_t end,
+                                     std::int32_t min_x, std::int32_t min_z, std::int32_t size)
+{
+    if (begin == end)
+        return kNoNode;
+
+    const auto index = static_cast<std::int32_t>(nodes_.size());
+    nodes_.push_back(Node{min_x, min_z, size, {kNoNode, kNoNode, kNoNode, kNoNode}});
+    if (size == 1)
+        return index;
+
+    // [begin, end)를 z, x 기준으로 두 번 나눠 네 사분면으로 만든다
+    const std::int32_t half = size / 2;
+    const auto first = tiles.begin() + static_cast<std::ptrdiff_t>(begin);
+    const auto last = tiles.begin() + static_cast<std::ptrdiff_t>(end);
+    const auto z_split = std::partition(first, last, [&](const TileCoord &c)
+                                        { return c.z < min_z + half; });
+    const auto low_x_split = std::partition(first, z_split, [&](const TileCoord &c)
+                                            { return c.x < min_x + half; });
+    const auto high_x_split = std::partition(z_split, last, [&](const TileCoord &c)
+                                             { return c.x < min_x + half; });
+
+    auto offset = [&](auto it)
+    { return static_cast<std::size_t>(it - tiles.begin()); };
+    const std::array<std::int32_t, 4> children{
+        buildNode(tiles, begin, offset(low_x_split), min_x, min_z, half),
+        buildNode(tiles, offset(low_x_split), offset(z_split), min_x + half, min_z, half),
+        buildNode(tiles, offset(z_split), offset(high_x_split), min_x, min_z + half, half),
+        buildNode(tiles, offset(high_x_split), end, min_x + half, min_z + half, half),
+    };
+    // 재귀 중에 nodes_가 커질 수 있으므로 참조를 잡지 않고 마지막에 쓴다
+    nodes_[static_cast<std::size_t>(index)].children = children;
+    return index;
+}
+
+void TileQuadtree::query(const glm::vec2 &center, float radius, std::vector<TileCoord> &out) const
+{
+    if (nodes_.empty())
+        return;
+
+    // 깊이당 형제 노드 3개씩만 쌓이므로 32단계 트리도 충분하다
+    std::int32_t stack[128];
+    std::size_t stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const Node &node = nodes_[static_cast<std::size_t>(stack[--stack_size])];
+        const glm::vec2 node_min = glm::vec2(static_cast<float>(node.min_x), static_cast<float>(node.min_z)) * tile_size_;
+        const glm::vec2 node_max = node_min + glm::vec2(static_cast<float>(node.size) * tile_size_);
+        if (distanceToRect(center, node_min, node_max) > radius)
+            continue;
+
+        if (node.size == 1)
+        {
+            out.push_back(TileCoord{node.min_x, node.min_z});
+            continue;
+        }
+        for (const std::int32_t child : node.children)
+        {
+            if (child != kNoNode)
+                stack[stack_size++] = child;
+        }
+    }
+}
+
+float TileQuadtree::distanceToTile(const glm::vec2 &point, TileCoord coord, float tile_size)
+{
+    const glm::vec2 tile_min = glm::vec2(static_cast<float>(coord.x), static_cast<float>(coord.z)) * tile_size;
+    return distanceToRect(point, tile_min, tile_min + glm::vec2(tile_size));
+}
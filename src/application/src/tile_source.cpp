@@ -0,0 +1,88 @@
+#include "tile_source.hpp"
+
+#include <algorithm>
+#include <random>
+#include <utility>
+
+namespace
+{
+// 블록 가장자리에 남기는 도로 폭의 절반
+constexpr float kStreetHalfWidth = 2.0f;
+
+std::uint32_t tileSeed(TileCoord coord)
+{
+    // 좌표 두 개를 섞는다 (큰 소수 곱 + xor)
+    const auto x = static_cast<std::uint32_t>(coord.x);
+    const auto z = static_cast<std::uint32_t>(coord.z);
+    return (x * 73856093u) ^ (z * 19349663u) ^ 0x9e3779b9u;
+}
+} // namespace
+
+CityTileSource::CityTileSource(CityTileConfig config)
+    : config_(std::move(config))
+{
+    config_.tiles_per_side = std::max(1, config_.tiles_per_side);
+    config_.blocks_per_side = std::max(1, config_.blocks_per_side);
+}
+
+std::vector<TileCoord> CityTileSource::tiles() const
+{
+    const std::int32_t half = config_.tiles_per_side / 2;
+    std::vector<TileCoord> result;
+    result.reserve(static_cast<std::size_t>(config_.tiles_per_side) * static_cast<std::size_t>(config_.tiles_per_side));
+    for (std::int32_t z = -half; z < config_.tiles_per_side - half; ++z)
+    {
+        for (std::int32_t x = -half; x < config_.tiles_per_side - half; ++x)
+            result.push_back(TileCoord{x, z});
+    }
+    return result;
+}
+
+TileData CityTileSource::loadTile(TileCoord coord) const
+{
+    TileData tile;
+    tile.coord = coord;
+    const float size = config_.tile_size;
+    const glm::vec3 origin(static_cast<float>(coord.x) * size, 0.0f, static_cast<float>(coord.z) * size);
+
+    // 바닥. Plane 메시는 중심이 원점인 1x1
+    TileEntity ground{};
+    ground.transform.position = origin + glm::vec3(size * 0.5f, 0.0f, size * 0.5f);
+    ground.transform.scale = glm::vec3(size, 1.0f, size);
+    ground.renderable.mesh_id = config_.ground_mesh_id;
+    ground.renderable.material_id = config_.ground_material;
+    ground.renderable.is_static = true;
+    ground.renderable.casts_shadow = false;
+    tile.entities.push_back(ground);
+
+    const bool plaza = coord.x >= -config_.plaza_tiles && coord.x < config_.plaza_tiles &&
+                       coord.z >= -config_.plaza_tiles && coord.z < config_.plaza_tiles;
+    if (plaza || config_.building_materials.empty())
+        return tile;
+
+    std::mt19937 rng(tileSeed(coord));
+    const float block = size / static_cast<float>(config_.blocks_per_side);
+    const float max_footprint = std::max(1.0f, block - 2.0f * kStreetHalfWidth);
+    std::uniform_real_distribution<float> height(4.0f, 40.0f);
+    std::uniform_real_distribution<float> footprint(max_footprint * 0.5f, max_footprint);
+    std::uniform_int_distribution<std::size_t> material(0, config_.building_materials.size() - 1);
+    tile.entities.reserve(1 + static_cast<std::size_t>(config_.blocks_per_side * config_.blocks_per_side));
+    for (std::int32_t bz = 0; bz < config_.blocks_per_side; ++bz)
+    {
+        for (std::int32_t bx = 0; bx < config_.blocks_per_side; ++bx)
+        {
+            const float h = height(rng);
+            TileEntity building{};
+            building.transform.position = origin + glm::vec3((static_cast<float>(bx) + 0.5f) * block,
+                                                             h * 0.5f,
+                                                             (static_cast<float>(bz) + 0.5f) * block);
+            building.transform.scale = glm::vec3(footprint(rng), h, footprint(rng));
+            building.renderable.mesh_id = config_.building_mesh_id;
+            building.renderable.material_id = config_.building_materials[material(rng)];
+            building.renderable.is_static = true;
+            building.renderable.occluder = true;
+            tile.entities.push_back(building);
+        }
+    }
+    return tile;
+}
@@ -0,0 +1,188 @@
+#include "world_streamer.hpp"
+
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+// 예산 확인은 entity 몇 개마다 한 번만 한다
+constexpr std::size_t kBudgetCheckInterval = 8;
+} // namespace
+
+WorldStreamer::WorldStreamer(std::shared_ptr<const TileSource> source,
+                             const WorldStreamerConfig &config,
+                             ThreadPool &pool)
+    : source_(std::move(source)),
+      config_(config),
+      pool_(pool),
+      inbox_(std::make_shared<Inbox>())
+{
+    config_.unload_radius = std::max(config_.unload_radius, config_.load_radius);
+    config_.max_pending_loads = std::max<std::size_t>(1, config_.max_pending_loads);
+    quadtree_.build(source_->tiles(), source_->tileSize());
+}
+
+// 진행 중인 로드는 기다리지 않는다. 작업이 source와 inbox를 shared_ptr로 잡고 있어 끝나면 알아서 버려진다
+WorldStreamer::~WorldStreamer() = default;
+
+void WorldStreamer::update(World &world, const glm::vec3 &pivot)
+{
+    PROFILE_SCOPE("WorldStreamer::update");
+    stats_.created_this_frame = 0;
+    stats_.destroyed_this_frame = 0;
+
+    const glm::vec2 center(pivot.x, pivot.z);
+    receiveLoadedTiles();
+    releaseFarTiles(center);
+    requestTiles(center);
+    commit(world, center);
+
+    stats_.resident_tiles = 0;
+    stats_.pending_tiles = 0;
+    for (const auto &[key, slot] : tiles_)
+    {
+        if (slot.state == TileState::Resident)
+            ++stats_.resident_tiles;
+        else
+            ++stats_.pending_tiles;
+    }
+}
+
+std::uint64_t WorldStreamer::tileKey(TileCoord coord)
+{
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(coord.x)) << 32) |
+           static_cast<std::uint32_t>(coord.z);
+}
+
+void WorldStreamer::receiveLoadedTiles()
+{
+    {
+        std::lock_guard<std::mutex> lock(inbox_->mutex);
+        inbox_scratch_.swap(inbox_->tiles);
+    }
+    for (TileData &tile : inbox_scratch_)
+    {
+        --pending_loads_;
+        auto it = tiles_.find(tileKey(tile.coord));
+        // 로드 중에 멀어져 내린 타일이거나, 다시 요청해 같은 타일이 두 번 도착한 경우
+        if (it == tiles_.end() || it->second.state != TileState::Loading)
+            continue;
+        TileSlot &slot = it->second;
+        slot.data = std::move(tile);
+        slot.entities.reserve(slot.data.entities.size());
+        slot.state = TileState::Committing;
+    }
+    inbox_scratch_.clear();
+}
+
+void WorldStreamer::releaseFarTiles(const glm::vec2 &center)
+{
+    const float tile_size = source_->tileSize();
+    for (auto it = tiles_.begin(); it != tiles_.end();)
+    {
+        if (TileQuadtree::distanceToTile(center, it->second.coord, tile_size) <= config_.unload_radius)
+        {
+            ++it;
+            continue;
+        }
+        // 만들어 둔 entity는 commit 예산 안에서 지운다
+        pending_destroy_.insert(pending_destroy_.end(), it->second.entities.begin(), it->second.entities.end());
+        it = tiles_.erase(it);
+    }
+}
+
+void WorldStreamer::requestTiles(const glm::vec2 &center)
+{
+    if (pending_loads_ >= config_.max_pending_loads)
+        return;
+
+    query_scratch_.clear();
+    quadtree_.query(center, config_.load_radius, query_scratch_);
+    const float tile_size = source_->tileSize();
+    // 가까운 타일부터 요청한다
+    std::sort(query_scratch_.begin(), query_scratch_.end(), [&](const TileCoord &a, const TileCoord &b)
+              { return TileQuadtree::distanceToTile(center, a, tile_size) < TileQuadtree::distanceToTile(center, b, tile_size); });
+
+    for (const TileCoord &coord : query_scratch_)
+    {
+        if (pending_loads_ >= config_.max_pending_loads)
+            break;
+        const auto [it, inserted] = tiles_.try_emplace(tileKey(coord));
+        if (!inserted)
+            continue;
+        it->second.coord = coord;
+        ++pending_loads_;
+
+        pool_.submit([source = source_, inbox = inbox_, coord]
+                     {
+            TileData tile;
+            try
+            {
+                tile = source->loadTile(coord);
+            }
+            catch (const std::exception &e)
+            {
+                // 빈 타일로 두어 매 프레임 다시 요청하지 않는다
+                std::cerr << "[streamer] failed to load tile (" << coord.x << ", " << coord.z << "): " << e.what() << "\n";
+                tile = TileData{};
+            }
+            tile.coord = coord;
+            std::lock_guard<std::mutex> lock(inbox->mutex);
+            inbox->tiles.push_back(std::move(tile)); });
+    }
+}
+
+void WorldStreamer::commit(World &world, const glm::vec2 &center)
+{
+    const std::int64_t deadline = Profiler::now() + static_cast<std::int64_t>(config_.commit_budget_ms * 1.0e6);
+    std::size_t operations = 0;
+    auto out_of_budget = [&]()
+    { return ++operations % kBudgetCheckInterval == 0 && Profiler::now() >= deadline; };
+
+    // 내린 타일 정리가 먼저. 같은 자리에 다시 들어올 타일과 겹쳐 보이지 않게 한다
+    while (!pending_destroy_.empty())
+    {
+        world.destroyEntity(pending_destroy_.back());
+        pending_destroy_.pop_back();
+        ++stats_.destroyed_this_frame;
+        --stats_.streamed_entities;
+        if (out_of_budget())
+            return;
+    }
+
+    commit_scratch_.clear();
+    for (auto &[key, slot] : tiles_)
+    {
+        if (slot.state == TileState::Committing)
+            commit_scratch_.push_back(&slot);
+    }
+    const float tile_size = source_->tileSize();
+    std::sort(commit_scratch_.begin(), commit_scratch_.end(), [&](const TileSlot *a, const TileSlot *b)
+              { return TileQuadtree::distanceToTile(center, a->coord, tile_size) < TileQuadtree::distanceToTile(center, b->coord, tile_size); });
+
+    for (TileSlot *slot : commit_scratch_)
+    {
+        while (slot->committed < slot->data.entities.size())
+        {
+            const TileEntity &spec = slot->data.entities[slot->committed++];
+            const entity_id entity = world.newEntity();
+            world.addComponent<TransformComponent>(entity, TransformComponent(spec.transform));
+            world.addComponent<RenderableComponent>(entity, RenderableComponent(spec.renderable));
+            slot->entities.push_back(entity);
+            ++stats_.created_this_frame;
+            ++stats_.streamed_entities;
+            if (out_of_budget())
+                break;
+        }
+        if (slot->committed < slot->data.entities.size())
+            return;
+
+        slot->state = TileState::Resident;
+        // 원본 데이터는 더 필요 없다
+        slot->data.entities = std::vector<TileEntity>();
+    }
+}
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// 벤치마크 공통 도구. 측정 구간만 BenchTimer로 감싸고, 결과는 표준 출력과 CSV/JSON으로 내보낸다
+namespace Bench
+{
+// 컴파일러가 결과를 버리지 못하게 한다
+template <typename T>
+inline void doNotOptimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T *sink;
+    sink = &value;
+#endif
+}
+
+class BenchTimer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void start() { start_ = Clock::now(); }
+    void stop() { elapsed_ += Clock::now() - start_; }
+    double elapsedMs() const { return std::chrono::duration<double, std::milli>(elapsed_).count(); }
+
+private:
+    Clock::time_point start_{};
+    Clock::duration elapsed_{};
+};
+
+struct BenchResult
+{
+    std::string suite;
+    std::string name;
+    std::size_t size = 0;       // entity 수, 큐브 수 등 scene 크기
+    std::size_t operations = 0; // 한 번의 실행에서 측정한 연산 수
+    std::size_t runs = 0;
+    double median_ms = 0.0; // 실행 한 번의 중앙값
+    double min_ms = 0.0;
+    double ns_per_op = 0.0;
+    // 벤치마크별 추가 지표 (이름, 값)
+    std::vector<std::pair<std::string, double>> extra;
+};
+
+class BenchReport
+{
+public:
+    explicit BenchReport(std::string suite) : suite_(std::move(suite)) {}
+
+    // run(timer)을 runs번 호출한다. 준비 작업은 timer.start() 전에 한다
+    template <typename Run>
+    BenchResult &measure(const std::string &name, std::size_t size, std::size_t operations, std::size_t runs, Run &&run)
+    {
+        std::vector<double> times;
+        times.reserve(runs);
+        for (std::size_t i = 0; i < runs; ++i)
+        {
+            BenchTimer timer;
+            run(timer);
+            times.push_back(timer.elapsedMs());
+        }
+        std::sort(times.begin(), times.end());
+
+        BenchResult result;
+        result.suite = suite_;
+        result.name = name;
+        result.size = size;
+        result.operations = operations;
+        result.runs = runs;
+        result.median_ms = times[times.size() / 2];
+        result.min_ms = times.front();
+        result.ns_per_op = operations ? result.median_ms * 1.0e6 / static_cast<double>(operations) : 0.0;
+        print(result);
+        results_.push_back(std::move(result));
+        return results_.back();
+    }
+
+    void add(BenchResult result)
+    {
+        result.suite = suite_;
+        print(result);
+        results_.push_back(std::move(result));
+    }
+
+    const std::vector<BenchResult> &results() const { return results_; }
+
+    bool writeCsv(const std::string &path) const
+    {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out)
+            return false;
+        out << "suite,name,size,operations,runs,median_ms,min_ms,ns_per_op,extra\n";
+        for (const BenchResult &result : results_)
+        {
+            out << result.suite << ',' << result.name << ',' << result.size << ',' << result.operations << ','
+                << result.runs << ',' << result.median_ms << ',' << result.min_ms << ',' << result.ns_per_op << ',';
+            for (std::size_t i = 0; i < result.extra.size(); ++i)
+                out << (i ? ";" : "") << result.extra[i].first << '=' << result.extra[i].second;
+            out << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+
+    bool writeJson(const std::string &path) const
+    {
+        std::ofstream out(path, std::ios::trunc);
+        if (!out)
+            return false;
+        out << "{\"suite\":\"" << suite_ << "\",\"results\":[\n";
+        for (std::size_t i = 0; i < results_.size(); ++i)
+        {
+            const BenchResult &result = results_[i];
+            out << "  {\"name\":\"" << result.name << "\",\"size\":" << result.size << ",\"operations\":" << result.operations
+                << ",\"runs\":" << result.runs << ",\"median_ms\":" << result.median_ms << ",\"min_ms\":" << result.min_ms
+                << ",\"ns_per_op\":" << result.ns_per_op;
+            for (const auto &[key, value] : result.extra)
+                out << ",\"" << key << "\":" << value;
+            out << '}' << (i + 1 < results_.size() ? "," : "") << '\n';
+        }
+        out << "]}\n";
+        return static_cast<bool>(out);
+    }
+
+private:
+    static void print(const BenchResult &result)
+    {
+        std::cout << std::left << std::setw(32) << result.name << std::right << std::setw(10) << result.size
+                  << std::setw(12) << std::fixed << std::setprecision(3) << result.median_ms << " ms"
+                  << std::setw(12) << std::setprecision(1) << result.ns_per_op << " ns/op";
+        for (const auto &[key, value] : result.extra)
+            std::cout << "  " << key << '=' << std::setprecision(3) << value;
+        std::cout << std::endl;
+    }
+
+    std::string suite_;
+    std::vector<BenchResult> results_;
+};
+
+// "--name value" 형식의 단순 인자 파서
+class BenchArgs
+{
+public:
+    BenchArgs(int argc, char **argv) : args_(argv + 1, argv + argc) {}
+
+    std::string get(const std::string &name, const std::string &fallback) const
+    {
+        for (std::size_t i = 0; i + 1 < args_.size(); ++i)
+        {
+            if (args_[i] == name)
+                return args_[i + 1];
+        }
+        return fallback;
+    }
+
+    bool has(const std::string &name) const { return std::find(args_.begin(), args_.end(), name) != args_.end(); }
+
+    // "1000,10000" -> {1000, 10000}
+    std::vector<std::size_t> sizes(const std::string &name, const std::vector<std::size_t> &fallback) const
+    {
+        const std::string value = get(name, "");
+        if (value.empty())
+            return fallback;
+        std::vector<std::size_t> sizes;
+        std::size_t begin = 0;
+        while (begin <= value.size())
+        {
+            const std::size_t end = std::min(value.find(',', begin), value.size());
+            if (end > begin)
+                sizes.push_back(static_cast<std::size_t>(std::stoull(value.substr(begin, end - begin))));
+            begin = end + 1;
+        }
+        return sizes;
+    }
+
+private:
+    std::vector<std::string> args_;
+};
+} // namespace Bench
@@ -0,0 +1,238 @@
+#include "bench_harness.hpp"
+#include "component.hpp"
+#include "component_array.hpp"
+#include "world.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// World / ComponentArray 연산별 비용. 저장 구조를 바꿀 때 전후 비교용
+namespace
+{
+constexpr std::uint32_t kSeed = 0x5eed;
+// destroyEntity가 순회하는 pool 수를 늘리기 위한 더미 component 종류 수
+constexpr std::size_t kExtraComponentTypes = 24;
+
+template <std::size_t I>
+struct DummyComponent
+{
+    float value[4] = {static_cast<float>(I), 0.0f, 0.0f, 0.0f};
+};
+
+std::size_t runsFor(std::size_t size)
+{
+    return size >= 1'000'000 ? 3 : 5;
+}
+
+std::vector<entity_id> shuffledEntities(const std::vector<entity_id> &entities)
+{
+    std::vector<entity_id> shuffled = entities;
+    std::mt19937 rng(kSeed);
+    std::shuffle(shuffled.begin(), shuffled.end(), rng);
+    return shuffled;
+}
+
+std::vector<entity_id> populate(World &world, std::size_t count)
+{
+    std::vector<entity_id> entities(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        entities[i] = world.newEntity();
+        TransformComponent transform{};
+        transform.position = glm::vec3(static_cast<float>(i), 0.0f, 0.0f);
+        world.addComponent<TransformComponent>(entities[i], std::move(transform));
+    }
+    return entities;
+}
+
+template <std::size_t... I>
+void addDummyComponents(World &world, entity_id entity, std::index_sequence<I...>)
+{
+    // entity마다 일부 종류만 붙여 pool은 모두 등록되지만 대부분의 remove는 miss가 되게 한다
+    ((entity % kExtraComponentTypes == I ? (void)world.addComponent<DummyComponent<I>>(entity, DummyComponent<I>{}) : (void)0), ...);
+}
+
+void benchWorld(Bench::BenchReport &report, std::size_t n)
+{
+    const std::size_t runs = runsFor(n);
+
+    report.measure("world_create_destroy_churn", n, n, runs, [&](Bench::BenchTimer &timer)
+                   {
+        World world;
+        std::vector<entity_id> entities = populate(world, n);
+        std::mt19937 rng(kSeed);
+        std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+        timer.start();
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            const std::size_t slot = pick(rng);
+            world.destroyEntity(entities[slot]);
+            entities[slot] = world.newEntity();
+            world.addComponent<TransformComponent>(entities[slot], TransformComponent{});
+        }
+        timer.stop();
+        Bench::doNotOptimize(world.componentCount<TransformComponent>()); });
+
+    report.measure("world_add_component", n, n, runs, [&](Bench::BenchTimer &timer)
+                   {
+        World world;
+        const std::vector<entity_id> entities = populate(world, n);
+        timer.start();
+        for (entity_id entity : entities)
+            world.addComponent<PhysicsComponent>(entity, PhysicsComponent{});
+        timer.stop();
+        Bench::doNotOptimize(world.componentCount<PhysicsComponent>()); });
+
+    report.measure("world_remove_component", n, n, runs, [&](Bench::BenchTimer &timer)
+                   {
+        World world;
+        const std::vector<entity_id> entities = populate(world, n);
+        for (entity_id entity : entities)
+            world.addComponent<PhysicsComponent>(entity, PhysicsComponent{});
+        const std::vector<entity_id> order = shuffledEntities(entities);
+        timer.start();
+        for (entity_id entity : order)
+            world.removeComponent<PhysicsComponent>(entity);
+        timer.stop();
+        Bench::doNotOptimize(world.componentCount<PhysicsComponent>()); });
+
+    {
+        World world;
+        const std::vector<entity_id> entities = populate(world, n);
+        for (std::size_t i = 0; i < entities.size(); i += 2)
+            world.addComponent<PhysicsComponent>(entities[i], PhysicsComponent{});
+        const std::vector<entity_id> order = shuffledEntities(entities);
+
+        report.measure("world_get_component_random", n, n, runs, [&](Bench::BenchTimer &timer)
+                       {
+            float sum = 0.0f;
+            timer.start();
+            for (entity_id entity : order)
+            {
+                if (auto transform = world.getComponent<TransformComponent>(entity))
+                    sum += transform->get().position.x;
+            }
+            timer.stop();
+            Bench::doNotOptimize(sum); });
+
+        report.measure("world_iterate_single", n, n, runs, [&](Bench::BenchTimer &timer)
+                       {
+            float sum = 0.0f;
+            timer.start();
+            world.forEachComponent<TransformComponent>([&](entity_id, const TransformComponent &transform)
+                                                       { sum += transform.position.x; });
+            timer.stop();
+            Bench::doNotOptimize(sum); });
+
+        // RenderSystem처럼 한 pool을 돌면서 다른 pool을 entity로 조회한다 (절반만 매칭)
+        report.measure("world_iterate_multi", n, n, runs, [&](Bench::BenchTimer &timer)
+                       {
+            const auto *physics = world.getPool<PhysicsComponent>();
+            float sum = 0.0f;
+            timer.start();
+            world.forEachComponent<TransformComponent>([&](entity_id entity, const TransformComponent &transform)
+                                                       {
+                if (const PhysicsComponent *body = physics->tryGetData(entity))
+                    sum += transform.position.x * body->friction; });
+            timer.stop();
+            Bench::doNotOptimize(sum); });
+    }
+
+    report.measure("world_destroy_many_types", n, n, runs, [&](Bench::BenchTimer &timer)
+                   {
+        World world;
+        const std::vector<entity_id> entities = populate(world, n);
+        for (entity_id entity : entities)
+        {
+            world.addComponent<PhysicsComponent>(entity, PhysicsComponent{});
+            addDummyComponents(world, entity, std::make_index_sequence<kExtraComponentTypes>{});
+        }
+        const std::vector<entity_id> order = shuffledEntities(entities);
+        timer.start();
+        for (entity_id entity : order)
+            world.destroyEntity(entity);
+        timer.stop();
+        Bench::doNotOptimize(world.componentCount<TransformComponent>()); });
+}
+
+void benchComponentArray(Bench::BenchReport &report, std::size_t n)
+{
+    const std::size_t runs = runsFor(n);
+    std::vector<Entity> entities(n);
+    std::iota(entities.begin(), entities.end(), 0u);
+    const std::vector<Entity> order = shuffledEntities(entities);
+
+    report.measure("array_insert", n, n, runs, [&](Bench::BenchTimer &timer)
+                   {
+        ComponentArray<TransformComponent> array;
+        timer.start();
+        for (Entity entity : entities)
+            array.insertData(entity, TransformComponent{});
+        timer.stop();
+        Bench::doNotOptimize(array.size()); });
+
+    report.measure("array_remove_random", n, n, runs, [&](Bench::BenchTimer &timer)
+                   {
+        ComponentArray<TransformComponent> array;
+        for (Entity entity : entities)
+            array.insertData(entity, TransformComponent{});
+        timer.start();
+        for (Entity entity : order)
+            array.removeData(entity);
+        timer.stop();
+        Bench::doNotOptimize(array.size()); });
+
+    ComponentArray<TransformComponent> array;
+    for (Entity entity : entities)
+        array.insertData(entity, TransformComponent{});
+
+    report.measure("array_try_get_random", n, n, runs, [&](Bench::BenchTimer &timer)
+                   {
+        float sum = 0.0f;
+        timer.start();
+        for (Entity entity : order)
+        {
+            if (const TransformComponent *transform = array.tryGetData(entity))
+                sum += transform->scale.x;
+        }
+        timer.stop();
+        Bench::doNotOptimize(sum); });
+
+    report.measure("array_iterate_raw", n, n, runs, [&](Bench::BenchTimer &timer)
+                   {
+        float sum = 0.0f;
+        timer.start();
+        for (const TransformComponent &transform : array.raw())
+            sum += transform.scale.x;
+        timer.stop();
+        Bench::doNotOptimize(sum); });
+}
+} // namespace
+
+// 사용법: ecs_bench [--sizes 1000,10000,100000,1000000] [--csv ecs_bench.csv] [--json ecs_bench.json]
+int main(int argc, char **argv)
+{
+    const Bench::BenchArgs args(argc, argv);
+    const std::vector<std::size_t> sizes = args.sizes("--sizes", {1'000, 10'000, 100'000, 1'000'000});
+    const std::string csv_path = args.get("--csv", "ecs_bench.csv");
+    const std::string json_path = args.get("--json", "ecs_bench.json");
+
+    Bench::BenchReport report("ecs");
+    for (std::size_t n : sizes)
+    {
+        if (n == 0)
+            continue;
+        benchWorld(report, n);
+        benchComponentArray(report, n);
+    }
+
+    const bool written = report.writeCsv(csv_path) && report.writeJson(json_path);
+    std::cout << (written ? "results written: " : "failed to write results: ") << csv_path << ", " << json_path << std::endl;
+    return written ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+#include "bench_harness.hpp"
+#include "lidar_scan.hpp"
+#include "ray_bvh.hpp"
+#include "thread_pool.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// 도시 블록 모양 장면(건물 상자 + 회전한 차량 삼각형 + 지면)에서 128채널 LiDAR 한 바퀴의 비용.
+// packet 폭별로 재서 SIMD packet 순회의 효과를 본다
+namespace
+{
+constexpr std::uint32_t kSeed = 0x5eed;
+constexpr std::size_t kRuns = 5;
+constexpr float kBlockSize = 12.0f;
+constexpr float kPi = 3.14159265358979f;
+
+void addRotatedBox(RayBvh &bvh, const glm::vec3 &center, const glm::vec3 &half, float yaw, std::uint32_t id)
+{
+    const float c = std::cos(yaw);
+    const float s = std::sin(yaw);
+    glm::vec3 corners[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        const glm::vec3 local((i & 1) ? half.x : -half.x, (i & 2) ? half.y : -half.y, (i & 4) ? half.z : -half.z);
+        corners[i] = center + glm::vec3(c * local.x + s * local.z, local.y, -s * local.x + c * local.z);
+    }
+    // 면마다 삼각형 두 개
+    constexpr int kFaces[6][4] = {{0, 2, 6, 4}, {1, 5, 7, 3}, {0, 4, 5, 1}, {2, 3, 7, 6}, {0, 1, 3, 2}, {4, 6, 7, 5}};
+    for (const auto &face : kFaces)
+    {
+        bvh.addTriangle(corners[face[0]], corners[face[1]], corners[face[2]], id);
+        bvh.addTriangle(corners[face[0]], corners[face[2]], corners[face[3]], id);
+    }
+}
+
+// blocks x blocks 블록마다 건물 하나, 도로 위에 차량 vehicles대
+void buildCity(RayBvh &bvh, int blocks, std::size_t vehicles)
+{
+    std::mt19937 rng(kSeed);
+    std::uniform_real_distribution<float> height(6.0f, 40.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float extent = static_cast<float>(blocks) * kBlockSize;
+    const float origin = -0.5f * extent;
+
+    std::uint32_t id = 0;
+    bvh.addBox(glm::vec3(origin, -0.1f, origin), glm::vec3(origin + extent, 0.0f, origin + extent), id++);
+    for (int x = 0; x < blocks; ++x)
+    {
+        for (int z = 0; z < blocks; ++z)
+        {
+            const glm::vec3 corner(origin + static_cast<float>(x) * kBlockSize, 0.0f, origin + static_cast<float>(z) * kBlockSize);
+            bvh.addBox(corner + glm::vec3(2.0f, 0.0f, 2.0f), corner + glm::vec3(kBlockSize - 2.0f, height(rng), kBlockSize - 2.0f), id++);
+        }
+    }
+    for (std::size_t i = 0; i < vehicles; ++i)
+    {
+        // 블록 경계선(도로) 위
+        const float along = origin + unit(rng) * extent;
+        const float across = origin + std::floor(unit(rng) * static_cast<float>(blocks)) * kBlockSize + 1.0f;
+        const bool along_x = (i & 1) != 0;
+        const glm::vec3 center = along_x ? glm::vec3(along, 0.5f, across) : glm::vec3(across, 0.5f, along);
+        addRotatedBox(bvh, center, glm::vec3(0.8f, 0.5f, 1.6f), along_x ? 0.5f * kPi + 0.05f : 0.05f, id++);
+    }
+    bvh.build();
+}
+
+void benchScene(Bench::BenchReport &report, int blocks, std::size_t vehicles)
+{
+    RayBvh bvh;
+    buildCity(bvh, blocks, vehicles);
+    const std::string suffix = "_" + std::to_string(blocks) + "x" + std::to_string(blocks) + "_" + std::to_string(vehicles);
+
+    report.measure("bvh_build" + suffix, bvh.primitiveCount(), bvh.primitiveCount(), kRuns, [&](Bench::BenchTimer &timer)
+                   {
+        timer.start();
+        bvh.build();
+        timer.stop();
+        Bench::doNotOptimize(bvh.nodeCount()); });
+
+    const LidarScanPattern pattern(LidarScanConfig{});
+    std::vector<LidarPoint> points(pattern.rayCount());
+    LidarCastParams params;
+    params.origin = glm::vec3(1.0f, 2.0f, 6.0f);
+    ThreadPool &pool = ThreadPool::instance();
+    for (std::size_t width : {std::size_t{1}, std::size_t{4}, std::size_t{8}})
+    {
+        if (width > RayBvh::maxPacketWidth())
+            continue;
+        params.packet_width = width;
+        report.measure("lidar_scan_w" + std::to_string(width) + suffix, pattern.rayCount(), pattern.rayCount(), kRuns,
+                       [&](Bench::BenchTimer &timer)
+                       {
+            timer.start();
+            castLidarColumns(bvh, pattern, params, 0, pattern.config().columns, points, pool);
+            timer.stop();
+            Bench::doNotOptimize(points.back().range); });
+    }
+}
+} // namespace
+
+// 사용법: lidar_bench [--blocks 16,64] [--vehicles 2000] [--csv lidar_bench.csv] [--json lidar_bench.json]
+int main(int argc, char **argv)
+{
+    const Bench::BenchArgs args(argc, argv);
+    const std::vector<std::size_t> blocks = args.sizes("--blocks", {16, 64});
+    const std::vector<std::size_t> vehicles = args.sizes("--vehicles", {2'000});
+    const std::string csv_path = args.get("--csv", "lidar_bench.csv");
+    const std::string json_path = args.get("--json", "lidar_bench.json");
+
+    Bench::BenchReport report("lidar");
+    for (std::size_t block_count : blocks)
+    {
+        for (std::size_t vehicle_count : vehicles)
+        {
+            if (block_count == 0)
+                continue;
+            benchScene(report, static_cast<int>(block_count), vehicle_count);
+        }
+    }
+
+    const bool written = report.writeCsv(csv_path) && report.writeJson(json_path);
+    std::cout << (written ? "results written: " : "failed to write results: ") << csv_path << ", " << json_path << std::endl;
+    return written ? 0 : 1;
+}
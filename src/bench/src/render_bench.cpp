@@ -0,0 +1,432 @@
+#include "bench_harness.hpp"
+#include "camera_sensor.hpp"
+#include "camera_sensor_system.hpp"
+#include "component.hpp"
+#include "frame_allocator.hpp"
+#include "gl_includes.hpp"
+#include "light_system.hpp"
+#include "occlusion_culler.hpp"
+#include "render_data.hpp"
+#include "render_system.hpp"
+#include "renderer.hpp"
+#include "world.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// 숨은 GLFW 창에서 절차적으로 만든 장면을 고정 카메라 경로로 그려 CPU 추출/제출/프레임 시간을 잰다.
+// GPU가 없는 빌드 머신에서는 Mesa llvmpipe로 돈다 (예: LIBGL_ALWAYS_SOFTWARE=1 xvfb-run ./render_bench)
+namespace
+{
+constexpr std::uint32_t kSeed = 0xC17E;
+constexpr float kFovDegrees = 45.0f;
+constexpr float kNearPlane = 0.1f;
+constexpr float kFarPlane = 1000.0f;
+// 셰이더 컴파일, 캐시 워밍업, 그림자 static 캐시 생성을 측정에서 뺀다
+constexpr std::size_t kWarmupFrames = 10;
+// 조명 장면에서 entity 몇 개당 점광원 하나를 둘지
+constexpr std::size_t kEntitiesPerLight = 8;
+// 카메라 센서는 매 프레임 찍도록 고정 프레임 간격과 같은 주기로 둔다
+constexpr float kSensorRateHz = 60.0f;
+// --mesh 로딩을 기다리는 동안 한 번에 업로드할 시간
+constexpr double kUploadBudgetMs = 2.0;
+// 장면의 방향광. Renderer 기본 방향광과 같다
+const glm::vec3 kSunDirection{-0.4f, -1.0f, -0.3f};
+
+struct SceneInfo
+{
+    glm::vec3 center{0.0f};
+    float radius = 1.0f; // 카메라 궤도 반지름 기준
+};
+
+// 장면을 만들 때 쓰는 renderer 자원
+struct SceneAssets
+{
+    std::vector<MaterialHandle> materials;
+    // --mesh로 불러온 메시. 없으면 -1
+    int mesh_id = -1;
+    float mesh_radius = 1.0f;
+};
+
+struct CullOptions
+{
+    bool frustum = true;
+    bool occlusion = true;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point begin, Clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+void addBox(World &world, const glm::vec3 &position, const glm::vec3 &scale, MaterialHandle material, bool is_static,
+            bool occluder = false)
+{
+    const entity_id entity = world.newEntity();
+    world.addComponent<TransformComponent>(entity, TransformComponent{position, {}, scale});
+    RenderableComponent renderable{static_cast<int>(MeshId::Cube), material};
+    renderable.is_static = is_static;
+    renderable.occluder = occluder;
+    world.addComponent<RenderableComponent>(entity, std::move(renderable));
+}
+
+void addGround(World &world, float size, MaterialHandle material)
+{
+    const entity_id entity = world.newEntity();
+    TransformComponent transform{};
+    transform.scale = glm::vec3(size, 1.0f, size);
+    world.addComponent<TransformComponent>(entity, std::move(transform));
+    RenderableComponent renderable{static_cast<int>(MeshId::Plane), material};
+    renderable.is_static = true;
+    world.addComponent<RenderableComponent>(entity, std::move(renderable));
+}
+
+void addSun(World &world)
+{
+    const entity_id entity = world.newEntity();
+    LightComponent light{};
+    light.type = LightType::Directional;
+    light.direction = glm::normalize(kSunDirection);
+    world.addComponent<LightComponent>(entity, std::move(light));
+}
+
+// 정사각 격자의 움직이는(dynamic) 큐브
+SceneInfo buildGrid(World &world, std::size_t count, const SceneAssets &assets)
+{
+    const std::vector<MaterialHandle> &materials = assets.materials;
+    const auto side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    constexpr float kSpacing = 2.0f;
+    const float half = static_cast<float>(side) * kSpacing * 0.5f;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const float x = static_cast<float>(i % side) * kSpacing - half;
+        const float z = static_cast<float>(i / side) * kSpacing - half;
+        addBox(world, {x, 0.5f, z}, glm::vec3(1.0f), materials[i % materials.size()], false);
+    }
+    addGround(world, half * 2.0f + kSpacing, materials.front());
+    addSun(world);
+    return SceneInfo{{0.0f, 0.0f, 0.0f}, half};
+}
+
+// 높이가 제각각인 static 건물 블록. 건물은 occluder
+SceneInfo buildCity(World &world, std::size_t count, const SceneAssets &assets)
+{
+    const std::vector<MaterialHandle> &materials = assets.materials;
+    const auto side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    constexpr float kBlock = 12.0f;
+    const float half = static_cast<float>(side) * kBlock * 0.5f;
+    std::mt19937 rng(kSeed);
+    std::uniform_real_distribution<float> height(4.0f, 40.0f);
+    std::uniform_real_distribution<float> footprint(5.0f, 9.0f);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const float x = static_cast<float>(i % side) * kBlock - half;
+        const float z = static_cast<float>(i / side) * kBlock - half;
+        const float h = height(rng);
+        const glm::vec3 scale(footprint(rng), h, footprint(rng));
+        addBox(world, {x, h * 0.5f, z}, scale, materials[i % materials.size()], true, true);
+    }
+    addGround(world, half * 2.0f + kBlock, materials.front());
+    addSun(world);
+    return SceneInfo{{0.0f, 0.0f, 0.0f}, half};
+}
+
+// 장면 중심을 둘러싸고 안쪽을 보는 카메라 센서
+void addCameraSensors(World &world, const SceneInfo &scene, std::size_t count)
+{
+    const float orbit = std::max(scene.radius * 0.5f, 5.0f);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const float angle = 6.2831853f * static_cast<float>(i) / static_cast<float>(count);
+        TransformComponent transform{};
+        transform.position = scene.center + glm::vec3(std::sin(angle) * orbit, 2.0f, std::cos(angle) * orbit);
+        // 로컬 +z가 중심을 보도록 y축으로 돌린다
+        transform.rotation = glm::angleAxis(angle + 3.14159265f, glm::vec3(0.0f, 1.0f, 0.0f));
+        const entity_id entity = world.newEntity();
+        world.addComponent<TransformComponent>(entity, std::move(transform));
+        CameraSensorComponent camera;
+        camera.rate_hz = kSensorRateHz;
+        world.addComponent<CameraSensorComponent>(entity, std::move(camera));
+    }
+}
+
+// 격자 + 다수의 점광원. 점광원은 LightingSystem 추출 비용만 더한다 (셰이딩은 방향광 하나)
+SceneInfo buildLights(World &world, std::size_t count, const SceneAssets &assets)
+{
+    const SceneInfo info = buildGrid(world, count, assets);
+    std::mt19937 rng(kSeed);
+    std::uniform_real_distribution<float> coord(-info.radius, info.radius);
+    for (std::size_t i = 0; i < std::max<std::size_t>(1, count / kEntitiesPerLight); ++i)
+    {
+        const entity_id entity = world.newEntity();
+        LightComponent light{};
+        light.type = LightType::Point;
+        light.position = {coord(rng), 3.0f, coord(rng)};
+        light.color = {1.0f, 0.8f, 0.6f};
+        world.addComponent<LightComponent>(entity, std::move(light));
+    }
+    return info;
+}
+
+// 불러온 메시를 반지름 1로 맞춰 격자에 놓는다. 메시마다 만든 LOD가 거리에 따라 골라진다
+SceneInfo buildMesh(World &world, std::size_t count, const SceneAssets &assets)
+{
+    const auto side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    constexpr float kSpacing = 3.0f;
+    const float half = static_cast<float>(side) * kSpacing * 0.5f;
+    const glm::vec3 scale(1.0f / std::max(assets.mesh_radius, 1e-3f));
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const float x = static_cast<float>(i % side) * kSpacing - half;
+        const float z = static_cast<float>(i / side) * kSpacing - half;
+        const entity_id entity = world.newEntity();
+        world.addComponent<TransformComponent>(entity, TransformComponent{{x, 1.0f, z}, {}, scale});
+        RenderableComponent renderable{assets.mesh_id, assets.materials[i % assets.materials.size()]};
+        renderable.is_static = true;
+        world.addComponent<RenderableComponent>(entity, std::move(renderable));
+    }
+    addGround(world, half * 2.0f + kSpacing, assets.materials.front());
+    addSun(world);
+    return SceneInfo{{0.0f, 0.0f, 0.0f}, half};
+}
+
+// 경로 registerMesh로 워커에서 읽고 LOD를 만든 뒤 업로드될 때까지 기다린다. 실패하면 false
+bool loadMesh(Renderer &renderer, const std::string &path, SceneAssets &assets)
+{
+    const auto begin = Clock::now();
+    const int mesh_id = renderer.registerMesh(path);
+    while (renderer.pendingMeshLoads() > 0)
+    {
+        renderer.processUploads(kUploadBudgetMs);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const std::vector<MeshLodInfo> &lods = renderer.getMeshLodTable();
+    if (!renderer.isMeshResident(mesh_id) || static_cast<std::size_t>(mesh_id) >= lods.size())
+        return false;
+
+    const MeshLodInfo &info = lods[static_cast<std::size_t>(mesh_id)];
+    assets.mesh_id = mesh_id;
+    assets.mesh_radius = info.bounding_radius;
+    std::cout << "mesh " << path << " loaded in " << elapsedMs(begin, Clock::now()) << " ms ("
+              << static_cast<int>(info.lod_count) << " lods)" << std::endl;
+    return true;
+}
+
+struct FrameSamples
+{
+    std::vector<double> extraction_ms;
+    std::vector<double> submit_ms;
+    std::vector<double> frame_ms;
+    // 마지막 프레임의 컬링 결과
+    RenderSystem::CullStats cull;
+    CameraSensorStats camera;
+};
+
+double percentile(std::vector<double> values, double p)
+{
+    if (values.empty())
+        return 0.0;
+    const std::size_t rank = std::min(values.size() - 1, static_cast<std::size_t>(p * static_cast<double>(values.size())));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(rank), values.end());
+    return values[rank];
+}
+
+Bench::BenchResult summarize(const std::string &name, std::size_t size, const FrameSamples &samples, const Renderer &renderer)
+{
+    Bench::BenchResult result;
+    result.name = name;
+    result.size = size;
+    result.operations = samples.frame_ms.size();
+    result.runs = 1;
+    result.median_ms = percentile(samples.frame_ms, 0.5);
+    result.min_ms = *std::min_element(samples.frame_ms.begin(), samples.frame_ms.end());
+    result.ns_per_op = result.median_ms * 1.0e6;
+    result.extra = {
+        {"extract_p50_ms", percentile(samples.extraction_ms, 0.5)},
+        {"extract_p99_ms", percentile(samples.extraction_ms, 0.99)},
+        {"submit_p50_ms", percentile(samples.submit_ms, 0.5)},
+        {"submit_p99_ms", percentile(samples.submit_ms, 0.99)},
+        {"frame_p50_ms", percentile(samples.frame_ms, 0.5)},
+        {"frame_p99_ms", percentile(samples.frame_ms, 0.99)},
+        {"draw_calls", static_cast<double>(renderer.getRenderStats().draw_calls)},
+        {"triangles", static_cast<double>(renderer.getRenderStats().triangles)},
+        {"state_changes", static_cast<double>(renderer.getStateStats().issued)},
+        {"frustum_culled", static_cast<double>(samples.cull.frustum_culled)},
+        {"occlusion_culled", static_cast<double>(samples.cull.occlusion_culled)},
+        {"occluders", static_cast<double>(samples.cull.occluders)},
+        {"camera_rendered", static_cast<double>(samples.camera.rendered)},
+        {"camera_delivered", static_cast<double>(samples.camera.delivered)},
+        {"camera_dropped", static_cast<double>(samples.camera.dropped)},
+    };
+    return result;
+}
+
+FrameSamples runScene(Renderer &renderer, World &world, const SceneInfo &scene, const CullOptions &cull,
+                      std::size_t frames, int width, int height)
+{
+    RenderSystem render_system;
+    LightingSystem lighting_system;
+    OcclusionCuller occlusion_culler;
+    FrameAllocator frame_allocator(16 * 1024 * 1024);
+    CameraSensorSystem camera_system;
+    CameraSensorRenderer camera_renderer;
+    // consumer가 없으면 readback을 걸지 않으므로 빈 consumer로 readback과 복사까지 잰다
+    camera_renderer.addConsumer([](const CameraImage &) {});
+    camera_system.setMaxViewsPerFrame(world.componentCount<CameraSensorComponent>());
+
+    const float aspect = static_cast<float>(width) / static_cast<float>(height);
+    const glm::mat4 projection = glm::perspective(glm::radians(kFovDegrees), aspect, kNearPlane, kFarPlane);
+    const ShadowCasterBounds shadow_bounds = CascadedShadowMap::casterBounds(projection);
+
+    FrameSamples samples;
+    samples.extraction_ms.reserve(frames);
+    samples.submit_ms.reserve(frames);
+    samples.frame_ms.reserve(frames);
+
+    for (std::size_t frame = 0; frame < kWarmupFrames + frames; ++frame)
+    {
+        const auto frame_begin = Clock::now();
+        frame_allocator.beginFrame();
+
+        // 장면 위를 한 바퀴 도는 고정 경로. 프레임 수가 같으면 항상 같은 화면을 그린다
+        const float t = static_cast<float>(frame) / static_cast<float>(kWarmupFrames + frames);
+        const float angle = t * 6.2831853f;
+        const float orbit = std::max(scene.radius, 10.0f);
+        const glm::vec3 eye = scene.center + glm::vec3(std::cos(angle) * orbit, orbit * 0.6f, std::sin(angle) * orbit);
+        const glm::mat4 view = glm::lookAt(eye, scene.center, glm::vec3(0.0f, 1.0f, 0.0f));
+
+        RenderView render_view;
+        render_view.camera_position = eye;
+        render_view.pixels_per_unit = static_cast<float>(height) / (2.0f * std::tan(glm::radians(kFovDegrees) * 0.5f));
+        render_view.mesh_lods = &renderer.getMeshLodTable();
+        render_view.material_variants = &renderer.getMaterialVariants();
+        render_view.view_projection = projection * view;
+        render_view.frustum_culling = cull.frustum;
+        render_view.occlusion = cull.frustum && cull.occlusion ? &occlusion_culler : nullptr;
+        render_view.shadow_casters = renderer.getConfig().shadows;
+        render_view.light_direction = glm::normalize(kSunDirection);
+        render_view.shadow_radius = shadow_bounds.radius;
+        render_view.shadow_depth = shadow_bounds.depth;
+
+        const auto extract_begin = Clock::now();
+        lighting_system.update(world, frame_allocator.current());
+        RenderQueue queue(&frame_allocator.current());
+        render_system.buildRenderQueue(world, render_view, queue);
+        camera_system.update(world, 1.0f / kSensorRateHz);
+        FrameVector<CameraSensorView> camera_views{ArenaAllocator<CameraSensorView>(&frame_allocator.current())};
+        camera_system.buildViews(world, render_view, camera_views, &frame_allocator.current());
+        const auto submit_begin = Clock::now();
+        renderer.draw(queue, view, projection);
+        for (const CameraSensorView &camera_view : camera_views)
+            camera_renderer.render(renderer, camera_view);
+        const auto submit_end = Clock::now();
+
+        // 소프트웨어 GL에서는 실제 래스터화가 여기서 끝난다
+        glFinish();
+        renderer.swapBuffers();
+        camera_renderer.collect();
+        renderer.pollEvents();
+        const auto frame_end = Clock::now();
+
+        if (frame < kWarmupFrames)
+            continue;
+        samples.extraction_ms.push_back(elapsedMs(extract_begin, submit_begin));
+        samples.submit_ms.push_back(elapsedMs(submit_begin, submit_end));
+        samples.frame_ms.push_back(elapsedMs(frame_begin, frame_end));
+    }
+    samples.cull = render_system.getCullStats();
+    samples.camera = camera_renderer.stats();
+    camera_renderer.release();
+    return samples;
+}
+} // namespace
+
+// 사용법: render_bench [--scenes grid,city,lights] [--sizes 1000,10000,100000] [--frames 300]
+//                      [--width 1280] [--height 720] [--no-instancing] [--no-shadows]
+//                      [--no-culling] [--no-occlusion] [--cameras 0] [--mesh path] [--csv ...] [--json ...]
+// --mesh를 주면 그 메시를 격자에 놓는 mesh 장면이 기본 장면 목록에 더해진다
+int main(int argc, char **argv)
+{
+    const Bench::BenchArgs args(argc, argv);
+    const std::vector<std::size_t> sizes = args.sizes("--sizes", {1'000, 10'000, 100'000});
+    const std::string mesh_path = args.get("--mesh", "");
+    const std::string scene_list = args.get("--scenes", mesh_path.empty() ? "grid,city,lights" : "grid,city,lights,mesh");
+    const auto frames = static_cast<std::size_t>(std::stoull(args.get("--frames", "300")));
+    const int width = std::stoi(args.get("--width", "1280"));
+    const int height = std::stoi(args.get("--height", "720"));
+    // 장면마다 추가로 찍을 640x480 카메라 센서 수 (매 프레임)
+    const auto cameras = static_cast<std::size_t>(std::stoull(args.get("--cameras", "0")));
+    const std::string csv_path = args.get("--csv", "render_bench.csv");
+    const std::string json_path = args.get("--json", "render_bench.json");
+
+    Renderer renderer;
+    if (!renderer.init(width, height, "render_bench", false))
+    {
+        std::cerr << "failed to create an OpenGL 3.3 context (is a display or Xvfb available?)\n";
+        return 1;
+    }
+    RendererConfig config;
+    config.instancing = !args.has("--no-instancing");
+    config.shadows = !args.has("--no-shadows");
+    renderer.setConfig(config);
+    CullOptions cull;
+    cull.frustum = !args.has("--no-culling");
+    cull.occlusion = !args.has("--no-occlusion");
+
+    SceneAssets assets;
+    for (const glm::vec3 &color : {glm::vec3(0.7f, 0.3f, 0.3f), glm::vec3(0.3f, 0.6f, 1.0f), glm::vec3(0.8f, 0.8f, 0.4f)})
+    {
+        Material material;
+        material.base_color = color;
+        assets.materials.push_back(renderer.registerMaterial(material));
+    }
+    if (!mesh_path.empty() && !loadMesh(renderer, mesh_path, assets))
+    {
+        std::cerr << "failed to load mesh: " << mesh_path << "\n";
+        return 1;
+    }
+
+    using SceneBuilder = SceneInfo (*)(World &, std::size_t, const SceneAssets &);
+    const std::pair<const char *, SceneBuilder> scenes[] = {
+        {"grid", buildGrid}, {"city", buildCity}, {"lights", buildLights}, {"mesh", buildMesh}};
+
+    Bench::BenchReport report("render");
+    for (const auto &[scene_name, build] : scenes)
+    {
+        if (("," + scene_list + ",").find("," + std::string(scene_name) + ",") == std::string::npos)
+            continue;
+        if (build == buildMesh && assets.mesh_id < 0)
+        {
+            std::cerr << "scene 'mesh' needs --mesh <path>\n";
+            continue;
+        }
+        for (std::size_t size : sizes)
+        {
+            World world;
+            const SceneInfo info = build(world, size, assets);
+            addCameraSensors(world, info, cameras);
+            const FrameSamples samples = runScene(renderer, world, info, cull, frames, width, height);
+            if (samples.frame_ms.empty())
+                continue;
+            const std::string suffix = cameras > 0 ? "_cameras" + std::to_string(cameras) : "";
+            report.add(summarize(std::string("render_") + scene_name + suffix, size, samples, renderer));
+        }
+    }
+
+    const bool written = report.writeCsv(csv_path) && report.writeJson(json_path);
+    std::cout << (written ? "results written: " : "failed to write results: ") << csv_path << ", " << json_path << std::endl;
+    return written ? 0 : 1;
+}
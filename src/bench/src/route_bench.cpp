@@ -0,0 +1,97 @@
+#include "bench_harness.hpp"
+#include "lane_router.hpp"
+#include "road_network.hpp"
+#include "thread_pool.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// 격자 도로망에서 무작위 출발/도착 차로의 일괄 재탐색 비용과 최근접 차로 검색 비용
+namespace
+{
+constexpr std::uint32_t kSeed = 0x5eed;
+constexpr std::size_t kRuns = 5;
+
+std::vector<RouteRequest> randomRequests(const LaneGraph &graph, std::size_t count)
+{
+    std::mt19937 rng(kSeed);
+    std::uniform_int_distribution<lane_id> lane(0, static_cast<lane_id>(graph.laneCount() - 1));
+    std::vector<RouteRequest> requests(count);
+    for (RouteRequest &request : requests)
+        request = RouteRequest{lane(rng), lane(rng)};
+    return requests;
+}
+
+void benchNetwork(Bench::BenchReport &report, int blocks, std::size_t agents)
+{
+    GridRoadConfig config;
+    config.blocks_x = blocks;
+    config.blocks_z = blocks;
+    const LaneGraph graph = buildGridRoadNetwork(config);
+    const std::vector<RouteRequest> requests = randomRequests(graph, agents);
+    const std::string suffix = "_" + std::to_string(blocks) + "x" + std::to_string(blocks);
+
+    LaneRouter router(graph);
+    std::vector<Route> routes(requests.size());
+    report.measure("route_single_thread" + suffix, agents, agents, kRuns, [&](Bench::BenchTimer &timer)
+                   {
+        timer.start();
+        for (std::size_t i = 0; i < requests.size(); ++i)
+            router.findRoute(requests[i], routes[i]);
+        timer.stop();
+        Bench::doNotOptimize(routes.back().cost); });
+
+    ThreadPool &pool = ThreadPool::instance();
+    report.measure("route_batched" + suffix, agents, agents, kRuns, [&](Bench::BenchTimer &timer)
+                   {
+        timer.start();
+        router.findRoutes(requests, routes, pool);
+        timer.stop();
+        Bench::doNotOptimize(routes.back().cost); });
+
+    // 차로 근처의 무작위 위치
+    std::mt19937 rng(kSeed);
+    const float extent = static_cast<float>(blocks) * config.block_size;
+    std::uniform_real_distribution<float> coord(0.0f, extent);
+    std::vector<glm::vec3> positions(agents);
+    for (glm::vec3 &position : positions)
+        position = glm::vec3(coord(rng), 0.0f, coord(rng));
+    report.measure("nearest_lane" + suffix, agents, agents, kRuns, [&](Bench::BenchTimer &timer)
+                   {
+        float sum = 0.0f;
+        timer.start();
+        for (const glm::vec3 &position : positions)
+            sum += graph.nearestLane(position, config.block_size).distance;
+        timer.stop();
+        Bench::doNotOptimize(sum); });
+}
+} // namespace
+
+// 사용법: route_bench [--blocks 16,64] [--agents 1000,10000] [--csv route_bench.csv] [--json route_bench.json]
+int main(int argc, char **argv)
+{
+    const Bench::BenchArgs args(argc, argv);
+    const std::vector<std::size_t> blocks = args.sizes("--blocks", {16, 64});
+    const std::vector<std::size_t> agents = args.sizes("--agents", {1'000, 10'000});
+    const std::string csv_path = args.get("--csv", "route_bench.csv");
+    const std::string json_path = args.get("--json", "route_bench.json");
+
+    Bench::BenchReport report("route");
+    for (std::size_t block_count : blocks)
+    {
+        for (std::size_t agent_count : agents)
+        {
+            if (block_count == 0 || agent_count == 0)
+                continue;
+            benchNetwork(report, static_cast<int>(block_count), agent_count);
+        }
+    }
+
+    const bool written = report.writeCsv(csv_path) && report.writeJson(json_path);
+    std::cout << (written ? "results written: " : "failed to write results: ") << csv_path << ", " << json_path << std::endl;
+    return written ? 0 : 1;
+}
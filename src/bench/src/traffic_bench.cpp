@@ -0,0 +1,74 @@
+#include "bench_harness.hpp"
+#include "road_network.hpp"
+#include "thread_pool.hpp"
+#include "traffic_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// 격자 도로망 위 IDM 에이전트의 고정 스텝(20Hz) 비용. 경로가 끝난 에이전트의 재탐색도 포함된다
+namespace
+{
+constexpr std::size_t kRuns = 5;
+constexpr float kStepSeconds = 1.0f / 20.0f;
+// 첫 스텝은 모든 에이전트의 경로를 찾으므로 측정 전에 흘려 보낸다
+constexpr int kWarmupSteps = 20;
+constexpr int kStepsPerRun = 20;
+
+void benchAgents(Bench::BenchReport &report, std::size_t agents)
+{
+    // 차로당 한 대 정도가 되도록 도로망 크기를 정한다 (engine과 같은 기준)
+    GridRoadConfig config;
+    config.blocks_x = std::max(8, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(agents) / 4.0))));
+    config.blocks_z = config.blocks_x;
+    const LaneGraph graph = buildGridRoadNetwork(config);
+
+    TrafficModel model(graph);
+    const std::size_t lane_count = graph.laneCount();
+    for (std::size_t i = 0; i < agents; ++i)
+    {
+        // 인접 차로에 몰리지 않게 흩어 놓는다
+        const auto lane = static_cast<lane_id>((i * 7919u) % lane_count);
+        const float offset = static_cast<float>(i / lane_count) * 6.4f;
+        model.addAgent(lane, std::min(offset, graph.laneLength(lane)), 8.0f + static_cast<float>(i % 7));
+    }
+
+    ThreadPool &pool = ThreadPool::instance();
+    for (int step = 0; step < kWarmupSteps; ++step)
+        model.step(kStepSeconds, pool);
+
+    const std::string suffix = "_" + std::to_string(config.blocks_x) + "x" + std::to_string(config.blocks_z);
+    report.measure("traffic_step" + suffix, agents, agents * kStepsPerRun, kRuns, [&](Bench::BenchTimer &timer)
+                   {
+        timer.start();
+        for (int step = 0; step < kStepsPerRun; ++step)
+            model.step(kStepSeconds, pool);
+        timer.stop();
+        Bench::doNotOptimize(model.speeds().back()); });
+}
+} // namespace
+
+// 사용법: traffic_bench [--agents 10000,100000] [--csv traffic_bench.csv] [--json traffic_bench.json]
+int main(int argc, char **argv)
+{
+    const Bench::BenchArgs args(argc, argv);
+    const std::vector<std::size_t> agents = args.sizes("--agents", {10'000, 100'000});
+    const std::string csv_path = args.get("--csv", "traffic_bench.csv");
+    const std::string json_path = args.get("--json", "traffic_bench.json");
+
+    Bench::BenchReport report("traffic");
+    for (std::size_t agent_count : agents)
+    {
+        if (agent_count == 0)
+            continue;
+        benchAgents(report, agent_count);
+    }
+
+    const bool written = report.writeCsv(csv_path) && report.writeJson(json_path);
+    std::cout << (written ? "results written: " : "failed to write results: ") << csv_path << ", " << json_path << std::endl;
+    return written ? 0 : 1;
+}
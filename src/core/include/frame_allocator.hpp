@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+// bump pointer 방식의 선형 할당기. 개별 해제는 없고 reset()으로 한 번에 비운다.
+// 용량을 넘으면 힙에서 overflow 블록을 받아 쓰고, 다음 reset()에서 용량을 high-water 만큼 늘려
+// 정상 상태에서는 힙 할당이 일어나지 않게 한다. 스레드 안전하지 않다.
+class LinearArena
+{
+public:
+    explicit LinearArena(std::size_t capacity = 0);
+    ~LinearArena();
+
+    LinearArena(const LinearArena &) = delete;
+    LinearArena &operator=(const LinearArena &) = delete;
+
+    void *allocate(std::size_t bytes, std::size_t alignment);
+    void reset();
+
+    std::size_t used() const { return used_; }
+    std::size_t capacity() const { return capacity_; }
+    std::size_t highWater() const { return high_water_; }
+    // 지금까지 용량 부족으로 힙에서 받은 블록 수
+    std::uint64_t overflowCount() const { return overflow_count_; }
+
+private:
+    std::byte *base_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t offset_ = 0;
+    std::size_t used_ = 0;
+    std::size_t high_water_ = 0;
+    std::uint64_t overflow_count_ = 0;
+    std::vector<std::byte *> overflow_blocks_;
+};
+
+// N 프레임 분량의 arena를 돌려 쓴다. beginFrame()에서 N 프레임 전에 쓴 arena를 비우므로
+// 그 사이에 다른 스레드(GPU 제출 등)가 읽는 프레임 데이터는 유지된다.
+// 렌더 스레드가 그리는 중 1 + 대기 2 (RenderThread::kMaxQueuedFrames) + 만드는 중 1 프레임
+class FrameAllocator
+{
+public:
+    static constexpr std::size_t kFrameCount = 4;
+
+    explicit FrameAllocator(std::size_t bytes_per_frame);
+
+    void beginFrame();
+    LinearArena &current() { return arenas_[frame_index_]; }
+    std::uint64_t frameNumber() const { return frame_number_; }
+
+private:
+    std::array<LinearArena, kFrameCount> arenas_;
+    std::size_t frame_index_ = 0;
+    std::uint64_t frame_number_ = 0;
+};
+
+// 표준 컨테이너용 allocator. arena가 없으면 일반 힙을 사용한다
+template <typename T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() noexcept = default;
+    explicit ArenaAllocator(LinearArena *arena) noexcept : arena_(arena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept : arena_(other.arena()) {}
+
+    T *allocate(std::size_t count)
+    {
+        if (arena_)
+            return static_cast<T *>(arena_->allocate(count * sizeof(T), alignof(T)));
+        return static_cast<T *>(::operator new(count * sizeof(T), std::align_val_t{alignof(T)}));
+    }
+
+    void deallocate(T *ptr, std::size_t /*count*/) noexcept
+    {
+        if (!arena_)
+            ::operator delete(ptr, std::align_val_t{alignof(T)});
+    }
+
+    LinearArena *arena() const noexcept { return arena_; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const noexcept { return arena_ == other.arena(); }
+
+private:
+    LinearArena *arena_ = nullptr;
+};
+
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
+
+// 전역 operator new 호출 횟수 (CORE_TRACK_HEAP_ALLOCATIONS 빌드에서만 집계, 아니면 항상 0)
+namespace HeapStats
+{
+bool enabled();
+std::uint64_t allocationCount();
+} // namespace HeapStats
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum class FramePacing
+{
+    Vsync,      // swap interval 1. 화면 주사율이 프레임을 맞춘다
+    Uncapped,   // swap interval 0, 대기 없음
+    Capped,     // swap interval 0, sleep + spin으로 target_fps에 맞춘다
+    LowLatency, // swap interval 1. 입력/시뮬레이션을 다음 present 직전까지 미룬다
+};
+// FramePacing 값의 수. 모드를 순서대로 돌릴 때 쓴다
+constexpr int kFramePacingCount = static_cast<int>(FramePacing::LowLatency) + 1;
+
+struct FramePacerConfig
+{
+    FramePacing mode = FramePacing::Vsync;
+    // Capped의 목표, LowLatency에서는 화면 주사율
+    double target_fps = 60.0;
+};
+
+// 프레임 시작 시각을 정한다. 시각은 Profiler::now() 기준 ns.
+// Capped는 데드라인까지 잠들었다가 마지막 구간만 spin해서 OS 스케줄러의 깨어남 오차를 없앤다.
+// LowLatency는 최근 프레임 작업 시간으로 다음 present까지 걸릴 시간을 예측해 그만큼 늦게 시작한다
+class FramePacer
+{
+public:
+    void setConfig(const FramePacerConfig &config);
+    const FramePacerConfig &config() const { return config_; }
+    // swap interval을 써야 하는 모드인지 (Vsync, LowLatency)
+    bool usesVsync() const;
+
+    // 입력을 읽기 전에 호출. 모드에 맞춰 블록한다
+    void waitForFrameStart();
+    // 프레임 작업(입력~제출)이 끝난 뒤 호출
+    void endFrame();
+    // 실제 present(swap이 돌아온) 시각과 렌더 스레드의 제출 시간.
+    // LowLatency가 vblank 위상을 맞추고 시작 시각을 당기는 데 쓴다
+    void onPresent(std::int64_t present_ns, std::int64_t render_work_ns);
+
+    // 최근 작업 시간의 상위 분위수 + 렌더 제출 시간 + 여유 (ms)
+    double predictedWorkMs() const;
+    // 직전 waitForFrameStart에서 잔 시간 (ms)
+    double lastWaitMs() const { return last_wait_ms_; }
+
+private:
+    static constexpr std::size_t kWorkHistory = 32;
+
+    std::int64_t periodNs() const;
+    // 다음 데드라인. 밀렸으면 지금 기준으로 다시 잡아 몰아서 따라잡지 않는다
+    std::int64_t nextDeadline(std::int64_t now_ns, std::int64_t lead_ns);
+    static void sleepUntil(std::int64_t target_ns);
+
+    FramePacerConfig config_{};
+    std::int64_t deadline_ns_ = 0;
+    std::int64_t frame_start_ns_ = 0;
+    std::int64_t last_present_ns_ = -1;
+    std::int64_t render_work_ns_ = 0;
+    std::array<std::int64_t, kWorkHistory> work_ns_{};
+    std::size_t work_count_ = 0;
+    double last_wait_ms_ = 0.0;
+};
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// 읽기 전용 메모리 매핑 파일. 파싱하는 동안만 살아있도록 지역 변수로 쓴다
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool isOpen() const { return data_ != nullptr || (fd_ >= 0 && size_ == 0); }
+    const std::byte *data() const { return static_cast<const std::byte *>(data_); }
+    std::size_t size() const { return size_; }
+    std::string_view text() const { return {static_cast<const char *>(data_), size_}; }
+
+private:
+    void close();
+
+    void *data_ = nullptr;
+    std::size_t size_ = 0;
+    int fd_ = -1;
+};
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// 스코프 단위 CPU 타이밍 + GPU 패스 시간 + 프레임 카운터를 모아 Chrome trace(JSON)로 내보낸다.
+// 이벤트는 스레드마다 고정 크기 ring buffer에 잠금 없이 기록되고, 오래된 것부터 덮어쓴다.
+// 이름은 문자열 리터럴처럼 프로그램이 끝날 때까지 유효한 포인터여야 한다.
+// 내보내기/통계는 메인 스레드에서 프레임 경계(워커가 parallelFor를 돌지 않을 때)에 호출한다.
+struct ProfileEvent
+{
+    const char *name = nullptr;
+    std::int64_t start_ns = 0;
+    std::int64_t end_ns = 0;
+};
+
+struct FrameTimeStats
+{
+    double p50_ms = 0.0;
+    double p99_ms = 0.0;
+    double mean_ms = 0.0;
+    // 프레임 시간의 표준편차
+    double stddev_ms = 0.0;
+    // 프레임 시작 간격의 평균/표준편차. pacing이 고른지(jitter) 본다
+    double interval_mean_ms = 0.0;
+    double interval_stddev_ms = 0.0;
+    std::size_t frame_count = 0;
+};
+
+class Profiler
+{
+public:
+    static constexpr std::size_t kEventsPerThread = 16 * 1024;
+    static constexpr std::size_t kGpuEventCapacity = 4 * 1024;
+    // 통계와 카운터를 유지하는 최근 프레임 수
+    static constexpr std::size_t kFrameHistory = 600;
+    static constexpr std::size_t kMaxCounters = 16;
+
+    static Profiler &instance();
+
+    // 프로파일러 기준 시각으로부터의 ns
+    static std::int64_t now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch()).count();
+    }
+
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+
+    // 호출 스레드의 trace 이름. 첫 기록 전에 부르면 좋다
+    void setThreadName(const char *name);
+    void recordCpu(const char *name, std::int64_t start_ns, std::int64_t end_ns);
+    // GPU 시간은 수 프레임 늦게 도착하므로 측정을 시작한 CPU 시각으로 배치한다
+    void recordGpu(const char *name, std::int64_t cpu_start_ns, std::int64_t duration_ns);
+
+    void beginFrame();
+    void endFrame();
+    // 현재 프레임의 카운터 값 (draw 수 등). 카운터는 처음 쓰일 때 등록되고 kMaxCounters를 넘으면 무시된다
+    void setCounter(const char *name, double value);
+
+    // 최근 kFrameHistory 프레임의 frame time 분포
+    FrameTimeStats frameTimeStats();
+    // ring buffer에 남아있는 CPU/GPU 이벤트와 카운터를 Chrome trace 형식으로 쓴다 (chrome://tracing, Perfetto)
+    bool writeChromeTrace(const std::string &path) const;
+
+private:
+    struct ThreadEvents
+    {
+        std::array<ProfileEvent, kEventsPerThread> events{};
+        // 지금까지 기록된 총 이벤트 수. ring 위치는 written % kEventsPerThread
+        std::atomic<std::uint64_t> written{0};
+        std::uint32_t thread_id = 0;
+        std::string name;
+    };
+
+    struct FrameRecord
+    {
+        std::int64_t start_ns = 0;
+        std::int64_t duration_ns = 0;
+        std::array<double, kMaxCounters> counters{};
+    };
+
+    Profiler() = default;
+    static std::chrono::steady_clock::time_point epoch();
+    ThreadEvents &threadEvents();
+
+    std::atomic<bool> enabled_{true};
+
+    mutable std::mutex threads_mutex_;
+    std::vector<std::unique_ptr<ThreadEvents>> threads_;
+
+    mutable std::mutex gpu_mutex_;
+    std::vector<ProfileEvent> gpu_events_;
+    std::uint64_t gpu_written_ = 0;
+
+    // 메인 스레드 전용
+    std::array<const char *, kMaxCounters> counter_names_{};
+    std::size_t counter_count_ = 0;
+    std::vector<FrameRecord> frames_;
+    std::uint64_t frame_count_ = 0;
+    FrameRecord current_frame_;
+    std::vector<double> percentile_scratch_;
+};
+
+// 스코프를 벗어날 때 [생성, 소멸] 구간을 기록한다
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char *name)
+        : name_(name),
+          start_ns_(Profiler::instance().enabled() ? Profiler::now() : -1)
+    {
+    }
+
+    ~ProfileScope()
+    {
+        if (start_ns_ >= 0)
+            Profiler::instance().recordCpu(name_, start_ns_, Profiler::now());
+    }
+
+    ProfileScope(const ProfileScope &) = delete;
+    ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+    const char *name_;
+    std::int64_t start_ns_;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#ifdef CORE_ENABLE_PROFILER
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#endif
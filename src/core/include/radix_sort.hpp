@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+class ThreadPool;
+
+// 정렬 키와 payload 인덱스 쌍. payload는 제자리에 두고 이 쌍만 정렬한다
+struct SortKeyIndex
+{
+    std::uint64_t key;
+    std::uint32_t index;
+};
+
+// 8비트씩 8번 도는 LSD radix sort (stable).
+// 모든 원소의 해당 바이트가 같은 pass는 건너뛴다. scratch는 count 이상의 크기가 필요하다
+void radixSortKeyIndex(SortKeyIndex *data, SortKeyIndex *scratch, std::size_t count);
+
+// 블록 단위 히스토그램/scatter를 스레드풀에서 병렬로 수행한다. 결과는 radixSortKeyIndex와 같다
+void parallelRadixSortKeyIndex(SortKeyIndex *data, SortKeyIndex *scratch, std::size_t count, ThreadPool &pool);
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// 고정 크기 단일 생산자/단일 소비자 링 버퍼. 락과 힙 할당이 없다.
+// head/tail을 서로 다른 캐시 라인에 두고, 상대편 인덱스는 가득 차거나 빌 때만 다시 읽는다
+template <typename T, std::size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // 생산자 스레드에서만 호출. 가득 차 있으면 false
+    bool tryPush(const T &value)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == Capacity)
+        {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == Capacity)
+                return false;
+        }
+        slots_[tail & kMask] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 소비자 스레드에서만 호출. 비어 있으면 false
+    bool tryPop(T &out)
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_)
+        {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_)
+                return false;
+        }
+        out = slots_[head & kMask];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 다른 스레드가 동시에 쓰는 중이면 근사값
+    std::size_t size() const
+    {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    static constexpr std::size_t kMask = Capacity - 1;
+    static constexpr std::size_t kCacheLine = 64;
+
+    // 소비자 소유
+    alignas(kCacheLine) std::atomic<std::size_t> head_{0};
+    std::size_t cached_tail_ = 0;
+    // 생산자 소유
+    alignas(kCacheLine) std::atomic<std::size_t> tail_{0};
+    std::size_t cached_head_ = 0;
+    alignas(kCacheLine) std::array<T, Capacity> slots_{};
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// 고정 개수의 워커 스레드를 가진 풀.
+// parallelFor는 호출 스레드도 작업에 참여하고, 모든 작업이 끝날 때까지 블록한다.
+// 매 프레임 호출되는 경로에서 쓰이므로 parallelFor는 힙 할당을 하지 않는다.
+// submit은 프레임과 무관한 백그라운드 작업(에셋 로딩 등)용이고, 워커는 parallelFor 작업을 먼저 처리한다.
+class ThreadPool
+{
+public:
+    explicit ThreadPool(std::size_t worker_count);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // hardware_concurrency - 1 개의 워커를 가진 전역 풀
+    static ThreadPool &instance();
+
+    std::size_t workerCount() const { return workers_.size(); }
+    // 호출 스레드를 포함한 동시 실행 가능 스레드 수
+    std::size_t concurrency() const { return workers_.size() + 1; }
+
+    // [0, task_count) 의 각 task index에 대해 func(index)를 호출한다
+    template <typename Func>
+    void parallelFor(std::size_t task_count, Func &&func)
+    {
+        using Callable = std::remove_reference_t<Func>;
+        dispatch(task_count, const_cast<void *>(static_cast<const void *>(&func)), [](void *ctx, std::size_t index)
+                 { (*static_cast<Callable *>(ctx))(index); });
+    }
+
+    // [0, count) 를 min_chunk 이상의 연속 구간으로 나눠 func(begin, end)를 호출한다
+    template <typename Func>
+    void parallelForRange(std::size_t count, std::size_t min_chunk, Func &&func)
+    {
+        if (count == 0)
+            return;
+        min_chunk = std::max<std::size_t>(1, min_chunk);
+        const std::size_t max_chunks = (count + min_chunk - 1) / min_chunk;
+        const std::size_t chunk_count = std::min(max_chunks, concurrency() * 4);
+        const std::size_t chunk_size = (count + chunk_count - 1) / chunk_count;
+        parallelFor(chunk_count, [&](std::size_t chunk)
+                    {
+            const std::size_t begin = chunk * chunk_size;
+            const std::size_t end = std::min(count, begin + chunk_size);
+            if (begin < end)
+                func(begin, end); });
+    }
+
+    // 완료를 기다리지 않는 백그라운드 작업. 워커가 없으면 호출 스레드에서 바로 실행한다
+    void submit(std::function<void()> task);
+    // 대기중이거나 실행중인 백그라운드 작업 수
+    std::size_t pendingBackgroundTasks() const;
+
+private:
+    using InvokeFn = void (*)(void *, std::size_t);
+    struct ParallelJob;
+
+    struct Task
+    {
+        ParallelJob *job = nullptr;
+    };
+
+    void dispatch(std::size_t task_count, void *ctx, InvokeFn invoke);
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    // head_ 부터가 대기중인 task. 용량을 재사용하기 위해 deque 대신 vector를 쓴다
+    std::vector<Task> tasks_;
+    std::size_t head_ = 0;
+    std::deque<std::function<void()>> background_tasks_;
+    std::size_t running_background_tasks_ = 0;
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    bool stopping_ = false;
+};
@@ -0,0 +1,169 @@
+#include "frame_allocator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+
+namespace
+{
+constexpr std::size_t kOverflowBlockMin = 64 * 1024;
+
+std::size_t alignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+std::byte *allocateBlock(std::size_t bytes)
+{
+    return static_cast<std::byte *>(::operator new(bytes, std::align_val_t{alignof(std::max_align_t)}));
+}
+
+void freeBlock(std::byte *block)
+{
+    ::operator delete(block, std::align_val_t{alignof(std::max_align_t)});
+}
+} // namespace
+
+LinearArena::LinearArena(std::size_t capacity)
+    : capacity_(capacity)
+{
+    if (capacity_ > 0)
+        base_ = allocateBlock(capacity_);
+}
+
+LinearArena::~LinearArena()
+{
+    reset();
+    if (base_)
+        freeBlock(base_);
+}
+
+void *LinearArena::allocate(std::size_t bytes, std::size_t alignment)
+{
+    alignment = std::max(alignment, alignof(std::max_align_t));
+    // 블록은 max_align_t까지만 정렬되어 있으므로 offset이 아니라 실제 주소를 맞춘다
+    const auto base_address = reinterpret_cast<std::uintptr_t>(base_);
+    const std::size_t start = alignUp(base_address + offset_, alignment) - base_address;
+    if (base_ && start + bytes <= capacity_)
+    {
+        offset_ = start + bytes;
+        used_ += bytes;
+        high_water_ = std::max(high_water_, used_);
+        return base_ + start;
+    }
+
+    // 용량 부족: 이번 프레임은 별도 블록으로 버티고 reset()에서 용량을 늘린다.
+    // 더 큰 정렬은 그만큼 여유를 두고 블록 안에서 맞춘다
+    const std::size_t padding = alignment - alignof(std::max_align_t);
+    std::byte *block = allocateBlock(std::max(bytes + padding, kOverflowBlockMin));
+    overflow_blocks_.push_back(block);
+    ++overflow_count_;
+    used_ += bytes;
+    high_water_ = std::max(high_water_, used_);
+    const auto block_address = reinterpret_cast<std::uintptr_t>(block);
+    return block + (alignUp(block_address, alignment) - block_address);
+}
+
+void LinearArena::reset()
+{
+    if (!overflow_blocks_.empty())
+    {
+        for (std::byte *block : overflow_blocks_)
+            freeBlock(block);
+        overflow_blocks_.clear();
+
+        const std::size_t new_capacity = alignUp(high_water_ + high_water_ / 2, kOverflowBlockMin);
+        if (new_capacity > capacity_)
+        {
+            if (base_)
+                freeBlock(base_);
+            base_ = allocateBlock(new_capacity);
+            capacity_ = new_capacity;
+        }
+    }
+    offset_ = 0;
+    used_ = 0;
+}
+
+FrameAllocator::FrameAllocator(std::size_t bytes_per_frame)
+    : arenas_{LinearArena(bytes_per_frame), LinearArena(bytes_per_frame), LinearArena(bytes_per_frame),
+              LinearArena(bytes_per_frame)}
+{
+    static_assert(kFrameCount == 4, "arena initializer list must match kFrameCount");
+}
+
+void FrameAllocator::beginFrame()
+{
+    frame_index_ = (frame_index_ + 1) % kFrameCount;
+    arenas_[frame_index_].reset();
+    ++frame_number_;
+}
+
+#ifdef CORE_TRACK_HEAP_ALLOCATIONS
+namespace
+{
+std::atomic<std::uint64_t> g_heap_allocations{0};
+
+void *countedAlloc(std::size_t size)
+{
+    g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *countedAlignedAlloc(std::size_t size, std::align_val_t alignment)
+{
+    g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t align = std::max(static_cast<std::size_t>(alignment), sizeof(void *));
+    if (void *ptr = std::aligned_alloc(align, alignUp(size ? size : 1, align)))
+        return ptr;
+    throw std::bad_alloc();
+}
+} // namespace
+
+void *operator new(std::size_t size) { return countedAlloc(size); }
+void *operator new[](std::size_t size) { return countedAlloc(size); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return countedAlignedAlloc(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return countedAlignedAlloc(size, alignment); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    g_heap_allocations.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t, std::align_val_t) noexcept { std::free(ptr); }
+#endif
+
+namespace HeapStats
+{
+bool enabled()
+{
+#ifdef CORE_TRACK_HEAP_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::uint64_t allocationCount()
+{
+#ifdef CORE_TRACK_HEAP_ALLOCATIONS
+    return g_heap_allocations.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+} // namespace HeapStats
@@ -0,0 +1,106 @@
+#include "frame_pacer.hpp"
+
+#include "profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+// 남은 시간이 이보다 많을 때만 잔다. sleep의 깨어남 오차(보통 1ms 안팎)보다 커야 한다
+constexpr std::int64_t kSpinThresholdNs = 2'000'000;
+// LowLatency에서 예측한 작업 시간에 더하는 여유
+constexpr std::int64_t kLowLatencyMarginNs = 1'000'000;
+constexpr double kWorkPercentile = 0.9;
+} // namespace
+
+void FramePacer::setConfig(const FramePacerConfig &config)
+{
+    config_ = config;
+    config_.target_fps = std::max(1.0, config_.target_fps);
+    deadline_ns_ = 0;
+}
+
+bool FramePacer::usesVsync() const
+{
+    return config_.mode == FramePacing::Vsync || config_.mode == FramePacing::LowLatency;
+}
+
+void FramePacer::waitForFrameStart()
+{
+    const std::int64_t now_ns = Profiler::now();
+    std::int64_t start_ns = now_ns;
+    if (config_.mode == FramePacing::Capped)
+        start_ns = nextDeadline(now_ns, 0);
+    else if (config_.mode == FramePacing::LowLatency)
+        start_ns = nextDeadline(now_ns, static_cast<std::int64_t>(predictedWorkMs() * 1.0e6));
+
+    if (start_ns > now_ns)
+        sleepUntil(start_ns);
+    frame_start_ns_ = Profiler::now();
+    last_wait_ms_ = static_cast<double>(frame_start_ns_ - now_ns) / 1.0e6;
+}
+
+void FramePacer::endFrame()
+{
+    work_ns_[work_count_ % kWorkHistory] = Profiler::now() - frame_start_ns_;
+    ++work_count_;
+}
+
+void FramePacer::onPresent(std::int64_t present_ns, std::int64_t render_work_ns)
+{
+    last_present_ns_ = present_ns;
+    render_work_ns_ = render_work_ns;
+}
+
+double FramePacer::predictedWorkMs() const
+{
+    const std::size_t count = std::min(work_count_, kWorkHistory);
+    std::int64_t work_ns = 0;
+    if (count > 0)
+    {
+        std::array<std::int64_t, kWorkHistory> sorted = work_ns_;
+        const std::size_t rank = std::min(count - 1, static_cast<std::size_t>(kWorkPercentile * static_cast<double>(count)));
+        std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank), sorted.begin() + static_cast<std::ptrdiff_t>(count));
+        work_ns = sorted[rank];
+    }
+    return static_cast<double>(work_ns + render_work_ns_ + kLowLatencyMarginNs) / 1.0e6;
+}
+
+std::int64_t FramePacer::periodNs() const
+{
+    return static_cast<std::int64_t>(1.0e9 / config_.target_fps);
+}
+
+std::int64_t FramePacer::nextDeadline(std::int64_t now_ns, std::int64_t lead_ns)
+{
+    // deadline은 프레임이 끝나야 하는(제출/present) 시각, 시작은 그보다 lead_ns 앞
+    const std::int64_t period = periodNs();
+    std::int64_t deadline = deadline_ns_ == 0 ? now_ns + lead_ns : deadline_ns_ + period;
+    if (deadline - lead_ns < now_ns)
+        deadline = now_ns + lead_ns;
+
+    // present 시각을 알면 vblank 격자(last_present + k * period)에 맞춘다
+    if (config_.mode == FramePacing::LowLatency && last_present_ns_ >= 0 && deadline > last_present_ns_)
+    {
+        const std::int64_t periods = (deadline - last_present_ns_ + period - 1) / period;
+        deadline = last_present_ns_ + periods * period;
+    }
+
+    deadline_ns_ = deadline;
+    return deadline - lead_ns;
+}
+
+void FramePacer::sleepUntil(std::int64_t target_ns)
+{
+    while (true)
+    {
+        const std::int64_t remaining = target_ns - Profiler::now();
+        if (remaining <= 0)
+            return;
+        if (remaining > kSpinThresholdNs)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(remaining - kSpinThresholdNs));
+        else
+            std::this_thread::yield();
+    }
+}
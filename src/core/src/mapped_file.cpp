@@ -0,0 +1,70 @@
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+MappedFile::MappedFile(const std::string &path)
+{
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0)
+        return;
+
+    struct stat info{};
+    if (::fstat(fd_, &info) != 0)
+    {
+        close();
+        return;
+    }
+
+    size_ = static_cast<std::size_t>(info.st_size);
+    if (size_ == 0)
+        return;
+
+    void *mapped = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (mapped == MAP_FAILED)
+    {
+        close();
+        return;
+    }
+    // 파서는 앞에서부터 한 번 훑고 지나간다
+    ::madvise(mapped, size_, MADV_SEQUENTIAL);
+    data_ = mapped;
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)),
+      fd_(std::exchange(other.fd_, -1))
+{
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        fd_ = std::exchange(other.fd_, -1);
+    }
+    return *this;
+}
+
+void MappedFile::close()
+{
+    if (data_)
+        ::munmap(data_, size_);
+    if (fd_ >= 0)
+        ::close(fd_);
+    data_ = nullptr;
+    size_ = 0;
+    fd_ = -1;
+}
@@ -0,0 +1,243 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+// 이벤트 이름은 대부분 리터럴이지만 따옴표/역슬래시는 JSON에서 깨지므로 걸러낸다
+void writeJsonString(std::ostream &out, const char *text)
+{
+    out << '"';
+    for (const char *c = text ? text : ""; *c; ++c)
+    {
+        if (*c == '"' || *c == '\\')
+            out << '\\';
+        if (static_cast<unsigned char>(*c) >= 0x20)
+            out << *c;
+    }
+    out << '"';
+}
+
+double toMicros(std::int64_t ns)
+{
+    return static_cast<double>(ns) / 1000.0;
+}
+
+constexpr int kCpuProcess = 1;
+constexpr int kGpuProcess = 2;
+} // namespace
+
+Profiler &Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+std::chrono::steady_clock::time_point Profiler::epoch()
+{
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return start;
+}
+
+Profiler::ThreadEvents &Profiler::threadEvents()
+{
+    // 스레드당 한 번만 버퍼를 만들고, 스레드가 끝나도 내보내기를 위해 Profiler가 소유한다
+    thread_local ThreadEvents *events = nullptr;
+    if (!events)
+    {
+        auto created = std::make_unique<ThreadEvents>();
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        created->thread_id = static_cast<std::uint32_t>(threads_.size());
+        created->name = "thread " + std::to_string(created->thread_id);
+        events = created.get();
+        threads_.push_back(std::move(created));
+    }
+    return *events;
+}
+
+void Profiler::setThreadName(const char *name)
+{
+    ThreadEvents &events = threadEvents();
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    events.name = name;
+}
+
+void Profiler::recordCpu(const char *name, std::int64_t start_ns, std::int64_t end_ns)
+{
+    ThreadEvents &events = threadEvents();
+    const std::uint64_t index = events.written.load(std::memory_order_relaxed);
+    events.events[index % kEventsPerThread] = ProfileEvent{name, start_ns, end_ns};
+    events.written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::recordGpu(const char *name, std::int64_t cpu_start_ns, std::int64_t duration_ns)
+{
+    std::lock_guard<std::mutex> lock(gpu_mutex_);
+    if (gpu_events_.size() < kGpuEventCapacity)
+        gpu_events_.resize(kGpuEventCapacity);
+    gpu_events_[gpu_written_ % kGpuEventCapacity] = ProfileEvent{name, cpu_start_ns, cpu_start_ns + duration_ns};
+    ++gpu_written_;
+}
+
+void Profiler::beginFrame()
+{
+    if (frames_.empty())
+    {
+        frames_.resize(kFrameHistory);
+        percentile_scratch_.reserve(kFrameHistory);
+    }
+    current_frame_ = FrameRecord{};
+    current_frame_.start_ns = now();
+}
+
+void Profiler::endFrame()
+{
+    if (frames_.empty())
+        return;
+    const std::int64_t end_ns = now();
+    current_frame_.duration_ns = end_ns - current_frame_.start_ns;
+    frames_[frame_count_ % kFrameHistory] = current_frame_;
+    ++frame_count_;
+    if (enabled())
+        recordCpu("Frame", current_frame_.start_ns, end_ns);
+}
+
+void Profiler::setCounter(const char *name, double value)
+{
+    std::size_t index = 0;
+    while (index < counter_count_ && counter_names_[index] != name)
+        ++index;
+    if (index == counter_count_)
+    {
+        if (counter_count_ >= kMaxCounters)
+            return;
+        counter_names_[counter_count_++] = name;
+    }
+    current_frame_.counters[index] = value;
+}
+
+FrameTimeStats Profiler::frameTimeStats()
+{
+    FrameTimeStats stats;
+    const std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(frame_count_, kFrameHistory));
+    if (count == 0)
+        return stats;
+
+    percentile_scratch_.clear();
+    double total = 0.0;
+    double total_squared = 0.0;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const double ms = static_cast<double>(frames_[i].duration_ns) / 1.0e6;
+        percentile_scratch_.push_back(ms);
+        total += ms;
+        total_squared += ms * ms;
+    }
+
+    // 시작 간격은 ring 순서가 아닌 프레임 순서로 이웃한 기록끼리 잰다
+    double interval_total = 0.0;
+    double interval_squared = 0.0;
+    const std::uint64_t first_frame = frame_count_ - count;
+    for (std::uint64_t frame = first_frame + 1; frame < frame_count_; ++frame)
+    {
+        const std::int64_t start = frames_[frame % kFrameHistory].start_ns;
+        const std::int64_t previous = frames_[(frame - 1) % kFrameHistory].start_ns;
+        const double ms = static_cast<double>(start - previous) / 1.0e6;
+        interval_total += ms;
+        interval_squared += ms * ms;
+    }
+    if (count > 1)
+    {
+        const auto intervals = static_cast<double>(count - 1);
+        stats.interval_mean_ms = interval_total / intervals;
+        stats.interval_stddev_ms = std::sqrt(std::max(0.0, interval_squared / intervals - stats.interval_mean_ms * stats.interval_mean_ms));
+    }
+
+    auto percentile = [&](double p)
+    {
+        const std::size_t rank = std::min(count - 1, static_cast<std::size_t>(p * static_cast<double>(count)));
+        std::nth_element(percentile_scratch_.begin(), percentile_scratch_.begin() + static_cast<std::ptrdiff_t>(rank), percentile_scratch_.end());
+        return percentile_scratch_[rank];
+    };
+    stats.p50_ms = percentile(0.50);
+    stats.p99_ms = percentile(0.99);
+    stats.mean_ms = total / static_cast<double>(count);
+    stats.stddev_ms = std::sqrt(std::max(0.0, total_squared / static_cast<double>(count) - stats.mean_ms * stats.mean_ms));
+    stats.frame_count = count;
+    return stats;
+}
+
+bool Profiler::writeChromeTrace(const std::string &path) const
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out)
+        return false;
+    // 기본 6자리 유효숫자로는 몇 초만 지나도 µs 단위 타임스탬프가 뭉개진다
+    out.setf(std::ios::fixed);
+    out.precision(3);
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() -> std::ostream &
+    {
+        if (!first)
+            out << ",\n";
+        first = false;
+        return out;
+    };
+    auto writeEvent = [&](const ProfileEvent &event, int pid, std::uint32_t tid)
+    {
+        separator() << "{\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"ts\":" << toMicros(event.start_ns)
+                    << ",\"dur\":" << toMicros(event.end_ns - event.start_ns) << ",\"name\":";
+        writeJsonString(out, event.name);
+        out << "}";
+    };
+    auto writeMetadata = [&](const char *kind, int pid, std::uint32_t tid, const char *name)
+    {
+        separator() << "{\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"name\":\"" << kind
+                    << "\",\"args\":{\"name\":";
+        writeJsonString(out, name);
+        out << "}}";
+    };
+
+    writeMetadata("process_name", kCpuProcess, 0, "CPU");
+    writeMetadata("process_name", kGpuProcess, 0, "GPU");
+    writeMetadata("thread_name", kGpuProcess, 0, "GL timer queries");
+
+    {
+        std::lock_guard<std::mutex> lock(threads_mutex_);
+        for (const auto &thread : threads_)
+        {
+            writeMetadata("thread_name", kCpuProcess, thread->thread_id, thread->name.c_str());
+            const std::uint64_t written = thread->written.load(std::memory_order_acquire);
+            const std::uint64_t begin = written > kEventsPerThread ? written - kEventsPerThread : 0;
+            for (std::uint64_t i = begin; i < written; ++i)
+                writeEvent(thread->events[i % kEventsPerThread], kCpuProcess, thread->thread_id);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(gpu_mutex_);
+        const std::uint64_t begin = gpu_written_ > kGpuEventCapacity ? gpu_written_ - kGpuEventCapacity : 0;
+        for (std::uint64_t i = begin; i < gpu_written_; ++i)
+            writeEvent(gpu_events_[i % kGpuEventCapacity], kGpuProcess, 0);
+    }
+
+    // 카운터는 프레임 시작 시각에 값 하나씩 찍는다
+    const std::uint64_t frame_begin = frame_count_ > kFrameHistory ? frame_count_ - kFrameHistory : 0;
+    for (std::uint64_t frame = frame_begin; frame < frame_count_; ++frame)
+    {
+        const FrameRecord &record = frames_[frame % kFrameHistory];
+        for (std::size_t counter = 0; counter < counter_count_; ++counter)
+        {
+            separator() << "{\"ph\":\"C\",\"pid\":" << kCpuProcess << ",\"ts\":" << toMicros(record.start_ns) << ",\"name\":";
+            writeJsonString(out, counter_names_[counter]);
+            out << ",\"args\":{\"value\":" << record.counters[counter] << "}}";
+        }
+    }
+
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
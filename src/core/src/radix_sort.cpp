@@ -0,0 +1,173 @@
+#include "radix_sort.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+constexpr std::size_t kRadixBits = 8;
+constexpr std::size_t kBuckets = 1u << kRadixBits;
+constexpr std::size_t kPasses = 64 / kRadixBits;
+constexpr std::size_t kMaxBlocks = 64;
+
+using Histogram = std::array<std::uint32_t, kBuckets>;
+
+inline std::size_t digitOf(std::uint64_t key, std::size_t pass)
+{
+    return static_cast<std::size_t>((key >> (pass * kRadixBits)) & (kBuckets - 1));
+}
+
+// 히스토그램의 한 버킷에 모든 원소가 몰려 있으면 그 pass는 순서를 바꾸지 않는다
+bool isTrivialPass(const Histogram &histogram, std::size_t count)
+{
+    for (std::uint32_t bucket_count : histogram)
+    {
+        if (bucket_count == count)
+            return true;
+        if (bucket_count != 0)
+            return false;
+    }
+    return true;
+}
+} // namespace
+
+void radixSortKeyIndex(SortKeyIndex *data, SortKeyIndex *scratch, std::size_t count)
+{
+    if (count < 2)
+        return;
+
+    std::array<Histogram, kPasses> histograms{};
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const std::uint64_t key = data[i].key;
+        for (std::size_t pass = 0; pass < kPasses; ++pass)
+            ++histograms[pass][digitOf(key, pass)];
+    }
+
+    SortKeyIndex *src = data;
+    SortKeyIndex *dst = scratch;
+    for (std::size_t pass = 0; pass < kPasses; ++pass)
+    {
+        const Histogram &histogram = histograms[pass];
+        if (isTrivialPass(histogram, count))
+            continue;
+
+        Histogram offsets{};
+        std::uint32_t running = 0;
+        for (std::size_t bucket = 0; bucket < kBuckets; ++bucket)
+        {
+            offsets[bucket] = running;
+            running += histogram[bucket];
+        }
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const SortKeyIndex &entry = src[i];
+            dst[offsets[digitOf(entry.key, pass)]++] = entry;
+        }
+        std::swap(src, dst);
+    }
+
+    if (src != data)
+        std::memcpy(data, src, count * sizeof(SortKeyIndex));
+}
+
+void parallelRadixSortKeyIndex(SortKeyIndex *data, SortKeyIndex *scratch, std::size_t count, ThreadPool &pool)
+{
+    const std::size_t block_count = std::min({pool.concurrency(), kMaxBlocks, count / 4096});
+    if (block_count < 2)
+    {
+        radixSortKeyIndex(data, scratch, count);
+        return;
+    }
+
+    const std::size_t block_size = (count + block_count - 1) / block_count;
+    auto block_begin = [&](std::size_t block)
+    { return std::min(count, block * block_size); };
+
+    // 블록별 히스토그램은 수백 KB라 스택 대신 스레드별로 한 번만 할당해 재사용한다
+    // (thread_local은 람다에서 워커 스레드 자신의 인스턴스를 가리키므로 참조로 받아 넘긴다)
+    thread_local std::vector<std::array<Histogram, kPasses>> block_histograms_storage(kMaxBlocks);
+    thread_local std::vector<Histogram> pass_histograms_storage(kMaxBlocks);
+    thread_local std::vector<Histogram> offsets_storage(kMaxBlocks);
+    auto &block_histograms = block_histograms_storage;
+    auto &pass_histograms = pass_histograms_storage;
+    auto &offsets = offsets_storage;
+
+    // 첫 pass에서 모든 자리수의 전체 히스토그램을 구해 건너뛸 pass를 미리 정한다
+    pool.parallelFor(block_count, [&](std::size_t block)
+                     {
+        auto &histograms = block_histograms[block];
+        histograms = {};
+        for (std::size_t i = block_begin(block), end = block_begin(block + 1); i < end; ++i)
+        {
+            const std::uint64_t key = data[i].key;
+            for (std::size_t pass = 0; pass < kPasses; ++pass)
+                ++histograms[pass][digitOf(key, pass)];
+        } });
+
+    std::array<bool, kPasses> trivial{};
+    for (std::size_t pass = 0; pass < kPasses; ++pass)
+    {
+        Histogram total{};
+        for (std::size_t block = 0; block < block_count; ++block)
+        {
+            for (std::size_t bucket = 0; bucket < kBuckets; ++bucket)
+                total[bucket] += block_histograms[block][pass][bucket];
+        }
+        trivial[pass] = isTrivialPass(total, count);
+    }
+
+    SortKeyIndex *src = data;
+    SortKeyIndex *dst = scratch;
+    bool first_pass = true;
+    for (std::size_t pass = 0; pass < kPasses; ++pass)
+    {
+        if (trivial[pass])
+            continue;
+
+        // 이전 pass에서 원소가 재배치됐으므로 블록별 히스토그램은 현재 배열에서 다시 구한다
+        if (first_pass)
+        {
+            for (std::size_t block = 0; block < block_count; ++block)
+                pass_histograms[block] = block_histograms[block][pass];
+        }
+        else
+        {
+            pool.parallelFor(block_count, [&](std::size_t block)
+                             {
+                Histogram &histogram = pass_histograms[block];
+                histogram = {};
+                for (std::size_t i = block_begin(block), end = block_begin(block + 1); i < end; ++i)
+                    ++histogram[digitOf(src[i].key, pass)]; });
+        }
+        first_pass = false;
+
+        // 버킷 순서 -> 블록 순서로 시작 위치를 정하면 stable 하다
+        std::uint32_t running = 0;
+        for (std::size_t bucket = 0; bucket < kBuckets; ++bucket)
+        {
+            for (std::size_t block = 0; block < block_count; ++block)
+            {
+                offsets[block][bucket] = running;
+                running += pass_histograms[block][bucket];
+            }
+        }
+
+        pool.parallelFor(block_count, [&](std::size_t block)
+                         {
+            Histogram &cursor = offsets[block];
+            for (std::size_t i = block_begin(block), end = block_begin(block + 1); i < end; ++i)
+            {
+                const SortKeyIndex &entry = src[i];
+                dst[cursor[digitOf(entry.key, pass)]++] = entry;
+            } });
+        std::swap(src, dst);
+    }
+
+    if (src != data)
+        std::memcpy(data, src, count * sizeof(SortKeyIndex));
+}
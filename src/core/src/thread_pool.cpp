@@ -0,0 +1,168 @@
+#include "thread_pool.hpp"
+#include "profiler.hpp"
+
+#include <atomic>
+
+struct ThreadPool::ParallelJob
+{
+    void *ctx = nullptr;
+    InvokeFn invoke = nullptr;
+    std::size_t task_count = 0;
+    std::atomic<std::size_t> next{0};
+    std::atomic<std::size_t> done{0};
+    // 이 job을 실행하러 들어온 헬퍼 중 아직 빠져나가지 않은 수
+    std::size_t active_helpers = 0;
+
+    void run()
+    {
+        for (;;)
+        {
+            const std::size_t index = next.fetch_add(1, std::memory_order_relaxed);
+            if (index >= task_count)
+                return;
+            invoke(ctx, index);
+            done.fetch_add(1, std::memory_order_acq_rel);
+        }
+    }
+};
+
+ThreadPool::ThreadPool(std::size_t worker_count)
+{
+    workers_.reserve(worker_count);
+    tasks_.reserve(64);
+    for (std::size_t i = 0; i < worker_count; ++i)
+    {
+        workers_.emplace_back([this]
+                              { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto &worker : workers_)
+    {
+        if (worker.joinable())
+            worker.join();
+    }
+}
+
+ThreadPool &ThreadPool::instance()
+{
+    static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+    if (workers_.empty())
+    {
+        task();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        background_tasks_.push_back(std::move(task));
+    }
+    work_cv_.notify_one();
+}
+
+std::size_t ThreadPool::pendingBackgroundTasks() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return background_tasks_.size() + running_background_tasks_;
+}
+
+void ThreadPool::dispatch(std::size_t task_count, void *ctx, InvokeFn invoke)
+{
+    if (task_count == 0)
+        return;
+    if (task_count == 1 || workers_.empty())
+    {
+        for (std::size_t i = 0; i < task_count; ++i)
+            invoke(ctx, i);
+        return;
+    }
+
+    // job은 호출자 스택에 있다. 반환 전에 아직 시작하지 않은 헬퍼는 큐에서 빼고,
+    // 이미 시작한 헬퍼가 빠져나갈 때까지 기다린다
+    ParallelJob job;
+    job.ctx = ctx;
+    job.invoke = invoke;
+    job.task_count = task_count;
+
+    const std::size_t helper_count = std::min(workers_.size(), task_count - 1);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (std::size_t i = 0; i < helper_count; ++i)
+            tasks_.push_back(Task{&job});
+    }
+    if (helper_count == 1)
+        work_cv_.notify_one();
+    else
+        work_cv_.notify_all();
+
+    job.run();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto first = tasks_.begin() + static_cast<std::ptrdiff_t>(head_);
+    tasks_.erase(std::remove_if(first, tasks_.end(), [&](const Task &task)
+                                { return task.job == &job; }),
+                 tasks_.end());
+    done_cv_.wait(lock, [&]
+                  { return job.active_helpers == 0 && job.done.load(std::memory_order_acquire) == task_count; });
+}
+
+void ThreadPool::workerLoop()
+{
+    Profiler::instance().setThreadName("pool worker");
+    for (;;)
+    {
+        ParallelJob *job = nullptr;
+        std::function<void()> background_task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this]
+                          { return stopping_ || head_ < tasks_.size() || !background_tasks_.empty(); });
+            // 종료 시 남은 백그라운드 작업은 버린다. parallelFor 호출자는 스스로 끝까지 처리한다
+            if (stopping_ && head_ >= tasks_.size())
+                return;
+
+            if (head_ < tasks_.size())
+            {
+                job = tasks_[head_++].job;
+                if (head_ == tasks_.size())
+                {
+                    tasks_.clear();
+                    head_ = 0;
+                }
+                ++job->active_helpers;
+            }
+            else
+            {
+                background_task = std::move(background_tasks_.front());
+                background_tasks_.pop_front();
+                ++running_background_tasks_;
+            }
+        }
+
+        if (!job)
+        {
+            background_task();
+            background_task = nullptr;
+            std::lock_guard<std::mutex> lock(mutex_);
+            --running_background_tasks_;
+            continue;
+        }
+
+        job->run();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        --job->active_helpers;
+        done_cv_.notify_all();
+    }
+}
@@ -22,8 +22,13 @@ struct TransformComponent
 struct RenderableComponent
 {
     int mesh_id = 0;
-    glm::vec3 color{1.0f, 0.5f, 0.2f};
-    bool use_grid = false;
+    // Renderer::registerMaterial로 받은 handle. 0은 기본 material
+    std::uint32_t material_id = 0;
+    // 지면/건물처럼 움직이지 않는 물체. 그림자를 캐시에 한 번만 그린다
+    bool is_static = false;
+    bool casts_shadow = true;
+    // 건물/벽처럼 크고 메시 AABB를 꽉 채우는 물체. occlusion culling에서 다른 물체를 가린다
+    bool occluder = false;
 };
 
 enum class LightType
@@ -68,8 +73,47 @@ struct PickBoundsComponent
     glm::vec3 center_offset{0.0f};
 };
 
+// 여러 entity로 된 물체의 한 부분 (차량 지붕 등). 센서는 owner와 그 부분들을 owner 하나로 본다
+struct PartOfComponent
+{
+    entity_id owner = 0;
+};
+
 struct CommNodeComponent
 {
     float range = 8.0f;
     bool enabled = true;
-};
\ No newline at end of file
+};
+
+// 회전식 LiDAR. entity의 위치/회전에 로컬 mount_offset을 더한 곳에 달리고 (scale은 무시)
+// 그 entity가 속한 물체(PartOfComponent의 owner와 그 부분들)는 맞지 않는다.
+// 결과는 LidarSystem::latestScan으로 읽는다
+struct LidarComponent
+{
+    std::uint32_t channels = 128;
+    std::uint32_t columns = 1024; // 한 바퀴의 발사 수
+    float elevation_min_deg = -25.0f;
+    float elevation_max_deg = 15.0f;
+    // 빔을 지평선 근처에 모은다
+    bool horizon_dense = false;
+    float rotation_hz = 10.0f;
+    float min_range = 0.5f;
+    float max_range = 120.0f;
+    glm::vec3 mount_offset{0.0f};
+    bool enabled = true;
+};
+
+// 카메라 센서. entity의 위치/회전에 mount_offset/mount_rotation을 더한 곳에서 로컬 +z를 보고 (scale은 무시)
+// rate_hz 주기로 color, depth, entity id 이미지를 찍는다. 이미지는 RenderThread::addCameraImageConsumer로 받는다
+struct CameraSensorComponent
+{
+    int width = 640;
+    int height = 480;
+    float fov_y_deg = 60.0f;
+    float near_plane = 0.1f;
+    float far_plane = 150.0f;
+    float rate_hz = 10.0f;
+    glm::vec3 mount_offset{0.0f};
+    glm::quat mount_rotation{1.0f, 0.0f, 0.0f, 0.0f};
+    bool enabled = true;
+};
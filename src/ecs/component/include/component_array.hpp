@@ -37,7 +37,7 @@ public:
 
         size_t new_index = component_data_.size();
         entity_to_index_map[entity] = new_index;
-        index_to_entity_map[new_index] = entity;
+        dense_entities_.push_back(entity);
         component_data_.emplace_back(std::forward<Args>(args)...);
         return component_data_.back();
     }
@@ -86,6 +86,25 @@ public:
         return component_data_;
     }
 
+    [[nodiscard]]
+    std::vector<T> &raw() noexcept
+    {
+        return component_data_;
+    }
+
+    // raw()와 같은 순서의 entity 목록 (dense index -> entity)
+    [[nodiscard]]
+    const std::vector<Entity> &denseEntities() const noexcept
+    {
+        return dense_entities_;
+    }
+
+    [[nodiscard]]
+    size_t size() const noexcept
+    {
+        return component_data_.size();
+    }
+
     [[nodiscard]]
     bool contains(Entity entity) const noexcept
     {
@@ -118,17 +137,17 @@ public:
         size_t index_of_last = component_data_.size() - 1;
 
         component_data_[index_of_removed] = std::move(component_data_[index_of_last]);
-        Entity entity_of_last = index_to_entity_map[index_of_last];
+        Entity entity_of_last = dense_entities_[index_of_last];
         entity_to_index_map[entity_of_last] = index_of_removed;
-        index_to_entity_map[index_of_removed] = entity_of_last;
+        dense_entities_[index_of_removed] = entity_of_last;
 
         component_data_.pop_back();
+        dense_entities_.pop_back();
         entity_to_index_map.erase(entity);
-        index_to_entity_map.erase(index_of_last);
     }
 
 private:
     std::vector<T> component_data_;
     std::unordered_map<Entity, size_t> entity_to_index_map;
-    std::unordered_map<size_t, Entity> index_to_entity_map;
+    std::vector<Entity> dense_entities_;
 };
\ No newline at end of file
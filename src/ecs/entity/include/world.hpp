@@ -32,6 +32,9 @@ public:
         return next_entity_id_++;
     }
 
+    // 지금까지 발급된 entity id의 상한. id로 인덱싱하는 배열의 크기로 쓴다
+    std::size_t entityCapacity() const { return next_entity_id_; }
+
     void destroyEntity(Entity entity)
     {
         for (auto &entry : component_pools_)
@@ -69,6 +72,27 @@ public:
         return array ? array->find(entity) : std::nullopt;
     }
 
+    template <typename T>
+    std::size_t componentCount() const
+    {
+        const auto *array = getArray<std::decay_t<T>>();
+        return array ? array->size() : 0;
+    }
+
+    // 시스템이 dense 배열을 직접 나눠 처리할 때 사용 (없으면 nullptr)
+    template <typename T>
+    const ComponentArray<std::decay_t<T>> *getPool() const
+    {
+        return getArray<std::decay_t<T>>();
+    }
+
+    // 여러 스레드가 서로 다른 entity의 component를 고칠 때 사용. 그동안 추가/삭제는 하면 안 된다
+    template <typename T>
+    ComponentArray<std::decay_t<T>> *getPool()
+    {
+        return getArray<std::decay_t<T>>();
+    }
+
     template <typename T, typename Func>
     void forEachComponent(Func &&func)
     {
@@ -76,9 +100,11 @@ public:
         if (!array)
             return;
 
-        for (const auto &[entity, _] : array->entities())
+        const auto &entities = array->denseEntities();
+        auto &data = array->raw();
+        for (std::size_t index = 0; index < entities.size(); ++index)
         {
-            func(entity, array->getData(entity));
+            func(entities[index], data[index]);
         }
     }
 
@@ -96,9 +122,11 @@ public:
         if (!array)
             return;
 
-        for (const auto &[entity, _] : array->entities())
+        const auto &entities = array->denseEntities();
+        const auto &data = array->raw();
+        for (std::size_t index = 0; index < entities.size(); ++index)
         {
-            func(entity, array->getData(entity));
+            func(entities[index], data[index]);
         }
     }
 
@@ -0,0 +1,166 @@
+#pragma once
+
+#include "camera_sensor.hpp"
+#include "component.hpp"
+#include "frame_allocator.hpp"
+#include "profiler.hpp"
+#include "render_data.hpp"
+#include "render_system.hpp"
+#include "world.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <vector>
+
+// CameraSensorComponent를 단 entity마다 rate_hz 주기로 촬영할 CameraSensorView를 만든다.
+// update에서 이번 프레임에 찍을 센서를 고르고, buildViews에서 센서 frustum으로 컬링한 RenderQueue를 추출한다.
+// 한 프레임에 max_views_per_frame장까지만 찍고 넘치면 가장 오래 기다린 센서부터 찍어 GPU 부하를 고르게 나눈다.
+// 센서 시점의 LOD hysteresis가 화면 카메라와 섞이지 않도록 센서 전용 RenderSystem으로 추출한다 (occlusion 없음)
+class CameraSensorSystem
+{
+public:
+    void setMaxViewsPerFrame(std::size_t count) { max_views_per_frame_ = std::max<std::size_t>(count, 1); }
+
+    void update(World &world, float delta_time)
+    {
+        PROFILE_SCOPE("CameraSensorSystem::update");
+        syncSensors(world);
+        due_.clear();
+        const ComponentArray<CameraSensorComponent> *cameras = world.getPool<CameraSensorComponent>();
+        if (!cameras)
+            return;
+
+        for (std::size_t index = 0; index < sensors_.size(); ++index)
+        {
+            Sensor &sensor = sensors_[index];
+            const CameraSensorComponent &camera = cameras->getData(sensor.entity);
+            sensor.chosen = false;
+            if (!camera.enabled || camera.rate_hz <= 0.0f)
+            {
+                sensor.elapsed = 0.0f;
+                continue;
+            }
+            sensor.elapsed += delta_time;
+            if (sensor.elapsed >= 1.0f / camera.rate_hz)
+                due_.push_back(index);
+        }
+
+        if (due_.size() > max_views_per_frame_)
+        {
+            std::nth_element(due_.begin(), due_.begin() + static_cast<std::ptrdiff_t>(max_views_per_frame_), due_.end(),
+                             [&](std::size_t a, std::size_t b)
+                             { return sensors_[a].elapsed > sensors_[b].elapsed; });
+            due_.resize(max_views_per_frame_);
+        }
+        for (std::size_t index : due_)
+        {
+            Sensor &sensor = sensors_[index];
+            const float period = 1.0f / cameras->getData(sensor.entity).rate_hz;
+            // 밀린 만큼 몰아서 찍지 않는다
+            sensor.elapsed = std::min(sensor.elapsed - period, period);
+            sensor.chosen = true;
+            ++sensor.sequence;
+        }
+    }
+
+    // update에서 고른 센서마다 out에 view를 붙인다. base의 mesh_lods/material_variants 표를 쓰고,
+    // view의 RenderQueue는 arena(프레임 arena)에서 할당한다
+    void buildViews(const World &world, const RenderView &base, FrameVector<CameraSensorView> &out, LinearArena *arena)
+    {
+        PROFILE_SCOPE("CameraSensorSystem::buildViews");
+        views_last_frame_ = 0;
+        const auto *cameras = world.getPool<CameraSensorComponent>();
+        const auto *transforms = world.getPool<TransformComponent>();
+        if (due_.empty() || !cameras || !transforms)
+            return;
+
+        for (std::size_t index : due_)
+        {
+            const Sensor &sensor = sensors_[index];
+            const TransformComponent *transform = transforms->tryGetData(sensor.entity);
+            if (!sensor.chosen || !transform)
+                continue;
+            const CameraSensorComponent &camera = cameras->getData(sensor.entity);
+
+            const glm::quat orientation = transform->rotation * camera.mount_rotation;
+            const glm::vec3 origin = transform->position + transform->rotation * camera.mount_offset;
+            const glm::vec3 forward = orientation * glm::vec3(0.0f, 0.0f, 1.0f);
+            const glm::vec3 up = orientation * glm::vec3(0.0f, 1.0f, 0.0f);
+            const int width = std::max(camera.width, 1);
+            const int height = std::max(camera.height, 1);
+            const float fov_y = glm::radians(camera.fov_y_deg);
+
+            CameraSensorView &view = out.emplace_back(arena);
+            view.sensor = sensor.entity;
+            view.sequence = sensor.sequence;
+            view.width = width;
+            view.height = height;
+            view.near_plane = camera.near_plane;
+            view.far_plane = camera.far_plane;
+            view.view = glm::lookAt(origin, origin + forward, up);
+            view.projection = glm::perspective(fov_y, static_cast<float>(width) / static_cast<float>(height),
+                                               camera.near_plane, camera.far_plane);
+
+            RenderView render_view;
+            render_view.camera_position = origin;
+            render_view.pixels_per_unit = static_cast<float>(height) / (2.0f * std::tan(fov_y * 0.5f));
+            render_view.mesh_lods = base.mesh_lods;
+            render_view.material_variants = base.material_variants;
+            render_view.view_projection = view.projection * view.view;
+            render_view.frustum_culling = true;
+            render_system_.buildRenderQueue(world, render_view, view.queue);
+            ++views_last_frame_;
+        }
+    }
+
+    std::size_t sensorCount() const { return sensors_.size(); }
+    std::size_t viewsLastFrame() const { return views_last_frame_; }
+
+private:
+    struct Sensor
+    {
+        entity_id entity = 0;
+        float elapsed = 0.0f;       // 마지막 촬영 뒤 지난 시간
+        std::uint64_t sequence = 0; // 찍은 장 수
+        bool chosen = false;        // 이번 프레임에 찍는다
+        bool alive = false;
+    };
+
+    // 센서 목록을 CameraSensorComponent에 맞춘다. 새 센서는 다음 update부터 주기를 센다
+    void syncSensors(World &world)
+    {
+        for (Sensor &sensor : sensors_)
+            sensor.alive = false;
+
+        world.forEachComponent<CameraSensorComponent>([&](entity_id entity, const CameraSensorComponent &)
+                                                      {
+            for (Sensor &sensor : sensors_)
+            {
+                if (sensor.entity == entity)
+                {
+                    sensor.alive = true;
+                    return;
+                }
+            }
+            Sensor sensor;
+            sensor.entity = entity;
+            sensor.alive = true;
+            sensors_.push_back(sensor); });
+
+        sensors_.erase(std::remove_if(sensors_.begin(), sensors_.end(), [](const Sensor &sensor)
+                                      { return !sensor.alive; }),
+                       sensors_.end());
+    }
+
+    std::vector<Sensor> sensors_;
+    // 이번 프레임에 찍을 sensors_ index
+    std::vector<std::size_t> due_;
+    std::size_t max_views_per_frame_ = 4;
+    std::size_t views_last_frame_ = 0;
+    RenderSystem render_system_;
+};
@@ -10,7 +10,9 @@ class CameraSystem
 {
 public:
     virtual ~CameraSystem() = default;
-    virtual void setPivot(const glm::vec3 &pivot) {}
+    // 카메라가 바라보는 기준점. WASD 이동과 월드 스트리밍 중심으로 쓴다
+    virtual void setPivot(const glm::vec3 &pivot) = 0;
+    virtual glm::vec3 getPivot() const = 0;
     virtual void update(float mouse_dx,
                         float mouse_dy,
                         float scroll_y,
@@ -35,6 +37,7 @@ class QuarterViewCameraSystem : public CameraSystem
 {
 public:
     void setPivot(const glm::vec3 &pivot) override { state_.pivot = pivot; }
+    glm::vec3 getPivot() const override { return state_.pivot; }
     void update(float /* mouse_dx */,
                 float /* mouse_dy */,
                 float scroll_y,
@@ -80,6 +83,8 @@ struct OrbitCameraState
 class OrbitCameraSystem : public CameraSystem
 {
 public:
+    void setPivot(const glm::vec3 &pivot) override { state_.pivot = pivot; }
+    glm::vec3 getPivot() const override { return state_.pivot; }
     void update(float mouse_dx,
                 float mouse_dy,
                 float scroll_y,
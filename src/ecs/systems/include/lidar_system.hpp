@@ -0,0 +1,341 @@
+#pragma once
+
+#include "component.hpp"
+#include "lidar_scan.hpp"
+#include "profiler.hpp"
+#include "ray_bvh.hpp"
+#include "render_data.hpp"
+#include "thread_pool.hpp"
+#include "world.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <memory>
+#include <span>
+#include <vector>
+
+// LidarComponent를 단 entity마다 회전식 LiDAR를 돌린다. 프레임마다 지난 시간만큼의 column만 쏴서
+// 한 바퀴의 비용을 여러 프레임에 나눈다. 쏘기 전에 센서 최대 거리 안의 Renderable로 RayBvh를 다시 만든다.
+//   - 상자 메시(box_shaped로 등록)나 occluder가 90도 단위로만 돌아 있으면 월드 AABB 그대로
+//   - 그 밖에 setMeshTriangles로 삼각형을 등록한 메시는 월드로 변환한 삼각형
+//   - 나머지는 메시 AABB를 감싸는 월드 AABB
+// primitive의 user id와 LidarPoint::entity는 PartOfComponent의 owner라서 센서는 자기가 달린 물체 전체에 맞지 않는다.
+// 센서마다 스캔 버퍼 두 개를 번갈아 채우고, 한 바퀴가 끝나면 latestScan이 방금 채운 버퍼를 가리킨다
+class LidarSystem
+{
+public:
+    struct Scan
+    {
+        std::vector<LidarPoint> points; // LidarScanPattern과 같은 [column * channels + channel] 격자
+        std::uint64_t sequence = 0;     // 이 버퍼를 마지막으로 채운 바퀴 번호 (1부터)
+    };
+
+    // mesh 로컬 좌표의 삼각형. indices가 비어 있으면 positions를 세 개씩 끊는다.
+    // box_shaped는 메시가 로컬 AABB를 꽉 채우는 상자(또는 평면)라는 뜻이다
+    void setMeshTriangles(int mesh_id, std::span<const glm::vec3> positions, std::span<const std::uint32_t> indices = {},
+                          bool box_shaped = false)
+    {
+        if (mesh_id < 0)
+            return;
+        if (static_cast<std::size_t>(mesh_id) >= mesh_triangles_.size())
+        {
+            mesh_triangles_.resize(static_cast<std::size_t>(mesh_id) + 1);
+            mesh_box_shaped_.resize(static_cast<std::size_t>(mesh_id) + 1, false);
+        }
+        mesh_box_shaped_[static_cast<std::size_t>(mesh_id)] = box_shaped;
+        std::vector<glm::vec3> &corners = mesh_triangles_[static_cast<std::size_t>(mesh_id)];
+        corners.clear();
+        if (indices.empty())
+        {
+            corners.assign(positions.begin(), positions.begin() + static_cast<std::ptrdiff_t>(positions.size() / 3 * 3));
+            return;
+        }
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            for (std::size_t k = 0; k < 3; ++k)
+                corners.push_back(positions[indices[i + k]]);
+        }
+    }
+
+    // 레이 packet 폭. RayBvh::maxPacketWidth()로 잘린다
+    void setPacketWidth(std::size_t width) { packet_width_ = width; }
+
+    // meshes는 mesh id로 인덱싱한 로컬 AABB 표 (bounding_radius가 0인 메시는 건너뛴다)
+    void update(World &world, float delta_time, std::span<const MeshLodInfo> meshes, ThreadPool &pool = ThreadPool::instance())
+    {
+        PROFILE_SCOPE("LidarSystem::update");
+        rays_last_update_ = 0;
+        syncSensors(world);
+        if (sensors_.empty())
+            return;
+
+        ComponentArray<TransformComponent> *transforms = world.getPool<TransformComponent>();
+        ComponentArray<LidarComponent> *lidars = world.getPool<LidarComponent>();
+        if (!transforms || !lidars)
+            return;
+        const ComponentArray<PartOfComponent> *parts = world.getPool<PartOfComponent>();
+
+        bool any_due = false;
+        for (Sensor &sensor : sensors_)
+        {
+            const LidarComponent &lidar = lidars->getData(sensor.entity);
+            const TransformComponent *transform = transforms->tryGetData(sensor.entity);
+            sensor.due_columns = 0;
+            if (!lidar.enabled || !transform)
+                continue;
+
+            // 밀린 프레임이 와도 한 바퀴 넘게 몰아서 쏘지 않는다
+            const auto columns = static_cast<float>(sensor.pattern->config().columns);
+            sensor.pending_columns = std::min(sensor.pending_columns + delta_time * lidar.rotation_hz * columns, columns);
+            sensor.due_columns = static_cast<std::uint32_t>(sensor.pending_columns);
+            sensor.pending_columns -= static_cast<float>(sensor.due_columns);
+
+            sensor.params.orientation = transform->rotation;
+            sensor.params.origin = transform->position + transform->rotation * lidar.mount_offset;
+            sensor.params.min_range = lidar.min_range;
+            sensor.params.max_range = lidar.max_range;
+            sensor.params.ignore_entity = ownerOf(parts, sensor.entity);
+            sensor.params.packet_width = packet_width_;
+            any_due = any_due || sensor.due_columns > 0;
+        }
+        if (!any_due)
+            return;
+
+        rebuildScene(world, *transforms, parts, meshes);
+        for (Sensor &sensor : sensors_)
+        {
+            if (sensor.due_columns > 0)
+                fireColumns(sensor, pool);
+        }
+    }
+
+    // 센서 entity의 마지막으로 완성된 한 바퀴. 없거나 아직 한 바퀴를 돌지 않았으면 nullptr
+    const Scan *latestScan(entity_id entity) const
+    {
+        const Sensor *sensor = findSensor(entity);
+        if (!sensor || sensor->completed == 0)
+            return nullptr;
+        return &sensor->scans[(sensor->writing + 1) % sensor->scans.size()];
+    }
+
+    const LidarScanPattern *pattern(entity_id entity) const
+    {
+        const Sensor *sensor = findSensor(entity);
+        return sensor ? sensor->pattern.get() : nullptr;
+    }
+
+    std::size_t sensorCount() const { return sensors_.size(); }
+    std::size_t raysLastUpdate() const { return rays_last_update_; }
+    const RayBvh &bvh() const { return bvh_; }
+
+private:
+    struct Sensor
+    {
+        entity_id entity = 0;
+        std::unique_ptr<LidarScanPattern> pattern;
+        std::array<Scan, 2> scans;
+        std::uint32_t writing = 0;
+        std::uint64_t completed = 0;
+        // 이번 바퀴에서 다음에 쏠 column과 아직 쏘지 않은 소수 column
+        std::uint32_t next_column = 0;
+        float pending_columns = 0.0f;
+        std::uint32_t due_columns = 0;
+        LidarCastParams params;
+        bool alive = false;
+    };
+
+    static LidarScanConfig scanConfig(const LidarComponent &lidar)
+    {
+        LidarScanConfig config;
+        config.channels = std::max(lidar.channels, 1u);
+        config.columns = std::max(lidar.columns, 1u);
+        config.elevation_min_deg = lidar.elevation_min_deg;
+        config.elevation_max_deg = lidar.elevation_max_deg;
+        config.layout = lidar.horizon_dense ? LidarBeamLayout::HorizonDense : LidarBeamLayout::Uniform;
+        return config;
+    }
+
+    static bool sameScan(const LidarScanConfig &a, const LidarScanConfig &b)
+    {
+        return a.channels == b.channels && a.columns == b.columns && a.elevation_min_deg == b.elevation_min_deg &&
+               a.elevation_max_deg == b.elevation_max_deg && a.layout == b.layout;
+    }
+
+    const Sensor *findSensor(entity_id entity) const
+    {
+        for (const Sensor &sensor : sensors_)
+        {
+            if (sensor.entity == entity)
+                return &sensor;
+        }
+        return nullptr;
+    }
+
+    Sensor *findSensor(entity_id entity)
+    {
+        for (Sensor &sensor : sensors_)
+        {
+            if (sensor.entity == entity)
+                return &sensor;
+        }
+        return nullptr;
+    }
+
+    // 센서 목록을 LidarComponent에 맞춘다. 스캔 설정이 바뀐 센서만 패턴과 버퍼를 다시 잡는다
+    void syncSensors(World &world)
+    {
+        for (Sensor &sensor : sensors_)
+            sensor.alive = false;
+
+        world.forEachComponent<LidarComponent>([&](entity_id entity, const LidarComponent &lidar)
+                                               {
+            const LidarScanConfig config = scanConfig(lidar);
+            Sensor *sensor = findSensor(entity);
+            if (!sensor)
+            {
+                sensors_.emplace_back();
+                sensor = &sensors_.back();
+                sensor->entity = entity;
+            }
+            sensor->alive = true;
+            if (sensor->pattern && sameScan(sensor->pattern->config(), config))
+                return;
+
+            sensor->pattern = std::make_unique<LidarScanPattern>(config);
+            for (Scan &scan : sensor->scans)
+            {
+                scan.points.assign(sensor->pattern->rayCount(), LidarPoint{});
+                scan.sequence = 0;
+            }
+            sensor->writing = 0;
+            sensor->completed = 0;
+            sensor->next_column = 0;
+            sensor->pending_columns = 0.0f; });
+
+        sensors_.erase(std::remove_if(sensors_.begin(), sensors_.end(), [](const Sensor &sensor)
+                                      { return !sensor.alive; }),
+                       sensors_.end());
+    }
+
+    static entity_id ownerOf(const ComponentArray<PartOfComponent> *parts, entity_id entity)
+    {
+        const PartOfComponent *part = parts ? parts->tryGetData(entity) : nullptr;
+        return part ? part->owner : entity;
+    }
+
+    void rebuildScene(World &world,
+                      ComponentArray<TransformComponent> &transforms,
+                      const ComponentArray<PartOfComponent> *parts,
+                      std::span<const MeshLodInfo> meshes)
+    {
+        PROFILE_SCOPE("LidarSystem::rebuildScene");
+        bvh_.clear();
+        world.forEachComponent<RenderableComponent>([&](entity_id entity, const RenderableComponent &renderable)
+                                                    {
+            const TransformComponent *transform = transforms.tryGetData(entity);
+            if (!transform || renderable.mesh_id < 0 || static_cast<std::size_t>(renderable.mesh_id) >= meshes.size())
+                return;
+            const MeshLodInfo &mesh = meshes[static_cast<std::size_t>(renderable.mesh_id)];
+            if (mesh.bounding_radius <= 0.0f)
+                return;
+
+            // 로컬 AABB의 중심과 반 크기를 변환해 감싸는 월드 AABB를 만든다
+            const glm::mat4 model = transform->getTransform();
+            const glm::vec3 local_center = (mesh.aabb_min + mesh.aabb_max) * 0.5f;
+            const glm::vec3 local_half = (mesh.aabb_max - mesh.aabb_min) * 0.5f;
+            const glm::vec3 center = glm::vec3(model * glm::vec4(local_center, 1.0f));
+            glm::vec3 half(0.0f);
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int column = 0; column < 3; ++column)
+                    half[row] += std::abs(model[column][row]) * local_half[column];
+            }
+            if (!withinAnySensor(center - half, center + half))
+                return;
+            const entity_id owner = ownerOf(parts, entity);
+
+            const std::size_t mesh_index = static_cast<std::size_t>(renderable.mesh_id);
+            const bool has_triangles = mesh_index < mesh_triangles_.size() && !mesh_triangles_[mesh_index].empty();
+            const bool box_shaped = renderable.occluder || (mesh_index < mesh_box_shaped_.size() && mesh_box_shaped_[mesh_index]);
+            if (!has_triangles || (box_shaped && isQuarterTurn(transform->rotation)))
+            {
+                bvh_.addBox(center - half, center + half, owner);
+                return;
+            }
+
+            const std::vector<glm::vec3> &corners = mesh_triangles_[mesh_index];
+            for (std::size_t i = 0; i + 2 < corners.size(); i += 3)
+            {
+                bvh_.addTriangle(glm::vec3(model * glm::vec4(corners[i], 1.0f)),
+                                 glm::vec3(model * glm::vec4(corners[i + 1], 1.0f)),
+                                 glm::vec3(model * glm::vec4(corners[i + 2], 1.0f)),
+                                 owner);
+            } });
+        bvh_.build();
+    }
+
+    // 축을 축으로 보내는 회전 (90도 단위). 상자의 월드 AABB가 상자 자신과 같다
+    static bool isQuarterTurn(const glm::quat &rotation)
+    {
+        const glm::mat3 basis = glm::mat3_cast(rotation);
+        for (int column = 0; column < 3; ++column)
+        {
+            const glm::vec3 axis = glm::abs(basis[column]);
+            if (std::max(axis.x, std::max(axis.y, axis.z)) < kQuarterTurnCosine)
+                return false;
+        }
+        return true;
+    }
+
+    bool withinAnySensor(const glm::vec3 &aabb_min, const glm::vec3 &aabb_max) const
+    {
+        for (const Sensor &sensor : sensors_)
+        {
+            if (sensor.due_columns == 0)
+                continue;
+            const glm::vec3 closest = glm::clamp(sensor.params.origin, aabb_min, aabb_max);
+            const glm::vec3 offset = closest - sensor.params.origin;
+            if (glm::dot(offset, offset) <= sensor.params.max_range * sensor.params.max_range)
+                return true;
+        }
+        return false;
+    }
+
+    // 바퀴 경계를 넘으면 앞부분으로 현재 버퍼를 마치고 나머지는 다음 버퍼에 쓴다
+    void fireColumns(Sensor &sensor, ThreadPool &pool)
+    {
+        const std::uint32_t columns = sensor.pattern->config().columns;
+        std::uint32_t remaining = sensor.due_columns;
+        while (remaining > 0)
+        {
+            const std::uint32_t count = std::min(remaining, columns - sensor.next_column);
+            Scan &scan = sensor.scans[sensor.writing];
+            castLidarColumns(bvh_, *sensor.pattern, sensor.params, sensor.next_column, count, scan.points, pool);
+            rays_last_update_ += static_cast<std::size_t>(count) * sensor.pattern->config().channels;
+            remaining -= count;
+            sensor.next_column += count;
+            if (sensor.next_column == columns)
+            {
+                scan.sequence = ++sensor.completed;
+                sensor.writing = (sensor.writing + 1) % static_cast<std::uint32_t>(sensor.scans.size());
+                sensor.next_column = 0;
+            }
+        }
+    }
+
+    // 회전한 축이 어느 축과 이루는 각의 코사인이 이 값 이상이면 나란한 것으로 본다 (약 0.1도)
+    static constexpr float kQuarterTurnCosine = 0.9999985f;
+
+    std::vector<Sensor> sensors_;
+    RayBvh bvh_;
+    // mesh id로 인덱싱. 삼각형마다 꼭짓점 3개
+    std::vector<std::vector<glm::vec3>> mesh_triangles_;
+    std::vector<bool> mesh_box_shaped_;
+    std::size_t packet_width_ = RayBvh::maxPacketWidth();
+    std::size_t rays_last_update_ = 0;
+};
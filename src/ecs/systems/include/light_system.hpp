@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "component.hpp"
+#include "frame_allocator.hpp"
 #include "world.hpp"
 
 namespace
@@ -20,29 +21,28 @@ struct GpuLight
     glm::vec4 params;
 };
 
+// 라이트 목록은 프레임 arena에 만들어지므로 해당 arena가 reset되기 전까지만 유효하다
 class LightingSystem
 {
 public:
-    void update(const World &world)
+    void update(const World &world, LinearArena &frame_arena)
     {
-        gpu_lights_.clear();
+        gpu_lights_ = FrameVector<GpuLight>(ArenaAllocator<GpuLight>(&frame_arena));
+        gpu_lights_.reserve(kMaxLights);
         world.forEachComponent<LightComponent>([this](World::Entity /*entity*/, const LightComponent &light)
                                                {
-            if (!light.enabled)
+            if (!light.enabled || gpu_lights_.size() >= kMaxLights)
                 return;
             GpuLight gpu_light{};
             gpu_light.position = glm::vec4(light.position, static_cast<float>(light.type));
             gpu_light.direction = glm::vec4(glm::normalize(light.direction), light.range);
             gpu_light.color = glm::vec4(light.color, light.intensity);
             gpu_light.params = glm::vec4(light.inner_cone, light.outer_cone, 0.0f, 0.0f);
-            gpu_lights_.push_back(gpu_light);
-
-            if (gpu_lights_.size() >= kMaxLights)
-                return; });
+            gpu_lights_.push_back(gpu_light); });
     }
 
-    const std::vector<GpuLight> &getGpuLights() { return gpu_lights_; }
+    const FrameVector<GpuLight> &getGpuLights() const { return gpu_lights_; }
 
 private:
-    std::vector<GpuLight> gpu_lights_;
+    FrameVector<GpuLight> gpu_lights_;
 };
\ No newline at end of file
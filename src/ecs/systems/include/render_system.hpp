@@ -1,36 +1,384 @@
 #pragma once
 
 #include "component.hpp"
+#include "occlusion_culler.hpp"
+#include "profiler.hpp"
 #include "render_data.hpp"
+#include "thread_pool.hpp"
 #include "world.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <utility>
+#include <vector>
 
+// Renderable pool을 연속 구간으로 나눠 워커마다 별도 RenderQueue 세그먼트에 추출하고,
+// 세그먼트 순서대로 합친 뒤 정렬한다. 구간 분할과 병합 순서가 dense index 순서를 유지하고
+// radix sort가 stable 하므로 결과는 스레드 수와 무관하게 항상 같다.
+// LOD는 단순화 오차의 화면 투영 크기로 고르고, entity별 직전 LOD 기준으로 hysteresis를 둔다.
+// 컬링이 켜져 있으면 frustum 밖이거나 occluder에 가려진 항목은 main pass에서 빠진다.
+// 그림자는 화면 밖 물체도 드리우므로 view가 그림자를 그리면 shadow bounds 안의 caster는 Hidden 플래그를 달아 남긴다
 class RenderSystem
 {
 public:
-    void buildRenderQueue(const World &world, RenderQueue &queue) const
+    struct CullStats
     {
+        std::size_t tested = 0;
+        std::size_t frustum_culled = 0;
+        std::size_t occlusion_culled = 0;
+        std::size_t occluders = 0;
+
+        void add(const CullStats &other)
+        {
+            tested += other.tested;
+            frustum_culled += other.frustum_culled;
+            occlusion_culled += other.occlusion_culled;
+        }
+    };
+
+    void buildRenderQueue(const World &world, const RenderView &view, RenderQueue &queue)
+    {
+        PROFILE_SCOPE("RenderSystem::buildRenderQueue");
         queue.clear();
 
-        world.forEachComponent<RenderableComponent>(
-            [&](World::Entity entity, const RenderableComponent &renderable)
+        const auto *renderables = world.getPool<RenderableComponent>();
+        const auto *transforms = world.getPool<TransformComponent>();
+        if (!renderables || !transforms || renderables->size() == 0)
+            return;
+
+        // 추출 중에는 entity마다 자기 칸만 쓰므로 미리 크기만 맞춰두면 병렬로 갱신해도 된다
+        if (lod_state_.size() < world.entityCapacity())
+            lod_state_.resize(world.entityCapacity(), 0);
+        view_ = &view;
+        cull_stats_ = {};
+
+        ThreadPool &pool = ThreadPool::instance();
+        if (view.frustum_culling)
+        {
+            extractFrustumPlanes(view.view_projection);
+            if (view.occlusion)
+                rasterizeOccluders(*renderables, *transforms, *view.occlusion, pool);
+        }
+
+        const std::size_t count = renderables->size();
+        const std::size_t segment_count = std::min((count + kMinItemsPerSegment - 1) / kMinItemsPerSegment,
+                                                   pool.concurrency() * 2);
+        if (segment_stats_.size() < std::max<std::size_t>(segment_count, 1))
+            segment_stats_.resize(std::max<std::size_t>(segment_count, 1));
+
+        if (segment_count <= 1)
+        {
+            queue.reserve(count);
+            segment_stats_[0] = {};
+            extractRange(*renderables, *transforms, 0, count, queue, segment_stats_[0]);
+            cull_stats_.add(segment_stats_[0]);
+        }
+        else
+        {
+            if (segments_.size() < segment_count)
+                segments_.resize(segment_count);
+
+            const std::size_t segment_size = (count + segment_count - 1) / segment_count;
+            pool.parallelFor(segment_count, [&](std::size_t segment)
+                             {
+                PROFILE_SCOPE("RenderSystem::extractSegment");
+                RenderQueue &out = segments_[segment];
+                out.clear();
+                segment_stats_[segment] = {};
+                const std::size_t begin = std::min(count, segment * segment_size);
+                const std::size_t end = std::min(count, begin + segment_size);
+                out.reserve(end - begin);
+                extractRange(*renderables, *transforms, begin, end, out, segment_stats_[segment]); });
+
+            for (std::size_t segment = 0; segment < segment_count; ++segment)
+                cull_stats_.add(segment_stats_[segment]);
+
+            mergeSegments(queue.opaque, &RenderQueue::opaque, segment_count, pool);
+            mergeSegments(queue.transparent, &RenderQueue::transparent, segment_count, pool);
+            for (std::size_t segment = 0; segment < segment_count; ++segment)
             {
-                auto transform = world.getComponent<TransformComponent>(entity);
-                if (!transform)
-                    return;
-
-                RenderItem item{};
-                item.mesh_handle = static_cast<MeshHandle>(renderable.mesh_id);
-                item.material_handle = 0; // TODO(jyan): hook up material component/pipeline
-                item.model = transform->get().getTransform();
-                item.color = renderable.color;
-                item.use_grid = renderable.use_grid;
-                item.pass = RenderPass::Opaque;
-
-                // opaque for now; if transparent flag added, compute distance and call addTransparent
-                queue.addOpaque(std::move(item));
-            });
+                queue.static_caster_hash += segments_[segment].static_caster_hash;
+                queue.static_caster_count += segments_[segment].static_caster_count;
+            }
+        }
 
+        PROFILE_SCOPE("RenderSystem::sort");
         queue.sort();
     }
+
+    // 직전 buildRenderQueue의 컬링 결과
+    const CullStats &getCullStats() const { return cull_stats_; }
+
+private:
+    static constexpr std::size_t kMinItemsPerSegment = 4096;
+    // 이 픽셀 수 이하의 오차면 더 거친 LOD를 써도 된다
+    static constexpr float kLodPixelError = 1.0f;
+    // 경계 근처에서 LOD가 프레임마다 바뀌지 않도록 coarsen/refine 기준을 벌린다
+    static constexpr float kLodHysteresis = 0.25f;
+    // 화면 점유가 큰 순서로 이만큼만 occluder로 래스터화한다
+    static constexpr std::size_t kMaxOccluders = 256;
+    // 투영 반지름이 이 픽셀 수보다 작은 occluder는 가리는 영역이 작아 건너뛴다
+    static constexpr float kMinOccluderPixels = 16.0f;
+
+    struct OccluderCandidate
+    {
+        float score = 0.0f;
+        std::uint32_t index = 0; // Renderable dense index
+    };
+
+    static float maxScale(const Matrix4x4 &model)
+    {
+        return std::max({glm::length(glm::vec3(model[0])),
+                         glm::length(glm::vec3(model[1])),
+                         glm::length(glm::vec3(model[2]))});
+    }
+
+    const MeshLodInfo *meshInfo(MeshHandle mesh) const
+    {
+        const std::vector<MeshLodInfo> *table = view_->mesh_lods;
+        if (!table || mesh >= table->size())
+            return nullptr;
+        return &(*table)[mesh];
+    }
+
+    // Gribb-Hartmann. 평면 법선은 안쪽을 향한다
+    void extractFrustumPlanes(const glm::mat4 &view_projection)
+    {
+        const glm::mat4 m = glm::transpose(view_projection);
+        frustum_planes_ = {m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2]};
+        for (glm::vec4 &plane : frustum_planes_)
+            plane /= glm::length(glm::vec3(plane));
+    }
+
+    // 로컬 AABB를 변환한 월드 AABB가 어느 한 평면의 완전히 바깥이면 false
+    bool inFrustum(const MeshLodInfo &info, const Matrix4x4 &model) const
+    {
+        const glm::vec3 local_center = (info.aabb_min + info.aabb_max) * 0.5f;
+        const glm::vec3 local_extent = (info.aabb_max - info.aabb_min) * 0.5f;
+        const glm::vec3 center = glm::vec3(model * glm::vec4(local_center, 1.0f));
+        const glm::vec3 extent = glm::abs(glm::vec3(model[0])) * local_extent.x +
+                                 glm::abs(glm::vec3(model[1])) * local_extent.y +
+                                 glm::abs(glm::vec3(model[2])) * local_extent.z;
+        for (const glm::vec4 &plane : frustum_planes_)
+        {
+            const glm::vec3 normal(plane);
+            if (glm::dot(normal, center) + plane.w + glm::dot(glm::abs(normal), extent) < 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+    // 화면에서 크게 보이는 occluder만 골라 culler에 래스터화한다
+    void rasterizeOccluders(const ComponentArray<RenderableComponent> &renderables,
+                            const ComponentArray<TransformComponent> &transforms,
+                            OcclusionCuller &culler,
+                            ThreadPool &pool)
+    {
+        PROFILE_SCOPE("RenderSystem::rasterizeOccluders");
+        const auto &entities = renderables.denseEntities();
+        const auto &data = renderables.raw();
+        occluder_candidates_.clear();
+        for (std::size_t index = 0; index < data.size(); ++index)
+        {
+            if (!data[index].occluder)
+                continue;
+            const TransformComponent *transform = transforms.tryGetData(entities[index]);
+            const MeshLodInfo *info = meshInfo(static_cast<MeshHandle>(data[index].mesh_id));
+            if (!transform || !info || info->bounding_radius <= 0.0f)
+                continue;
+
+            const Matrix4x4 model = transform->getTransform();
+            if (!inFrustum(*info, model))
+                continue;
+            const float radius = info->bounding_radius * maxScale(model);
+            const float distance = std::max(glm::length(glm::vec3(model[3]) - view_->camera_position), 1e-3f);
+            const float projected_radius = radius * view_->pixels_per_unit / distance;
+            if (projected_radius < kMinOccluderPixels)
+                continue;
+            occluder_candidates_.push_back(OccluderCandidate{projected_radius, static_cast<std::uint32_t>(index)});
+        }
+
+        if (occluder_candidates_.size() > kMaxOccluders)
+        {
+            std::nth_element(occluder_candidates_.begin(),
+                             occluder_candidates_.begin() + kMaxOccluders,
+                             occluder_candidates_.end(),
+                             [](const OccluderCandidate &a, const OccluderCandidate &b)
+                             { return a.score > b.score; });
+            occluder_candidates_.resize(kMaxOccluders);
+        }
+
+        culler.beginFrame(view_->view_projection);
+        for (const OccluderCandidate &candidate : occluder_candidates_)
+        {
+            const TransformComponent *transform = transforms.tryGetData(entities[candidate.index]);
+            const MeshLodInfo *info = meshInfo(static_cast<MeshHandle>(data[candidate.index].mesh_id));
+            culler.addOccluder(transform->getTransform(), info->aabb_min, info->aabb_max);
+        }
+        culler.finish(pool);
+        cull_stats_.occluders = culler.stats().occluders;
+    }
+
+    uint8_t selectLod(entity_id entity, MeshHandle mesh, const Matrix4x4 &model)
+    {
+        const MeshLodInfo *lod_info = meshInfo(mesh);
+        if (!lod_info || lod_info->lod_count <= 1)
+            return 0;
+        const MeshLodInfo &info = *lod_info;
+
+        const float radius = info.bounding_radius * maxScale(model);
+        const float distance = glm::length(glm::vec3(model[3]) - view_->camera_position) - radius;
+        if (distance <= 0.0f)
+        {
+            lod_state_[entity] = 0;
+            return 0;
+        }
+
+        // LOD k의 화면상 오차 = relative_error[k] * 투영된 반지름(px)
+        const float projected_radius = radius * view_->pixels_per_unit / distance;
+        const float coarsen_limit = kLodPixelError * (1.0f - kLodHysteresis);
+        const float refine_limit = kLodPixelError * (1.0f + kLodHysteresis);
+
+        uint8_t lod = std::min<uint8_t>(lod_state_[entity], info.lod_count - 1);
+        while (lod + 1 < info.lod_count && info.relative_error[lod + 1] * projected_radius <= coarsen_limit)
+            ++lod;
+        while (lod > 0 && info.relative_error[lod] * projected_radius > refine_limit)
+            --lod;
+
+        lod_state_[entity] = lod;
+        return lod;
+    }
+
+    ShaderVariant selectVariant(MaterialHandle material) const
+    {
+        const std::vector<ShaderVariant> *table = view_->material_variants;
+        if (!table || material >= table->size())
+            return 0;
+        return (*table)[material];
+    }
+
+    void extractRange(const ComponentArray<RenderableComponent> &renderables,
+                      const ComponentArray<TransformComponent> &transforms,
+                      std::size_t begin,
+                      std::size_t end,
+                      RenderQueue &out,
+                      CullStats &stats)
+    {
+        const auto &entities = renderables.denseEntities();
+        const auto &data = renderables.raw();
+        for (std::size_t index = begin; index < end; ++index)
+        {
+            const TransformComponent *transform = transforms.tryGetData(entities[index]);
+            if (!transform)
+                continue;
+
+            const RenderableComponent &renderable = data[index];
+            RenderItem item{};
+            item.mesh_handle = static_cast<MeshHandle>(renderable.mesh_id);
+            item.material_handle = static_cast<MaterialHandle>(renderable.material_id);
+            item.model = transform->getTransform();
+            item.flags = static_cast<uint8_t>((renderable.is_static ? RenderItemFlag::Static : 0u) |
+                                              (renderable.casts_shadow ? RenderItemFlag::CastsShadow : 0u));
+            if (!isVisible(item.mesh_handle, item.model, stats))
+            {
+                if (!renderable.casts_shadow || !view_->shadow_casters ||
+                    !inShadowBounds(item.mesh_handle, item.model))
+                {
+                    // 큐에서 빠져도 static caster 집합에는 넣어야 카메라 이동만으로 shadow 캐시가 무효화되지 않는다
+                    if (renderable.casts_shadow && renderable.is_static)
+                        out.noteStaticCaster(item.mesh_handle, item.model);
+                    continue;
+                }
+                item.flags |= RenderItemFlag::Hidden;
+            }
+            item.lod = selectLod(entities[index], item.mesh_handle, item.model);
+            item.shader_variant = selectVariant(item.material_handle);
+            item.pass = RenderPass::Opaque;
+            item.entity = entities[index];
+
+            // opaque for now; if transparent flag added, compute distance and call addTransparent
+            out.addOpaque(std::move(item));
+        }
+    }
+
+    // 컬링이 꺼져 있거나 메시 bounds를 모르면 보이는 것으로 본다
+    bool isVisible(MeshHandle mesh, const Matrix4x4 &model, CullStats &stats) const
+    {
+        if (!view_->frustum_culling)
+            return true;
+        const MeshLodInfo *info = meshInfo(mesh);
+        if (!info || info->bounding_radius <= 0.0f)
+            return true;
+
+        ++stats.tested;
+        if (!inFrustum(*info, model))
+        {
+            ++stats.frustum_culled;
+            return false;
+        }
+        if (view_->occlusion && !view_->occlusion->isVisible(model, info->aabb_min, info->aabb_max))
+        {
+            ++stats.occlusion_culled;
+            return false;
+        }
+        return true;
+    }
+
+    // bounding sphere가 카메라를 지나는 빛 축 원기둥(RenderView::shadow_radius/shadow_depth)과 겹치면 true.
+    // 모든 cascade의 캐스터 영역이 이 원기둥 안에 있다. 메시 bounds를 모르면 남긴다
+    bool inShadowBounds(MeshHandle mesh, const Matrix4x4 &model) const
+    {
+        const MeshLodInfo *info = meshInfo(mesh);
+        if (!info || info->bounding_radius <= 0.0f)
+            return true;
+
+        const float radius = info->bounding_radius * maxScale(model);
+        const glm::vec3 offset = glm::vec3(model[3]) - view_->camera_position;
+        const float along = glm::dot(offset, view_->light_direction);
+        if (std::abs(along) > view_->shadow_depth + radius)
+            return false;
+        return glm::length(offset - view_->light_direction * along) <= view_->shadow_radius + radius;
+    }
+
+    // 세그먼트 순서대로 이어 붙인다. 각 세그먼트의 복사는 병렬로 수행
+    void mergeSegments(RenderBucket &dst,
+                       RenderBucket RenderQueue::*bucket,
+                       std::size_t segment_count,
+                       ThreadPool &pool)
+    {
+        offsets_.resize(segment_count + 1);
+        offsets_[0] = 0;
+        for (std::size_t segment = 0; segment < segment_count; ++segment)
+            offsets_[segment + 1] = offsets_[segment] + (segments_[segment].*bucket).size();
+
+        const std::size_t total = offsets_[segment_count];
+        if (total == 0)
+            return;
+
+        dst.items.resize(total);
+        dst.order.resize(total);
+        pool.parallelFor(segment_count, [&](std::size_t segment)
+                         {
+            const RenderBucket &src = segments_[segment].*bucket;
+            const std::size_t base = offsets_[segment];
+            std::copy(src.items.begin(), src.items.end(), dst.items.begin() + static_cast<std::ptrdiff_t>(base));
+            for (std::size_t i = 0; i < src.order.size(); ++i)
+            {
+                SortKeyIndex entry = src.order[i];
+                entry.index += static_cast<uint32_t>(base);
+                dst.order[base + i] = entry;
+            } });
+    }
+
+    // 프레임 간에 용량을 재사용하는 워커별 세그먼트
+    std::vector<RenderQueue> segments_;
+    std::vector<CullStats> segment_stats_;
+    std::vector<std::size_t> offsets_;
+    std::vector<OccluderCandidate> occluder_candidates_;
+    std::array<glm::vec4, 6> frustum_planes_{};
+    CullStats cull_stats_;
+    // entity id별 직전 프레임 LOD
+    std::vector<uint8_t> lod_state_;
+    const RenderView *view_ = nullptr;
 };
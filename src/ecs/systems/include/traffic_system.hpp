@@ -0,0 +1,110 @@
+#pragma once
+
+#include "component.hpp"
+#include "profiler.hpp"
+#include "thread_pool.hpp"
+#include "traffic_model.hpp"
+#include "world.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <span>
+#include <vector>
+
+// TrafficModel을 고정 주기로 돌리고 결과를 차량 entity의 TransformComponent에 쓴다.
+// 렌더 프레임은 직전 스텝과 현재 스텝의 offset 사이를 보간한다
+class TrafficSystem
+{
+public:
+    explicit TrafficSystem(const LaneGraph &graph, float step_hz = 20.0f, const IdmParams &params = {})
+        : graph_(graph),
+          model_(graph, params),
+          step_dt_(1.0f / std::max(step_hz, 1.0f))
+    {
+    }
+
+    // parts[0]이 차체이고 나머지(지붕 등)는 지금 높이를 유지한 채 차체와 같이 움직인다
+    std::uint32_t addVehicle(World &world, std::span<const entity_id> parts, lane_id lane, float offset, float desired_speed)
+    {
+        for (const entity_id part : parts)
+        {
+            auto transform = world.getComponent<TransformComponent>(part);
+            part_entities_.push_back(part);
+            part_heights_.push_back(transform ? transform->get().position.y : 0.0f);
+        }
+        part_offsets_.push_back(static_cast<std::uint32_t>(part_entities_.size()));
+        return model_.addAgent(lane, offset, desired_speed);
+    }
+
+    void update(World &world, float delta_time, ThreadPool &pool = ThreadPool::instance())
+    {
+        if (model_.agentCount() == 0)
+            return;
+
+        // 멈췄다 돌아온 프레임이 스텝을 몰아서 돌리지 않게 한 번에 따라잡는 양을 제한한다
+        accumulator_ = std::min(accumulator_ + delta_time, step_dt_ * kMaxStepsPerUpdate);
+        steps_last_update_ = 0;
+        while (accumulator_ >= step_dt_)
+        {
+            model_.step(step_dt_, pool);
+            accumulator_ -= step_dt_;
+            ++steps_last_update_;
+        }
+        writeTransforms(world, accumulator_ / step_dt_, pool);
+    }
+
+    const TrafficModel &model() const { return model_; }
+    std::size_t stepsLastUpdate() const { return steps_last_update_; }
+
+private:
+    static constexpr float kMaxStepsPerUpdate = 4.0f;
+    static constexpr std::size_t kMinAgentsPerTask = 2048;
+
+    void writeTransforms(World &world, float alpha, ThreadPool &pool)
+    {
+        PROFILE_SCOPE("TrafficSystem::writeTransforms");
+        ComponentArray<TransformComponent> *transforms = world.getPool<TransformComponent>();
+        if (!transforms)
+            return;
+
+        const std::vector<lane_id> &lanes = model_.lanes();
+        const std::vector<float> &offsets = model_.offsets();
+        const std::vector<float> &previous = model_.previousOffsets();
+        pool.parallelForRange(model_.agentCount(), kMinAgentsPerTask, [&](std::size_t begin, std::size_t end)
+                              {
+            for (std::size_t agent = begin; agent < end; ++agent)
+            {
+                const lane_id lane = lanes[agent];
+                const float offset = previous[agent] + (offsets[agent] - previous[agent]) * alpha;
+                // 스텝 사이에 차로를 옮긴 차는 새 차로 시작점 뒤로 연장한 선 위에 둔다
+                const glm::vec3 direction = graph_.directionAt(lane, std::max(offset, 0.0f));
+                const glm::vec3 position = offset < 0.0f ? graph_.laneStart(lane) + direction * offset
+                                                         : graph_.pointAt(lane, offset);
+                const glm::quat rotation = glm::angleAxis(std::atan2(direction.x, direction.z), glm::vec3(0.0f, 1.0f, 0.0f));
+
+                for (std::uint32_t part = part_offsets_[agent]; part < part_offsets_[agent + 1]; ++part)
+                {
+                    if (TransformComponent *transform = transforms->tryGetData(part_entities_[part]))
+                    {
+                        transform->position = glm::vec3(position.x, part_heights_[part], position.z);
+                        transform->rotation = rotation;
+                    }
+                }
+            } });
+    }
+
+    const LaneGraph &graph_;
+    TrafficModel model_;
+    float step_dt_;
+    float accumulator_ = 0.0f;
+    std::size_t steps_last_update_ = 0;
+
+    // 에이전트 i의 entity는 part_entities_[part_offsets_[i] .. part_offsets_[i + 1])
+    std::vector<std::uint32_t> part_offsets_{0};
+    std::vector<entity_id> part_entities_;
+    std::vector<float> part_heights_;
+};
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "frame_allocator.hpp"
+#include "gl_includes.hpp"
+#include "pixel_readback.hpp"
+#include "render_data.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+class Renderer;
+
+// 카메라 센서 한 장을 찍는 데 필요한 것. 메인 스레드가 FramePacket::camera_sensors에 채운다
+struct CameraSensorView
+{
+    explicit CameraSensorView(LinearArena *arena = nullptr)
+        : queue(arena)
+    {
+    }
+
+    std::uint32_t sensor = 0;   // 센서를 단 entity
+    std::uint64_t sequence = 0; // 이 센서의 몇 번째 촬영인지 (1부터)
+    int width = 1;
+    int height = 1;
+    float near_plane = 0.1f;
+    float far_plane = 100.0f;
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    RenderQueue queue;
+};
+
+// readback이 끝난 센서 이미지. 행은 아래에서 위로 (glReadPixels 순서)
+struct CameraImage
+{
+    std::uint32_t sensor = 0;
+    std::uint64_t sequence = 0;
+    int width = 0;
+    int height = 0;
+    float near_plane = 0.1f;
+    float far_plane = 100.0f;
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    std::vector<std::uint8_t> color;   // RGBA8
+    std::vector<float> depth;          // [0, 1] depth buffer 값. linearDepth로 거리로 바꾼다
+    std::vector<std::uint32_t> entity; // 픽셀을 덮은 entity. 배경은 kNoRenderEntity
+
+    // 카메라 앞 방향 거리. 배경(depth 1)이면 far_plane
+    float linearDepth(std::size_t pixel) const
+    {
+        const float ndc = depth[pixel] * 2.0f - 1.0f;
+        return 2.0f * near_plane * far_plane / (far_plane + near_plane - ndc * (far_plane - near_plane));
+    }
+};
+
+// ThreadPool 워커에서 불린다. image는 콜백이 돌아오면 다시 쓰이므로 남길 것은 복사한다
+using CameraImageConsumer = std::function<void(const CameraImage &)>;
+
+struct CameraSensorStats
+{
+    std::size_t sensors = 0;         // GPU target이 있는 센서 수
+    std::uint64_t rendered = 0;      // 누적 촬영 수
+    std::uint64_t delivered = 0;     // consumer에 넘긴 이미지 수
+    std::uint64_t dropped = 0;       // readback 칸이나 이미지 버퍼가 모자라 버린 수
+    std::size_t pending_readbacks = 0;
+};
+
+// 렌더 스레드 전용. 센서마다 color/entity id/depth FBO와 PixelReadback 칸을 두고,
+// 끝난 readback을 재사용하는 CameraImage로 옮긴 뒤 ThreadPool 워커에서 consumer에 넘긴다.
+// 렌더 스레드는 fence가 이미 끝난 버퍼만 map하므로 glReadPixels 때문에 멈추지 않는다
+class CameraSensorRenderer
+{
+public:
+    // readback 칸 수. 촬영 간격이 짧아도 GPU가 2프레임 뒤처질 때까지는 버리지 않는다
+    static constexpr std::size_t kReadbackSlots = 3;
+    // consumer가 느려 밀린 이미지가 이만큼이면 새 이미지를 버린다
+    static constexpr std::size_t kMaxImagesInFlight = 16;
+    // 이만큼 촬영이 없던 센서의 GPU target은 해제한다
+    static constexpr std::uint64_t kIdleFramesBeforeRelease = 240;
+
+    CameraSensorRenderer();
+    // release()를 먼저 불러 GL 객체를 지워야 한다
+    ~CameraSensorRenderer();
+
+    CameraSensorRenderer(const CameraSensorRenderer &) = delete;
+    CameraSensorRenderer &operator=(const CameraSensorRenderer &) = delete;
+
+    // 아무 스레드에서나 호출할 수 있다. 다음 이미지부터 적용된다
+    void addConsumer(CameraImageConsumer consumer);
+
+    // view를 센서 target에 그리고 consumer가 있으면 readback을 건다. Renderer::draw 뒤에 호출
+    void render(Renderer &renderer, const CameraSensorView &view);
+    // 끝난 readback을 consumer에 넘기고 오래 쓰지 않은 target을 정리한다. 프레임마다 한 번
+    void collect();
+    // context가 current인 상태에서 모든 GL 객체를 지운다
+    void release();
+
+    // 렌더 스레드에서 호출
+    CameraSensorStats stats() const;
+
+private:
+    // readback이 끝날 때까지 들고 있는 촬영 정보
+    struct Shot
+    {
+        std::uint64_t sequence = 0;
+        float near_plane = 0.1f;
+        float far_plane = 100.0f;
+        glm::mat4 view{1.0f};
+        glm::mat4 projection{1.0f};
+    };
+
+    struct Target
+    {
+        std::uint32_t sensor = 0;
+        int width = 0;
+        int height = 0;
+        GLuint framebuffer = 0;
+        GLuint color = 0;
+        GLuint entity = 0;
+        GLuint depth = 0;
+        std::unique_ptr<PixelReadback> readback;
+        std::uint64_t last_used_frame = 0;
+        // FBO를 만들 수 없던 해상도. 같은 해상도로는 다시 시도하지 않는다
+        bool failed = false;
+        // readback 요청 순서대로 쌓인다. poll도 같은 순서로 끝난다
+        std::vector<Shot> shots;
+    };
+
+    // 워커와 렌더 스레드가 함께 쓰므로 shared_ptr로 잡아 렌더러가 먼저 사라져도 안전하게 한다
+    struct ImagePool
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<CameraImage>> storage;
+        std::vector<CameraImage *> free;
+        std::shared_ptr<const std::vector<CameraImageConsumer>> consumers =
+            std::make_shared<const std::vector<CameraImageConsumer>>();
+    };
+
+    Target *findTarget(std::uint32_t sensor);
+    bool createTarget(Target &target, int width, int height);
+    void destroyTarget(Target &target);
+    void deliver(const Target &target, const Shot &shot, std::span<const std::byte> data);
+    bool hasConsumers() const;
+    CameraImage *acquireImage();
+
+    std::vector<Target> targets_;
+    std::shared_ptr<ImagePool> images_;
+    std::uint64_t frame_ = 0;
+    std::uint64_t rendered_ = 0;
+    std::uint64_t delivered_ = 0;
+    std::uint64_t dropped_images_ = 0;
+};
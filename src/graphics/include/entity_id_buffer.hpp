@@ -0,0 +1,118 @@
+#pragma once
+
+#include "gl_includes.hpp"
+#include "pixel_readback.hpp"
+#include "render_data.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// 화면 entity id 버퍼에서 읽을 영역. framebuffer 픽셀 단위, 왼쪽 아래 원점 (glReadPixels 좌표)
+struct EntityPickQuery
+{
+    std::uint64_t id = 0; // 결과에 그대로 돌려준다
+    int x = 0;
+    int y = 0;
+    int width = 1;
+    int height = 1;
+};
+
+struct EntityPickResult
+{
+    std::uint64_t id = 0;
+    // false면 버퍼가 없거나 readback이 버려져 읽지 못했다
+    bool ok = false;
+    // 영역 가운데 픽셀의 entity. 배경이면 kNoRenderEntity
+    std::uint32_t center = kNoRenderEntity;
+    // EntityPickResults::entities 안의 구간. 영역에 보인 entity가 중복 없이 오름차순으로 있다 (배경 제외)
+    std::size_t first = 0;
+    std::size_t count = 0;
+};
+
+// 스레드 사이로 넘기는 결과 묶음. 다 쓴 묶음을 clear해서 다시 넘기면 벡터 용량이 재사용된다
+struct EntityPickResults
+{
+    std::vector<EntityPickResult> results;
+    std::vector<std::uint32_t> entities;
+
+    void clear()
+    {
+        results.clear();
+        entities.clear();
+    }
+
+    std::span<const std::uint32_t> entitiesOf(const EntityPickResult &result) const
+    {
+        return std::span<const std::uint32_t>(entities).subspan(result.first, result.count);
+    }
+
+    // other의 결과를 뒤에 붙인다
+    void append(const EntityPickResults &other)
+    {
+        const std::size_t base = entities.size();
+        entities.insert(entities.end(), other.entities.begin(), other.entities.end());
+        for (EntityPickResult result : other.results)
+        {
+            result.first += base;
+            results.push_back(result);
+        }
+    }
+};
+
+// Renderer 전용. 화면 pass를 color(RGBA8) + entity id(R32UI) + depth FBO에 그리게 하고,
+// 그린 color는 화면 framebuffer로 blit한다. 셰이더가 픽셀마다 entity id를 쓰므로 피킹은
+// 작은 영역을 PixelReadback으로 읽는 것뿐이고 CPU는 entity 수와 상관없이 GPU를 기다리지 않는다
+class EntityIdBuffer
+{
+public:
+    // hover 한 칸 + 클릭/드래그 몇 개가 겹쳐도 버리지 않을 만큼
+    static constexpr std::size_t kReadbackSlots = 8;
+
+    // context가 current인 상태에서 생성/소멸
+    EntityIdBuffer();
+    ~EntityIdBuffer();
+
+    EntityIdBuffer(const EntityIdBuffer &) = delete;
+    EntityIdBuffer &operator=(const EntityIdBuffer &) = delete;
+
+    // 크기가 바뀌면 FBO를 다시 만든다. 진행 중인 readback은 PBO에 있으므로 그대로 끝난다
+    bool resize(int width, int height);
+    // FBO를 지운다. 이후 요청은 ok=false로 끝난다
+    void release();
+    bool valid() const { return framebuffer_ != 0; }
+    GLuint framebuffer() const { return framebuffer_; }
+
+    // FBO에 그린 color를 화면 framebuffer(0)로 복사하고 0을 다시 묶는다
+    void resolveToScreen();
+
+    // 마지막으로 그린 id의 query 영역을 읽기 시작한다. 영역은 버퍼 안으로 잘린다
+    void request(const EntityPickQuery &query);
+    // 끝난 요청의 결과를 요청 순서대로 out에 붙인다. 프레임마다 swap 뒤에 한 번
+    void collect(EntityPickResults &out);
+
+    std::size_t pending() const { return queries_.size(); }
+
+private:
+    struct Pending
+    {
+        EntityPickQuery query; // 잘린 영역
+        bool ok = false;       // readback을 걸었다
+    };
+
+    static void finish(const Pending &pending, std::span<const std::uint32_t> ids, EntityPickResults &out);
+    static void fail(const Pending &pending, EntityPickResults &out);
+
+    int width_ = 0;
+    int height_ = 0;
+    GLuint framebuffer_ = 0;
+    GLuint color_ = 0;
+    GLuint entity_ = 0;
+    GLuint depth_ = 0;
+    // 같은 크기로 매 프레임 다시 만들지 않는다
+    bool failed_ = false;
+    PixelReadback readback_{kReadbackSlots};
+    // 요청 순서대로. readback도 같은 순서로 끝난다
+    std::vector<Pending> queries_;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+// 디버그 빌드(GRAPHICS_GL_DEBUG)에서만 KHR_debug 콜백을 등록한다.
+// 릴리스 빌드에서는 아무것도 하지 않으므로 draw 경로에서 glGetError로 파이프라인을 동기화하지 않는다.
+namespace GlDebug
+{
+// GLFW window hint 설정 (glfwCreateWindow 이전에 호출)
+void applyContextHints();
+// context가 current인 상태에서 호출. 콜백 등록 여부를 반환
+bool installMessageCallback();
+} // namespace GlDebug
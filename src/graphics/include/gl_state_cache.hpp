@@ -0,0 +1,99 @@
+#pragma once
+
+#include "gl_includes.hpp"
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+struct GlStateStats
+{
+    std::uint64_t issued = 0;
+    std::uint64_t skipped = 0;
+
+    void reset()
+    {
+        issued = 0;
+        skipped = 0;
+    }
+};
+
+// Renderer가 내보내는 GL 상태 변경을 모두 이 캐시를 통해 호출하고, 이미 설정된 값이면 호출을 생략한다.
+// 캐시 밖에서 GL 상태를 바꿨다면 invalidate()로 캐시를 비워야 한다.
+class GlStateCache
+{
+public:
+    void useProgram(GLuint program);
+    void bindVertexArray(GLuint vao);
+    void bindBuffer(GLenum target, GLuint buffer);
+    // GL_UNIFORM_BUFFER indexed binding. generic binding도 함께 바뀐다
+    void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+    void bindTexture(GLuint unit, GLenum target, GLuint texture);
+
+    // 현재 사용중인 program 기준으로 uniform 값을 캐싱
+    void setUniform(GLint location, int value);
+    void setUniform(GLint location, float value);
+    void setUniform(GLint location, const glm::vec3 &value);
+    void setUniform(GLint location, const glm::vec4 &value);
+    void setUniform(GLint location, const glm::mat4 &value);
+
+    void invalidate();
+    void forgetProgram(GLuint program);
+
+    const GlStateStats &stats() const { return stats_; }
+    void resetStats() { stats_.reset(); }
+
+private:
+    static constexpr GLuint kUnknown = 0xFFFFFFFFu;
+    static constexpr std::size_t kMaxTextureUnits = 16;
+    static constexpr std::size_t kMaxUniformFloats = 16;
+    static constexpr std::size_t kMaxUniformBindings = 8;
+
+    enum class UniformType : std::uint8_t
+    {
+        None = 0,
+        Int,
+        Float,
+        Vec3,
+        Vec4,
+        Mat4,
+    };
+
+    struct UniformSlot
+    {
+        UniformType type = UniformType::None;
+        float data[kMaxUniformFloats]{}; // Int는 비트 패턴을 그대로 담는다
+    };
+
+    struct TextureBinding
+    {
+        GLenum target = 0;
+        GLuint texture = kUnknown;
+    };
+
+    bool updateUniform(GLint location, UniformType type, const float *data, std::size_t count);
+    GLuint *bufferSlot(GLenum target);
+    bool track(bool changed)
+    {
+        if (changed)
+            ++stats_.issued;
+        else
+            ++stats_.skipped;
+        return changed;
+    }
+
+    GLuint program_ = kUnknown;
+    GLuint vao_ = kUnknown;
+    GLuint array_buffer_ = kUnknown;
+    GLuint element_buffer_ = kUnknown;
+    GLuint uniform_buffer_ = kUnknown;
+    GLuint draw_indirect_buffer_ = kUnknown;
+    GLuint active_texture_unit_ = kUnknown;
+    std::array<TextureBinding, kMaxTextureUnits> textures_{};
+    std::array<GLuint, kMaxUniformBindings> uniform_bindings_{};
+    std::unordered_map<GLuint, std::vector<UniformSlot>> uniforms_;
+    std::vector<UniformSlot> *program_uniforms_ = nullptr;
+
+    GlStateStats stats_;
+};
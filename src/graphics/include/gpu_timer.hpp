@@ -0,0 +1,47 @@
+#pragma once
+
+#include "gl_includes.hpp"
+#include <array>
+#include <cstdint>
+
+// GL_TIME_ELAPSED 쿼리로 렌더 패스별 GPU 시간을 재서 Profiler에 넘긴다.
+// 프레임마다 쿼리 세트를 돌려 쓰고, kFrameLatency 프레임 뒤 결과가 준비된 경우에만 읽으므로 절대 대기하지 않는다.
+// GL_TIME_ELAPSED는 중첩할 수 없으므로 begin/end 구간이 겹치면 안 된다
+class GpuTimer
+{
+public:
+    static constexpr std::size_t kFrameLatency = 3;
+    static constexpr std::size_t kMaxPasses = 8;
+
+    // context가 current인 상태에서 생성
+    GpuTimer();
+    ~GpuTimer();
+
+    GpuTimer(const GpuTimer &) = delete;
+    GpuTimer &operator=(const GpuTimer &) = delete;
+
+    // 가장 오래된 세트의 결과를 수거하고 이번 프레임 세트를 연다
+    void beginFrame();
+    // name은 리터럴처럼 계속 유효해야 한다. 한 프레임에 kMaxPasses를 넘으면 무시된다
+    void begin(const char *name);
+    void end();
+
+    // 결과가 늦어 버린 세트 수
+    std::uint64_t droppedFrames() const { return dropped_frames_; }
+
+private:
+    struct FrameQueries
+    {
+        std::array<GLuint, kMaxPasses> queries{};
+        std::array<const char *, kMaxPasses> names{};
+        std::array<std::int64_t, kMaxPasses> cpu_start_ns{};
+        std::size_t count = 0;
+    };
+
+    void collect(FrameQueries &frame);
+
+    std::array<FrameQueries, kFrameLatency> frames_{};
+    std::size_t frame_index_ = 0;
+    bool active_ = false;
+    std::uint64_t dropped_frames_ = 0;
+};
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "gl_includes.hpp"
+#include "gl_state_cache.hpp"
+#include "render_data.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// use_grid / lit / albedo_layer는 셰이더 variant를 정한다 (MaterialTable::variantOf)
+struct Material
+{
+    glm::vec3 base_color{1.0f, 0.5f, 0.2f};
+    bool use_grid = false;
+    bool lit = true;
+    glm::vec3 grid_line_color{0.9f};
+    float grid_line_width = 0.01f;
+    // MaterialTable::addTexture가 돌려준 layer. -1이면 텍스처 없음
+    int albedo_layer = -1;
+};
+
+// 등록된 모든 Material의 파라미터를 std140 uniform buffer 하나에 담는다.
+// 인스턴스는 material handle만 들고 셰이더가 배열에서 꺼내 쓰므로, material이 달라도 draw를 나누지 않는다
+class MaterialTable
+{
+public:
+    // shader_fragment의 MAX_MATERIALS / binding과 맞춘다. 48 bytes * 256 = 12KB (최소 보장 16KB 이내)
+    static constexpr std::size_t kMaxMaterials = 256;
+    static constexpr GLuint kBindingPoint = 0;
+    static constexpr MaterialHandle kDefaultMaterial = 0;
+    static constexpr MaterialHandle kInvalidMaterial = 0xFFFFFFFFu;
+    // albedo 텍스처는 모두 같은 크기의 2D array 한 장에 layer로 담아 material마다 바인딩을 바꾸지 않는다
+    static constexpr int kTextureSize = 256;
+    static constexpr int kMaxTextureLayers = 16;
+    static constexpr GLuint kTextureUnit = 0;
+
+    // context가 current인 상태에서 생성. kDefaultMaterial을 미리 등록한다
+    MaterialTable();
+    ~MaterialTable();
+
+    MaterialTable(const MaterialTable &) = delete;
+    MaterialTable &operator=(const MaterialTable &) = delete;
+
+    // 가득 차면 kInvalidMaterial
+    MaterialHandle add(const Material &material);
+    void update(MaterialHandle handle, const Material &material);
+    const Material &get(MaterialHandle handle) const { return materials_[handle]; }
+    std::size_t size() const { return materials_.size(); }
+    // 범위를 벗어난 handle은 기본 material로 그린다
+    MaterialHandle resolve(MaterialHandle handle) const { return handle < materials_.size() ? handle : kDefaultMaterial; }
+    // handle로 인덱싱되는 variant 표. RenderView::material_variants로 넘긴다
+    const std::vector<ShaderVariant> &variants() const { return variants_; }
+    static ShaderVariant variantOf(const Material &material);
+
+    // kTextureSize x kTextureSize RGBA8 픽셀을 새 layer에 올린다. 크기가 다르거나 가득 차면 -1
+    int addTexture(const std::uint8_t *rgba, int width, int height);
+
+    // 바뀐 구간만 올리고 binding point에 연결한다. 텍스처가 있으면 kTextureUnit에 묶는다. draw 전에 호출
+    void bind(GlStateCache &state_cache);
+    // program의 Materials 블록을 kBindingPoint에 연결한다 (GLSL 330에는 layout(binding)이 없음)
+    static void attachProgram(GLuint program);
+
+private:
+    // std140: vec4 3개
+    struct GpuMaterial
+    {
+        glm::vec4 base_color;
+        glm::vec4 grid;   // rgb = line color, a = line width
+        glm::vec4 params; // x = albedo layer
+    };
+    static_assert(sizeof(GpuMaterial) == 48, "GpuMaterial must match the std140 MaterialData layout");
+
+    static GpuMaterial toGpu(const Material &material);
+    void markDirty(std::size_t index);
+
+    GLuint buffer_ = 0;
+    std::vector<Material> materials_;
+    std::vector<GpuMaterial> gpu_materials_;
+    std::vector<ShaderVariant> variants_;
+    GLuint texture_array_ = 0;
+    int texture_layers_ = 0;
+    std::size_t dirty_begin_ = 0;
+    std::size_t dirty_end_ = 0;
+};
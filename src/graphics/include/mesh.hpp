@@ -1,8 +1,12 @@
 #pragma once
 
 #include "gl_includes.hpp"
+#include "mesh_arena.hpp"
+#include "render_data.hpp"
+#include <array>
 #include <cstddef>
 #include <glm/glm.hpp>
+#include <memory>
 #include <vector>
 
 struct Vertex
@@ -12,17 +16,80 @@ struct Vertex
     glm::vec2 texture_coordinates;
 };
 
+// LOD 한 단계. 인덱스는 LOD0과 같은 정점 배열을 가리킨다
+struct MeshLodData
+{
+    std::vector<unsigned int> indices;
+    float error = 0.0f; // 원본 대비 최대 기하 오차 (메시 로컬 거리)
+};
+
+// GPU 업로드 전 CPU 측 geometry. lods는 LOD1부터 (MeshSimplify::generateLods)
+struct MeshData
+{
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<MeshLodData> lods;
+};
+
+// 인코딩된 index 버퍼 안에서 LOD 한 단계가 차지하는 구간 (index 단위)
+struct MeshLodRange
+{
+    GLuint index_offset = 0;
+    GLuint index_count = 0;
+};
+
+struct MeshUploadOptions
+{
+    VertexFormat format = VertexFormat::Packed;
+    bool keep_cpu_copy = false;
+    // MeshData.lods가 비어있으면 업로드 전에 QEM으로 LOD를 만든다.
+    // MeshData로 등록하면 호출한 스레드에서 돌므로 그 overload의 기본값은 끈다
+    bool generate_lods = true;
+};
+
+// arena에 그대로 복사할 수 있게 인코딩된 버퍼. GL 호출이 없으므로 워커 스레드에서 만들 수 있다
+struct EncodedMesh
+{
+    VertexFormat format = VertexFormat::Packed;
+    std::vector<std::byte> vertex_bytes;
+    std::size_t vertex_count = 0;
+    std::vector<std::byte> index_bytes;
+    std::size_t index_count = 0;
+    GLenum index_type = GL_UNSIGNED_INT;
+    // 모든 LOD의 인덱스를 이어 붙여 index_bytes 하나에 담는다
+    std::array<MeshLodRange, kMaxMeshLods> lods{};
+    MeshLodInfo lod_info{};
+};
+
+// 정점을 format으로 인코딩하고, 정점이 65536개 이하이면 인덱스를 16비트로 줄인다.
+// kMaxMeshLods를 넘는 LOD는 버린다
+EncodedMesh encodeMesh(const MeshData &data, VertexFormat format);
+
+// MeshArena 안의 구간 하나. 정점은 arena의 layout으로 인코딩되고, 정점이 65536개 이하이면
+// 인덱스는 GL_UNSIGNED_SHORT로 저장된다. CPU 사본은 keep_cpu_copy일 때만 유지한다
 class Mesh
 {
 public:
-    Mesh(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices);
+    Mesh(MeshArena &arena, const MeshData &data, bool keep_cpu_copy = false);
+    // encoded.format은 arena의 layout과 같아야 한다
+    Mesh(MeshArena &arena, const EncodedMesh &encoded, std::unique_ptr<MeshData> cpu_copy = nullptr);
     ~Mesh();
 
-    GLuint getVAO() const { return vao_; }
-    size_t getIndexCount() const { return indices_.size(); }
+    Mesh(const Mesh &) = delete;
+    Mesh &operator=(const Mesh &) = delete;
+
+    // lod는 getLodCount() - 1로 잘린다
+    MeshRange getRange(std::size_t lod = 0) const;
+    const MeshArena &getArena() const { return *arena_; }
+    size_t getIndexCount() const { return lods_[0].index_count; }
+    std::size_t getLodCount() const { return lod_info_.lod_count; }
+    const MeshLodInfo &getLodInfo() const { return lod_info_; }
+    const MeshData *getCpuData() const { return cpu_data_.get(); }
 
 private:
-    std::vector<Vertex> vertices_;
-    std::vector<unsigned int> indices_;
-    GLuint vao_, vbo_, ebo_ = 0;
-};
\ No newline at end of file
+    MeshArena *arena_ = nullptr;
+    MeshArena::Handle handle_ = MeshArena::kInvalidHandle;
+    std::array<MeshLodRange, kMaxMeshLods> lods_{};
+    MeshLodInfo lod_info_{};
+    std::unique_ptr<MeshData> cpu_data_;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "gl_includes.hpp"
+#include "vertex_layout.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+// arena 안에서 메시 하나가 차지하는 구간. 인덱스는 메시 로컬(base_vertex 기준)로 저장되고,
+// first_index는 index_type 단위다
+struct MeshRange
+{
+    GLint base_vertex = 0;
+    GLuint vertex_count = 0;
+    GLuint first_index = 0;
+    GLuint index_count = 0;
+    GLenum index_type = GL_UNSIGNED_INT;
+};
+
+// 같은 vertex layout을 쓰는 모든 메시가 공유하는 vertex buffer / index buffer 한 쌍과 VAO.
+// 구간 할당/해제는 first-fit free list로 하고, 공간이 모자라면 버퍼를 키운다.
+// index buffer는 4바이트 word 단위로 관리해 16/32비트 인덱스를 섞어 담는다.
+// compact()는 살아있는 구간을 앞으로 모아 단편화를 없앤다 (핸들은 그대로 유효).
+class MeshArena
+{
+public:
+    using Handle = std::uint32_t;
+    static constexpr Handle kInvalidHandle = 0xFFFFFFFFu;
+
+    MeshArena(const VertexLayout &layout, std::size_t vertex_capacity, std::size_t index_word_capacity);
+    ~MeshArena();
+
+    MeshArena(const MeshArena &) = delete;
+    MeshArena &operator=(const MeshArena &) = delete;
+
+    // vertex_data는 layout().stride 단위로 인코딩된 바이트, index_type은 GL_UNSIGNED_SHORT 또는 GL_UNSIGNED_INT
+    Handle allocate(const void *vertex_data,
+                    std::size_t vertex_count,
+                    const void *index_data,
+                    std::size_t index_count,
+                    GLenum index_type);
+    void free(Handle handle);
+    void compact();
+
+    const MeshRange &range(Handle handle) const { return slots_[handle].range; }
+    GLuint vao() const { return vao_; }
+    const VertexLayout &layout() const { return layout_; }
+
+    std::size_t vertexCapacity() const { return vertex_capacity_; }
+    std::size_t vertexBytes() const { return vertex_capacity_ * static_cast<std::size_t>(layout_.stride); }
+    std::size_t indexBytes() const { return index_capacity_ * kIndexWordSize; }
+    std::size_t liveVertexCount() const { return live_vertices_; }
+    std::size_t liveIndexBytes() const { return live_index_words_ * kIndexWordSize; }
+    // 0 = 단편화 없음, 1 = 빈 공간이 전부 잘게 쪼개져 있음
+    float fragmentation() const;
+
+private:
+    // [offset, offset + size) 형태의 빈 구간 목록. 인접 구간은 합친다
+    class FreeList
+    {
+    public:
+        void reset(std::size_t capacity);
+        bool allocate(std::size_t size, std::size_t &offset);
+        void release(std::size_t offset, std::size_t size);
+        void grow(std::size_t old_capacity, std::size_t new_capacity);
+        std::size_t largestBlock() const;
+        std::size_t totalFree() const;
+
+    private:
+        std::map<std::size_t, std::size_t> blocks_;
+    };
+
+    struct Slot
+    {
+        MeshRange range{};
+        std::size_t index_word_offset = 0;
+        std::size_t index_words = 0;
+        bool live = false;
+    };
+
+    static constexpr std::size_t kIndexWordSize = 4;
+
+    void createBuffers();
+    void setupVertexAttributes();
+    void growVertices(std::size_t required);
+    void growIndices(std::size_t required);
+
+    const VertexLayout &layout_;
+    GLuint vao_ = 0;
+    GLuint vbo_ = 0;
+    GLuint ebo_ = 0;
+    std::size_t vertex_capacity_ = 0;
+    std::size_t index_capacity_ = 0; // word 단위
+    std::size_t live_vertices_ = 0;
+    std::size_t live_index_words_ = 0;
+
+    FreeList vertex_free_;
+    FreeList index_free_;
+    std::vector<Slot> slots_;
+    std::vector<Handle> free_slots_;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "mesh.hpp"
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// 외부 geometry 파일을 MeshData로 읽는다. GL 호출이 없으므로 워커 스레드에서 호출해도 된다.
+// 실패하면 std::runtime_error를 던진다
+namespace MeshImport
+{
+// 확장자로 형식을 고른다 (.obj / .glb). 파일은 mmap으로 읽는다
+MeshData loadFile(const std::string &path);
+
+// v / vt / vn / f 만 해석한다. 다각형 면은 fan으로 삼각형화한다
+MeshData parseObj(std::string_view text);
+
+// glTF 2.0 binary. 기본 scene의 노드 transform을 적용해 모든 TRIANGLES primitive를 하나로 합친다
+MeshData parseGlb(const std::byte *data, std::size_t size);
+
+// 길이가 0인 법선을 인접 삼각형의 면적 가중 평균으로 채운다
+void fillMissingNormals(MeshData &data);
+} // namespace MeshImport
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "mesh.hpp"
+#include <cstddef>
+#include <vector>
+
+// quadric error metric 기반 메시 단순화. GL 호출이 없으므로 워커 스레드에서 호출해도 된다
+namespace MeshSimplify
+{
+// half-edge collapse로 indices를 target_index_count 이하로 줄인다. 다음 collapse의 오차가
+// max_error(거리)를 넘으면 그 전에 멈춘다. 결과 인덱스는 mesh.vertices를 그대로 가리키고,
+// out_error에는 누적된 최대 오차 추정치를 쓴다
+std::vector<unsigned int> simplify(const MeshData &mesh,
+                                   std::size_t target_index_count,
+                                   float max_error,
+                                   float *out_error = nullptr);
+
+// mesh.lods를 채운다. 단계마다 삼각형 수를 절반으로 줄이고, 충분히 줄지 않으면 멈춘다
+void generateLods(MeshData &mesh);
+} // namespace MeshSimplify
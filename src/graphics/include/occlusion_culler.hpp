@@ -0,0 +1,68 @@
+#pragma once
+
+#include "thread_pool.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// CPU 소프트웨어 occlusion culling. 큰 occluder(건물, 벽)의 AABB를 저해상도 depth buffer에
+// 타일 단위로 병렬 래스터화하고(SSE2 4픽셀 동시), 타일마다 max depth mip chain(HiZ)을 만든다.
+// 후보 AABB는 화면 사각형이 2x2 texel 이하가 되는 mip에서 가장 가까운 depth와 비교한다.
+// occluder는 AABB를 꽉 채운다고 가정하므로 상자 모양 물체에만 지정해야 한다. GL 호출은 없다
+class OcclusionCuller
+{
+public:
+    static constexpr int kWidth = 256;
+    static constexpr int kHeight = 128;
+    static constexpr int kTileSize = 32;
+    static constexpr int kTilesX = kWidth / kTileSize;
+    static constexpr int kTilesY = kHeight / kTileSize;
+    // 타일 하나가 마지막 mip에서 1 texel이 되도록 한다 (32 -> 1)
+    static constexpr int kMipCount = 6;
+
+    struct Stats
+    {
+        std::size_t occluders = 0;
+        std::size_t triangles = 0;
+    };
+
+    OcclusionCuller();
+
+    // depth buffer를 비우고 이번 프레임 view_projection을 정한다
+    void beginFrame(const glm::mat4 &view_projection);
+    // 로컬 AABB를 model로 변환한 상자를 occluder로 추가한다 (삼각형 12개)
+    void addOccluder(const glm::mat4 &model, const glm::vec3 &aabb_min, const glm::vec3 &aabb_max);
+    // 추가된 삼각형을 타일별로 래스터화하고 HiZ를 만든다
+    void finish(ThreadPool &pool);
+
+    // finish 이후 여러 스레드에서 동시에 호출해도 된다. 가려졌다고 확신할 때만 false
+    bool isVisible(const glm::mat4 &model, const glm::vec3 &aabb_min, const glm::vec3 &aabb_max) const;
+
+    const Stats &stats() const { return stats_; }
+    // mip 0 depth ([0, 1], 1이 far). 디버그 시각화용
+    const std::vector<float> &depthBuffer() const { return levels_[0]; }
+
+private:
+    // 화면 좌표(texel 단위)의 삼각형. z는 [0, 1] depth
+    struct ScreenTriangle
+    {
+        float x[3];
+        float y[3];
+        float z[3];
+    };
+
+    void addTriangle(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c);
+    void setupTriangle(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c);
+    void binTriangles();
+    void rasterizeTile(int tile);
+    void buildTileMips(int tile);
+
+    glm::mat4 view_projection_{1.0f};
+    std::vector<ScreenTriangle> triangles_;
+    std::array<std::vector<std::uint32_t>, kTilesX * kTilesY> bins_;
+    // level k는 (kWidth >> k) x (kHeight >> k)
+    std::array<std::vector<float>, kMipCount> levels_;
+    Stats stats_;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "gl_includes.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// glReadPixels를 pixel pack buffer(PBO)로 받아 CPU가 GPU를 기다리지 않게 한다.
+// request는 복사 명령과 fence만 넣고 돌아오고, poll은 fence가 이미 끝난 요청만 map해서 넘긴다.
+// 칸을 돌려 쓰므로 결과는 보통 1~2 프레임 뒤에 나온다. 빈 칸이 없으면 request는 버려지고 dropped로 센다.
+// 칸의 PBO는 요청 크기에 맞춰 늘고, 훨씬 작은 요청이 오면 다시 줄어든다.
+// GpuTimer처럼 context가 current인 스레드에서만 쓴다
+class PixelReadback
+{
+public:
+    // 한 요청 안에서 읽을 첨부 하나. 결과는 regions 순서대로 width * height * pixel_size 바이트씩 이어진다
+    struct Region
+    {
+        GLenum attachment = GL_COLOR_ATTACHMENT0; // GL_DEPTH_ATTACHMENT면 depth를 읽는다
+        GLenum format = GL_RGBA;
+        GLenum type = GL_UNSIGNED_BYTE;
+        std::size_t pixel_size = 4;
+    };
+
+    // context가 current인 상태에서 생성
+    explicit PixelReadback(std::size_t slot_count = 3);
+    ~PixelReadback();
+
+    PixelReadback(const PixelReadback &) = delete;
+    PixelReadback &operator=(const PixelReadback &) = delete;
+
+    // framebuffer의 (x, y, width, height) 영역을 복사하기 시작한다. tag는 poll에서 그대로 돌려준다
+    bool request(GLuint framebuffer, int x, int y, int width, int height, std::span<const Region> regions, std::uint64_t tag);
+
+    // 끝난 요청을 요청 순서대로 consume(tag, data)에 넘기고 그 수를 돌려준다. data는 consume이 돌아오면 무효
+    template <typename Consume>
+    std::size_t poll(Consume &&consume)
+    {
+        std::size_t count = 0;
+        std::uint64_t tag = 0;
+        std::span<const std::byte> data;
+        while (mapReady(tag, data))
+        {
+            consume(tag, data);
+            releaseOldest();
+            ++count;
+        }
+        return count;
+    }
+
+    std::size_t pending() const { return count_; }
+    std::uint64_t droppedRequests() const { return dropped_; }
+
+private:
+    struct Slot
+    {
+        GLuint buffer = 0;
+        std::size_t capacity = 0;
+        std::size_t size = 0;
+        GLsync fence = nullptr;
+        std::uint64_t tag = 0;
+    };
+
+    // 가장 오래된 요청이 끝났으면 map한다
+    bool mapReady(std::uint64_t &tag, std::span<const std::byte> &data);
+    void releaseOldest();
+
+    std::vector<Slot> slots_;
+    std::size_t head_ = 0;
+    std::size_t count_ = 0;
+    std::uint64_t dropped_ = 0;
+};
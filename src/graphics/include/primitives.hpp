@@ -1,11 +1,9 @@
 #pragma once
 
-#include <memory>
-
 #include "mesh.hpp"
 
 namespace Primitives
 {
-std::unique_ptr<Mesh> createCube();
-std::unique_ptr<Mesh> createPlane(float width, float height);
+MeshData createCube();
+MeshData createPlane(float width, float height);
 } // namespace Primitives
\ No newline at end of file
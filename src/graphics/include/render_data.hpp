@@ -1,6 +1,12 @@
 #pragma once
 
+#include "frame_allocator.hpp"
+#include "radix_sort.hpp"
+#include "thread_pool.hpp"
+
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <glm/glm.hpp>
 #include <utility>
@@ -9,6 +15,19 @@
 using Matrix4x4 = glm::mat4;
 using MeshHandle = uint32_t;
 using MaterialHandle = uint32_t;
+using ShaderVariant = uint8_t;
+
+// 셰이더 permutation 비트. 각 비트는 같은 이름의 #define(FEATURE_GRID 등)으로 따로 컴파일된다.
+// Grid/Lit/Textured는 material이 정하고, Instanced는 Renderer가 제출 방식에 따라 붙인다
+namespace ShaderFeature
+{
+constexpr ShaderVariant Grid = 1u << 0;
+constexpr ShaderVariant Lit = 1u << 1;
+constexpr ShaderVariant Textured = 1u << 2;
+constexpr ShaderVariant Instanced = 1u << 3;
+} // namespace ShaderFeature
+
+constexpr std::size_t kShaderVariantCount = 16;
 
 enum class MeshId : int
 {
@@ -16,12 +35,60 @@ enum class MeshId : int
     Plane = 1,
 };
 
-inline uint64_t makeOpaqueKey(MaterialHandle material_handle, MeshHandle mesh_handle)
+// LOD0 포함 메시 하나가 가질 수 있는 최대 LOD 단계 수
+constexpr std::size_t kMaxMeshLods = 4;
+
+class OcclusionCuller;
+
+// 메시별 LOD 선택 / 컬링 정보. Renderer가 채우고 RenderSystem이 읽는다
+struct MeshLodInfo
+{
+    float bounding_radius = 0.0f; // 메시 로컬 원점 기준. 0이면 정보 없음 (컬링하지 않음)
+    glm::vec3 aabb_min{0.0f};     // 메시 로컬 AABB
+    glm::vec3 aabb_max{0.0f};
+    uint8_t lod_count = 1;
+    // LOD k의 최대 기하 오차 / bounding_radius. LOD0은 0
+    std::array<float, kMaxMeshLods> relative_error{};
+};
+
+// 추출 단계에서 쓰는 카메라 정보
+struct RenderView
+{
+    glm::vec3 camera_position{0.0f};
+    // 거리 1에서 길이 1이 차지하는 픽셀 수 (viewport_height / (2 * tan(fovy / 2)))
+    float pixels_per_unit = 1.0f;
+    // mesh id로 인덱싱. 없으면 모두 LOD0
+    const std::vector<MeshLodInfo> *mesh_lods = nullptr;
+    // material handle로 인덱싱. 없거나 범위 밖이면 variant 0
+    const std::vector<ShaderVariant> *material_variants = nullptr;
+
+    // frustum_culling이 켜져 있으면 view_projection 밖의 항목을 버린다
+    glm::mat4 view_projection{1.0f};
+    bool frustum_culling = false;
+    // 있으면 occluder를 래스터화해 HiZ로 가려진 항목을 버린다 (frustum_culling 필요)
+    OcclusionCuller *occlusion = nullptr;
+
+    // 그림자를 그리는 view면 컬링에 걸린 shadow caster 중 shadow bounds 안의 것만 Hidden으로 남긴다.
+    // bounds는 카메라 기준 원기둥: 빛 축에 수직인 거리 shadow_radius, 빛 축 방향 거리 shadow_depth
+    // (CascadedShadowMap::casterBounds)
+    bool shadow_casters = false;
+    glm::vec3 light_direction{0.0f, -1.0f, 0.0f}; // 빛이 진행하는 방향, 정규화됨
+    float shadow_radius = 0.0f;
+    float shadow_depth = 0.0f;
+};
+
+// program 전환이 가장 비싸므로 shader variant를 pass 바로 아래에 둔다.
+// material은 인스턴스 데이터로 넘어가 상태 변경을 만들지 않으므로 가장 아래에 둔다.
+// 같은 variant/mesh/LOD가 이어져 한 번의 instanced draw로 묶이고, 그 안에서는 material 순서로 정렬된다
+// [63] pass | [59..62] variant | [32..58] mesh | [28..31] lod | [0..27] material
+inline uint64_t makeOpaqueKey(MaterialHandle material_handle, MeshHandle mesh_handle, uint8_t lod = 0, ShaderVariant variant = 0)
 {
     uint64_t key = 0;
     key |= (uint64_t)0 << 63;
-    key |= (uint64_t)material_handle << 32;
-    key |= (uint64_t)mesh_handle << 0;
+    key |= (uint64_t)(variant & 0xFu) << 59;
+    key |= (uint64_t)(mesh_handle & 0x07FFFFFFu) << 32;
+    key |= (uint64_t)(lod & 0xFu) << 28;
+    key |= (uint64_t)(material_handle & 0x0FFFFFFFu) << 0;
     return key;
 }
 
@@ -34,34 +101,139 @@ inline uint64_t makeTransparentKey(float distance_to_camera)
     return key;
 }
 
+// RenderItem::flags
+namespace RenderItemFlag
+{
+// 움직이지 않는 물체. 그림자 static 캐시에 한 번만 그려진다
+constexpr uint8_t Static = 1u << 0;
+constexpr uint8_t CastsShadow = 1u << 1;
+// 카메라 컬링에 걸린 shadow caster. 그림자 pass에만 그린다
+constexpr uint8_t Hidden = 1u << 2;
+} // namespace RenderItemFlag
+
 enum class RenderPass : uint8_t
 {
     Opaque = 0,
     Transparent = 1,
 };
 
+// RenderItem::entity가 없음. entity id 버퍼의 배경 값이기도 하다
+constexpr uint32_t kNoRenderEntity = 0xffffffffu;
+
 struct RenderItem
 {
     MeshHandle mesh_handle{};
     MaterialHandle material_handle{};
     Matrix4x4 model{1.0f};
-    glm::vec3 color{1.0f};
-    bool use_grid{};
+    uint8_t lod{};
+    ShaderVariant shader_variant{};
+    uint8_t flags{RenderItemFlag::CastsShadow};
     RenderPass pass{RenderPass::Opaque};
-    uint64_t sort_key{0};
+    // entity id 버퍼에 쓰이는 값
+    uint32_t entity{kNoRenderEntity};
+};
+
+// static shadow caster 하나의 해시. 집합 해시는 이 값의 합이라 순서와 무관하다.
+// LOD는 카메라에 따라 바뀌므로 넣지 않는다
+inline uint64_t staticCasterHash(MeshHandle mesh_handle, const Matrix4x4 &model)
+{
+    constexpr uint64_t kPrime = 1099511628211ull;
+    uint64_t hash = 14695981039346656037ull ^ mesh_handle;
+    const auto *words = reinterpret_cast<const uint32_t *>(&model);
+    for (std::size_t i = 0; i < sizeof(model) / sizeof(uint32_t); ++i)
+        hash = (hash ^ words[i]) * kPrime;
+    hash ^= hash >> 29;
+    return hash * kPrime;
+}
+
+// payload(RenderItem)는 추가된 순서대로 두고, (key, index) 쌍만 radix sort 한다.
+// arena를 주면 모든 배열을 프레임 arena에서 할당한다
+struct RenderBucket
+{
+    FrameVector<RenderItem> items;
+    FrameVector<SortKeyIndex> order;
+    FrameVector<SortKeyIndex> scratch;
+
+    explicit RenderBucket(LinearArena *arena = nullptr)
+        : items(ArenaAllocator<RenderItem>(arena)),
+          order(ArenaAllocator<SortKeyIndex>(arena)),
+          scratch(ArenaAllocator<SortKeyIndex>(arena))
+    {
+    }
+
+    void clear()
+    {
+        items.clear();
+        order.clear();
+    }
+
+    void reserve(std::size_t count)
+    {
+        items.reserve(count);
+        order.reserve(count);
+        scratch.reserve(count);
+    }
+
+    void add(RenderItem item, uint64_t sort_key)
+    {
+        order.push_back(SortKeyIndex{sort_key, static_cast<uint32_t>(items.size())});
+        items.push_back(std::move(item));
+    }
+
+    std::size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+
+    void sort(bool allow_parallel)
+    {
+        scratch.resize(order.size());
+        if (allow_parallel && order.size() >= kParallelSortThreshold)
+            parallelRadixSortKeyIndex(order.data(), scratch.data(), order.size(), ThreadPool::instance());
+        else
+            radixSortKeyIndex(order.data(), scratch.data(), order.size());
+    }
+
+    // sort() 이후 키 순서대로 payload를 순회한다
+    template <typename Func>
+    void forEachSorted(Func &&func) const
+    {
+        for (const SortKeyIndex &entry : order)
+            func(items[entry.index]);
+    }
+
+    static constexpr std::size_t kParallelSortThreshold = 1u << 15;
 };
 
 struct RenderQueue
 {
-    std::vector<RenderItem> opaque;
-    std::vector<RenderItem> transparent;
+    RenderBucket opaque;
+    RenderBucket transparent;
+    // 이 큐가 본 static shadow caster 집합 (staticCasterHash의 합과 개수). 컬링으로 큐에 넣지 않은 caster도
+    // noteStaticCaster로 더해 카메라가 움직여도 집합이 같으면 값이 같다. 바뀌면 static shadow 캐시를 다시 그린다
+    uint64_t static_caster_hash = 0;
+    uint64_t static_caster_count = 0;
+
+    explicit RenderQueue(LinearArena *arena = nullptr)
+        : opaque(arena),
+          transparent(arena)
+    {
+    }
 
     void clear()
     {
         opaque.clear();
         transparent.clear();
+        static_caster_hash = 0;
+        static_caster_count = 0;
+    }
+
+    void noteStaticCaster(MeshHandle mesh_handle, const Matrix4x4 &model)
+    {
+        static_caster_hash += staticCasterHash(mesh_handle, model);
+        ++static_caster_count;
     }
 
+    uint64_t staticCasterSignature() const { return static_caster_hash ^ (static_caster_count * 0x9E3779B97F4A7C15ull); }
+
     void reserve(std::size_t opaque_count, std::size_t transparent_count = 0)
     {
         opaque.reserve(opaque_count);
@@ -70,22 +242,24 @@ struct RenderQueue
 
     void addOpaque(RenderItem item)
     {
+        constexpr uint8_t kStaticCaster = RenderItemFlag::Static | RenderItemFlag::CastsShadow;
+        if ((item.flags & kStaticCaster) == kStaticCaster)
+            noteStaticCaster(item.mesh_handle, item.model);
         item.pass = RenderPass::Opaque;
-        item.sort_key = makeOpaqueKey(item.material_handle, item.mesh_handle);
-        opaque.push_back(std::move(item));
+        const uint64_t key = makeOpaqueKey(item.material_handle, item.mesh_handle, item.lod, item.shader_variant);
+        opaque.add(std::move(item), key);
     }
 
-    void addTransparent(RenderItem item)
+    void addTransparent(RenderItem item, float distance_to_camera)
     {
         item.pass = RenderPass::Transparent;
-        transparent.push_back(std::move(item));
+        transparent.add(std::move(item), makeTransparentKey(distance_to_camera));
     }
 
-    void sort()
+    // 큰 큐는 스레드풀에서 병렬 radix sort
+    void sort(bool allow_parallel = true)
     {
-        auto by_key = [](const RenderItem &lhs, const RenderItem &rhs)
-        { return lhs.sort_key < rhs.sort_key; };
-        std::sort(opaque.begin(), opaque.end(), by_key);
-        std::sort(transparent.begin(), transparent.end(), by_key);
+        opaque.sort(allow_parallel);
+        transparent.sort(allow_parallel);
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "camera_sensor.hpp"
+#include "entity_id_buffer.hpp"
+#include "render_data.hpp"
+#include "renderer.hpp"
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <glm/glm.hpp>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <thread>
+#include <vector>
+
+// 한 프레임을 그리는 데 필요한 모든 것. 메인 스레드가 채워 RenderThread에 넘기면
+// 렌더 스레드는 읽기만 하므로 queue가 프레임 arena를 써도 된다 (FrameAllocator가 그동안 비우지 않는다)
+struct FramePacket
+{
+    explicit FramePacket(LinearArena *arena = nullptr)
+        : queue(arena),
+          camera_sensors(ArenaAllocator<CameraSensorView>(arena)),
+          pick_queries(ArenaAllocator<EntityPickQuery>(arena))
+    {
+    }
+
+    RenderQueue queue;
+    // 화면을 그린 뒤 offscreen으로 찍을 카메라 센서들
+    FrameVector<CameraSensorView> camera_sensors;
+    // 이 프레임 화면의 entity id에서 읽을 영역 (RendererConfig::entity_ids). 결과는 takePickResults로 받는다
+    FrameVector<EntityPickQuery> pick_queries;
+    // hover 강조할 entity
+    std::uint32_t highlight_entity = kNoRenderEntity;
+    glm::mat4 view{1.0f};
+    glm::mat4 projection{1.0f};
+    // direction은 빛이 진행하는 방향
+    bool has_directional_light = false;
+    glm::vec3 light_direction{0.0f, -1.0f, 0.0f};
+    glm::vec3 light_color{1.0f};
+    glm::vec3 ambient_color{0.0f};
+    int viewport_width = 1;
+    int viewport_height = 1;
+    // 메시 GPU 업로드에 쓸 수 있는 시간
+    double upload_budget_ms = 2.0;
+    // 이 프레임에 반영된 가장 이른 클릭의 Profiler::now() (없으면 -1)
+    std::int64_t input_timestamp_ns = -1;
+};
+
+// 렌더 스레드가 마지막으로 끝낸 프레임의 결과
+struct FrameResult
+{
+    std::uint64_t frame = 0; // 끝낸 packet 수
+    RenderStats render;
+    GlStateStats state;
+    // 클릭이 실린 packet을 swap한 시각까지의 지연. 없으면 -1
+    double input_to_swap_ms = -1.0;
+    // swapBuffers가 돌아온 시각 (Profiler::now())과 그 전까지의 업로드/draw 시간
+    std::int64_t present_ns = -1;
+    std::int64_t render_work_ns = 0;
+    CameraSensorStats camera;
+};
+
+// Renderer의 GL 호출을 전용 스레드에서 실행한다. 생성하면 호출 스레드의 context를 넘겨받고, 소멸하면 돌려준다.
+// 메인 스레드는 submit으로 packet을 넘기고 다음 프레임을 만들기 시작하므로 프레임 N+1의 시뮬레이션이
+// 프레임 N의 제출/vsync 대기와 겹친다. 대기 packet이 kMaxQueuedFrames개면 submit이 블록한다.
+// 실행 중에는 메인 스레드가 Renderer를 직접 부르면 안 되고, 리소스 변경은 post로 보낸다
+class RenderThread
+{
+public:
+    static constexpr std::size_t kMaxQueuedFrames = 2;
+
+    // renderer.init()이 끝나 context가 호출 스레드에 current인 상태에서 생성
+    explicit RenderThread(Renderer &renderer);
+    ~RenderThread();
+
+    RenderThread(const RenderThread &) = delete;
+    RenderThread &operator=(const RenderThread &) = delete;
+
+    void submit(FramePacket &&packet);
+    // 다음 packet을 그리기 전에 렌더 스레드에서 순서대로 실행한다
+    void post(std::function<void(Renderer &)> command);
+    // 넘긴 packet을 모두 그릴 때까지 기다린다
+    void flush();
+    // 카메라 센서 이미지를 받을 콜백. ThreadPool 워커에서 불린다
+    void addCameraImageConsumer(CameraImageConsumer consumer) { camera_sensors_.addConsumer(std::move(consumer)); }
+    // 지난 호출 뒤 끝난 피킹 결과를 out으로 옮긴다. out은 비워지고 그 용량은 다음 결과에 재사용된다 (메인 스레드 전용)
+    void takePickResults(EntityPickResults &out);
+
+    FrameResult lastResult() const;
+    // 렌더 스레드 Renderer 표의 사본. submit에서 바뀐 경우에만 다시 복사된다 (메인 스레드 전용)
+    const std::vector<MeshLodInfo> &meshLodTable() const { return mesh_lods_; }
+    const std::vector<ShaderVariant> &materialVariants() const { return material_variants_; }
+
+private:
+    void threadLoop();
+    // 렌더 스레드에서 호출. Renderer 표가 바뀌었으면 공유 사본을 갱신한다
+    void publishResources();
+    // 메인 스레드에서 호출
+    void syncResources();
+
+    Renderer &renderer_;
+    std::thread thread_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable space_cv_;
+    std::array<std::optional<FramePacket>, kMaxQueuedFrames> packets_;
+    std::size_t packet_head_ = 0;
+    std::size_t packet_count_ = 0;
+    std::vector<std::function<void(Renderer &)>> commands_;
+    bool busy_ = false;
+    bool stopping_ = false;
+    FrameResult result_;
+    // GL 객체는 렌더 스레드가 끝날 때 지운다
+    CameraSensorRenderer camera_sensors_;
+    // 렌더 스레드가 붙이고 mutex_ 아래에서 메인 스레드가 가져간다
+    EntityPickResults shared_picks_;
+
+    // 렌더 스레드가 쓰고 mutex_ 아래에서 메인 스레드가 가져간다
+    std::uint64_t shared_version_ = 0;
+    std::vector<MeshLodInfo> shared_mesh_lods_;
+    std::vector<ShaderVariant> shared_material_variants_;
+    // 렌더 스레드 전용
+    std::uint64_t published_version_ = 0;
+    EntityPickResults completed_picks_;
+    int viewport_width_ = 0;
+    int viewport_height_ = 0;
+    // 메인 스레드 전용
+    std::uint64_t synced_version_ = 0;
+    std::vector<MeshLodInfo> mesh_lods_;
+    std::vector<ShaderVariant> material_variants_;
+};
@@ -1,49 +1,283 @@
 #pragma once
 
+#include "entity_id_buffer.hpp"
 #include "gl_includes.hpp"
+#include "gl_state_cache.hpp"
+#include "gpu_timer.hpp"
+#include "material_table.hpp"
 #include "mesh.hpp"
+#include "mesh_arena.hpp"
 #include "render_data.hpp"
+#include "shader_cache.hpp"
+#include "shadow_map.hpp"
 
 #ifndef GLFW_INCLUDE_NONE
 #define GLFW_INCLUDE_NONE
 #endif
 #include <GLFW/glfw3.h>
+#include <array>
+#include <cstdint>
 #include <glm/mat4x4.hpp>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+struct RendererConfig
+{
+    // false면 instanced batching 없이 RenderItem마다 uniform을 바꿔 그린다 (FEATURE_INSTANCED가 빠진 variant)
+    bool instancing = true;
+    // 방향광 cascaded shadow map
+    bool shadows = true;
+    // 화면 pass를 entity id 첨부가 있는 FBO에 그려 requestEntityPick으로 픽셀 단위 피킹을 한다
+    bool entity_ids = false;
+};
+
+// 마지막 draw()부터 제출한 양 (shadow pass와 그 뒤의 drawOffscreen 포함)
+struct RenderStats
+{
+    std::uint64_t draw_calls = 0; // multi-draw 한 번도 1회
+    std::uint64_t instances = 0;
+    std::uint64_t triangles = 0;
+
+    void reset()
+    {
+        draw_calls = 0;
+        instances = 0;
+        triangles = 0;
+    }
+};
+
+struct ShadowStats
+{
+    std::uint64_t static_cascade_renders = 0; // static 캐시를 다시 그린 횟수 (cascade 단위 누적)
+    std::uint64_t dynamic_cascade_renders = 0;
+};
+
 class Renderer
 {
 public:
     ~Renderer();
 
-    bool init(int width, int height, const std::string &title);
+    // visible=false면 숨은 창(벤치마크/CI용)을 만들고 vsync를 끈다
+    bool init(int width, int height, const std::string &title, bool visible = true);
     void draw(const RenderQueue &queue, const glm::mat4 &view, const glm::mat4 &projection);
+    // queue를 framebuffer(color 0 = RGBA, color 1 = R32UI entity id, depth)에 그린다. draw() 뒤에 부르며
+    // shadow map은 화면 카메라 기준이라 받지 않는다. 끝나면 화면 framebuffer와 viewport로 돌아간다
+    void drawOffscreen(const RenderQueue &queue, const glm::mat4 &view, const glm::mat4 &projection,
+                       GLuint framebuffer, int width, int height);
     bool windowShouldClose() const { return should_close_; };
 
     void swapBuffers();
     void pollEvents();
+    // 0이면 vsync 없음. context가 current인 스레드에서 호출 (렌더 스레드가 있으면 post로)
+    void setSwapInterval(int interval);
 
     GLFWwindow *getWindowPtr() { return window_ptr_; };
 
+    // 마지막 draw() 호출에서 실제로 호출된/생략된 GL 상태 변경 수
+    const GlStateStats &getStateStats() const { return state_cache_.stats(); }
+    const RenderStats &getRenderStats() const { return render_stats_; }
+    // 셰이더 로딩(캐시 적중/컴파일) 통계. 시작 시간 측정용
+    const ShaderCacheStats &getShaderCacheStats() const { return shader_cache_->stats(); }
+
+    // 호출한 스레드에서 바로 업로드한다. LOD 생성(QEM)도 여기서 돌므로 기본은 끈다
+    int registerMesh(const MeshData &data, int preferred_id = -1, const MeshUploadOptions &options = {.generate_lods = false});
+    // 파일(.obj / .glb)을 워커 스레드에서 mmap + 파싱 + LOD 생성 + 인코딩하고 id를 바로 반환한다.
+    // GL 업로드는 processUploads에서 하며, 상주하기 전까지 이 id는 그려지지 않는다
+    int registerMesh(const std::string &path, int preferred_id = -1, const MeshUploadOptions &options = {});
+    void unregisterMesh(int mesh_id);
+    bool isMeshResident(int mesh_id) const;
+    // mesh id로 인덱싱되는 LOD 정보. RenderView::mesh_lods로 넘긴다
+    const std::vector<MeshLodInfo> &getMeshLodTable() const { return mesh_lod_table_; }
+    std::size_t pendingMeshLoads() const { return pending_loads_.size(); }
+    // 파싱이 끝난 메시를 budget_ms 안에서 업로드한다 (최소 한 개). 매 프레임 draw 전에 호출
+    void processUploads(double budget_ms);
+    // 가득 차면 MaterialTable::kInvalidMaterial. 그 handle로 그리면 기본 material이 쓰인다
+    MaterialHandle registerMaterial(const Material &material);
+    void updateMaterial(MaterialHandle handle, const Material &material);
+    // MaterialTable::kTextureSize 정사각 RGBA8. 반환값을 Material::albedo_layer에 넣는다. 실패하면 -1
+    int addMaterialTexture(const std::uint8_t *rgba, int width, int height);
+    // material handle로 인덱싱되는 shader variant 표. RenderView::material_variants로 넘긴다
+    const std::vector<ShaderVariant> &getMaterialVariants() const { return material_table_->variants(); }
+    // mesh LOD 표나 material variant 표가 바뀔 때마다 증가한다. 다른 스레드의 사본 갱신 판단용
+    std::uint64_t getResourceVersion() const { return resource_version_; }
+
+    // direction은 빛이 진행하는 방향 (월드 공간)
+    void setDirectionalLight(const glm::vec3 &direction, const glm::vec3 &color, const glm::vec3 &ambient);
+    void setConfig(const RendererConfig &config);
+    const RendererConfig &getConfig() const { return config_; }
+    // 화면 pass에서 밝게 칠할 entity (hover 강조). kNoRenderEntity면 없음
+    void setHighlightEntity(std::uint32_t entity) { highlight_entity_ = entity; }
+    // 마지막 draw()가 쓴 entity id에서 query 영역을 비동기로 읽는다. draw() 뒤에 부른다.
+    // config.entity_ids가 꺼져 있으면 결과는 ok=false로 나온다
+    void requestEntityPick(const EntityPickQuery &query);
+    // 끝난 피킹 결과를 out에 붙인다. swap 뒤에 프레임마다 한 번
+    void collectEntityPicks(EntityPickResults &out);
+    const ShadowStats &getShadowStats() const { return shadow_stats_; }
+
+    // arena 단편화를 정리한다. unregisterMesh에서 단편화가 심하면 자동으로 호출됨
+    void compactMeshes();
+
 private:
-    GLuint loadShaders(const std::string &vertex_shader_path, const std::string &fragment_shader_path);
+    // 인스턴스 버퍼 한 칸. shader_vertex의 location 3~8과 맞춰야 한다
+    struct InstanceData
+    {
+        glm::mat4 model;
+        std::uint32_t material; // MaterialTable index
+        std::uint32_t entity;   // RenderItem::entity
+    };
+
+    // glMultiDrawElementsIndirect 명령 형식
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instance_count;
+        GLuint first_index;
+        GLint base_vertex;
+        GLuint base_instance;
+    };
+
+    // 같은 shader variant, arena(VAO), index type을 쓰는 연속 명령 구간. 한 번의 multi-draw로 제출된다
+    struct DrawBatch
+    {
+        ShaderVariant variant;
+        const MeshArena *arena;
+        GLenum index_type;
+        std::size_t first_command;
+        std::size_t command_count;
+    };
+
+    // 워커가 채우고 GL 스레드가 비우는 완료 목록. Renderer가 먼저 사라져도 워커가 안전하게 쓸 수 있도록 shared_ptr로 잡는다
+    struct MeshLoadResult
+    {
+        int mesh_id = -1;
+        std::uint32_t ticket = 0;
+        std::string path;
+        EncodedMesh encoded;
+        std::unique_ptr<MeshData> cpu_copy;
+        std::string error;
+    };
+
+    struct MeshLoadQueue
+    {
+        std::mutex mutex;
+        std::vector<MeshLoadResult> completed;
+    };
+
+    // FEATURE_* define 조합 하나로 컴파일된 program과 uniform 위치
+    struct ProgramVariant
+    {
+        GLuint program = 0;
+        bool failed = false;
+        GLint view_loc = -1;
+        GLint projection_loc = -1;
+        GLint model_loc = -1;
+        GLint material_loc = -1;
+        GLint entity_loc = -1;
+        GLint highlight_entity_loc = -1;
+        GLint light_direction_loc = -1;
+        GLint light_color_loc = -1;
+        GLint ambient_color_loc = -1;
+        GLint albedo_maps_loc = -1;
+        GLint shadow_maps_loc = -1;
+        GLint cascade_splits_loc = -1;
+        GLint shadow_strength_loc = -1;
+        std::array<GLint, CascadedShadowMap::kCascadeCount> shadow_matrix_locs{};
+    };
+
+    // appendBatches에서 (item.flags & flag_mask) == flag_value 인 항목만 담는다
+    struct BatchFilter
+    {
+        std::uint8_t flag_mask = 0;
+        std::uint8_t flag_value = 0;
+        // false면 variant를 무시하고 묶는다 (depth 전용 pass)
+        bool split_variants = true;
+    };
+
+    void loadShaders(const std::string &vertex_shader_path, const std::string &fragment_shader_path);
+    // 처음 쓰일 때 컴파일한다 (셰이더 캐시가 있으면 binary 로드). 실패한 variant는 nullptr
+    const ProgramVariant *programFor(ShaderVariant variant);
+    const ProgramVariant *shadowProgram();
+    bool buildProgram(ProgramVariant &slot, const std::string &name, const std::string &vertex_source,
+                      const std::string &fragment_source, ShaderVariant variant);
+    // 현재 config 기준으로 등록된 material들이 쓸 variant를 미리 만들어 draw 중 컴파일을 피한다
+    void precompileVariants();
+    ShaderVariant submitVariant(ShaderVariant material_variant) const;
+    // screen_pass면 그림자(config.shadows)와 hover 강조를 적용한다
+    void bindProgram(const ProgramVariant &program, const glm::mat4 &view, const glm::mat4 &projection,
+                     bool screen_pass = false);
     void registerBuiltinMeshes();
-    int registerMesh(std::unique_ptr<Mesh> mesh, int preferred_id = -1);
     Mesh *getMeshFromId(int mesh_id);
+    // preferred_id가 없으면 새 슬롯을 만든다. 슬롯의 기존 메시는 호출자가 교체한다
+    int reserveMeshId(int preferred_id);
+    void setMesh(int mesh_id, std::unique_ptr<Mesh> mesh);
+
+    void initBatching();
+    void setInstanceAttributes(std::size_t first_instance);
+    // group_by_format: opaque처럼 순서가 중요하지 않으면 arena/index type별로 모아 multi-draw 횟수를 줄인다
+    void appendBatches(const RenderBucket &bucket, bool group_by_format, std::vector<DrawBatch> &out, const BatchFilter &filter);
+    void uploadBatches();
+    void submitBatch(const DrawBatch &batch);
+    void submitBatchPerItem(const DrawBatch &batch, const ProgramVariant &program);
+    // batches_를 현재 framebuffer에 그린다
+    void submitSceneBatches(const glm::mat4 &view, const glm::mat4 &projection, bool screen_pass);
+    // entity id 버퍼를 현재 viewport 크기로 맞춘다. 쓸 수 없으면 false
+    bool prepareEntityIds();
+    // static_cascades 비트의 cascade는 static 캐시부터 다시 그린다
+    void renderShadows(std::uint32_t static_cascades);
+    void submitShadowBatches(const std::vector<DrawBatch> &batches, const ProgramVariant &program);
 
     GLFWwindow *window_ptr_ = nullptr;
     bool should_close_ = false;
     int width_ = 0;
     int height_ = 0;
 
-    GLuint shader_program_ = 0;
-    GLint model_loc_ = -1;
-    GLint view_loc_ = -1;
-    GLint projection_loc_ = -1;
-    GLint color_loc_ = -1;
-    GLint use_grid_loc_ = -1;
+    std::unique_ptr<ShaderCache> shader_cache_;
+    std::unique_ptr<MaterialTable> material_table_;
+    std::string vertex_source_;
+    std::string fragment_source_;
+    std::array<ProgramVariant, kShaderVariantCount> programs_{};
+    std::string shadow_vertex_source_;
+    std::string shadow_fragment_source_;
+    // [0] per-item, [1] instanced
+    std::array<ProgramVariant, 2> shadow_programs_{};
+    std::unique_ptr<CascadedShadowMap> shadow_map_;
+    ShadowStats shadow_stats_;
+    std::unique_ptr<GpuTimer> gpu_timer_;
+    RenderStats render_stats_;
+    RendererConfig config_;
+    std::unique_ptr<EntityIdBuffer> entity_ids_;
+    std::uint32_t highlight_entity_ = kNoRenderEntity;
+    glm::vec3 light_direction_{0.0f};
+    glm::vec3 light_color_{0.0f};
+    glm::vec3 ambient_color_{0.0f};
 
+    std::array<std::unique_ptr<MeshArena>, kVertexFormatCount> mesh_arenas_;
     std::vector<std::unique_ptr<Mesh>> meshes_;
-};
\ No newline at end of file
+    std::vector<MeshLodInfo> mesh_lod_table_;
+    std::uint64_t resource_version_ = 0;
+    GlStateCache state_cache_;
+
+    // mesh id -> 진행중인 비동기 로드의 ticket. unregister나 재등록 시 ticket이 달라져 결과를 버린다
+    std::unordered_map<int, std::uint32_t> pending_loads_;
+    std::uint32_t next_load_ticket_ = 1;
+    std::shared_ptr<MeshLoadQueue> load_queue_ = std::make_shared<MeshLoadQueue>();
+    std::vector<MeshLoadResult> ready_uploads_;
+    std::size_t ready_upload_head_ = 0;
+
+    // 정렬된 큐를 같은 메시 연속 구간 단위의 instanced draw 명령으로 묶어 제출한다
+    GLuint instance_buffer_ = 0;
+    GLuint indirect_buffer_ = 0;
+    std::size_t instance_capacity_ = 0;
+    std::size_t indirect_capacity_ = 0;
+    std::vector<InstanceData> instances_;
+    std::vector<DrawElementsIndirectCommand> draw_commands_;
+    std::vector<std::uint8_t> command_groups_;
+    std::vector<DrawElementsIndirectCommand> grouped_commands_;
+    std::vector<DrawBatch> batches_;
+    std::vector<DrawBatch> shadow_static_batches_;
+    std::vector<DrawBatch> shadow_dynamic_batches_;
+    GLFWglproc multi_draw_elements_indirect_ = nullptr;
+};
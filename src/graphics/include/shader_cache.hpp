@@ -0,0 +1,46 @@
+#pragma once
+
+#include "gl_includes.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct ShaderCacheStats
+{
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    // 파일은 있었지만 드라이버가 거부했거나 손상된 경우 (miss에도 포함)
+    std::size_t rejected = 0;
+    double total_ms = 0.0;
+};
+
+// glProgramBinary 기반 디스크 캐시. 키는 소스 + define + 드라이버 문자열(vendor/renderer/version)의 해시라
+// 셰이더나 드라이버가 바뀌면 자동으로 새로 컴파일한다. 캐시를 못 쓰면 소스 컴파일로 돌아간다.
+class ShaderCache
+{
+public:
+    explicit ShaderCache(std::string directory);
+
+    // context가 current인 상태에서 호출. 실패하면 std::runtime_error
+    GLuint loadProgram(const std::string &name,
+                       const std::string &vertex_source,
+                       const std::string &fragment_source,
+                       const std::vector<std::string> &defines = {});
+
+    const ShaderCacheStats &stats() const { return stats_; }
+    bool binarySupported() const { return binary_supported_; }
+
+private:
+    std::uint64_t makeKey(const std::string &vertex_source,
+                          const std::string &fragment_source,
+                          const std::vector<std::string> &defines) const;
+    std::string cachePath(const std::string &name, std::uint64_t key) const;
+    GLuint loadBinary(const std::string &path, std::uint64_t key);
+    void storeBinary(const std::string &path, std::uint64_t key, GLuint program) const;
+
+    std::string directory_;
+    std::string driver_;
+    bool binary_supported_ = false;
+    ShaderCacheStats stats_;
+};
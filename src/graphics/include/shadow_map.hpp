@@ -0,0 +1,84 @@
+#pragma once
+
+#include "gl_includes.hpp"
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+// 카메라 주변에서 cascade 캐시 영역이 닿을 수 있는 범위. 이 밖의 물체는 어느 cascade에도 그림자를 드리우지 않는다
+struct ShadowCasterBounds
+{
+    float radius = 0.0f; // 빛에 수직인 평면에서 카메라로부터의 거리
+    float depth = 0.0f;  // 빛 축을 따라 카메라로부터의 거리 (앞뒤 모두)
+};
+
+// 방향광 cascaded shadow map. cascade마다 static 캐시와 프레임별 합성본 두 장의 depth layer를 둔다.
+// static 캐시는 광원 방향, static 집합, cascade 중심(카메라가 캐시 영역을 벗어날 때)이 바뀔 때만 다시 그리고,
+// 매 프레임은 캐시를 합성본에 복사한 뒤 dynamic 물체만 그 위에 그린다.
+// 캐시 영역은 cascade가 덮어야 하는 구보다 kCacheMargin만큼 넓게 잡고 texel 단위로 중심을 맞춰 떨림을 없앤다
+class CascadedShadowMap
+{
+public:
+    static constexpr int kCascadeCount = 3;
+    static constexpr int kResolution = 2048;
+    // MaterialTable::kTextureUnit(0) 다음
+    static constexpr GLuint kTextureUnit = 1;
+
+    // context가 current인 상태에서 생성
+    CascadedShadowMap();
+    ~CascadedShadowMap();
+
+    CascadedShadowMap(const CascadedShadowMap &) = delete;
+    CascadedShadowMap &operator=(const CascadedShadowMap &) = delete;
+
+    // 카메라와 광원으로 cascade를 갱신하고, static 캐시를 다시 그려야 하는 cascade를 비트마스크로 돌려준다.
+    // light_direction은 빛이 진행하는 방향, static_signature는 static caster 집합의 해시
+    std::uint32_t update(const glm::mat4 &view,
+                         const glm::mat4 &projection,
+                         const glm::vec3 &light_direction,
+                         std::uint64_t static_signature);
+    void invalidate() { cache_valid_ = false; }
+    // update와 같은 분할로 구한 보수적인 범위. GL을 쓰지 않으므로 메인 스레드의 caster 컬링에 쓴다
+    static ShadowCasterBounds casterBounds(const glm::mat4 &projection);
+
+    // 해당 cascade의 static 캐시 layer를 비우고 render target으로 잡는다
+    void beginStatic(int cascade);
+    // static 캐시를 합성본에 복사하고 합성본 layer를 render target으로 잡는다
+    void beginDynamic(int cascade);
+
+    const glm::mat4 &lightView(int cascade) const { return cascades_[cascade].view; }
+    const glm::mat4 &lightProjection(int cascade) const { return cascades_[cascade].projection; }
+    // 월드 좌표 -> [0, 1] shadow map 좌표
+    const glm::mat4 &shadowMatrix(int cascade) const { return cascades_[cascade].shadow_matrix; }
+    // 각 cascade가 끝나는 view-space 거리 (사용하지 않는 칸은 0)
+    const glm::vec4 &splits() const { return splits_; }
+    // 셰이더가 샘플링하는 합성본 (sampler2DArrayShadow)
+    GLuint texture() const { return dynamic_texture_; }
+
+private:
+    struct Cascade
+    {
+        glm::vec3 center{0.0f}; // 캐시 영역 중심 (texel에 맞춰짐)
+        float radius = 0.0f;    // 이 cascade의 카메라 frustum 조각을 감싸는 구
+        float extent = 0.0f;    // 캐시 영역 반 너비
+        glm::mat4 view{1.0f};
+        glm::mat4 projection{1.0f};
+        glm::mat4 shadow_matrix{1.0f};
+    };
+
+    GLuint createDepthArray() const;
+    void placeCascade(Cascade &cascade, const glm::vec3 &center, float radius) const;
+
+    GLuint static_texture_ = 0;
+    GLuint dynamic_texture_ = 0;
+    std::array<GLuint, kCascadeCount> static_fbos_{};
+    std::array<GLuint, kCascadeCount> dynamic_fbos_{};
+    std::array<Cascade, kCascadeCount> cascades_{};
+    glm::vec4 splits_{0.0f};
+
+    bool cache_valid_ = false;
+    glm::vec3 light_direction_{0.0f, -1.0f, 0.0f};
+    glm::vec3 light_right_{1.0f, 0.0f, 0.0f};
+    glm::vec3 light_up_{0.0f, 0.0f, 1.0f};
+    std::uint64_t static_signature_ = 0;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "gl_includes.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Vertex;
+
+enum class VertexFormat : std::uint8_t
+{
+    Float = 0,  // Vertex 그대로 (32 bytes)
+    Packed = 1, // position float3 + normal 2_10_10_10_REV + uv half2 (20 bytes)
+};
+
+constexpr std::size_t kVertexFormatCount = 2;
+
+struct VertexAttribute
+{
+    GLuint location;
+    GLint components;
+    GLenum type;
+    GLboolean normalized;
+    std::size_t offset;
+};
+
+// vertex buffer 하나의 attribute 배치. MeshArena가 VAO를 구성할 때 사용한다
+struct VertexLayout
+{
+    VertexFormat format;
+    GLsizei stride;
+    std::vector<VertexAttribute> attributes;
+
+    // 현재 바인딩된 VAO에 GL_ARRAY_BUFFER로 bind된 buffer 기준 attribute를 설정한다
+    void apply() const;
+    // Vertex 배열을 이 layout의 바이트 배열로 변환한다
+    std::vector<std::byte> encode(const Vertex *vertices, std::size_t count) const;
+
+    static const VertexLayout &get(VertexFormat format);
+};
+
+struct PackedVertex
+{
+    float position[3];
+    std::uint32_t normal; // GL_INT_2_10_10_10_REV, normalized
+    std::uint32_t uv;     // 2 x GL_HALF_FLOAT
+};
+static_assert(sizeof(PackedVertex) == 20, "PackedVertex must stay tightly packed");
@@ -0,0 +1,266 @@
+#include "camera_sensor.hpp"
+
+#include "profiler.hpp"
+#include "renderer.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+// readback 버퍼 안의 순서: color, entity id, depth
+const std::array<PixelReadback::Region, 3> kImageRegions = {
+    PixelReadback::Region{GL_COLOR_ATTACHMENT0, GL_RGBA, GL_UNSIGNED_BYTE, 4},
+    PixelReadback::Region{GL_COLOR_ATTACHMENT1, GL_RED_INTEGER, GL_UNSIGNED_INT, 4},
+    PixelReadback::Region{GL_DEPTH_ATTACHMENT, GL_DEPTH_COMPONENT, GL_FLOAT, 4},
+};
+
+GLuint createRenderbuffer(GLenum internal_format, int width, int height)
+{
+    GLuint renderbuffer = 0;
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, internal_format, width, height);
+    return renderbuffer;
+}
+} // namespace
+
+CameraSensorRenderer::CameraSensorRenderer()
+    : images_(std::make_shared<ImagePool>())
+{
+}
+
+CameraSensorRenderer::~CameraSensorRenderer() = default;
+
+void CameraSensorRenderer::addConsumer(CameraImageConsumer consumer)
+{
+    // 워커가 들고 있는 목록은 그대로 두고 새 목록으로 바꾼다
+    std::lock_guard<std::mutex> lock(images_->mutex);
+    auto consumers = std::make_shared<std::vector<CameraImageConsumer>>(*images_->consumers);
+    consumers->push_back(std::move(consumer));
+    images_->consumers = std::move(consumers);
+}
+
+CameraSensorRenderer::Target *CameraSensorRenderer::findTarget(std::uint32_t sensor)
+{
+    for (Target &target : targets_)
+    {
+        if (target.sensor == sensor)
+            return &target;
+    }
+    return nullptr;
+}
+
+bool CameraSensorRenderer::createTarget(Target &target, int width, int height)
+{
+    target.width = width;
+    target.height = height;
+    target.color = createRenderbuffer(GL_RGBA8, width, height);
+    target.entity = createRenderbuffer(GL_R32UI, width, height);
+    target.depth = createRenderbuffer(GL_DEPTH_COMPONENT32F, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &target.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_RENDERBUFFER, target.entity);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target.depth);
+    const GLenum draw_buffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, draw_buffers);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "[camera] sensor " << target.sensor << " framebuffer incomplete (0x" << std::hex << status << std::dec
+                  << ")\n";
+        destroyTarget(target);
+        // 같은 해상도로 매 프레임 다시 만들지 않도록 크기는 남겨 둔다
+        target.width = width;
+        target.height = height;
+        return false;
+    }
+
+    target.readback = std::make_unique<PixelReadback>(kReadbackSlots);
+    target.shots.clear();
+    return true;
+}
+
+void CameraSensorRenderer::destroyTarget(Target &target)
+{
+    target.readback.reset();
+    target.shots.clear();
+    if (target.framebuffer != 0)
+        glDeleteFramebuffers(1, &target.framebuffer);
+    const GLuint renderbuffers[] = {target.color, target.entity, target.depth};
+    glDeleteRenderbuffers(3, renderbuffers);
+    target.framebuffer = 0;
+    target.color = 0;
+    target.entity = 0;
+    target.depth = 0;
+    target.width = 0;
+    target.height = 0;
+}
+
+void CameraSensorRenderer::render(Renderer &renderer, const CameraSensorView &view)
+{
+    PROFILE_SCOPE("CameraSensorRenderer::render");
+    const int width = std::max(view.width, 1);
+    const int height = std::max(view.height, 1);
+    Target *target = findTarget(view.sensor);
+    if (!target)
+    {
+        targets_.emplace_back();
+        target = &targets_.back();
+        target->sensor = view.sensor;
+    }
+    target->last_used_frame = frame_;
+    // 해상도가 바뀌면 진행 중인 readback과 함께 다시 만든다
+    if (target->width != width || target->height != height)
+    {
+        destroyTarget(*target);
+        target->failed = !createTarget(*target, width, height);
+    }
+    if (target->failed)
+        return;
+
+    renderer.drawOffscreen(view.queue, view.view, view.projection, target->framebuffer, width, height);
+    ++rendered_;
+    // 받을 consumer가 없으면 PBO 복사와 map을 하지 않는다
+    if (!hasConsumers())
+        return;
+    if (target->readback->request(target->framebuffer, 0, 0, width, height, kImageRegions, view.sequence))
+        target->shots.push_back(Shot{view.sequence, view.near_plane, view.far_plane, view.view, view.projection});
+}
+
+void CameraSensorRenderer::collect()
+{
+    PROFILE_SCOPE("CameraSensorRenderer::collect");
+    ++frame_;
+    for (Target &target : targets_)
+    {
+        if (!target.readback)
+            continue;
+        target.readback->poll([&](std::uint64_t sequence, std::span<const std::byte> data)
+                              {
+            const auto shot = std::find_if(target.shots.begin(), target.shots.end(), [&](const Shot &candidate)
+                                           { return candidate.sequence == sequence; });
+            if (shot == target.shots.end())
+                return;
+            deliver(target, *shot, data);
+            target.shots.erase(target.shots.begin(), shot + 1); });
+    }
+
+    // 촬영이 끊긴 센서(컴포넌트 제거 등)는 readback이 모두 끝난 뒤 해제한다
+    for (std::size_t i = 0; i < targets_.size();)
+    {
+        Target &target = targets_[i];
+        const bool idle = frame_ - target.last_used_frame > kIdleFramesBeforeRelease;
+        if (!idle || (target.readback && target.readback->pending() > 0))
+        {
+            ++i;
+            continue;
+        }
+        destroyTarget(target);
+        if (i + 1 != targets_.size())
+            targets_[i] = std::move(targets_.back());
+        targets_.pop_back();
+    }
+}
+
+bool CameraSensorRenderer::hasConsumers() const
+{
+    std::lock_guard<std::mutex> lock(images_->mutex);
+    return !images_->consumers->empty();
+}
+
+CameraImage *CameraSensorRenderer::acquireImage()
+{
+    std::lock_guard<std::mutex> lock(images_->mutex);
+    if (!images_->free.empty())
+    {
+        CameraImage *image = images_->free.back();
+        images_->free.pop_back();
+        return image;
+    }
+    if (images_->storage.size() >= kMaxImagesInFlight)
+        return nullptr;
+    images_->storage.push_back(std::make_unique<CameraImage>());
+    return images_->storage.back().get();
+}
+
+void CameraSensorRenderer::deliver(const Target &target, const Shot &shot, std::span<const std::byte> data)
+{
+    // 넘길 consumer가 없으면 이미지 버퍼를 잡거나 복사하지 않는다
+    std::shared_ptr<const std::vector<CameraImageConsumer>> consumers;
+    {
+        std::lock_guard<std::mutex> lock(images_->mutex);
+        consumers = images_->consumers;
+    }
+    if (consumers->empty())
+        return;
+
+    CameraImage *image = acquireImage();
+    if (!image)
+    {
+        ++dropped_images_;
+        return;
+    }
+
+    image->sensor = target.sensor;
+    image->sequence = shot.sequence;
+    image->width = target.width;
+    image->height = target.height;
+    image->near_plane = shot.near_plane;
+    image->far_plane = shot.far_plane;
+    image->view = shot.view;
+    image->projection = shot.projection;
+
+    // map된 PBO는 렌더 스레드가 곧 돌려줘야 하므로 여기서 복사한다. 이미지 버퍼는 재사용되어 할당이 없다
+    const auto pixels = static_cast<std::size_t>(target.width) * static_cast<std::size_t>(target.height);
+    image->color.resize(pixels * 4);
+    image->entity.resize(pixels);
+    image->depth.resize(pixels);
+    const std::byte *source = data.data();
+    std::memcpy(image->color.data(), source, image->color.size());
+    source += image->color.size();
+    std::memcpy(image->entity.data(), source, pixels * sizeof(std::uint32_t));
+    source += pixels * sizeof(std::uint32_t);
+    std::memcpy(image->depth.data(), source, pixels * sizeof(float));
+    ++delivered_;
+
+    ThreadPool::instance().submit([pool = images_, consumers = std::move(consumers), image]
+                                  {
+        PROFILE_SCOPE("CameraImageConsumer");
+        for (const CameraImageConsumer &consumer : *consumers)
+            consumer(*image);
+        std::lock_guard<std::mutex> lock(pool->mutex);
+        pool->free.push_back(image); });
+}
+
+void CameraSensorRenderer::release()
+{
+    for (Target &target : targets_)
+        destroyTarget(target);
+    targets_.clear();
+}
+
+CameraSensorStats CameraSensorRenderer::stats() const
+{
+    CameraSensorStats stats;
+    stats.sensors = targets_.size();
+    stats.rendered = rendered_;
+    stats.delivered = delivered_;
+    stats.dropped = dropped_images_;
+    for (const Target &target : targets_)
+    {
+        if (!target.readback)
+            continue;
+        stats.dropped += target.readback->droppedRequests();
+        stats.pending_readbacks += target.readback->pending();
+    }
+    return stats;
+}
@@ -0,0 +1,173 @@
+#include "entity_id_buffer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <iostream>
+
+namespace
+{
+const std::array<PixelReadback::Region, 1> kIdRegion = {
+    PixelReadback::Region{GL_COLOR_ATTACHMENT1, GL_RED_INTEGER, GL_UNSIGNED_INT, sizeof(std::uint32_t)},
+};
+
+GLuint createRenderbuffer(GLenum internal_format, int width, int height)
+{
+    GLuint renderbuffer = 0;
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, internal_format, width, height);
+    return renderbuffer;
+}
+} // namespace
+
+EntityIdBuffer::EntityIdBuffer() = default;
+
+EntityIdBuffer::~EntityIdBuffer()
+{
+    release();
+}
+
+bool EntityIdBuffer::resize(int width, int height)
+{
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (width == width_ && height == height_)
+        return !failed_;
+
+    release();
+    width_ = width;
+    height_ = height;
+    color_ = createRenderbuffer(GL_RGBA8, width, height);
+    entity_ = createRenderbuffer(GL_R32UI, width, height);
+    depth_ = createRenderbuffer(GL_DEPTH_COMPONENT32F, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer_);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_RENDERBUFFER, entity_);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth_);
+    const GLenum draw_buffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, draw_buffers);
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        std::cerr << "[renderer] entity id framebuffer incomplete (0x" << std::hex << status << std::dec << ")\n";
+        release();
+        width_ = width;
+        height_ = height;
+        failed_ = true;
+        return false;
+    }
+    std::clog << "[renderer] entity id buffer " << width << "x" << height << std::endl;
+    return true;
+}
+
+void EntityIdBuffer::release()
+{
+    if (framebuffer_ != 0)
+        glDeleteFramebuffers(1, &framebuffer_);
+    const GLuint renderbuffers[] = {color_, entity_, depth_};
+    glDeleteRenderbuffers(3, renderbuffers);
+    framebuffer_ = 0;
+    color_ = 0;
+    entity_ = 0;
+    depth_ = 0;
+    width_ = 0;
+    height_ = 0;
+    failed_ = false;
+}
+
+void EntityIdBuffer::resolveToScreen()
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer_);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, width_, height_, 0, 0, width_, height_, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void EntityIdBuffer::request(const EntityPickQuery &query)
+{
+    Pending pending;
+    pending.query = query;
+    const int x0 = std::max(query.x, 0);
+    const int y0 = std::max(query.y, 0);
+    const int x1 = std::min(query.x + query.width, width_);
+    const int y1 = std::min(query.y + query.height, height_);
+    if (valid() && x1 > x0 && y1 > y0)
+    {
+        pending.query.x = x0;
+        pending.query.y = y0;
+        pending.query.width = x1 - x0;
+        pending.query.height = y1 - y0;
+        pending.ok = readback_.request(framebuffer_, x0, y0, x1 - x0, y1 - y0, kIdRegion, query.id);
+    }
+    queries_.push_back(pending);
+}
+
+void EntityIdBuffer::collect(EntityPickResults &out)
+{
+    readback_.poll([&](std::uint64_t id, std::span<const std::byte> data)
+                   {
+        const auto it = std::find_if(queries_.begin(), queries_.end(), [&](const Pending &pending)
+                                     { return pending.ok && pending.query.id == id; });
+        if (it == queries_.end())
+            return;
+        // 앞에 남은 요청은 readback을 못 걸었거나 map에 실패한 것이다
+        for (auto failed = queries_.begin(); failed != it; ++failed)
+            fail(*failed, out);
+        const std::span<const std::uint32_t> ids(reinterpret_cast<const std::uint32_t *>(data.data()),
+                                                 data.size() / sizeof(std::uint32_t));
+        finish(*it, ids, out);
+        queries_.erase(queries_.begin(), it + 1); });
+
+    // 기다릴 readback이 없으면 남은 요청은 모두 실패다. 있으면 순서를 지키려고 앞의 실패만 낸다
+    auto end = queries_.begin();
+    if (readback_.pending() == 0)
+        end = queries_.end();
+    else
+    {
+        while (end != queries_.end() && !end->ok)
+            ++end;
+    }
+    for (auto failed = queries_.begin(); failed != end; ++failed)
+        fail(*failed, out);
+    queries_.erase(queries_.begin(), end);
+}
+
+void EntityIdBuffer::finish(const Pending &pending, std::span<const std::uint32_t> ids, EntityPickResults &out)
+{
+    const EntityPickQuery &query = pending.query;
+    EntityPickResult result;
+    result.id = query.id;
+    result.ok = true;
+    result.center = ids[static_cast<std::size_t>(query.height / 2) * static_cast<std::size_t>(query.width) +
+                        static_cast<std::size_t>(query.width / 2)];
+    result.first = out.entities.size();
+
+    // 같은 entity는 픽셀이 이어지므로 연속 중복을 먼저 걸러 정렬할 양을 줄인다
+    std::uint32_t previous = kNoRenderEntity;
+    for (std::uint32_t entity : ids)
+    {
+        if (entity == previous)
+            continue;
+        previous = entity;
+        if (entity != kNoRenderEntity)
+            out.entities.push_back(entity);
+    }
+    const auto first = out.entities.begin() + static_cast<std::ptrdiff_t>(result.first);
+    std::sort(first, out.entities.end());
+    out.entities.erase(std::unique(first, out.entities.end()), out.entities.end());
+    result.count = out.entities.size() - result.first;
+    out.results.push_back(result);
+}
+
+void EntityIdBuffer::fail(const Pending &pending, EntityPickResults &out)
+{
+    EntityPickResult result;
+    result.id = pending.query.id;
+    result.first = out.entities.size();
+    out.results.push_back(result);
+}
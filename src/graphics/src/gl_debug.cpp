@@ -0,0 +1,99 @@
+#include "gl_debug.hpp"
+#include "gl_includes.hpp"
+
+#ifndef GLFW_INCLUDE_NONE
+#define GLFW_INCLUDE_NONE
+#endif
+#include <GLFW/glfw3.h>
+#include <iostream>
+
+namespace
+{
+#if defined(GRAPHICS_GL_DEBUG) && !defined(__APPLE__)
+const char *sourceName(GLenum source)
+{
+    switch (source)
+    {
+    case GL_DEBUG_SOURCE_API:
+        return "api";
+    case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+        return "window";
+    case GL_DEBUG_SOURCE_SHADER_COMPILER:
+        return "shader";
+    case GL_DEBUG_SOURCE_THIRD_PARTY:
+        return "third-party";
+    case GL_DEBUG_SOURCE_APPLICATION:
+        return "app";
+    default:
+        return "other";
+    }
+}
+
+const char *severityName(GLenum severity)
+{
+    switch (severity)
+    {
+    case GL_DEBUG_SEVERITY_HIGH:
+        return "high";
+    case GL_DEBUG_SEVERITY_MEDIUM:
+        return "medium";
+    case GL_DEBUG_SEVERITY_LOW:
+        return "low";
+    default:
+        return "notice";
+    }
+}
+
+void GLAPIENTRY messageCallback(GLenum source,
+                                GLenum type,
+                                GLuint id,
+                                GLenum severity,
+                                GLsizei /*length*/,
+                                const GLchar *message,
+                                const void * /*user_param*/)
+{
+    std::clog << "[gl] " << severityName(severity) << " " << sourceName(source)
+              << " type=0x" << std::hex << type << std::dec << " id=" << id << ": "
+              << (message ? message : "") << std::endl;
+}
+#endif
+} // namespace
+
+namespace GlDebug
+{
+void applyContextHints()
+{
+#if defined(GRAPHICS_GL_DEBUG) && !defined(__APPLE__)
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+}
+
+bool installMessageCallback()
+{
+#if defined(GRAPHICS_GL_DEBUG) && !defined(__APPLE__)
+    if (!glfwExtensionSupported("GL_KHR_debug"))
+    {
+        std::clog << "[renderer] GL_KHR_debug not supported, gl error logging disabled" << std::endl;
+        return false;
+    }
+
+    auto debug_message_callback = reinterpret_cast<PFNGLDEBUGMESSAGECALLBACKPROC>(glfwGetProcAddress("glDebugMessageCallback"));
+    auto debug_message_control = reinterpret_cast<PFNGLDEBUGMESSAGECONTROLPROC>(glfwGetProcAddress("glDebugMessageControl"));
+    if (!debug_message_callback)
+        return false;
+
+    glEnable(GL_DEBUG_OUTPUT);
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    debug_message_callback(messageCallback, nullptr);
+    if (debug_message_control)
+    {
+        // notification 레벨은 드라이버마다 너무 많이 나와서 끈다
+        debug_message_control(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+    }
+    std::clog << "[renderer] GL_KHR_debug callback installed" << std::endl;
+    return true;
+#else
+    return false;
+#endif
+}
+} // namespace GlDebug
@@ -0,0 +1,188 @@
+#include "gl_state_cache.hpp"
+
+#include <cstring>
+#include <glm/gtc/type_ptr.hpp>
+
+void GlStateCache::useProgram(GLuint program)
+{
+    if (track(program_ != program))
+    {
+        glUseProgram(program);
+        program_ = program;
+        program_uniforms_ = &uniforms_[program];
+    }
+}
+
+void GlStateCache::bindVertexArray(GLuint vao)
+{
+    if (track(vao_ != vao))
+    {
+        glBindVertexArray(vao);
+        vao_ = vao;
+        // element array buffer 바인딩은 VAO 상태에 포함된다
+        element_buffer_ = kUnknown;
+    }
+}
+
+void GlStateCache::bindBuffer(GLenum target, GLuint buffer)
+{
+    GLuint *slot = bufferSlot(target);
+    if (!slot)
+    {
+        ++stats_.issued;
+        glBindBuffer(target, buffer);
+        return;
+    }
+
+    if (track(*slot != buffer))
+    {
+        glBindBuffer(target, buffer);
+        *slot = buffer;
+    }
+}
+
+void GlStateCache::bindTexture(GLuint unit, GLenum target, GLuint texture)
+{
+    if (unit >= kMaxTextureUnits)
+    {
+        ++stats_.issued;
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(target, texture);
+        active_texture_unit_ = unit;
+        return;
+    }
+
+    TextureBinding &binding = textures_[unit];
+    if (!track(binding.target != target || binding.texture != texture))
+        return;
+
+    if (active_texture_unit_ != unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        active_texture_unit_ = unit;
+    }
+    glBindTexture(target, texture);
+    binding.target = target;
+    binding.texture = texture;
+}
+
+void GlStateCache::setUniform(GLint location, int value)
+{
+    // float로 바꾸면 2^24를 넘는 서로 다른 값(entity id 등)이 같아지므로 비트를 그대로 담는다
+    static_assert(sizeof(int) == sizeof(float));
+    float data = 0.0f;
+    std::memcpy(&data, &value, sizeof(value));
+    if (updateUniform(location, UniformType::Int, &data, 1))
+        glUniform1i(location, value);
+}
+
+void GlStateCache::setUniform(GLint location, float value)
+{
+    if (updateUniform(location, UniformType::Float, &value, 1))
+        glUniform1f(location, value);
+}
+
+void GlStateCache::setUniform(GLint location, const glm::vec3 &value)
+{
+    if (updateUniform(location, UniformType::Vec3, glm::value_ptr(value), 3))
+        glUniform3f(location, value.x, value.y, value.z);
+}
+
+void GlStateCache::setUniform(GLint location, const glm::vec4 &value)
+{
+    if (updateUniform(location, UniformType::Vec4, glm::value_ptr(value), 4))
+        glUniform4f(location, value.x, value.y, value.z, value.w);
+}
+
+void GlStateCache::setUniform(GLint location, const glm::mat4 &value)
+{
+    if (updateUniform(location, UniformType::Mat4, glm::value_ptr(value), 16))
+        glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void GlStateCache::bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+{
+    if (target != GL_UNIFORM_BUFFER || index >= kMaxUniformBindings)
+    {
+        ++stats_.issued;
+        glBindBufferBase(target, index, buffer);
+        if (GLuint *slot = bufferSlot(target))
+            *slot = buffer;
+        return;
+    }
+
+    if (track(uniform_bindings_[index] != buffer || uniform_buffer_ != buffer))
+    {
+        glBindBufferBase(target, index, buffer);
+        uniform_bindings_[index] = buffer;
+        uniform_buffer_ = buffer;
+    }
+}
+
+void GlStateCache::invalidate()
+{
+    program_ = kUnknown;
+    vao_ = kUnknown;
+    array_buffer_ = kUnknown;
+    element_buffer_ = kUnknown;
+    uniform_buffer_ = kUnknown;
+    draw_indirect_buffer_ = kUnknown;
+    active_texture_unit_ = kUnknown;
+    textures_.fill(TextureBinding{});
+    uniform_bindings_.fill(kUnknown);
+    uniforms_.clear();
+    program_uniforms_ = nullptr;
+}
+
+void GlStateCache::forgetProgram(GLuint program)
+{
+    if (program_ == program)
+    {
+        program_ = kUnknown;
+        program_uniforms_ = nullptr;
+    }
+    uniforms_.erase(program);
+}
+
+bool GlStateCache::updateUniform(GLint location, UniformType type, const float *data, std::size_t count)
+{
+    // 위치가 -1이면 GL도 무시하므로 호출하지 않는다
+    if (location < 0)
+        return false;
+    if (!program_uniforms_)
+    {
+        ++stats_.issued;
+        return true;
+    }
+
+    std::vector<UniformSlot> &slots = *program_uniforms_;
+    const std::size_t index = static_cast<std::size_t>(location);
+    if (index >= slots.size())
+        slots.resize(index + 1);
+
+    UniformSlot &slot = slots[index];
+    const bool changed = slot.type != type || std::memcmp(slot.data, data, count * sizeof(float)) != 0;
+    if (track(changed))
+    {
+        slot.type = type;
+        std::memcpy(slot.data, data, count * sizeof(float));
+    }
+    return changed;
+}
+
+GLuint *GlStateCache::bufferSlot(GLenum target)
+{
+    switch (target)
+    {
+    case GL_ARRAY_BUFFER:
+        return &array_buffer_;
+    case GL_ELEMENT_ARRAY_BUFFER:
+        return &element_buffer_;
+    case GL_UNIFORM_BUFFER:
+        return &uniform_buffer_;
+    case GL_DRAW_INDIRECT_BUFFER:
+        return &draw_indirect_buffer_;
+    default:
+        return nullptr;
+    }
+}
@@ -0,0 +1,637 @@
+#include "mesh_import.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace MeshImport
+{
+namespace
+{
+constexpr std::uint32_t kGlbMagic = 0x46546C67;  // "glTF"
+constexpr std::uint32_t kChunkJson = 0x4E4F534A; // "JSON"
+constexpr std::uint32_t kChunkBin = 0x004E4942;  // "BIN\0"
+constexpr int kComponentUnsignedByte = 5121;
+constexpr int kComponentUnsignedShort = 5123;
+constexpr int kComponentUnsignedInt = 5125;
+constexpr int kComponentFloat = 5126;
+constexpr int kModeTriangles = 4;
+constexpr int kMaxNodeDepth = 64;
+
+// glTF 헤더에 필요한 만큼만 해석하는 JSON 트리
+struct JsonValue
+{
+    enum class Type
+    {
+        Null,
+        Bool,
+        Number,
+        String,
+        Array,
+        Object
+    };
+
+    Type type = Type::Null;
+    double number = 0.0;
+    bool boolean = false;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    const JsonValue *find(std::string_view key) const
+    {
+        for (const auto &[name, value] : object)
+        {
+            if (name == key)
+                return &value;
+        }
+        return nullptr;
+    }
+
+    const JsonValue &at(std::size_t index) const
+    {
+        if (type != Type::Array || index >= array.size())
+            throw std::runtime_error("glTF: index out of range");
+        return array[index];
+    }
+
+    int intOr(std::string_view key, int fallback) const
+    {
+        const JsonValue *value = find(key);
+        return value && value->type == Type::Number ? static_cast<int>(value->number) : fallback;
+    }
+
+    int requireInt(std::string_view key) const
+    {
+        const JsonValue *value = find(key);
+        if (!value || value->type != Type::Number)
+            throw std::runtime_error("glTF: missing '" + std::string(key) + "'");
+        return static_cast<int>(value->number);
+    }
+
+    // 개수/바이트 크기/인덱스처럼 음수가 될 수 없는 값. 숫자가 아니거나 음수, 소수, 32비트를 넘는 값은 잘못된 파일로 본다
+    std::size_t asSize(std::string_view what) const
+    {
+        if (type != Type::Number || !(number >= 0.0) ||
+            number > static_cast<double>(std::numeric_limits<std::uint32_t>::max()) ||
+            number != static_cast<double>(static_cast<std::uint64_t>(number)))
+            throw std::runtime_error("glTF: invalid '" + std::string(what) + "'");
+        return static_cast<std::size_t>(number);
+    }
+
+    std::size_t sizeOr(std::string_view key, std::size_t fallback) const
+    {
+        const JsonValue *value = find(key);
+        if (!value || value->type != Type::Number)
+            return fallback;
+        return value->asSize(key);
+    }
+
+    std::size_t requireSize(std::string_view key) const
+    {
+        if (!find(key))
+            throw std::runtime_error("glTF: missing '" + std::string(key) + "'");
+        return sizeOr(key, 0);
+    }
+};
+
+class JsonParser
+{
+public:
+    explicit JsonParser(std::string_view text) : cur_(text.data()), end_(text.data() + text.size()) {}
+
+    JsonValue parseDocument()
+    {
+        JsonValue root = parseValue(0);
+        skipSpaces();
+        if (cur_ != end_)
+            fail("trailing characters");
+        return root;
+    }
+
+private:
+    static constexpr int kMaxDepth = 128;
+
+    [[noreturn]] void fail(const char *what) const
+    {
+        throw std::runtime_error(std::string("glTF JSON: ") + what);
+    }
+
+    void skipSpaces()
+    {
+        while (cur_ < end_ && (*cur_ == ' ' || *cur_ == '\t' || *cur_ == '\n' || *cur_ == '\r'))
+            ++cur_;
+    }
+
+    bool consume(char c)
+    {
+        skipSpaces();
+        if (cur_ < end_ && *cur_ == c)
+        {
+            ++cur_;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if (!consume(c))
+            fail("unexpected character");
+    }
+
+    bool consumeLiteral(std::string_view literal)
+    {
+        if (static_cast<std::size_t>(end_ - cur_) >= literal.size() && std::string_view(cur_, literal.size()) == literal)
+        {
+            cur_ += literal.size();
+            return true;
+        }
+        return false;
+    }
+
+    JsonValue parseValue(int depth)
+    {
+        if (depth > kMaxDepth)
+            fail("nesting too deep");
+
+        skipSpaces();
+        if (cur_ >= end_)
+            fail("unexpected end");
+
+        JsonValue value;
+        const char c = *cur_;
+        if (c == '{')
+        {
+            ++cur_;
+            value.type = JsonValue::Type::Object;
+            if (consume('}'))
+                return value;
+            do
+            {
+                skipSpaces();
+                std::string key = parseString();
+                expect(':');
+                value.object.emplace_back(std::move(key), parseValue(depth + 1));
+            } while (consume(','));
+            expect('}');
+        }
+        else if (c == '[')
+        {
+            ++cur_;
+            value.type = JsonValue::Type::Array;
+            if (consume(']'))
+                return value;
+            do
+            {
+                value.array.push_back(parseValue(depth + 1));
+            } while (consume(','));
+            expect(']');
+        }
+        else if (c == '"')
+        {
+            value.type = JsonValue::Type::String;
+            value.string = parseString();
+        }
+        else if (consumeLiteral("true"))
+        {
+            value.type = JsonValue::Type::Bool;
+            value.boolean = true;
+        }
+        else if (consumeLiteral("false"))
+        {
+            value.type = JsonValue::Type::Bool;
+        }
+        else if (consumeLiteral("null"))
+        {
+            value.type = JsonValue::Type::Null;
+        }
+        else
+        {
+            value.type = JsonValue::Type::Number;
+            value.number = parseNumber();
+        }
+        return value;
+    }
+
+    std::string parseString()
+    {
+        if (cur_ >= end_ || *cur_ != '"')
+            fail("expected string");
+        ++cur_;
+        std::string out;
+        while (cur_ < end_ && *cur_ != '"')
+        {
+            char c = *cur_++;
+            if (c == '\\')
+            {
+                if (cur_ >= end_)
+                    fail("bad escape");
+                c = *cur_++;
+                switch (c)
+                {
+                case 'n': out.push_back('\n'); break;
+                case 't': out.push_back('\t'); break;
+                case 'r': out.push_back('\r'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'u':
+                    // 이름/URI에만 쓰이므로 코드 포인트는 보존하지 않는다
+                    if (end_ - cur_ < 4)
+                        fail("bad escape");
+                    cur_ += 4;
+                    out.push_back('?');
+                    break;
+                default: out.push_back(c); break;
+                }
+            }
+            else
+            {
+                out.push_back(c);
+            }
+        }
+        if (cur_ >= end_)
+            fail("unterminated string");
+        ++cur_;
+        return out;
+    }
+
+    double parseNumber()
+    {
+        const char *begin = cur_;
+        if (cur_ < end_ && *cur_ == '-')
+            ++cur_;
+        while (cur_ < end_ && ((*cur_ >= '0' && *cur_ <= '9') || *cur_ == '.' || *cur_ == 'e' || *cur_ == 'E' || *cur_ == '+' || *cur_ == '-'))
+            ++cur_;
+        if (cur_ == begin)
+            fail("unexpected character");
+        // JSON 청크 안의 짧은 토큰이므로 복사해서 strtod에 넘긴다
+        const std::string token(begin, cur_);
+        char *parsed_end = nullptr;
+        const double number = std::strtod(token.c_str(), &parsed_end);
+        if (parsed_end != token.c_str() + token.size())
+            fail("bad number");
+        return number;
+    }
+
+    const char *cur_;
+    const char *end_;
+};
+
+std::uint32_t readU32(const std::byte *data)
+{
+    std::uint32_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+int componentCountOf(const std::string &type)
+{
+    if (type == "SCALAR")
+        return 1;
+    if (type == "VEC2")
+        return 2;
+    if (type == "VEC3")
+        return 3;
+    if (type == "VEC4")
+        return 4;
+    throw std::runtime_error("glTF: unsupported accessor type " + type);
+}
+
+int componentSizeOf(int component_type)
+{
+    switch (component_type)
+    {
+    case kComponentUnsignedByte: return 1;
+    case kComponentUnsignedShort: return 2;
+    case kComponentUnsignedInt:
+    case kComponentFloat: return 4;
+    default: throw std::runtime_error("glTF: unsupported component type");
+    }
+}
+
+// BIN 청크 위의 accessor 하나. element(i)는 i번째 원소의 시작 주소
+struct AccessorView
+{
+    const std::byte *base = nullptr;
+    std::size_t count = 0;
+    std::size_t stride = 0;
+    int component_type = 0;
+    int components = 0;
+    bool normalized = false;
+
+    const std::byte *element(std::size_t i) const { return base + i * stride; }
+
+    float component(std::size_t i, int c) const
+    {
+        const std::byte *p = element(i);
+        switch (component_type)
+        {
+        case kComponentFloat:
+        {
+            float value = 0.0f;
+            std::memcpy(&value, p + c * 4, sizeof(value));
+            return value;
+        }
+        case kComponentUnsignedShort:
+        {
+            std::uint16_t value = 0;
+            std::memcpy(&value, p + c * 2, sizeof(value));
+            return normalized ? value / 65535.0f : static_cast<float>(value);
+        }
+        case kComponentUnsignedByte:
+        {
+            const auto value = static_cast<std::uint8_t>(p[c]);
+            return normalized ? value / 255.0f : static_cast<float>(value);
+        }
+        default:
+            throw std::runtime_error("glTF: unsupported attribute component type");
+        }
+    }
+
+    unsigned int index(std::size_t i) const
+    {
+        const std::byte *p = element(i);
+        switch (component_type)
+        {
+        case kComponentUnsignedByte: return static_cast<std::uint8_t>(p[0]);
+        case kComponentUnsignedShort:
+        {
+            std::uint16_t value = 0;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+        case kComponentUnsignedInt: return readU32(p);
+        default: throw std::runtime_error("glTF: unsupported index component type");
+        }
+    }
+};
+
+class GlbReader
+{
+public:
+    GlbReader(const JsonValue &json, const std::byte *bin, std::size_t bin_size)
+        : json_(json), bin_(bin), bin_size_(bin_size)
+    {
+    }
+
+    MeshData read()
+    {
+        MeshData out;
+        const JsonValue *scenes = json_.find("scenes");
+        if (scenes && scenes->type == JsonValue::Type::Array && !scenes->array.empty())
+        {
+            const JsonValue &scene = scenes->at(json_.sizeOr("scene", 0));
+            if (const JsonValue *roots = scene.find("nodes"))
+            {
+                // glTF node 그래프는 엄격한 트리여야 한다. 두 번 닿는 node는 잘못된 파일로 본다
+                std::vector<bool> visited(section("nodes").array.size(), false);
+                for (const JsonValue &root : roots->array)
+                    appendNode(root.asSize("nodes"), glm::mat4(1.0f), 0, visited, out);
+            }
+        }
+        else if (const JsonValue *meshes = json_.find("meshes"))
+        {
+            // scene이 없으면 mesh를 변환 없이 모두 합친다
+            for (std::size_t mesh = 0; mesh < meshes->array.size(); ++mesh)
+                appendMesh(mesh, glm::mat4(1.0f), out);
+        }
+
+        if (out.indices.empty())
+            throw std::runtime_error("glTF: no triangle primitives");
+        fillMissingNormals(out);
+        return out;
+    }
+
+private:
+    const JsonValue &section(std::string_view name) const
+    {
+        const JsonValue *value = json_.find(name);
+        if (!value || value->type != JsonValue::Type::Array)
+            throw std::runtime_error("glTF: missing '" + std::string(name) + "'");
+        return *value;
+    }
+
+    static glm::mat4 localTransform(const JsonValue &node)
+    {
+        if (const JsonValue *matrix = node.find("matrix"))
+        {
+            glm::mat4 m(1.0f);
+            for (int column = 0; column < 4; ++column)
+            {
+                for (int row = 0; row < 4; ++row)
+                    m[column][row] = static_cast<float>(matrix->at(static_cast<std::size_t>(column * 4 + row)).number);
+            }
+            return m;
+        }
+
+        glm::mat4 m(1.0f);
+        if (const JsonValue *t = node.find("translation"))
+            m = glm::translate(m, glm::vec3(t->at(0).number, t->at(1).number, t->at(2).number));
+        if (const JsonValue *r = node.find("rotation"))
+        {
+            // glTF는 (x, y, z, w) 순서
+            const glm::quat rotation(static_cast<float>(r->at(3).number),
+                                     static_cast<float>(r->at(0).number),
+                                     static_cast<float>(r->at(1).number),
+                                     static_cast<float>(r->at(2).number));
+            m = m * glm::mat4_cast(rotation);
+        }
+        if (const JsonValue *s = node.find("scale"))
+            m = glm::scale(m, glm::vec3(s->at(0).number, s->at(1).number, s->at(2).number));
+        return m;
+    }
+
+    void appendNode(std::size_t node_index, const glm::mat4 &parent, int depth, std::vector<bool> &visited, MeshData &out) const
+    {
+        if (depth > kMaxNodeDepth)
+            throw std::runtime_error("glTF: node hierarchy too deep");
+        if (node_index >= visited.size())
+            throw std::runtime_error("glTF: node index out of range");
+        if (visited[node_index])
+            throw std::runtime_error("glTF: node reached twice (node graph must be a tree)");
+        visited[node_index] = true;
+
+        const JsonValue &node = section("nodes").at(node_index);
+        const glm::mat4 world = parent * localTransform(node);
+        const int mesh = node.intOr("mesh", -1);
+        if (mesh >= 0)
+            appendMesh(static_cast<std::size_t>(mesh), world, out);
+
+        if (const JsonValue *children = node.find("children"))
+        {
+            for (const JsonValue &child : children->array)
+                appendNode(child.asSize("children"), world, depth + 1, visited, out);
+        }
+    }
+
+    void appendMesh(std::size_t mesh_index, const glm::mat4 &transform, MeshData &out) const
+    {
+        const JsonValue &mesh = section("meshes").at(mesh_index);
+        const JsonValue *primitives = mesh.find("primitives");
+        if (!primitives)
+            return;
+
+        const glm::mat3 normal_matrix = glm::transpose(glm::inverse(glm::mat3(transform)));
+        for (const JsonValue &primitive : primitives->array)
+        {
+            if (primitive.intOr("mode", kModeTriangles) != kModeTriangles)
+                continue;
+            const JsonValue *attributes = primitive.find("attributes");
+            if (!attributes || !attributes->find("POSITION"))
+                continue;
+
+            const AccessorView positions = accessor(static_cast<std::size_t>(attributes->requireInt("POSITION")));
+            if (positions.component_type != kComponentFloat || positions.components != 3)
+                throw std::runtime_error("glTF: POSITION must be float VEC3");
+
+            AccessorView normals;
+            const int normal_accessor = attributes->intOr("NORMAL", -1);
+            if (normal_accessor >= 0)
+            {
+                normals = accessor(static_cast<std::size_t>(normal_accessor));
+                if (normals.component_type != kComponentFloat || normals.components != 3)
+                    throw std::runtime_error("glTF: NORMAL must be float VEC3");
+            }
+
+            AccessorView uvs;
+            const int uv_accessor = attributes->intOr("TEXCOORD_0", -1);
+            if (uv_accessor >= 0)
+            {
+                uvs = accessor(static_cast<std::size_t>(uv_accessor));
+                // float 또는 normalized unsigned byte/short (glTF 2.0 3.7.2.1)
+                if (uvs.components != 2 || uvs.component_type == kComponentUnsignedInt)
+                    throw std::runtime_error("glTF: TEXCOORD_0 must be VEC2 of float, unsigned byte or unsigned short");
+            }
+
+            const std::size_t base_vertex = out.vertices.size();
+            out.vertices.reserve(base_vertex + positions.count);
+            for (std::size_t i = 0; i < positions.count; ++i)
+            {
+                Vertex vertex{};
+                const glm::vec4 position(positions.component(i, 0), positions.component(i, 1), positions.component(i, 2), 1.0f);
+                vertex.position = glm::vec3(transform * position);
+                if (i < normals.count)
+                {
+                    const glm::vec3 normal(normals.component(i, 0), normals.component(i, 1), normals.component(i, 2));
+                    const glm::vec3 transformed = normal_matrix * normal;
+                    const float length = glm::length(transformed);
+                    vertex.normal = length > 0.0f ? transformed / length : glm::vec3(0.0f);
+                }
+                if (i < uvs.count)
+                    vertex.texture_coordinates = glm::vec2(uvs.component(i, 0), uvs.component(i, 1));
+                out.vertices.push_back(vertex);
+            }
+
+            const int index_accessor = primitive.intOr("indices", -1);
+            if (index_accessor >= 0)
+            {
+                const AccessorView indices = accessor(static_cast<std::size_t>(index_accessor));
+                out.indices.reserve(out.indices.size() + indices.count);
+                for (std::size_t i = 0; i < indices.count; ++i)
+                {
+                    const unsigned int index = indices.index(i);
+                    if (index >= positions.count)
+                        throw std::runtime_error("glTF: index out of range");
+                    out.indices.push_back(static_cast<unsigned int>(base_vertex) + index);
+                }
+            }
+            else
+            {
+                for (std::size_t i = 0; i < positions.count; ++i)
+                    out.indices.push_back(static_cast<unsigned int>(base_vertex + i));
+            }
+        }
+    }
+
+    AccessorView accessor(std::size_t accessor_index) const
+    {
+        const JsonValue &accessor = section("accessors").at(accessor_index);
+        if (accessor.find("sparse"))
+            throw std::runtime_error("glTF: sparse accessors are not supported");
+
+        const JsonValue *type = accessor.find("type");
+        AccessorView view;
+        view.count = accessor.requireSize("count");
+        view.component_type = accessor.requireInt("componentType");
+        view.components = componentCountOf(type ? type->string : std::string());
+        if (const JsonValue *normalized = accessor.find("normalized"))
+            view.normalized = normalized->boolean;
+
+        const std::size_t element_size = static_cast<std::size_t>(componentSizeOf(view.component_type) * view.components);
+        const JsonValue &buffer_view = section("bufferViews").at(accessor.requireSize("bufferView"));
+        if (buffer_view.intOr("buffer", 0) != 0)
+            throw std::runtime_error("glTF: only the GLB binary buffer is supported");
+
+        const std::size_t view_offset = buffer_view.sizeOr("byteOffset", 0);
+        const std::size_t view_length = buffer_view.requireSize("byteLength");
+        const std::size_t accessor_offset = accessor.sizeOr("byteOffset", 0);
+        view.stride = buffer_view.sizeOr("byteStride", 0);
+        if (view.stride == 0)
+            view.stride = element_size;
+
+        // 곱과 합이 넘치지 않도록 남은 길이에서 빼고 나눠 비교한다
+        if (view_offset > bin_size_ || view_length > bin_size_ - view_offset)
+            throw std::runtime_error("glTF: buffer view out of range");
+        if (view.count > 0)
+        {
+            if (accessor_offset > view_length || element_size > view_length - accessor_offset ||
+                view.count - 1 > (view_length - accessor_offset - element_size) / view.stride)
+                throw std::runtime_error("glTF: accessor out of range");
+        }
+
+        view.base = bin_ + view_offset + accessor_offset;
+        return view;
+    }
+
+    const JsonValue &json_;
+    const std::byte *bin_;
+    std::size_t bin_size_;
+};
+} // namespace
+
+MeshData parseGlb(const std::byte *data, std::size_t size)
+{
+    constexpr std::size_t kHeaderSize = 12;
+    constexpr std::size_t kChunkHeaderSize = 8;
+    if (size < kHeaderSize || readU32(data) != kGlbMagic)
+        throw std::runtime_error("glTF: not a GLB file");
+    if (readU32(data + 4) != 2)
+        throw std::runtime_error("glTF: only version 2 is supported");
+    const std::size_t total = std::min<std::size_t>(readU32(data + 8), size);
+
+    std::string_view json_text;
+    const std::byte *bin = nullptr;
+    std::size_t bin_size = 0;
+    for (std::size_t offset = kHeaderSize; offset + kChunkHeaderSize <= total;)
+    {
+        const std::size_t chunk_length = readU32(data + offset);
+        const std::uint32_t chunk_type = readU32(data + offset + 4);
+        const std::byte *chunk = data + offset + kChunkHeaderSize;
+        if (chunk_length > total - offset - kChunkHeaderSize)
+            throw std::runtime_error("glTF: truncated chunk");
+
+        if (chunk_type == kChunkJson && json_text.empty())
+            json_text = std::string_view(reinterpret_cast<const char *>(chunk), chunk_length);
+        else if (chunk_type == kChunkBin && !bin)
+        {
+            bin = chunk;
+            bin_size = chunk_length;
+        }
+        // 청크는 4바이트 정렬
+        offset += kChunkHeaderSize + ((chunk_length + 3) & ~std::size_t{3});
+    }
+    if (json_text.empty())
+        throw std::runtime_error("glTF: missing JSON chunk");
+
+    const JsonValue json = JsonParser(json_text).parseDocument();
+    return GlbReader(json, bin, bin_size).read();
+}
+} // namespace MeshImport
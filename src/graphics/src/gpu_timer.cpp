@@ -0,0 +1,66 @@
+#include "gpu_timer.hpp"
+#include "profiler.hpp"
+
+GpuTimer::GpuTimer()
+{
+    for (FrameQueries &frame : frames_)
+        glGenQueries(static_cast<GLsizei>(kMaxPasses), frame.queries.data());
+}
+
+GpuTimer::~GpuTimer()
+{
+    for (FrameQueries &frame : frames_)
+        glDeleteQueries(static_cast<GLsizei>(kMaxPasses), frame.queries.data());
+}
+
+void GpuTimer::beginFrame()
+{
+    frame_index_ = (frame_index_ + 1) % kFrameLatency;
+    collect(frames_[frame_index_]);
+}
+
+void GpuTimer::collect(FrameQueries &frame)
+{
+    if (frame.count == 0)
+        return;
+
+    // 마지막 쿼리가 끝났으면 앞선 쿼리도 모두 끝났다
+    GLint available = 0;
+    glGetQueryObjectiv(frame.queries[frame.count - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_TRUE)
+    {
+        Profiler &profiler = Profiler::instance();
+        for (std::size_t i = 0; i < frame.count; ++i)
+        {
+            GLuint64 elapsed_ns = 0;
+            glGetQueryObjectui64v(frame.queries[i], GL_QUERY_RESULT, &elapsed_ns);
+            profiler.recordGpu(frame.names[i], frame.cpu_start_ns[i], static_cast<std::int64_t>(elapsed_ns));
+        }
+    }
+    else
+    {
+        ++dropped_frames_;
+    }
+    frame.count = 0;
+}
+
+void GpuTimer::begin(const char *name)
+{
+    FrameQueries &frame = frames_[frame_index_];
+    if (active_ || frame.count >= kMaxPasses || !Profiler::instance().enabled())
+        return;
+
+    frame.names[frame.count] = name;
+    frame.cpu_start_ns[frame.count] = Profiler::now();
+    glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.count]);
+    active_ = true;
+}
+
+void GpuTimer::end()
+{
+    if (!active_)
+        return;
+    glEndQuery(GL_TIME_ELAPSED);
+    ++frames_[frame_index_].count;
+    active_ = false;
+}
@@ -0,0 +1,132 @@
+#include "material_table.hpp"
+
+#include <algorithm>
+
+MaterialTable::MaterialTable()
+{
+    materials_.reserve(kMaxMaterials);
+    gpu_materials_.reserve(kMaxMaterials);
+    variants_.reserve(kMaxMaterials);
+
+    glGenBuffers(1, &buffer_);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(kMaxMaterials * sizeof(GpuMaterial)), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    add(Material{});
+}
+
+MaterialTable::~MaterialTable()
+{
+    if (buffer_ != 0)
+        glDeleteBuffers(1, &buffer_);
+    if (texture_array_ != 0)
+        glDeleteTextures(1, &texture_array_);
+}
+
+MaterialHandle MaterialTable::add(const Material &material)
+{
+    if (materials_.size() >= kMaxMaterials)
+        return kInvalidMaterial;
+
+    materials_.push_back(material);
+    gpu_materials_.push_back(toGpu(material));
+    variants_.push_back(variantOf(material));
+    markDirty(materials_.size() - 1);
+    return static_cast<MaterialHandle>(materials_.size() - 1);
+}
+
+void MaterialTable::update(MaterialHandle handle, const Material &material)
+{
+    if (handle >= materials_.size())
+        return;
+    materials_[handle] = material;
+    gpu_materials_[handle] = toGpu(material);
+    variants_[handle] = variantOf(material);
+    markDirty(handle);
+}
+
+ShaderVariant MaterialTable::variantOf(const Material &material)
+{
+    ShaderVariant variant = 0;
+    if (material.use_grid)
+        variant |= ShaderFeature::Grid;
+    if (material.lit)
+        variant |= ShaderFeature::Lit;
+    if (material.albedo_layer >= 0)
+        variant |= ShaderFeature::Textured;
+    return variant;
+}
+
+int MaterialTable::addTexture(const std::uint8_t *rgba, int width, int height)
+{
+    if (!rgba || width != kTextureSize || height != kTextureSize || texture_layers_ >= kMaxTextureLayers)
+        return -1;
+
+    if (texture_array_ == 0)
+    {
+        glGenTextures(1, &texture_array_);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture_array_);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, kTextureSize, kTextureSize, kMaxTextureLayers, 0,
+                     GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    }
+    else
+    {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, texture_array_);
+    }
+
+    const int layer = texture_layers_++;
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, kTextureSize, kTextureSize, 1, GL_RGBA, GL_UNSIGNED_BYTE, rgba);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return layer;
+}
+
+void MaterialTable::bind(GlStateCache &state_cache)
+{
+    if (dirty_begin_ < dirty_end_)
+    {
+        state_cache.bindBuffer(GL_UNIFORM_BUFFER, buffer_);
+        glBufferSubData(GL_UNIFORM_BUFFER,
+                        static_cast<GLintptr>(dirty_begin_ * sizeof(GpuMaterial)),
+                        static_cast<GLsizeiptr>((dirty_end_ - dirty_begin_) * sizeof(GpuMaterial)),
+                        gpu_materials_.data() + dirty_begin_);
+        dirty_begin_ = 0;
+        dirty_end_ = 0;
+    }
+    state_cache.bindBufferBase(GL_UNIFORM_BUFFER, kBindingPoint, buffer_);
+    if (texture_array_ != 0)
+        state_cache.bindTexture(kTextureUnit, GL_TEXTURE_2D_ARRAY, texture_array_);
+}
+
+void MaterialTable::attachProgram(GLuint program)
+{
+    const GLuint block = glGetUniformBlockIndex(program, "Materials");
+    if (block != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, block, kBindingPoint);
+}
+
+MaterialTable::GpuMaterial MaterialTable::toGpu(const Material &material)
+{
+    GpuMaterial gpu{};
+    gpu.base_color = glm::vec4(material.base_color, 1.0f);
+    gpu.grid = glm::vec4(material.grid_line_color, material.grid_line_width);
+    gpu.params = glm::vec4(static_cast<float>(std::max(material.albedo_layer, 0)), 0.0f, 0.0f, 0.0f);
+    return gpu;
+}
+
+void MaterialTable::markDirty(std::size_t index)
+{
+    if (dirty_begin_ == dirty_end_)
+    {
+        dirty_begin_ = index;
+        dirty_end_ = index + 1;
+        return;
+    }
+    dirty_begin_ = std::min(dirty_begin_, index);
+    dirty_end_ = std::max(dirty_end_, index + 1);
+}
@@ -1,40 +1,102 @@
 #include "mesh.hpp"
 
-#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
 
-Mesh::Mesh(const std::vector<Vertex> &vertices, const std::vector<unsigned int> &indices)
-    : vertices_(vertices),
-      indices_(indices)
+namespace
 {
-    glGenVertexArrays(1, &vao_);
-    glGenBuffers(1, &vbo_);
-    glGenBuffers(1, &ebo_);
+// 16비트 인덱스로 표현 가능한 최대 정점 수
+constexpr std::size_t kMaxShortIndexVertices = 65536;
+} // namespace
 
-    glBindVertexArray(vao_);
+EncodedMesh encodeMesh(const MeshData &data, VertexFormat format)
+{
+    EncodedMesh encoded;
+    encoded.format = format;
+    encoded.vertex_bytes = VertexLayout::get(format).encode(data.vertices.data(), data.vertices.size());
+    encoded.vertex_count = data.vertices.size();
+
+    float radius = 0.0f;
+    glm::vec3 aabb_min = data.vertices.empty() ? glm::vec3(0.0f) : data.vertices.front().position;
+    glm::vec3 aabb_max = aabb_min;
+    for (const Vertex &vertex : data.vertices)
+    {
+        radius = std::max(radius, glm::length(vertex.position));
+        aabb_min = glm::min(aabb_min, vertex.position);
+        aabb_max = glm::max(aabb_max, vertex.position);
+    }
+    encoded.lod_info.bounding_radius = radius;
+    encoded.lod_info.aabb_min = aabb_min;
+    encoded.lod_info.aabb_max = aabb_max;
 
-    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-    glBufferData(GL_ARRAY_BUFFER, vertices_.size() * sizeof(Vertex), vertices_.data(), GL_STATIC_DRAW);
+    // LOD0 뒤에 LOD1.. 의 인덱스를 이어 붙인다
+    const std::size_t lod_count = std::min(kMaxMeshLods, data.lods.size() + 1);
+    encoded.lods[0] = MeshLodRange{0, static_cast<GLuint>(data.indices.size())};
+    encoded.index_count = data.indices.size();
+    for (std::size_t lod = 1; lod < lod_count; ++lod)
+    {
+        const MeshLodData &level = data.lods[lod - 1];
+        encoded.lods[lod] = MeshLodRange{static_cast<GLuint>(encoded.index_count), static_cast<GLuint>(level.indices.size())};
+        encoded.lod_info.relative_error[lod] = radius > 0.0f ? level.error / radius : 0.0f;
+        encoded.index_count += level.indices.size();
+    }
+    encoded.lod_info.lod_count = static_cast<std::uint8_t>(lod_count);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_.size() * sizeof(unsigned int), indices_.data(), GL_STATIC_DRAW);
+    auto appendIndices = [&](auto *out)
+    {
+        std::size_t cursor = 0;
+        for (unsigned int index : data.indices)
+            out[cursor++] = static_cast<std::remove_pointer_t<decltype(out)>>(index);
+        for (std::size_t lod = 1; lod < lod_count; ++lod)
+        {
+            for (unsigned int index : data.lods[lod - 1].indices)
+                out[cursor++] = static_cast<std::remove_pointer_t<decltype(out)>>(index);
+        }
+    };
 
-    constexpr GLsizei stride = sizeof(Vertex);
-    glEnableVertexAttribArray(0); // 위치
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(offsetof(Vertex, position)));
-    glEnableVertexAttribArray(1); // 법선
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(offsetof(Vertex, normal)));
-    glEnableVertexAttribArray(2); // 텍스처 좌표
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(offsetof(Vertex, texture_coordinates)));
+    if (data.vertices.size() <= kMaxShortIndexVertices)
+    {
+        encoded.index_type = GL_UNSIGNED_SHORT;
+        encoded.index_bytes.resize(encoded.index_count * sizeof(std::uint16_t));
+        appendIndices(reinterpret_cast<std::uint16_t *>(encoded.index_bytes.data()));
+    }
+    else
+    {
+        encoded.index_type = GL_UNSIGNED_INT;
+        encoded.index_bytes.resize(encoded.index_count * sizeof(std::uint32_t));
+        appendIndices(reinterpret_cast<std::uint32_t *>(encoded.index_bytes.data()));
+    }
+    return encoded;
+}
 
-    glBindVertexArray(0);
+Mesh::Mesh(MeshArena &arena, const MeshData &data, bool keep_cpu_copy)
+    : Mesh(arena, encodeMesh(data, arena.layout().format),
+           keep_cpu_copy ? std::make_unique<MeshData>(data) : nullptr)
+{
+}
+
+Mesh::Mesh(MeshArena &arena, const EncodedMesh &encoded, std::unique_ptr<MeshData> cpu_copy)
+    : arena_(&arena),
+      cpu_data_(std::move(cpu_copy))
+{
+    handle_ = arena_->allocate(encoded.vertex_bytes.data(), encoded.vertex_count,
+                               encoded.index_bytes.data(), encoded.index_count, encoded.index_type);
+    lods_ = encoded.lods;
+    lod_info_ = encoded.lod_info;
+}
+
+MeshRange Mesh::getRange(std::size_t lod) const
+{
+    MeshRange range = arena_->range(handle_);
+    const MeshLodRange &level = lods_[std::min<std::size_t>(lod, lod_info_.lod_count - 1)];
+    range.first_index += level.index_offset;
+    range.index_count = level.index_count;
+    return range;
 }
 
 Mesh::~Mesh()
 {
-    if (ebo_ != 0)
-        glDeleteBuffers(1, &ebo_);
-    if (vbo_ != 0)
-        glDeleteBuffers(1, &vbo_);
-    if (vao_ != 0)
-        glDeleteVertexArrays(1, &vao_);
-}
\ No newline at end of file
+    if (arena_ && handle_ != MeshArena::kInvalidHandle)
+        arena_->free(handle_);
+}
@@ -0,0 +1,295 @@
+#include "mesh_arena.hpp"
+
+#include <algorithm>
+
+namespace
+{
+std::size_t indexSize(GLenum index_type)
+{
+    return index_type == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+}
+
+GLuint createBuffer(GLsizeiptr bytes)
+{
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, bytes, nullptr, GL_STATIC_DRAW);
+    return buffer;
+}
+
+// 기존 버퍼 내용을 더 큰 새 버퍼로 옮긴다
+GLuint reallocateBuffer(GLuint old_buffer, GLsizeiptr old_bytes, GLsizeiptr new_bytes)
+{
+    GLuint buffer = createBuffer(new_bytes);
+    glBindBuffer(GL_COPY_READ_BUFFER, old_buffer);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, old_bytes);
+    glDeleteBuffers(1, &old_buffer);
+    return buffer;
+}
+} // namespace
+
+void MeshArena::FreeList::reset(std::size_t capacity)
+{
+    blocks_.clear();
+    if (capacity > 0)
+        blocks_.emplace(0, capacity);
+}
+
+bool MeshArena::FreeList::allocate(std::size_t size, std::size_t &offset)
+{
+    for (auto it = blocks_.begin(); it != blocks_.end(); ++it)
+    {
+        if (it->second < size)
+            continue;
+        offset = it->first;
+        const std::size_t remaining = it->second - size;
+        blocks_.erase(it);
+        if (remaining > 0)
+            blocks_.emplace(offset + size, remaining);
+        return true;
+    }
+    return false;
+}
+
+void MeshArena::FreeList::release(std::size_t offset, std::size_t size)
+{
+    if (size == 0)
+        return;
+
+    auto next = blocks_.lower_bound(offset);
+    if (next != blocks_.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            size += prev->second;
+            blocks_.erase(prev);
+        }
+    }
+    if (next != blocks_.end() && offset + size == next->first)
+    {
+        size += next->second;
+        blocks_.erase(next);
+    }
+    blocks_.emplace(offset, size);
+}
+
+void MeshArena::FreeList::grow(std::size_t old_capacity, std::size_t new_capacity)
+{
+    release(old_capacity, new_capacity - old_capacity);
+}
+
+std::size_t MeshArena::FreeList::largestBlock() const
+{
+    std::size_t largest = 0;
+    for (const auto &[offset, size] : blocks_)
+        largest = std::max(largest, size);
+    return largest;
+}
+
+std::size_t MeshArena::FreeList::totalFree() const
+{
+    std::size_t total = 0;
+    for (const auto &[offset, size] : blocks_)
+        total += size;
+    return total;
+}
+
+MeshArena::MeshArena(const VertexLayout &layout, std::size_t vertex_capacity, std::size_t index_word_capacity)
+    : layout_(layout),
+      vertex_capacity_(std::max<std::size_t>(vertex_capacity, 1)),
+      index_capacity_(std::max<std::size_t>(index_word_capacity, 1))
+{
+    glGenVertexArrays(1, &vao_);
+    createBuffers();
+    vertex_free_.reset(vertex_capacity_);
+    index_free_.reset(index_capacity_);
+}
+
+MeshArena::~MeshArena()
+{
+    if (ebo_ != 0)
+        glDeleteBuffers(1, &ebo_);
+    if (vbo_ != 0)
+        glDeleteBuffers(1, &vbo_);
+    if (vao_ != 0)
+        glDeleteVertexArrays(1, &vao_);
+}
+
+MeshArena::Handle MeshArena::allocate(const void *vertex_data,
+                                      std::size_t vertex_count,
+                                      const void *index_data,
+                                      std::size_t index_count,
+                                      GLenum index_type)
+{
+    const GLsizeiptr vertex_size = layout_.stride;
+    const std::size_t index_bytes = index_count * indexSize(index_type);
+    const std::size_t index_words = (index_bytes + kIndexWordSize - 1) / kIndexWordSize;
+
+    std::size_t vertex_offset = 0;
+    if (!vertex_free_.allocate(vertex_count, vertex_offset))
+    {
+        growVertices(vertex_count);
+        vertex_free_.allocate(vertex_count, vertex_offset);
+    }
+
+    std::size_t index_word_offset = 0;
+    if (!index_free_.allocate(index_words, index_word_offset))
+    {
+        growIndices(index_words);
+        index_free_.allocate(index_words, index_word_offset);
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo_);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(vertex_offset) * vertex_size,
+                    static_cast<GLsizeiptr>(vertex_count) * vertex_size, vertex_data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ebo_);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(index_word_offset * kIndexWordSize),
+                    static_cast<GLsizeiptr>(index_bytes), index_data);
+
+    Handle handle = kInvalidHandle;
+    if (!free_slots_.empty())
+    {
+        handle = free_slots_.back();
+        free_slots_.pop_back();
+    }
+    else
+    {
+        handle = static_cast<Handle>(slots_.size());
+        slots_.emplace_back();
+    }
+
+    Slot &slot = slots_[handle];
+    slot.live = true;
+    slot.index_word_offset = index_word_offset;
+    slot.index_words = index_words;
+    slot.range.base_vertex = static_cast<GLint>(vertex_offset);
+    slot.range.vertex_count = static_cast<GLuint>(vertex_count);
+    slot.range.first_index = static_cast<GLuint>(index_word_offset * kIndexWordSize / indexSize(index_type));
+    slot.range.index_count = static_cast<GLuint>(index_count);
+    slot.range.index_type = index_type;
+    live_vertices_ += vertex_count;
+    live_index_words_ += index_words;
+    return handle;
+}
+
+void MeshArena::free(Handle handle)
+{
+    if (handle >= slots_.size() || !slots_[handle].live)
+        return;
+
+    Slot &slot = slots_[handle];
+    vertex_free_.release(static_cast<std::size_t>(slot.range.base_vertex), slot.range.vertex_count);
+    index_free_.release(slot.index_word_offset, slot.index_words);
+    live_vertices_ -= slot.range.vertex_count;
+    live_index_words_ -= slot.index_words;
+    slot = Slot{};
+    free_slots_.push_back(handle);
+}
+
+void MeshArena::compact()
+{
+    // 같은 버퍼 안에서 겹치는 복사는 정의되지 않으므로 새 버퍼에 앞에서부터 채운다
+    std::vector<Handle> live;
+    for (Handle handle = 0; handle < slots_.size(); ++handle)
+    {
+        if (slots_[handle].live)
+            live.push_back(handle);
+    }
+    std::sort(live.begin(), live.end(), [&](Handle lhs, Handle rhs)
+              { return slots_[lhs].range.base_vertex < slots_[rhs].range.base_vertex; });
+
+    const GLsizeiptr vertex_size = layout_.stride;
+    const GLuint old_vbo = vbo_;
+    const GLuint old_ebo = ebo_;
+    createBuffers();
+
+    std::size_t vertex_cursor = 0;
+    std::size_t index_cursor = 0;
+    for (Handle handle : live)
+    {
+        Slot &slot = slots_[handle];
+        MeshRange &range = slot.range;
+
+        glBindBuffer(GL_COPY_READ_BUFFER, old_vbo);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vbo_);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            static_cast<GLintptr>(range.base_vertex) * vertex_size,
+                            static_cast<GLintptr>(vertex_cursor) * vertex_size,
+                            static_cast<GLsizeiptr>(range.vertex_count) * vertex_size);
+
+        glBindBuffer(GL_COPY_READ_BUFFER, old_ebo);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ebo_);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            static_cast<GLintptr>(slot.index_word_offset * kIndexWordSize),
+                            static_cast<GLintptr>(index_cursor * kIndexWordSize),
+                            static_cast<GLsizeiptr>(slot.index_words * kIndexWordSize));
+
+        range.base_vertex = static_cast<GLint>(vertex_cursor);
+        range.first_index = static_cast<GLuint>(index_cursor * kIndexWordSize / indexSize(range.index_type));
+        slot.index_word_offset = index_cursor;
+        vertex_cursor += range.vertex_count;
+        index_cursor += slot.index_words;
+    }
+
+    glDeleteBuffers(1, &old_vbo);
+    glDeleteBuffers(1, &old_ebo);
+
+    vertex_free_.reset(vertex_capacity_);
+    index_free_.reset(index_capacity_);
+    std::size_t unused = 0;
+    if (vertex_cursor > 0)
+        vertex_free_.allocate(vertex_cursor, unused);
+    if (index_cursor > 0)
+        index_free_.allocate(index_cursor, unused);
+}
+
+float MeshArena::fragmentation() const
+{
+    const std::size_t free_vertices = vertex_free_.totalFree();
+    if (free_vertices == 0)
+        return 0.0f;
+    return 1.0f - static_cast<float>(vertex_free_.largestBlock()) / static_cast<float>(free_vertices);
+}
+
+void MeshArena::createBuffers()
+{
+    vbo_ = createBuffer(static_cast<GLsizeiptr>(vertexBytes()));
+    ebo_ = createBuffer(static_cast<GLsizeiptr>(indexBytes()));
+    setupVertexAttributes();
+}
+
+void MeshArena::setupVertexAttributes()
+{
+    glBindVertexArray(vao_);
+
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+    layout_.apply();
+
+    glBindVertexArray(0);
+}
+
+void MeshArena::growVertices(std::size_t required)
+{
+    const std::size_t old_capacity = vertex_capacity_;
+    const std::size_t new_capacity = std::max(old_capacity * 2, old_capacity + required);
+    vbo_ = reallocateBuffer(vbo_, static_cast<GLsizeiptr>(old_capacity) * layout_.stride,
+                            static_cast<GLsizeiptr>(new_capacity) * layout_.stride);
+    vertex_capacity_ = new_capacity;
+    vertex_free_.grow(old_capacity, new_capacity);
+    setupVertexAttributes();
+}
+
+void MeshArena::growIndices(std::size_t required)
+{
+    const std::size_t old_capacity = index_capacity_;
+    const std::size_t new_capacity = std::max(old_capacity * 2, old_capacity + required);
+    ebo_ = reallocateBuffer(ebo_, static_cast<GLsizeiptr>(old_capacity * kIndexWordSize),
+                            static_cast<GLsizeiptr>(new_capacity * kIndexWordSize));
+    index_capacity_ = new_capacity;
+    index_free_.grow(old_capacity, new_capacity);
+    setupVertexAttributes();
+}
@@ -0,0 +1,301 @@
+#include "mesh_import.hpp"
+#include "mapped_file.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace MeshImport
+{
+namespace
+{
+bool hasExtension(const std::string &path, std::string_view extension)
+{
+    if (path.size() < extension.size())
+        return false;
+    return std::equal(extension.rbegin(), extension.rend(), path.rbegin(), [](char a, char b)
+                      { return a == std::tolower(static_cast<unsigned char>(b)); });
+}
+
+// mmap된 텍스트는 0으로 끝나지 않으므로 strtof 대신 범위를 아는 파서를 쓴다
+class ObjCursor
+{
+public:
+    explicit ObjCursor(std::string_view text) : cur_(text.data()), end_(text.data() + text.size()) {}
+
+    bool atEnd() const { return cur_ >= end_; }
+
+    void skipSpaces()
+    {
+        while (cur_ < end_ && (*cur_ == ' ' || *cur_ == '\t' || *cur_ == '\r'))
+            ++cur_;
+    }
+
+    void skipLine()
+    {
+        while (cur_ < end_ && *cur_ != '\n')
+            ++cur_;
+        if (cur_ < end_)
+            ++cur_;
+    }
+
+    bool atLineEnd() const { return cur_ >= end_ || *cur_ == '\n' || *cur_ == '#'; }
+
+    std::string_view keyword()
+    {
+        skipSpaces();
+        const char *begin = cur_;
+        while (cur_ < end_ && !std::isspace(static_cast<unsigned char>(*cur_)))
+            ++cur_;
+        return {begin, static_cast<std::size_t>(cur_ - begin)};
+    }
+
+    float readFloat()
+    {
+        skipSpaces();
+        bool negative = false;
+        if (cur_ < end_ && (*cur_ == '-' || *cur_ == '+'))
+            negative = *cur_++ == '-';
+
+        double value = 0.0;
+        bool any_digit = false;
+        while (cur_ < end_ && std::isdigit(static_cast<unsigned char>(*cur_)))
+        {
+            value = value * 10.0 + (*cur_++ - '0');
+            any_digit = true;
+        }
+        if (cur_ < end_ && *cur_ == '.')
+        {
+            ++cur_;
+            double scale = 0.1;
+            while (cur_ < end_ && std::isdigit(static_cast<unsigned char>(*cur_)))
+            {
+                value += (*cur_++ - '0') * scale;
+                scale *= 0.1;
+                any_digit = true;
+            }
+        }
+        if (!any_digit)
+            throw std::runtime_error("OBJ: expected number");
+
+        if (cur_ < end_ && (*cur_ == 'e' || *cur_ == 'E'))
+        {
+            ++cur_;
+            const bool negative_exponent = cur_ < end_ && *cur_ == '-';
+            if (cur_ < end_ && (*cur_ == '-' || *cur_ == '+'))
+                ++cur_;
+            int exponent = 0;
+            while (cur_ < end_ && std::isdigit(static_cast<unsigned char>(*cur_)))
+                exponent = exponent * 10 + (*cur_++ - '0');
+            value *= std::pow(10.0, negative_exponent ? -exponent : exponent);
+        }
+        return static_cast<float>(negative ? -value : value);
+    }
+
+    // "v", "v/t", "v//n", "v/t/n". 없는 항목은 0
+    bool readFaceVertex(int &position, int &uv, int &normal)
+    {
+        skipSpaces();
+        if (atLineEnd())
+            return false;
+        position = readInt();
+        uv = 0;
+        normal = 0;
+        if (cur_ < end_ && *cur_ == '/')
+        {
+            ++cur_;
+            if (cur_ < end_ && *cur_ != '/')
+                uv = readInt();
+            if (cur_ < end_ && *cur_ == '/')
+            {
+                ++cur_;
+                normal = readInt();
+            }
+        }
+        return true;
+    }
+
+private:
+    int readInt()
+    {
+        bool negative = false;
+        if (cur_ < end_ && (*cur_ == '-' || *cur_ == '+'))
+            negative = *cur_++ == '-';
+        if (cur_ >= end_ || !std::isdigit(static_cast<unsigned char>(*cur_)))
+            throw std::runtime_error("OBJ: expected index");
+        int value = 0;
+        while (cur_ < end_ && std::isdigit(static_cast<unsigned char>(*cur_)))
+            value = value * 10 + (*cur_++ - '0');
+        return negative ? -value : value;
+    }
+
+    const char *cur_;
+    const char *end_;
+};
+
+// 1 기반, 음수는 끝에서부터. 없으면(0) -1
+int resolveObjIndex(int index, std::size_t count)
+{
+    if (index == 0)
+        return -1;
+    const int resolved = index > 0 ? index - 1 : static_cast<int>(count) + index;
+    if (resolved < 0 || resolved >= static_cast<int>(count))
+        throw std::runtime_error("OBJ: index out of range");
+    return resolved;
+}
+
+struct ObjVertexKey
+{
+    int position;
+    int uv;
+    int normal;
+
+    bool operator==(const ObjVertexKey &other) const
+    {
+        return position == other.position && uv == other.uv && normal == other.normal;
+    }
+};
+
+struct ObjVertexKeyHash
+{
+    std::size_t operator()(const ObjVertexKey &key) const
+    {
+        std::uint64_t h = static_cast<std::uint32_t>(key.position);
+        h = h * 0x9E3779B97F4A7C15ull ^ static_cast<std::uint32_t>(key.uv);
+        h = h * 0x9E3779B97F4A7C15ull ^ static_cast<std::uint32_t>(key.normal);
+        return static_cast<std::size_t>(h ^ (h >> 29));
+    }
+};
+} // namespace
+
+MeshData loadFile(const std::string &path)
+{
+    MappedFile file(path);
+    if (!file.isOpen())
+        throw std::runtime_error("Failed to open mesh: " + path);
+
+    if (hasExtension(path, ".obj"))
+        return parseObj(file.text());
+    if (hasExtension(path, ".glb"))
+        return parseGlb(file.data(), file.size());
+    throw std::runtime_error("Unsupported mesh format: " + path);
+}
+
+MeshData parseObj(std::string_view text)
+{
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec2> uvs;
+    std::unordered_map<ObjVertexKey, unsigned int, ObjVertexKeyHash> vertex_lookup;
+    std::vector<unsigned int> polygon;
+    MeshData mesh;
+
+    ObjCursor cursor(text);
+    while (!cursor.atEnd())
+    {
+        const std::string_view keyword = cursor.keyword();
+        if (keyword == "v")
+        {
+            const float x = cursor.readFloat();
+            const float y = cursor.readFloat();
+            const float z = cursor.readFloat();
+            positions.emplace_back(x, y, z);
+        }
+        else if (keyword == "vn")
+        {
+            const float x = cursor.readFloat();
+            const float y = cursor.readFloat();
+            const float z = cursor.readFloat();
+            normals.emplace_back(x, y, z);
+        }
+        else if (keyword == "vt")
+        {
+            const float u = cursor.readFloat();
+            const float v = cursor.readFloat();
+            uvs.emplace_back(u, v);
+        }
+        else if (keyword == "f")
+        {
+            polygon.clear();
+            int position = 0;
+            int uv = 0;
+            int normal = 0;
+            while (cursor.readFaceVertex(position, uv, normal))
+            {
+                const ObjVertexKey key{resolveObjIndex(position, positions.size()),
+                                       resolveObjIndex(uv, uvs.size()),
+                                       resolveObjIndex(normal, normals.size())};
+                if (key.position < 0)
+                    throw std::runtime_error("OBJ: face without position");
+
+                auto [it, inserted] = vertex_lookup.try_emplace(key, static_cast<unsigned int>(mesh.vertices.size()));
+                if (inserted)
+                {
+                    Vertex vertex{};
+                    vertex.position = positions[static_cast<std::size_t>(key.position)];
+                    vertex.normal = key.normal >= 0 ? normals[static_cast<std::size_t>(key.normal)] : glm::vec3(0.0f);
+                    vertex.texture_coordinates = key.uv >= 0 ? uvs[static_cast<std::size_t>(key.uv)] : glm::vec2(0.0f);
+                    mesh.vertices.push_back(vertex);
+                }
+                polygon.push_back(it->second);
+            }
+            for (std::size_t i = 2; i < polygon.size(); ++i)
+            {
+                mesh.indices.push_back(polygon[0]);
+                mesh.indices.push_back(polygon[i - 1]);
+                mesh.indices.push_back(polygon[i]);
+            }
+        }
+        // o, g, s, usemtl, mtllib 등은 무시한다
+        cursor.skipLine();
+    }
+
+    if (mesh.indices.empty())
+        throw std::runtime_error("OBJ: no faces");
+    fillMissingNormals(mesh);
+    return mesh;
+}
+
+void fillMissingNormals(MeshData &data)
+{
+    std::vector<bool> missing(data.vertices.size(), false);
+    bool any_missing = false;
+    for (std::size_t i = 0; i < data.vertices.size(); ++i)
+    {
+        if (glm::dot(data.vertices[i].normal, data.vertices[i].normal) == 0.0f)
+        {
+            missing[i] = true;
+            any_missing = true;
+        }
+    }
+    if (!any_missing)
+        return;
+
+    for (std::size_t i = 0; i + 2 < data.indices.size(); i += 3)
+    {
+        const unsigned int a = data.indices[i];
+        const unsigned int b = data.indices[i + 1];
+        const unsigned int c = data.indices[i + 2];
+        // 정규화하지 않은 외적 = 면적 가중
+        const glm::vec3 face_normal = glm::cross(data.vertices[b].position - data.vertices[a].position,
+                                                 data.vertices[c].position - data.vertices[a].position);
+        for (unsigned int index : {a, b, c})
+        {
+            if (missing[index])
+                data.vertices[index].normal += face_normal;
+        }
+    }
+
+    for (std::size_t i = 0; i < data.vertices.size(); ++i)
+    {
+        if (!missing[i])
+            continue;
+        const float length = glm::length(data.vertices[i].normal);
+        data.vertices[i].normal = length > 0.0f ? data.vertices[i].normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+}
+} // namespace MeshImport
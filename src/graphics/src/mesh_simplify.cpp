@@ -0,0 +1,433 @@
+#include "mesh_simplify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <queue>
+#include <unordered_map>
+
+namespace MeshSimplify
+{
+namespace
+{
+// 이보다 작은 메시는 LOD를 만들지 않는다
+constexpr std::size_t kMinLodTriangles = 256;
+// 다음 단계가 이전 단계의 이 비율보다 작아지지 않으면 중단
+constexpr float kMinLodReduction = 0.8f;
+// bounding radius 대비 허용 오차 상한
+constexpr float kMaxLodRelativeError = 0.2f;
+// 경계 변을 유지하기 위한 수직 평면의 가중치
+constexpr double kBoundaryWeight = 10.0;
+
+// 대칭 4x4 행렬의 상삼각 10개 원소
+struct Quadric
+{
+    std::array<double, 10> q{};
+
+    void addPlane(const glm::dvec3 &n, double d, double weight)
+    {
+        q[0] += weight * n.x * n.x;
+        q[1] += weight * n.x * n.y;
+        q[2] += weight * n.x * n.z;
+        q[3] += weight * n.x * d;
+        q[4] += weight * n.y * n.y;
+        q[5] += weight * n.y * n.z;
+        q[6] += weight * n.y * d;
+        q[7] += weight * n.z * n.z;
+        q[8] += weight * n.z * d;
+        q[9] += weight * d * d;
+    }
+
+    Quadric &operator+=(const Quadric &other)
+    {
+        for (std::size_t i = 0; i < q.size(); ++i)
+            q[i] += other.q[i];
+        return *this;
+    }
+
+    double evaluate(const glm::dvec3 &p) const
+    {
+        const double x = p.x;
+        const double y = p.y;
+        const double z = p.z;
+        const double value = q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x +
+                             q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y +
+                             q[7] * z * z + 2.0 * q[8] * z + q[9];
+        return std::max(0.0, value);
+    }
+};
+
+struct Collapse
+{
+    double cost;
+    std::uint32_t from;
+    std::uint32_t to;
+    std::uint32_t from_version;
+    std::uint32_t to_version;
+
+    bool operator>(const Collapse &other) const { return cost > other.cost; }
+};
+
+struct PositionKey
+{
+    std::uint32_t x;
+    std::uint32_t y;
+    std::uint32_t z;
+
+    bool operator==(const PositionKey &other) const { return x == other.x && y == other.y && z == other.z; }
+};
+
+struct PositionKeyHash
+{
+    std::size_t operator()(const PositionKey &key) const
+    {
+        std::uint64_t h = key.x;
+        h = h * 0x9E3779B97F4A7C15ull ^ key.y;
+        h = h * 0x9E3779B97F4A7C15ull ^ key.z;
+        return static_cast<std::size_t>(h ^ (h >> 31));
+    }
+};
+
+PositionKey makePositionKey(const glm::vec3 &p)
+{
+    PositionKey key{};
+    // -0.0과 0.0을 같게 취급한다
+    const float x = p.x + 0.0f;
+    const float y = p.y + 0.0f;
+    const float z = p.z + 0.0f;
+    std::memcpy(&key.x, &x, sizeof(float));
+    std::memcpy(&key.y, &y, sizeof(float));
+    std::memcpy(&key.z, &z, sizeof(float));
+    return key;
+}
+
+std::uint64_t edgeKey(std::uint32_t a, std::uint32_t b)
+{
+    if (a > b)
+        std::swap(a, b);
+    return (static_cast<std::uint64_t>(a) << 32) | b;
+}
+
+// 위치가 같은 정점(uv/법선 seam)을 하나로 보고 위치 단위로 collapse 한다.
+// 삼각형 꼭짓점은 원래 정점 index를 유지하고, 이동할 때 목적지 위치의 원래 정점 중 속성이 가장 가까운 것을 고른다
+class Simplifier
+{
+public:
+    explicit Simplifier(const MeshData &mesh) : mesh_(mesh)
+    {
+        weld();
+        buildTriangles();
+        buildQuadrics();
+    }
+
+    std::vector<unsigned int> run(std::size_t target_index_count, float max_error, float *out_error)
+    {
+        const double max_cost = static_cast<double>(max_error) * static_cast<double>(max_error);
+        double worst_cost = 0.0;
+
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> heap;
+        for (const auto &[key, count] : edge_use_)
+        {
+            (void)count;
+            pushEdge(heap, static_cast<std::uint32_t>(key >> 32), static_cast<std::uint32_t>(key & 0xFFFFFFFFu));
+        }
+
+        while (live_triangles_ * 3 > target_index_count && !heap.empty())
+        {
+            const Collapse collapse = heap.top();
+            heap.pop();
+            if (removed_[collapse.from] || removed_[collapse.to] ||
+                version_[collapse.from] != collapse.from_version || version_[collapse.to] != collapse.to_version)
+                continue;
+            if (collapse.cost > max_cost)
+                break;
+            if (!canCollapse(collapse.from, collapse.to))
+                continue;
+
+            apply(collapse.from, collapse.to);
+            worst_cost = std::max(worst_cost, collapse.cost);
+
+            neighbors_.clear();
+            for (std::uint32_t triangle : vertex_triangles_[collapse.to])
+            {
+                if (!alive_[triangle])
+                    continue;
+                for (std::uint32_t corner = 0; corner < 3; ++corner)
+                {
+                    const std::uint32_t position = positionOf(triangle, corner);
+                    if (position != collapse.to)
+                        neighbors_.push_back(position);
+                }
+            }
+            std::sort(neighbors_.begin(), neighbors_.end());
+            neighbors_.erase(std::unique(neighbors_.begin(), neighbors_.end()), neighbors_.end());
+            for (std::uint32_t neighbor : neighbors_)
+                pushEdge(heap, collapse.to, neighbor);
+        }
+
+        if (out_error)
+            *out_error = static_cast<float>(std::sqrt(worst_cost));
+
+        std::vector<unsigned int> indices;
+        indices.reserve(live_triangles_ * 3);
+        for (std::size_t triangle = 0; triangle < alive_.size(); ++triangle)
+        {
+            if (!alive_[triangle])
+                continue;
+            for (std::size_t corner = 0; corner < 3; ++corner)
+                indices.push_back(corners_[triangle * 3 + corner]);
+        }
+        return indices;
+    }
+
+private:
+    void weld()
+    {
+        std::unordered_map<PositionKey, std::uint32_t, PositionKeyHash> lookup;
+        lookup.reserve(mesh_.vertices.size());
+        vertex_position_.resize(mesh_.vertices.size());
+        for (std::size_t vertex = 0; vertex < mesh_.vertices.size(); ++vertex)
+        {
+            const glm::vec3 &p = mesh_.vertices[vertex].position;
+            auto [it, inserted] = lookup.try_emplace(makePositionKey(p), static_cast<std::uint32_t>(positions_.size()));
+            if (inserted)
+            {
+                positions_.emplace_back(p);
+                position_vertices_.emplace_back();
+            }
+            vertex_position_[vertex] = it->second;
+            position_vertices_[it->second].push_back(static_cast<std::uint32_t>(vertex));
+        }
+        removed_.assign(positions_.size(), false);
+        version_.assign(positions_.size(), 0);
+        quadrics_.assign(positions_.size(), Quadric{});
+        vertex_triangles_.resize(positions_.size());
+    }
+
+    void buildTriangles()
+    {
+        const std::vector<unsigned int> &indices = mesh_.indices;
+        corners_.reserve(indices.size());
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const std::uint32_t a = vertex_position_[indices[i]];
+            const std::uint32_t b = vertex_position_[indices[i + 1]];
+            const std::uint32_t c = vertex_position_[indices[i + 2]];
+            if (a == b || b == c || a == c)
+                continue;
+
+            const auto triangle = static_cast<std::uint32_t>(alive_.size());
+            corners_.insert(corners_.end(), {indices[i], indices[i + 1], indices[i + 2]});
+            alive_.push_back(true);
+            for (std::uint32_t position : {a, b, c})
+                vertex_triangles_[position].push_back(triangle);
+            ++edge_use_[edgeKey(a, b)];
+            ++edge_use_[edgeKey(b, c)];
+            ++edge_use_[edgeKey(c, a)];
+        }
+        live_triangles_ = alive_.size();
+    }
+
+    void buildQuadrics()
+    {
+        for (std::uint32_t triangle = 0; triangle < alive_.size(); ++triangle)
+        {
+            const std::uint32_t p[3] = {positionOf(triangle, 0), positionOf(triangle, 1), positionOf(triangle, 2)};
+            const glm::dvec3 normal = faceNormal(positions_[p[0]], positions_[p[1]], positions_[p[2]]);
+            const double length = glm::length(normal);
+            if (length <= 0.0)
+                continue;
+            const glm::dvec3 n = normal / length;
+            const double d = -glm::dot(n, positions_[p[0]]);
+            for (std::uint32_t position : p)
+                quadrics_[position].addPlane(n, d, 1.0);
+
+            // 한 삼각형만 쓰는 변은 경계다. 변을 포함하고 면에 수직인 평면으로 경계가 안쪽으로 말려들지 않게 한다
+            for (std::size_t edge = 0; edge < 3; ++edge)
+            {
+                const std::uint32_t a = p[edge];
+                const std::uint32_t b = p[(edge + 1) % 3];
+                if (edge_use_[edgeKey(a, b)] != 1)
+                    continue;
+                const glm::dvec3 direction = positions_[b] - positions_[a];
+                const glm::dvec3 boundary_normal = glm::cross(direction, n);
+                const double boundary_length = glm::length(boundary_normal);
+                if (boundary_length <= 0.0)
+                    continue;
+                const glm::dvec3 bn = boundary_normal / boundary_length;
+                const double bd = -glm::dot(bn, positions_[a]);
+                quadrics_[a].addPlane(bn, bd, kBoundaryWeight);
+                quadrics_[b].addPlane(bn, bd, kBoundaryWeight);
+            }
+        }
+    }
+
+    std::uint32_t positionOf(std::uint32_t triangle, std::uint32_t corner) const
+    {
+        return vertex_position_[corners_[triangle * 3 + corner]];
+    }
+
+    static glm::dvec3 faceNormal(const glm::dvec3 &a, const glm::dvec3 &b, const glm::dvec3 &c)
+    {
+        return glm::cross(b - a, c - a);
+    }
+
+    template <typename Heap>
+    void pushEdge(Heap &heap, std::uint32_t a, std::uint32_t b)
+    {
+        Quadric combined = quadrics_[a];
+        combined += quadrics_[b];
+        const double cost_to_b = combined.evaluate(positions_[b]);
+        const double cost_to_a = combined.evaluate(positions_[a]);
+        if (cost_to_b <= cost_to_a)
+            heap.push(Collapse{cost_to_b, a, b, version_[a], version_[b]});
+        else
+            heap.push(Collapse{cost_to_a, b, a, version_[b], version_[a]});
+    }
+
+    // from을 to로 옮겼을 때 남는 삼각형이 뒤집히거나 퇴화하면 거부한다
+    bool canCollapse(std::uint32_t from, std::uint32_t to) const
+    {
+        for (std::uint32_t triangle : vertex_triangles_[from])
+        {
+            if (!alive_[triangle])
+                continue;
+
+            glm::dvec3 before[3];
+            glm::dvec3 after[3];
+            bool has_to = false;
+            for (std::uint32_t corner = 0; corner < 3; ++corner)
+            {
+                const std::uint32_t position = positionOf(triangle, corner);
+                has_to = has_to || position == to;
+                before[corner] = positions_[position];
+                after[corner] = positions_[position == from ? to : position];
+            }
+            if (has_to)
+                continue;
+
+            const glm::dvec3 n0 = faceNormal(before[0], before[1], before[2]);
+            const glm::dvec3 n1 = faceNormal(after[0], after[1], after[2]);
+            const double l0 = glm::length(n0);
+            const double l1 = glm::length(n1);
+            if (l1 <= 1e-12 * std::max(1.0, l0))
+                return false;
+            if (l0 > 0.0 && glm::dot(n0, n1) < 0.2 * l0 * l1)
+                return false;
+        }
+        return true;
+    }
+
+    void apply(std::uint32_t from, std::uint32_t to)
+    {
+        for (std::uint32_t triangle : vertex_triangles_[from])
+        {
+            if (!alive_[triangle])
+                continue;
+
+            bool has_to = false;
+            for (std::uint32_t corner = 0; corner < 3; ++corner)
+                has_to = has_to || positionOf(triangle, corner) == to;
+            if (has_to)
+            {
+                alive_[triangle] = false;
+                --live_triangles_;
+                continue;
+            }
+
+            for (std::uint32_t corner = 0; corner < 3; ++corner)
+            {
+                unsigned int &vertex = corners_[triangle * 3 + corner];
+                if (vertex_position_[vertex] == from)
+                    vertex = closestVertexAt(to, vertex);
+            }
+            vertex_triangles_[to].push_back(triangle);
+        }
+
+        quadrics_[to] += quadrics_[from];
+        removed_[from] = true;
+        ++version_[to];
+        vertex_triangles_[from].clear();
+    }
+
+    // 위치 to에 있는 원래 정점 중 법선/uv가 source에 가장 가까운 것
+    std::uint32_t closestVertexAt(std::uint32_t to, std::uint32_t source) const
+    {
+        const Vertex &reference = mesh_.vertices[source];
+        std::uint32_t best = position_vertices_[to].front();
+        float best_score = -1e30f;
+        for (std::uint32_t candidate : position_vertices_[to])
+        {
+            const Vertex &vertex = mesh_.vertices[candidate];
+            const glm::vec2 uv_delta = vertex.texture_coordinates - reference.texture_coordinates;
+            const float score = glm::dot(vertex.normal, reference.normal) - glm::dot(uv_delta, uv_delta);
+            if (score > best_score)
+            {
+                best_score = score;
+                best = candidate;
+            }
+        }
+        return best;
+    }
+
+    const MeshData &mesh_;
+    std::vector<glm::dvec3> positions_;
+    std::vector<std::vector<std::uint32_t>> position_vertices_;
+    std::vector<std::uint32_t> vertex_position_;
+    std::vector<Quadric> quadrics_;
+    std::vector<bool> removed_;
+    std::vector<std::uint32_t> version_;
+
+    std::vector<unsigned int> corners_;
+    std::vector<bool> alive_;
+    std::size_t live_triangles_ = 0;
+    std::vector<std::vector<std::uint32_t>> vertex_triangles_;
+    std::unordered_map<std::uint64_t, std::uint32_t> edge_use_;
+    std::vector<std::uint32_t> neighbors_;
+};
+} // namespace
+
+std::vector<unsigned int> simplify(const MeshData &mesh,
+                                   std::size_t target_index_count,
+                                   float max_error,
+                                   float *out_error)
+{
+    Simplifier simplifier(mesh);
+    return simplifier.run(target_index_count, max_error, out_error);
+}
+
+void generateLods(MeshData &mesh)
+{
+    mesh.lods.clear();
+    const std::size_t triangle_count = mesh.indices.size() / 3;
+    if (triangle_count < kMinLodTriangles)
+        return;
+
+    float radius = 0.0f;
+    for (const Vertex &vertex : mesh.vertices)
+        radius = std::max(radius, glm::length(vertex.position));
+    const float max_error = radius * kMaxLodRelativeError;
+
+    // 매 단계 원본에서 다시 줄여 오차가 누적되지 않게 한다
+    std::size_t previous_count = mesh.indices.size();
+    float previous_error = 0.0f;
+    for (std::size_t level = 1; level < kMaxMeshLods; ++level)
+    {
+        const std::size_t target = (previous_count / 2) / 3 * 3;
+        if (target / 3 < kMinLodTriangles / 4)
+            break;
+
+        float error = 0.0f;
+        std::vector<unsigned int> indices = simplify(mesh, target, max_error, &error);
+        if (indices.empty() || static_cast<float>(indices.size()) > static_cast<float>(previous_count) * kMinLodReduction)
+            break;
+
+        previous_count = indices.size();
+        previous_error = std::max(previous_error, error);
+        mesh.lods.push_back(MeshLodData{std::move(indices), previous_error});
+    }
+}
+} // namespace MeshSimplify
@@ -0,0 +1,347 @@
+#include "occlusion_culler.hpp"
+
+#include "profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OCCLUSION_CULLER_SSE2 1
+#endif
+
+namespace
+{
+// 상자 면 6개를 꼭짓점 인덱스(bit0 = x, bit1 = y, bit2 = z가 max 쪽)로 둘레 순서대로
+constexpr int kBoxFaces[6][4] = {
+    {0, 2, 6, 4},
+    {1, 3, 7, 5},
+    {0, 1, 5, 4},
+    {2, 3, 7, 6},
+    {0, 1, 3, 2},
+    {4, 5, 7, 6},
+};
+// 이보다 작은 화면 면적(texel^2)의 삼각형은 덮는 픽셀이 거의 없으므로 버린다
+constexpr float kMinTriangleArea = 1e-6f;
+
+// 근평면 근처에서 화면 좌표가 매우 커질 수 있으므로 float 상태에서 먼저 자른다
+int clampToInt(float value, int low, int high)
+{
+    return static_cast<int>(std::clamp(value, static_cast<float>(low), static_cast<float>(high)));
+}
+
+std::array<glm::vec4, 8> boxCorners(const glm::mat4 &transform, const glm::vec3 &aabb_min, const glm::vec3 &aabb_max)
+{
+    std::array<glm::vec4, 8> corners;
+    for (int i = 0; i < 8; ++i)
+    {
+        const glm::vec3 corner((i & 1) ? aabb_max.x : aabb_min.x,
+                               (i & 2) ? aabb_max.y : aabb_min.y,
+                               (i & 4) ? aabb_max.z : aabb_min.z);
+        corners[i] = transform * glm::vec4(corner, 1.0f);
+    }
+    return corners;
+}
+
+// 모든 꼭짓점이 clip volume의 같은 평면 밖에 있으면 true
+bool outsideClipVolume(const std::array<glm::vec4, 8> &corners)
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        bool all_below = true;
+        bool all_above = true;
+        for (const glm::vec4 &corner : corners)
+        {
+            all_below = all_below && corner[axis] < -corner.w;
+            all_above = all_above && corner[axis] > corner.w;
+        }
+        if (all_below || all_above)
+            return true;
+    }
+    return false;
+}
+} // namespace
+
+OcclusionCuller::OcclusionCuller()
+{
+    for (int level = 0; level < kMipCount; ++level)
+        levels_[level].assign(static_cast<std::size_t>((kWidth >> level) * (kHeight >> level)), 1.0f);
+}
+
+void OcclusionCuller::beginFrame(const glm::mat4 &view_projection)
+{
+    view_projection_ = view_projection;
+    triangles_.clear();
+    stats_ = {};
+}
+
+void OcclusionCuller::addOccluder(const glm::mat4 &model, const glm::vec3 &aabb_min, const glm::vec3 &aabb_max)
+{
+    const std::array<glm::vec4, 8> corners = boxCorners(view_projection_ * model, aabb_min, aabb_max);
+    if (outsideClipVolume(corners))
+        return;
+
+    // 닫힌 상자라 뒷면은 앞면보다 멀어 depth에 영향이 없으므로 backface culling은 하지 않는다
+    ++stats_.occluders;
+    for (const auto &face : kBoxFaces)
+    {
+        addTriangle(corners[face[0]], corners[face[1]], corners[face[2]]);
+        addTriangle(corners[face[0]], corners[face[2]], corners[face[3]]);
+    }
+}
+
+void OcclusionCuller::addTriangle(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c)
+{
+    // near 평면(z = -w)으로 자른다. 나머지 평면은 타일 범위로 잘린다
+    const glm::vec4 input[3] = {a, b, c};
+    float distance[3];
+    int inside = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        distance[i] = input[i].z + input[i].w;
+        inside += distance[i] >= 0.0f ? 1 : 0;
+    }
+    if (inside == 0)
+        return;
+    if (inside == 3)
+    {
+        setupTriangle(a, b, c);
+        return;
+    }
+
+    glm::vec4 clipped[4];
+    int count = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+        const int next = (i + 1) % 3;
+        if (distance[i] >= 0.0f)
+            clipped[count++] = input[i];
+        if ((distance[i] >= 0.0f) != (distance[next] >= 0.0f))
+        {
+            const float t = distance[i] / (distance[i] - distance[next]);
+            clipped[count++] = input[i] + (input[next] - input[i]) * t;
+        }
+    }
+    for (int i = 1; i + 1 < count; ++i)
+        setupTriangle(clipped[0], clipped[i], clipped[i + 1]);
+}
+
+void OcclusionCuller::setupTriangle(const glm::vec4 &a, const glm::vec4 &b, const glm::vec4 &c)
+{
+    ScreenTriangle triangle;
+    const glm::vec4 *vertices[3] = {&a, &b, &c};
+    for (int i = 0; i < 3; ++i)
+    {
+        const glm::vec4 &clip = *vertices[i];
+        const float inv_w = 1.0f / std::max(clip.w, 1e-6f);
+        triangle.x[i] = (clip.x * inv_w * 0.5f + 0.5f) * static_cast<float>(kWidth);
+        triangle.y[i] = (clip.y * inv_w * 0.5f + 0.5f) * static_cast<float>(kHeight);
+        triangle.z[i] = std::clamp(clip.z * inv_w * 0.5f + 0.5f, 0.0f, 1.0f);
+    }
+
+    const float area = (triangle.x[1] - triangle.x[0]) * (triangle.y[2] - triangle.y[0]) -
+                       (triangle.x[2] - triangle.x[0]) * (triangle.y[1] - triangle.y[0]);
+    if (std::abs(area) < kMinTriangleArea)
+        return;
+    // 래스터라이저는 반시계 방향만 받는다
+    if (area < 0.0f)
+    {
+        std::swap(triangle.x[1], triangle.x[2]);
+        std::swap(triangle.y[1], triangle.y[2]);
+        std::swap(triangle.z[1], triangle.z[2]);
+    }
+    triangles_.push_back(triangle);
+    ++stats_.triangles;
+}
+
+void OcclusionCuller::binTriangles()
+{
+    for (std::vector<std::uint32_t> &bin : bins_)
+        bin.clear();
+
+    for (std::size_t index = 0; index < triangles_.size(); ++index)
+    {
+        const ScreenTriangle &triangle = triangles_[index];
+        const float min_x = std::min({triangle.x[0], triangle.x[1], triangle.x[2]});
+        const float max_x = std::max({triangle.x[0], triangle.x[1], triangle.x[2]});
+        const float min_y = std::min({triangle.y[0], triangle.y[1], triangle.y[2]});
+        const float max_y = std::max({triangle.y[0], triangle.y[1], triangle.y[2]});
+        if (max_x < 0.0f || max_y < 0.0f || min_x >= kWidth || min_y >= kHeight)
+            continue;
+
+        const int tile_x0 = clampToInt(min_x, 0, kWidth - 1) / kTileSize;
+        const int tile_x1 = clampToInt(max_x, 0, kWidth - 1) / kTileSize;
+        const int tile_y0 = clampToInt(min_y, 0, kHeight - 1) / kTileSize;
+        const int tile_y1 = clampToInt(max_y, 0, kHeight - 1) / kTileSize;
+        for (int tile_y = tile_y0; tile_y <= tile_y1; ++tile_y)
+            for (int tile_x = tile_x0; tile_x <= tile_x1; ++tile_x)
+                bins_[tile_y * kTilesX + tile_x].push_back(static_cast<std::uint32_t>(index));
+    }
+}
+
+void OcclusionCuller::finish(ThreadPool &pool)
+{
+    PROFILE_SCOPE("OcclusionCuller::finish");
+    binTriangles();
+    // 타일끼리 쓰는 영역이 겹치지 않으므로 mip까지 타일 단위로 끝낸다
+    pool.parallelFor(bins_.size(), [this](std::size_t tile)
+                     {
+        rasterizeTile(static_cast<int>(tile));
+        buildTileMips(static_cast<int>(tile)); });
+}
+
+void OcclusionCuller::rasterizeTile(int tile)
+{
+    const int tile_x0 = (tile % kTilesX) * kTileSize;
+    const int tile_y0 = (tile / kTilesX) * kTileSize;
+    float *depth = levels_[0].data();
+    for (int y = tile_y0; y < tile_y0 + kTileSize; ++y)
+        std::fill_n(depth + y * kWidth + tile_x0, kTileSize, 1.0f);
+
+    for (std::uint32_t index : bins_[tile])
+    {
+        const ScreenTriangle &t = triangles_[index];
+
+        // 픽셀 중심(+0.5)이 bounding box 안에 드는 범위. x는 4픽셀 단위로 맞춘다
+        const float min_x = std::min({t.x[0], t.x[1], t.x[2]});
+        const float max_x = std::max({t.x[0], t.x[1], t.x[2]});
+        const float min_y = std::min({t.y[0], t.y[1], t.y[2]});
+        const float max_y = std::max({t.y[0], t.y[1], t.y[2]});
+        const int x0 = clampToInt(std::ceil(min_x - 0.5f), tile_x0, tile_x0 + kTileSize) & ~3;
+        const int x1 = clampToInt(std::floor(max_x - 0.5f), tile_x0 - 1, tile_x0 + kTileSize - 1);
+        const int y0 = clampToInt(std::ceil(min_y - 0.5f), tile_y0, tile_y0 + kTileSize);
+        const int y1 = clampToInt(std::floor(max_y - 0.5f), tile_y0 - 1, tile_y0 + kTileSize - 1);
+        if (x0 > x1 || y0 > y1)
+            continue;
+
+        // edge i: 꼭짓점 i -> i+1. 반시계 방향이므로 안쪽이 양수
+        float edge_a[3];
+        float edge_b[3];
+        float edge_c[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            const int j = (i + 1) % 3;
+            edge_a[i] = t.y[i] - t.y[j];
+            edge_b[i] = t.x[j] - t.x[i];
+            edge_c[i] = -edge_a[i] * t.x[i] - edge_b[i] * t.y[i];
+        }
+
+        const float area = (t.x[1] - t.x[0]) * (t.y[2] - t.y[0]) - (t.x[2] - t.x[0]) * (t.y[1] - t.y[0]);
+        const float dz_dx = ((t.z[1] - t.z[0]) * (t.y[2] - t.y[0]) - (t.z[2] - t.z[0]) * (t.y[1] - t.y[0])) / area;
+        const float dz_dy = ((t.z[2] - t.z[0]) * (t.x[1] - t.x[0]) - (t.z[1] - t.z[0]) * (t.x[2] - t.x[0])) / area;
+        const float z_c = t.z[0] - dz_dx * t.x[0] - dz_dy * t.y[0];
+
+        const float start_x = static_cast<float>(x0) + 0.5f;
+        for (int y = y0; y <= y1; ++y)
+        {
+            const float py = static_cast<float>(y) + 0.5f;
+            float *row = depth + y * kWidth;
+#ifdef OCCLUSION_CULLER_SSE2
+            const __m128 offsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+            const __m128 px = _mm_add_ps(_mm_set1_ps(start_x), offsets);
+            __m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edge_a[0]), px), _mm_set1_ps(edge_b[0] * py + edge_c[0]));
+            __m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edge_a[1]), px), _mm_set1_ps(edge_b[1] * py + edge_c[1]));
+            __m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edge_a[2]), px), _mm_set1_ps(edge_b[2] * py + edge_c[2]));
+            __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(dz_dx), px), _mm_set1_ps(dz_dy * py + z_c));
+            const __m128 step0 = _mm_set1_ps(edge_a[0] * 4.0f);
+            const __m128 step1 = _mm_set1_ps(edge_a[1] * 4.0f);
+            const __m128 step2 = _mm_set1_ps(edge_a[2] * 4.0f);
+            const __m128 step_z = _mm_set1_ps(dz_dx * 4.0f);
+            const __m128 zero = _mm_setzero_ps();
+            for (int x = x0; x <= x1; x += 4)
+            {
+                const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)),
+                                                 _mm_cmpge_ps(e2, zero));
+                if (_mm_movemask_ps(inside) != 0)
+                {
+                    const __m128 old_depth = _mm_loadu_ps(row + x);
+                    const __m128 nearest = _mm_min_ps(old_depth, z);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old_depth)));
+                }
+                e0 = _mm_add_ps(e0, step0);
+                e1 = _mm_add_ps(e1, step1);
+                e2 = _mm_add_ps(e2, step2);
+                z = _mm_add_ps(z, step_z);
+            }
+#else
+            for (int x = x0; x <= x1; ++x)
+            {
+                const float px = static_cast<float>(x) + 0.5f;
+                if (edge_a[0] * px + edge_b[0] * py + edge_c[0] < 0.0f ||
+                    edge_a[1] * px + edge_b[1] * py + edge_c[1] < 0.0f ||
+                    edge_a[2] * px + edge_b[2] * py + edge_c[2] < 0.0f)
+                    continue;
+                row[x] = std::min(row[x], dz_dx * px + dz_dy * py + z_c);
+            }
+#endif
+        }
+    }
+}
+
+void OcclusionCuller::buildTileMips(int tile)
+{
+    // 상위 level은 2x2 중 가장 먼 depth. 이 값보다 멀면 그 영역 전체에서 가려진다
+    for (int level = 1; level < kMipCount; ++level)
+    {
+        const int size = kTileSize >> level;
+        const int x0 = (tile % kTilesX) * size;
+        const int y0 = (tile / kTilesX) * size;
+        const int width = kWidth >> level;
+        const int src_width = width * 2;
+        const float *src = levels_[level - 1].data();
+        float *dst = levels_[level].data();
+        for (int y = y0; y < y0 + size; ++y)
+        {
+            for (int x = x0; x < x0 + size; ++x)
+            {
+                const float *top = src + (y * 2) * src_width + x * 2;
+                const float *bottom = top + src_width;
+                dst[y * width + x] = std::max({top[0], top[1], bottom[0], bottom[1]});
+            }
+        }
+    }
+}
+
+bool OcclusionCuller::isVisible(const glm::mat4 &model, const glm::vec3 &aabb_min, const glm::vec3 &aabb_max) const
+{
+    const std::array<glm::vec4, 8> corners = boxCorners(view_projection_ * model, aabb_min, aabb_max);
+
+    float min_x = static_cast<float>(kWidth);
+    float max_x = 0.0f;
+    float min_y = static_cast<float>(kHeight);
+    float max_y = 0.0f;
+    float min_z = 1.0f;
+    for (const glm::vec4 &clip : corners)
+    {
+        // near 평면에 걸치면 화면 사각형을 믿을 수 없다
+        if (clip.z < -clip.w || clip.w <= 1e-6f)
+            return true;
+        const float inv_w = 1.0f / clip.w;
+        const float x = (clip.x * inv_w * 0.5f + 0.5f) * static_cast<float>(kWidth);
+        const float y = (clip.y * inv_w * 0.5f + 0.5f) * static_cast<float>(kHeight);
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+        min_z = std::min(min_z, clip.z * inv_w * 0.5f + 0.5f);
+    }
+    if (max_x < 0.0f || max_y < 0.0f || min_x >= kWidth || min_y >= kHeight)
+        return true;
+
+    // occluder 가장자리는 픽셀 중심 기준이라 반 texel까지 넘쳐 보일 수 있으므로 1 texel 넓혀 본다
+    const int x0 = clampToInt(std::floor(min_x) - 1.0f, 0, kWidth - 1);
+    const int x1 = clampToInt(std::floor(max_x) + 1.0f, 0, kWidth - 1);
+    const int y0 = clampToInt(std::floor(min_y) - 1.0f, 0, kHeight - 1);
+    const int y1 = clampToInt(std::floor(max_y) + 1.0f, 0, kHeight - 1);
+
+    int level = 0;
+    while (level + 1 < kMipCount && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+        ++level;
+
+    const int width = kWidth >> level;
+    const float *depth = levels_[level].data();
+    for (int y = y0 >> level; y <= (y1 >> level); ++y)
+        for (int x = x0 >> level; x <= (x1 >> level); ++x)
+            if (min_z <= depth[y * width + x])
+                return true;
+    return false;
+}
@@ -0,0 +1,114 @@
+#include "pixel_readback.hpp"
+
+#include <algorithm>
+
+namespace
+{
+// 칸이 이만큼 크고 요청보다 kShrinkRatio배 넘게 크면 요청 크기로 다시 잡는다.
+// 전체 화면 marquee 한 번이 모든 칸을 계속 크게 붙잡지 않게 하고, 비슷한 크기끼리는 재할당하지 않는다
+constexpr std::size_t kShrinkMinBytes = 64 * 1024;
+constexpr std::size_t kShrinkRatio = 4;
+} // namespace
+
+PixelReadback::PixelReadback(std::size_t slot_count)
+    : slots_(std::max<std::size_t>(slot_count, 1))
+{
+    for (Slot &slot : slots_)
+        glGenBuffers(1, &slot.buffer);
+}
+
+PixelReadback::~PixelReadback()
+{
+    for (Slot &slot : slots_)
+    {
+        if (slot.fence)
+            glDeleteSync(slot.fence);
+        glDeleteBuffers(1, &slot.buffer);
+    }
+}
+
+bool PixelReadback::request(GLuint framebuffer, int x, int y, int width, int height, std::span<const Region> regions,
+                            std::uint64_t tag)
+{
+    if (width <= 0 || height <= 0 || regions.empty())
+        return false;
+    if (count_ == slots_.size())
+    {
+        ++dropped_;
+        return false;
+    }
+
+    const auto pixels = static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    std::size_t size = 0;
+    for (const Region &region : regions)
+        size += pixels * region.pixel_size;
+
+    Slot &slot = slots_[(head_ + count_) % slots_.size()];
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (size > slot.capacity || (slot.capacity > kShrinkMinBytes && slot.capacity / kShrinkRatio > size))
+    {
+        slot.capacity = size;
+        glBufferData(GL_PIXEL_PACK_BUFFER, static_cast<GLsizeiptr>(slot.capacity), nullptr, GL_STREAM_READ);
+    }
+
+    // PBO가 묶여 있으면 glReadPixels의 포인터는 버퍼 안 offset이고 바로 돌아온다
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    std::size_t offset = 0;
+    for (const Region &region : regions)
+    {
+        if (region.attachment != GL_DEPTH_ATTACHMENT)
+            glReadBuffer(region.attachment);
+        glReadPixels(x, y, width, height, region.format, region.type, reinterpret_cast<void *>(offset));
+        offset += pixels * region.pixel_size;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.size = size;
+    slot.tag = tag;
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++count_;
+    return true;
+}
+
+bool PixelReadback::mapReady(std::uint64_t &tag, std::span<const std::byte> &data)
+{
+    while (count_ > 0)
+    {
+        Slot &slot = slots_[head_];
+        // timeout 0: 끝났는지만 본다. flush 비트로 fence가 GPU에 실제로 제출되게 한다
+        const GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if (status == GL_TIMEOUT_EXPIRED)
+            return false;
+        if (status != GL_WAIT_FAILED)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+            const void *mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(slot.size), GL_MAP_READ_BIT);
+            if (mapped)
+            {
+                tag = slot.tag;
+                data = std::span<const std::byte>(static_cast<const std::byte *>(mapped), slot.size);
+                return true;
+            }
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+        // fence나 map이 실패한 요청은 버리고 다음 요청을 본다
+        ++dropped_;
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        head_ = (head_ + 1) % slots_.size();
+        --count_;
+    }
+    return false;
+}
+
+void PixelReadback::releaseOldest()
+{
+    Slot &slot = slots_[head_];
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    head_ = (head_ + 1) % slots_.size();
+    --count_;
+}
@@ -1,6 +1,7 @@
 #include "primitives.hpp"
 
 #include <glm/glm.hpp>
+#include <utility>
 
 namespace Primitives
 {
@@ -12,10 +13,10 @@ Vertex makeVertex(const glm::vec3 &pos, const glm::vec3 &normal, const glm::vec2
 }
 } // namespace
 
-std::unique_ptr<Mesh> createCube()
+MeshData createCube()
 {
     // 각 면마다 고유한 법선을 갖도록 24개의 정점 정의
-    const std::vector<Vertex> vertices = {
+    std::vector<Vertex> vertices = {
         // 앞면
         makeVertex({-0.5f, -0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f}),
         makeVertex({0.5f, -0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}, {1.0f, 0.0f}),
@@ -53,7 +54,7 @@ std::unique_ptr<Mesh> createCube()
         makeVertex({-0.5f, 0.5f, -0.5f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}),
     };
 
-    const std::vector<unsigned int> indices = {
+    std::vector<unsigned int> indices = {
         0, 1, 2, 0, 2, 3,       // 앞면
         4, 5, 6, 4, 6, 7,       // 뒷면
         8, 9, 10, 8, 10, 11,    // 왼쪽면
@@ -62,22 +63,22 @@ std::unique_ptr<Mesh> createCube()
         20, 21, 22, 20, 22, 23  // 윗면
     };
 
-    return std::make_unique<Mesh>(vertices, indices);
+    return MeshData{std::move(vertices), std::move(indices), {}};
 }
 
-std::unique_ptr<Mesh> createPlane(float width, float height)
+MeshData createPlane(float width, float height)
 {
     const float half_width = width * 0.5f;
     const float half_height = height * 0.5f;
 
-    const std::vector<Vertex> vertices = {
+    std::vector<Vertex> vertices = {
         makeVertex({-half_width, 0.0f, -half_height}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f}),
         makeVertex({half_width, 0.0f, -half_height}, {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f}),
         makeVertex({half_width, 0.0f, half_height}, {0.0f, 1.0f, 0.0f}, {1.0f, 1.0f}),
         makeVertex({-half_width, 0.0f, half_height}, {0.0f, 1.0f, 0.0f}, {0.0f, 1.0f}),
     };
 
-    const std::vector<unsigned int> indices = {0, 1, 2, 0, 2, 3};
-    return std::make_unique<Mesh>(vertices, indices);
+    std::vector<unsigned int> indices = {0, 1, 2, 0, 2, 3};
+    return MeshData{std::move(vertices), std::move(indices), {}};
 }
 } // namespace Primitives
\ No newline at end of file
@@ -0,0 +1,190 @@
+#include "render_thread.hpp"
+
+#include "profiler.hpp"
+#include <utility>
+
+RenderThread::RenderThread(Renderer &renderer)
+    : renderer_(renderer)
+{
+    shared_version_ = renderer_.getResourceVersion();
+    published_version_ = shared_version_;
+    synced_version_ = shared_version_;
+    mesh_lods_ = renderer_.getMeshLodTable();
+    material_variants_ = renderer_.getMaterialVariants();
+
+    // context는 한 번에 한 스레드에서만 current일 수 있다
+    glfwMakeContextCurrent(nullptr);
+    thread_ = std::thread(&RenderThread::threadLoop, this);
+}
+
+RenderThread::~RenderThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    if (thread_.joinable())
+        thread_.join();
+    // Renderer 소멸자가 GL 객체를 지울 수 있도록 context를 돌려준다
+    glfwMakeContextCurrent(renderer_.getWindowPtr());
+}
+
+void RenderThread::submit(FramePacket &&packet)
+{
+    PROFILE_SCOPE("RenderThread::submit");
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_cv_.wait(lock, [this]
+                       { return packet_count_ < kMaxQueuedFrames; });
+        packets_[(packet_head_ + packet_count_) % kMaxQueuedFrames].emplace(std::move(packet));
+        ++packet_count_;
+    }
+    work_cv_.notify_one();
+    syncResources();
+}
+
+void RenderThread::post(std::function<void(Renderer &)> command)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        commands_.push_back(std::move(command));
+    }
+    work_cv_.notify_one();
+}
+
+void RenderThread::flush()
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        space_cv_.wait(lock, [this]
+                       { return packet_count_ == 0 && commands_.empty() && !busy_; });
+    }
+    syncResources();
+}
+
+void RenderThread::takePickResults(EntityPickResults &out)
+{
+    out.clear();
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::swap(out, shared_picks_);
+}
+
+FrameResult RenderThread::lastResult() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return result_;
+}
+
+void RenderThread::threadLoop()
+{
+    glfwMakeContextCurrent(renderer_.getWindowPtr());
+    Profiler::instance().setThreadName("render");
+
+    std::vector<std::function<void(Renderer &)>> commands;
+    while (true)
+    {
+        std::optional<FramePacket> packet;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this]
+                          { return stopping_ || packet_count_ > 0 || !commands_.empty(); });
+            // 종료 요청이 와도 이미 넘겨받은 packet과 명령은 끝낸다
+            if (packet_count_ == 0 && commands_.empty())
+                break;
+
+            commands.swap(commands_);
+            if (packet_count_ > 0)
+            {
+                packet = std::move(packets_[packet_head_]);
+                packets_[packet_head_].reset();
+                packet_head_ = (packet_head_ + 1) % kMaxQueuedFrames;
+                --packet_count_;
+            }
+            busy_ = true;
+        }
+        // 빈 칸이 생겼으므로 메인 스레드는 다음 프레임을 넘길 수 있다
+        space_cv_.notify_all();
+
+        for (const auto &command : commands)
+            command(renderer_);
+        commands.clear();
+
+        FrameResult result;
+        if (packet)
+        {
+            PROFILE_SCOPE("RenderThread::frame");
+            const std::int64_t work_begin = Profiler::now();
+            if (packet->viewport_width != viewport_width_ || packet->viewport_height != viewport_height_)
+            {
+                viewport_width_ = packet->viewport_width;
+                viewport_height_ = packet->viewport_height;
+                glViewport(0, 0, viewport_width_, viewport_height_);
+            }
+            renderer_.processUploads(packet->upload_budget_ms);
+            if (packet->has_directional_light)
+                renderer_.setDirectionalLight(packet->light_direction, packet->light_color, packet->ambient_color);
+            renderer_.setHighlightEntity(packet->highlight_entity);
+            renderer_.draw(packet->queue, packet->view, packet->projection);
+            for (const EntityPickQuery &query : packet->pick_queries)
+                renderer_.requestEntityPick(query);
+            for (const CameraSensorView &sensor : packet->camera_sensors)
+                camera_sensors_.render(renderer_, sensor);
+            result.render_work_ns = Profiler::now() - work_begin;
+            {
+                PROFILE_SCOPE("Renderer::swapBuffers");
+                renderer_.swapBuffers();
+            }
+            result.present_ns = Profiler::now();
+            // swap 뒤라 앞선 프레임의 readback은 대개 끝나 있다. 끝나지 않은 것은 다음 프레임에 본다
+            camera_sensors_.collect();
+            result.camera = camera_sensors_.stats();
+            renderer_.collectEntityPicks(completed_picks_);
+
+            result.render = renderer_.getRenderStats();
+            result.state = renderer_.getStateStats();
+            if (packet->input_timestamp_ns >= 0)
+                result.input_to_swap_ms = static_cast<double>(result.present_ns - packet->input_timestamp_ns) * 1.0e-6;
+        }
+        publishResources();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (packet)
+            {
+                result.frame = result_.frame + 1;
+                result_ = result;
+            }
+            shared_picks_.append(completed_picks_);
+            busy_ = false;
+        }
+        completed_picks_.clear();
+        space_cv_.notify_all();
+    }
+
+    camera_sensors_.release();
+    glfwMakeContextCurrent(nullptr);
+}
+
+void RenderThread::publishResources()
+{
+    const std::uint64_t version = renderer_.getResourceVersion();
+    if (version == published_version_)
+        return;
+    published_version_ = version;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    shared_mesh_lods_ = renderer_.getMeshLodTable();
+    shared_material_variants_ = renderer_.getMaterialVariants();
+    shared_version_ = version;
+}
+
+void RenderThread::syncResources()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (shared_version_ == synced_version_)
+        return;
+    mesh_lods_ = shared_mesh_lods_;
+    material_variants_ = shared_material_variants_;
+    synced_version_ = shared_version_;
+}
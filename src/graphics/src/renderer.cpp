@@ -1,12 +1,20 @@
 #include "renderer.hpp"
+#include "gl_debug.hpp"
+#include "mesh_import.hpp"
+#include "mesh_simplify.hpp"
 #include "primitives.hpp"
+#include "profiler.hpp"
 #include "render_data.hpp"
 #include "shader.hpp"
+#include "thread_pool.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <glm/ext/matrix_transform.hpp>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
+#include <stdexcept>
 
 namespace
 {
@@ -16,12 +24,100 @@ constexpr float kClearColorB = 0.08F;
 constexpr float kClearColorA = 1.0F;
 const std::string kVertexShader = std::string(SHADER_ASSET_DIR) + "/shader_vertex";
 const std::string kFragmentShader = std::string(SHADER_ASSET_DIR) + "/shader_fragment";
+const std::string kShadowVertexShader = std::string(SHADER_ASSET_DIR) + "/shadow_vertex";
+const std::string kShadowFragmentShader = std::string(SHADER_ASSET_DIR) + "/shadow_fragment";
+
+constexpr std::size_t kInitialArenaVertices = 64 * 1024;
+constexpr std::size_t kInitialArenaIndexWords = 128 * 1024;
+// arena(정점 포맷) x index type. variant별로 다시 나눈다
+constexpr std::size_t kArenaGroupCount = kVertexFormatCount * 2;
+constexpr std::size_t kBatchGroupCount = kShaderVariantCount * kArenaGroupCount;
+constexpr std::size_t kInitialInstanceCapacity = 1024;
+constexpr float kCompactFragmentation = 0.5f;
+
+const glm::vec3 kDefaultLightDirection{-0.4f, -1.0f, -0.3f};
+const glm::vec3 kDefaultLightColor{0.85f, 0.85f, 0.8f};
+const glm::vec3 kDefaultAmbientColor{0.25f, 0.25f, 0.3f};
+
+// shadow depth pass의 glPolygonOffset (slope, constant)
+constexpr float kShadowSlopeBias = 2.0f;
+constexpr float kShadowConstantBias = 4.0f;
+
+// shader_vertex의 instance attribute 위치
+constexpr GLuint kInstanceModelLocation = 3; // mat4: 3, 4, 5, 6
+constexpr GLuint kInstanceMaterialLocation = 7;
+constexpr GLuint kInstanceEntityLocation = 8;
+
+#ifndef __APPLE__
+using MultiDrawElementsIndirectFn = PFNGLMULTIDRAWELEMENTSINDIRECTPROC;
+#endif
+
+// color 0 = RGBA, color 1 = entity id, depth를 가진 현재 framebuffer를 비운다
+void clearEntityTarget()
+{
+    const GLfloat clear_color[4] = {kClearColorR, kClearColorG, kClearColorB, kClearColorA};
+    const GLuint clear_entity[4] = {kNoRenderEntity, 0, 0, 0};
+    const GLfloat clear_depth = 1.0f;
+    glClearBufferfv(GL_COLOR, 0, clear_color);
+    glClearBufferuiv(GL_COLOR, 1, clear_entity);
+    glClearBufferfv(GL_DEPTH, 0, &clear_depth);
+}
+
+std::size_t batchGroupOf(ShaderVariant variant, const MeshArena &arena, GLenum index_type)
+{
+    const std::size_t arena_group = static_cast<std::size_t>(arena.layout().format) * 2 + (index_type == GL_UNSIGNED_SHORT ? 1 : 0);
+    return static_cast<std::size_t>(variant % kShaderVariantCount) * kArenaGroupCount + arena_group;
+}
+
+std::vector<std::string> variantDefines(ShaderVariant variant)
+{
+    std::vector<std::string> defines = {"MAX_MATERIALS " + std::to_string(MaterialTable::kMaxMaterials),
+                                        "SHADOW_CASCADES " + std::to_string(CascadedShadowMap::kCascadeCount)};
+    if (variant & ShaderFeature::Grid)
+        defines.emplace_back("FEATURE_GRID");
+    if (variant & ShaderFeature::Lit)
+        defines.emplace_back("FEATURE_LIT");
+    if (variant & ShaderFeature::Textured)
+        defines.emplace_back("FEATURE_TEXTURED");
+    if (variant & ShaderFeature::Instanced)
+        defines.emplace_back("FEATURE_INSTANCED");
+    return defines;
+}
+
+std::size_t indexSize(GLenum index_type)
+{
+    return index_type == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(std::uint32_t);
+}
 } // namespace
 
 Renderer::~Renderer()
 {
-    if (shader_program_ != 0)
-        glDeleteProgram(shader_program_);
+    // Mesh는 arena에 구간을 반납하므로 arena보다 먼저, context가 살아있을 때 정리한다
+    meshes_.clear();
+    for (auto &arena : mesh_arenas_)
+        arena.reset();
+    material_table_.reset();
+    if (instance_buffer_ != 0)
+        glDeleteBuffers(1, &instance_buffer_);
+    if (indirect_buffer_ != 0)
+        glDeleteBuffers(1, &indirect_buffer_);
+    shadow_map_.reset();
+    gpu_timer_.reset();
+    entity_ids_.reset();
+    for (ProgramVariant &variant : shadow_programs_)
+    {
+        if (variant.program == 0)
+            continue;
+        state_cache_.forgetProgram(variant.program);
+        glDeleteProgram(variant.program);
+    }
+    for (ProgramVariant &variant : programs_)
+    {
+        if (variant.program == 0)
+            continue;
+        state_cache_.forgetProgram(variant.program);
+        glDeleteProgram(variant.program);
+    }
     if (window_ptr_)
     {
         glfwDestroyWindow(window_ptr_);
@@ -30,7 +126,7 @@ Renderer::~Renderer()
     glfwTerminate();
 }
 
-bool Renderer::init(int width, int height, const std::string &title)
+bool Renderer::init(int width, int height, const std::string &title, bool visible)
 {
     width_ = width;
     height_ = height;
@@ -47,6 +143,8 @@ bool Renderer::init(int width, int height, const std::string &title)
 #ifdef __APPLE__
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
+    GlDebug::applyContextHints();
+    glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
 
     window_ptr_ = glfwCreateWindow(width,
                                    height,
@@ -60,7 +158,7 @@ bool Renderer::init(int width, int height, const std::string &title)
         return false;
     }
     glfwMakeContextCurrent(window_ptr_);
-    glfwSwapInterval(1);
+    glfwSwapInterval(visible ? 1 : 0);
     std::clog << "[renderer] window created: " << width << "x" << height << " (" << title << ")" << std::endl;
 
     int framebuffer_width = width;
@@ -70,11 +168,22 @@ bool Renderer::init(int width, int height, const std::string &title)
     glEnable(GL_DEPTH_TEST);
 
     std::clog << "[renderer] GL version: " << reinterpret_cast<const char *>(glGetString(GL_VERSION)) << std::endl;
+    GlDebug::installMessageCallback();
 
     try
     {
-        shader_program_ = loadShaders(kVertexShader, kFragmentShader);
+        shader_cache_ = std::make_unique<ShaderCache>(SHADER_CACHE_DIR);
+        material_table_ = std::make_unique<MaterialTable>();
+        setDirectionalLight(kDefaultLightDirection, kDefaultLightColor, kDefaultAmbientColor);
+        loadShaders(kVertexShader, kFragmentShader);
+        shadow_map_ = std::make_unique<CascadedShadowMap>();
+        gpu_timer_ = std::make_unique<GpuTimer>();
+        entity_ids_ = std::make_unique<EntityIdBuffer>();
+        const ShaderCacheStats &shader_stats = shader_cache_->stats();
         std::clog << "[renderer] shaders loaded: " << kVertexShader << ", " << kFragmentShader << std::endl;
+        std::clog << "[renderer] shader startup: " << shader_stats.total_ms << " ms (cache hits " << shader_stats.hits
+                  << ", misses " << shader_stats.misses << ", rejected " << shader_stats.rejected
+                  << (shader_cache_->binarySupported() ? "" : ", program binaries unsupported") << ")" << std::endl;
     }
     catch (const std::exception &ex)
     {
@@ -82,54 +191,181 @@ bool Renderer::init(int width, int height, const std::string &title)
         return false;
     }
 
+    for (std::size_t format = 0; format < kVertexFormatCount; ++format)
+    {
+        const VertexLayout &layout = VertexLayout::get(static_cast<VertexFormat>(format));
+        mesh_arenas_[format] = std::make_unique<MeshArena>(layout, kInitialArenaVertices, kInitialArenaIndexWords);
+    }
+    initBatching();
     registerBuiltinMeshes();
     return true;
 }
 
 void Renderer::draw(const RenderQueue &queue, const glm::mat4 &view, const glm::mat4 &projection)
 {
-    auto log_error = [](const char *where)
+    PROFILE_SCOPE("Renderer::draw");
+    state_cache_.resetStats();
+    render_stats_.reset();
+    gpu_timer_->beginFrame();
+
+    instances_.clear();
+    draw_commands_.clear();
+    batches_.clear();
+    shadow_static_batches_.clear();
+    shadow_dynamic_batches_.clear();
+
+    // shadow 명령도 같은 instance/indirect 버퍼에 담아 한 번에 올린다
+    const bool shadows = config_.shadows && shadow_map_;
+    std::uint32_t static_cascades = 0;
+    if (shadows)
     {
-        GLenum err = glGetError();
-        if (err != GL_NO_ERROR)
-        {
-            std::clog << "[renderer] gl error at " << where << ": 0x" << std::hex << err << std::dec << std::endl;
-        }
-    };
-
-    glClearColor(kClearColorR, kClearColorG, kClearColorB, kClearColorA);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glUseProgram(shader_program_);
-    log_error("glUseProgram");
+        static_cascades = shadow_map_->update(view, projection, -light_direction_, queue.staticCasterSignature());
+        constexpr std::uint8_t kMask = RenderItemFlag::Static | RenderItemFlag::CastsShadow;
+        if (static_cascades != 0)
+            appendBatches(queue.opaque, true, shadow_static_batches_, BatchFilter{kMask, kMask, false});
+        appendBatches(queue.opaque, true, shadow_dynamic_batches_, BatchFilter{kMask, RenderItemFlag::CastsShadow, false});
+    }
+    appendBatches(queue.opaque, true, batches_, BatchFilter{RenderItemFlag::Hidden, 0, true});
+    appendBatches(queue.transparent, false, batches_, BatchFilter{});
 
-    glUniformMatrix4fv(view_loc_, 1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(projection_loc_, 1, GL_FALSE, glm::value_ptr(projection));
-    log_error("set view/projection");
+    if (!draw_commands_.empty())
+        uploadBatches();
+    if (shadows)
+    {
+        PROFILE_SCOPE("Renderer::shadows");
+        gpu_timer_->begin("shadow pass");
+        renderShadows(static_cascades);
+        gpu_timer_->end();
+    }
 
-    auto draw_item = [&](const RenderItem &item)
+    PROFILE_SCOPE("Renderer::main");
+    gpu_timer_->begin("main pass");
+    // entity id를 함께 쓰는 FBO에 그리고 color만 화면으로 옮긴다. geometry pass가 늘지 않는다
+    const bool entity_ids = prepareEntityIds();
+    if (entity_ids)
     {
-        Mesh *mesh = getMeshFromId(static_cast<int>(item.mesh_handle));
-        if (!mesh)
-            return;
+        glBindFramebuffer(GL_FRAMEBUFFER, entity_ids_->framebuffer());
+        clearEntityTarget();
+    }
+    else
+    {
+        glClearColor(kClearColorR, kClearColorG, kClearColorB, kClearColorA);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    }
+    if (!batches_.empty())
+        submitSceneBatches(view, projection, true);
+    if (entity_ids)
+        entity_ids_->resolveToScreen();
+    gpu_timer_->end();
+}
+
+bool Renderer::prepareEntityIds()
+{
+    if (!config_.entity_ids || !entity_ids_)
+        return false;
+    GLint viewport[4] = {};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    return entity_ids_->resize(viewport[2], viewport[3]);
+}
 
-        glUniformMatrix4fv(model_loc_, 1, GL_FALSE, glm::value_ptr(item.model));
-        glUniform3f(color_loc_, item.color.x, item.color.y, item.color.z);
-        glUniform1i(use_grid_loc_, item.use_grid ? 1 : 0);
+void Renderer::requestEntityPick(const EntityPickQuery &query)
+{
+    if (entity_ids_)
+        entity_ids_->request(query);
+}
 
-        glBindVertexArray(mesh->getVAO());
-        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(mesh->getIndexCount()), GL_UNSIGNED_INT, nullptr);
-        log_error("glDrawElements");
-    };
+void Renderer::collectEntityPicks(EntityPickResults &out)
+{
+    if (entity_ids_)
+        entity_ids_->collect(out);
+}
+
+void Renderer::drawOffscreen(const RenderQueue &queue, const glm::mat4 &view, const glm::mat4 &projection,
+                             GLuint framebuffer, int width, int height)
+{
+    PROFILE_SCOPE("Renderer::drawOffscreen");
+    // 화면 pass의 instance/indirect 버퍼는 이미 제출됐으므로 orphaning으로 새로 채워도 된다
+    instances_.clear();
+    draw_commands_.clear();
+    batches_.clear();
+    appendBatches(queue.opaque, true, batches_, BatchFilter{RenderItemFlag::Hidden, 0, true});
+    appendBatches(queue.transparent, false, batches_, BatchFilter{});
+    if (!draw_commands_.empty())
+        uploadBatches();
+
+    gpu_timer_->begin("offscreen pass");
+    GLint viewport[4] = {};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+    clearEntityTarget();
+    if (!batches_.empty())
+        submitSceneBatches(view, projection, false);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    gpu_timer_->end();
+}
 
-    for (const auto &item : queue.opaque)
+void Renderer::submitSceneBatches(const glm::mat4 &view, const glm::mat4 &projection, bool screen_pass)
+{
+    material_table_->bind(state_cache_);
+    if (shadow_map_)
+        state_cache_.bindTexture(CascadedShadowMap::kTextureUnit, GL_TEXTURE_2D_ARRAY, shadow_map_->texture());
+    for (const DrawBatch &batch : batches_)
     {
-        draw_item(item);
+        const ProgramVariant *program = programFor(submitVariant(batch.variant));
+        if (!program)
+            continue;
+        bindProgram(*program, view, projection, screen_pass);
+        if (config_.instancing)
+            submitBatch(batch);
+        else
+            submitBatchPerItem(batch, *program);
     }
-    for (const auto &item : queue.transparent)
+}
+
+void Renderer::submitShadowBatches(const std::vector<DrawBatch> &batches, const ProgramVariant &program)
+{
+    for (const DrawBatch &batch : batches)
     {
-        draw_item(item);
+        if (config_.instancing)
+            submitBatch(batch);
+        else
+            submitBatchPerItem(batch, program);
     }
-    glBindVertexArray(0);
+}
+
+void Renderer::renderShadows(std::uint32_t static_cascades)
+{
+    const ProgramVariant *program = shadowProgram();
+    if (!program)
+        return;
+
+    // 화면 viewport는 Engine이 resize 때 정하므로 끝나고 되돌린다
+    GLint viewport[4] = {};
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glEnable(GL_POLYGON_OFFSET_FILL);
+    glPolygonOffset(kShadowSlopeBias, kShadowConstantBias);
+
+    for (int cascade = 0; cascade < CascadedShadowMap::kCascadeCount; ++cascade)
+    {
+        bindProgram(*program, shadow_map_->lightView(cascade), shadow_map_->lightProjection(cascade));
+        if (static_cascades & (1u << cascade))
+        {
+            shadow_map_->beginStatic(cascade);
+            submitShadowBatches(shadow_static_batches_, *program);
+            ++shadow_stats_.static_cascade_renders;
+        }
+
+        shadow_map_->beginDynamic(cascade);
+        submitShadowBatches(shadow_dynamic_batches_, *program);
+        ++shadow_stats_.dynamic_cascade_renders;
+    }
+
+    glDisable(GL_POLYGON_OFFSET_FILL);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 }
 
 void Renderer::swapBuffers()
@@ -138,6 +374,12 @@ void Renderer::swapBuffers()
         glfwSwapBuffers(window_ptr_);
 }
 
+void Renderer::setSwapInterval(int interval)
+{
+    glfwSwapInterval(interval);
+    std::clog << "[renderer] swap interval " << interval << std::endl;
+}
+
 void Renderer::pollEvents()
 {
     glfwPollEvents();
@@ -147,47 +389,139 @@ void Renderer::pollEvents()
     }
 }
 
-GLuint Renderer::loadShaders(const std::string &vertex_shader_path, const std::string &fragment_shader_path)
+void Renderer::loadShaders(const std::string &vertex_shader_path, const std::string &fragment_shader_path)
 {
-    const std::string vertex_source = readShaderFile(vertex_shader_path);
-    const std::string fragment_source = readShaderFile(fragment_shader_path);
+    vertex_source_ = readShaderFile(vertex_shader_path);
+    fragment_source_ = readShaderFile(fragment_shader_path);
+    shadow_vertex_source_ = readShaderFile(kShadowVertexShader);
+    shadow_fragment_source_ = readShaderFile(kShadowFragmentShader);
+
+    // 기본 material의 variant는 시작 시 반드시 만들어져야 하므로 실패를 그대로 던진다
+    const ShaderVariant variant = submitVariant(material_table_->variants()[MaterialTable::kDefaultMaterial]);
+    if (!programFor(variant))
+        throw std::runtime_error("failed to build default shader variant " + std::to_string(variant));
+    if (!shadowProgram())
+        std::cerr << "[renderer] shadow program unavailable, shadows disabled\n";
+}
 
-    GLuint vertex_shader = compileShader(GL_VERTEX_SHADER, vertex_source);
-    GLuint fragment_shader = compileShader(GL_FRAGMENT_SHADER, fragment_source);
+const Renderer::ProgramVariant *Renderer::programFor(ShaderVariant variant)
+{
+    ProgramVariant &slot = programs_[variant % kShaderVariantCount];
+    if (slot.program != 0)
+        return &slot;
+    if (slot.failed || !buildProgram(slot, "main_v" + std::to_string(variant), vertex_source_, fragment_source_, variant))
+        return nullptr;
+    return &slot;
+}
 
-    GLuint program = glCreateProgram();
-    glAttachShader(program, vertex_shader);
-    glAttachShader(program, fragment_shader);
-    glLinkProgram(program);
+const Renderer::ProgramVariant *Renderer::shadowProgram()
+{
+    const ShaderVariant variant = config_.instancing ? ShaderFeature::Instanced : 0;
+    ProgramVariant &slot = shadow_programs_[config_.instancing ? 1 : 0];
+    if (slot.program != 0)
+        return &slot;
+    if (slot.failed ||
+        !buildProgram(slot, "shadow_v" + std::to_string(variant), shadow_vertex_source_, shadow_fragment_source_, variant))
+        return nullptr;
+    return &slot;
+}
 
-    GLint linked = 0;
-    glGetProgramiv(program, GL_LINK_STATUS, &linked);
-    if (linked != GL_TRUE)
+bool Renderer::buildProgram(ProgramVariant &slot,
+                            const std::string &name,
+                            const std::string &vertex_source,
+                            const std::string &fragment_source,
+                            ShaderVariant variant)
+{
+    try
     {
-        char log[1024];
-        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
-        glDeleteProgram(program);
-        glDeleteShader(vertex_shader);
-        glDeleteShader(fragment_shader);
-        throw std::runtime_error(std::string("Program link failed: ") + log);
+        slot.program = shader_cache_->loadProgram(name, vertex_source, fragment_source, variantDefines(variant));
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "[renderer] shader " << name << " failed: " << ex.what() << "\n";
+        slot.failed = true;
+        return false;
     }
 
-    glDeleteShader(vertex_shader);
-    glDeleteShader(fragment_shader);
-
-    model_loc_ = glGetUniformLocation(program, "model");
-    view_loc_ = glGetUniformLocation(program, "view");
-    projection_loc_ = glGetUniformLocation(program, "projection");
-    color_loc_ = glGetUniformLocation(program, "uColor");
-    use_grid_loc_ = glGetUniformLocation(program, "uUseGrid");
-    if (model_loc_ == -1 || view_loc_ == -1 || projection_loc_ == -1 || color_loc_ == -1 || use_grid_loc_ == -1)
+    MaterialTable::attachProgram(slot.program);
+    slot.view_loc = glGetUniformLocation(slot.program, "view");
+    slot.projection_loc = glGetUniformLocation(slot.program, "projection");
+    slot.model_loc = glGetUniformLocation(slot.program, "model");
+    slot.material_loc = glGetUniformLocation(slot.program, "material_index");
+    slot.entity_loc = glGetUniformLocation(slot.program, "entity_id");
+    slot.highlight_entity_loc = glGetUniformLocation(slot.program, "highlight_entity");
+    slot.light_direction_loc = glGetUniformLocation(slot.program, "light_direction");
+    slot.light_color_loc = glGetUniformLocation(slot.program, "light_color");
+    slot.ambient_color_loc = glGetUniformLocation(slot.program, "ambient_color");
+    slot.albedo_maps_loc = glGetUniformLocation(slot.program, "albedo_maps");
+    slot.shadow_maps_loc = glGetUniformLocation(slot.program, "shadow_maps");
+    slot.cascade_splits_loc = glGetUniformLocation(slot.program, "cascade_splits");
+    slot.shadow_strength_loc = glGetUniformLocation(slot.program, "shadow_strength");
+    for (std::size_t cascade = 0; cascade < slot.shadow_matrix_locs.size(); ++cascade)
+    {
+        const std::string uniform = "shadow_matrices[" + std::to_string(cascade) + "]";
+        slot.shadow_matrix_locs[cascade] = glGetUniformLocation(slot.program, uniform.c_str());
+    }
+    if (slot.view_loc == -1 || slot.projection_loc == -1)
     {
-        std::clog << "[renderer] warning: uniform location invalid "
-                  << "(model=" << model_loc_ << ", view=" << view_loc_ << ", proj=" << projection_loc_ << ", color=" << color_loc_
-                  << ", grid=" << use_grid_loc_ << ")\n";
+        std::clog << "[renderer] warning: uniform location invalid in " << name << " (view=" << slot.view_loc
+                  << ", proj=" << slot.projection_loc << ")\n";
     }
+    return true;
+}
 
-    return program;
+void Renderer::precompileVariants()
+{
+    for (ShaderVariant variant : material_table_->variants())
+        programFor(submitVariant(variant));
+    shadowProgram();
+}
+
+ShaderVariant Renderer::submitVariant(ShaderVariant material_variant) const
+{
+    const auto features = static_cast<ShaderVariant>(material_variant & ~ShaderFeature::Instanced);
+    return config_.instancing ? static_cast<ShaderVariant>(features | ShaderFeature::Instanced) : features;
+}
+
+void Renderer::bindProgram(const ProgramVariant &program, const glm::mat4 &view, const glm::mat4 &projection,
+                           bool screen_pass)
+{
+    // uniform 캐시는 program별이라 이미 값이 같으면 GL 호출이 생략된다
+    state_cache_.useProgram(program.program);
+    state_cache_.setUniform(program.view_loc, view);
+    state_cache_.setUniform(program.projection_loc, projection);
+    state_cache_.setUniform(program.light_direction_loc, light_direction_);
+    state_cache_.setUniform(program.light_color_loc, light_color_);
+    state_cache_.setUniform(program.ambient_color_loc, ambient_color_);
+    state_cache_.setUniform(program.albedo_maps_loc, static_cast<int>(MaterialTable::kTextureUnit));
+    const bool highlight = screen_pass && highlight_entity_ != kNoRenderEntity;
+    state_cache_.setUniform(program.highlight_entity_loc, highlight ? static_cast<int>(highlight_entity_) : -1);
+    if (program.shadow_maps_loc < 0 || !shadow_map_)
+        return;
+
+    state_cache_.setUniform(program.shadow_maps_loc, static_cast<int>(CascadedShadowMap::kTextureUnit));
+    state_cache_.setUniform(program.shadow_strength_loc, screen_pass && config_.shadows ? 1.0f : 0.0f);
+    state_cache_.setUniform(program.cascade_splits_loc, shadow_map_->splits());
+    for (int cascade = 0; cascade < CascadedShadowMap::kCascadeCount; ++cascade)
+        state_cache_.setUniform(program.shadow_matrix_locs[static_cast<std::size_t>(cascade)], shadow_map_->shadowMatrix(cascade));
+}
+
+void Renderer::setDirectionalLight(const glm::vec3 &direction, const glm::vec3 &color, const glm::vec3 &ambient)
+{
+    // 셰이더는 표면에서 광원 쪽 방향을 쓴다
+    light_direction_ = -glm::normalize(direction);
+    light_color_ = color;
+    ambient_color_ = ambient;
+}
+
+void Renderer::setConfig(const RendererConfig &config)
+{
+    config_ = config;
+    if (!config_.entity_ids && entity_ids_)
+        entity_ids_->release();
+    std::clog << "[renderer] instancing " << (config_.instancing ? "on" : "off") << ", entity id buffer "
+              << (config_.entity_ids ? "on" : "off") << std::endl;
+    precompileVariants();
 }
 
 void Renderer::registerBuiltinMeshes()
@@ -198,24 +532,215 @@ void Renderer::registerBuiltinMeshes()
               << ", plane=" << static_cast<int>(MeshId::Plane) << ")\n";
 }
 
-int Renderer::registerMesh(std::unique_ptr<Mesh> mesh, int preferred_id)
+int Renderer::registerMesh(const MeshData &data, int preferred_id, const MeshUploadOptions &options)
 {
-    if (!mesh)
+    if (data.vertices.empty() || data.indices.empty())
         return -1;
 
+    MeshData with_lods;
+    const MeshData *source = &data;
+    if (options.generate_lods && data.lods.empty())
+    {
+        with_lods = data;
+        MeshSimplify::generateLods(with_lods);
+        if (!with_lods.lods.empty())
+            source = &with_lods;
+    }
+
+    MeshArena &arena = *mesh_arenas_[static_cast<std::size_t>(options.format)];
+    auto mesh = std::make_unique<Mesh>(arena, *source, options.keep_cpu_copy);
+    // arena가 VAO/버퍼를 직접 바인딩하므로 캐시를 비운다
+    state_cache_.invalidate();
+
     // TODO(jyan): createCube, cretePlane에 맞춰서 작성된거라 나중에 수정 필요
+    const int mesh_id = reserveMeshId(preferred_id);
+    setMesh(mesh_id, std::move(mesh));
+    return mesh_id;
+}
+
+int Renderer::registerMesh(const std::string &path, int preferred_id, const MeshUploadOptions &options)
+{
+    const int mesh_id = reserveMeshId(preferred_id);
+    setMesh(mesh_id, nullptr);
+
+    const std::uint32_t ticket = next_load_ticket_++;
+    pending_loads_[mesh_id] = ticket;
+
+    std::weak_ptr<MeshLoadQueue> queue = load_queue_;
+    ThreadPool::instance().submit([queue, path, mesh_id, ticket, options]
+                                  {
+        MeshLoadResult result;
+        result.mesh_id = mesh_id;
+        result.ticket = ticket;
+        result.path = path;
+        try
+        {
+            MeshData data = MeshImport::loadFile(path);
+            if (options.generate_lods && data.lods.empty())
+                MeshSimplify::generateLods(data);
+            result.encoded = encodeMesh(data, options.format);
+            if (options.keep_cpu_copy)
+                result.cpu_copy = std::make_unique<MeshData>(std::move(data));
+        }
+        catch (const std::exception &ex)
+        {
+            result.error = ex.what();
+        }
+
+        if (auto shared_queue = queue.lock())
+        {
+            std::lock_guard<std::mutex> lock(shared_queue->mutex);
+            shared_queue->completed.push_back(std::move(result));
+        } });
+    return mesh_id;
+}
+
+bool Renderer::isMeshResident(int mesh_id) const
+{
+    return mesh_id >= 0 && static_cast<size_t>(mesh_id) < meshes_.size() && meshes_[static_cast<size_t>(mesh_id)] != nullptr;
+}
+
+void Renderer::processUploads(double budget_ms)
+{
+    {
+        std::lock_guard<std::mutex> lock(load_queue_->mutex);
+        for (MeshLoadResult &result : load_queue_->completed)
+            ready_uploads_.push_back(std::move(result));
+        load_queue_->completed.clear();
+    }
+    if (ready_upload_head_ >= ready_uploads_.size())
+        return;
+
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    bool uploaded = false;
+    while (ready_upload_head_ < ready_uploads_.size())
+    {
+        if (uploaded && std::chrono::duration<double, std::milli>(Clock::now() - start).count() >= budget_ms)
+            break;
+
+        MeshLoadResult &result = ready_uploads_[ready_upload_head_++];
+        auto pending = pending_loads_.find(result.mesh_id);
+        if (pending == pending_loads_.end() || pending->second != result.ticket)
+            continue; // unregister되었거나 다시 등록됨
+        pending_loads_.erase(pending);
+
+        if (!result.error.empty())
+        {
+            std::cerr << "[renderer] mesh load failed: " << result.path << " (" << result.error << ")\n";
+            continue;
+        }
+        if (result.encoded.index_count == 0)
+            continue;
+
+        MeshArena &arena = *mesh_arenas_[static_cast<std::size_t>(result.encoded.format)];
+        setMesh(result.mesh_id, std::make_unique<Mesh>(arena, result.encoded, std::move(result.cpu_copy)));
+        uploaded = true;
+        std::clog << "[renderer] mesh resident: " << result.path << " (id=" << result.mesh_id << ", vertices "
+                  << result.encoded.vertex_count << ", indices " << result.encoded.index_count << ", lods "
+                  << static_cast<int>(result.encoded.lod_info.lod_count) << ")\n";
+    }
+
+    if (uploaded)
+        state_cache_.invalidate();
+    if (ready_upload_head_ >= ready_uploads_.size())
+    {
+        ready_uploads_.clear();
+        ready_upload_head_ = 0;
+    }
+}
+
+MaterialHandle Renderer::registerMaterial(const Material &material)
+{
+    const MaterialHandle handle = material_table_->add(material);
+    if (handle == MaterialTable::kInvalidMaterial)
+    {
+        std::cerr << "[renderer] material table full (" << MaterialTable::kMaxMaterials << ")\n";
+        return handle;
+    }
+    programFor(submitVariant(MaterialTable::variantOf(material)));
+    ++resource_version_;
+    return handle;
+}
+
+void Renderer::updateMaterial(MaterialHandle handle, const Material &material)
+{
+    material_table_->update(handle, material);
+    programFor(submitVariant(MaterialTable::variantOf(material)));
+    ++resource_version_;
+}
+
+int Renderer::addMaterialTexture(const std::uint8_t *rgba, int width, int height)
+{
+    const int layer = material_table_->addTexture(rgba, width, height);
+    if (layer < 0)
+    {
+        std::cerr << "[renderer] material texture rejected (" << width << "x" << height << ", expected "
+                  << MaterialTable::kTextureSize << "x" << MaterialTable::kTextureSize << ", max layers "
+                  << MaterialTable::kMaxTextureLayers << ")\n";
+    }
+    // 텍스처 바인딩을 직접 바꿨으므로 캐시를 비운다
+    state_cache_.invalidate();
+    return layer;
+}
+
+int Renderer::reserveMeshId(int preferred_id)
+{
+    ++resource_version_;
     if (preferred_id >= 0)
     {
         if (static_cast<size_t>(preferred_id) >= meshes_.size())
+        {
             meshes_.resize(static_cast<size_t>(preferred_id) + 1);
-        meshes_[static_cast<size_t>(preferred_id)] = std::move(mesh);
+            mesh_lod_table_.resize(meshes_.size());
+        }
+        // 같은 id로 진행중이던 비동기 로드는 취소된다
+        pending_loads_.erase(preferred_id);
         return preferred_id;
     }
 
-    meshes_.push_back(std::move(mesh));
+    meshes_.emplace_back();
+    mesh_lod_table_.emplace_back();
     return static_cast<int>(meshes_.size() - 1);
 }
 
+void Renderer::setMesh(int mesh_id, std::unique_ptr<Mesh> mesh)
+{
+    const auto slot = static_cast<size_t>(mesh_id);
+    mesh_lod_table_[slot] = mesh ? mesh->getLodInfo() : MeshLodInfo{};
+    meshes_[slot] = std::move(mesh);
+    ++resource_version_;
+}
+
+void Renderer::unregisterMesh(int mesh_id)
+{
+    pending_loads_.erase(mesh_id);
+    if (!getMeshFromId(mesh_id))
+        return;
+
+    setMesh(mesh_id, nullptr);
+    for (const auto &arena : mesh_arenas_)
+    {
+        if (arena->fragmentation() > kCompactFragmentation)
+        {
+            compactMeshes();
+            break;
+        }
+    }
+}
+
+void Renderer::compactMeshes()
+{
+    for (const auto &arena : mesh_arenas_)
+    {
+        arena->compact();
+        std::clog << "[renderer] mesh arena compacted (stride " << arena->layout().stride << ", vertices "
+                  << arena->liveVertexCount() << "/" << arena->vertexCapacity() << ", index bytes "
+                  << arena->liveIndexBytes() << "/" << arena->indexBytes() << ")\n";
+    }
+    state_cache_.invalidate();
+}
+
 Mesh *Renderer::getMeshFromId(int mesh_id)
 {
     if (mesh_id < 0)
@@ -225,3 +750,226 @@ Mesh *Renderer::getMeshFromId(int mesh_id)
         return nullptr;
     return meshes_[idx].get();
 }
+
+void Renderer::initBatching()
+{
+    glGenBuffers(1, &instance_buffer_);
+    glBindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+    instance_capacity_ = kInitialInstanceCapacity;
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instance_capacity_ * sizeof(InstanceData)), nullptr, GL_STREAM_DRAW);
+
+    // instance attribute는 arena VAO마다 한 번만 설정한다. arena가 버퍼를 바꿔도 location 0~2만 다시 잡는다
+    for (const auto &arena : mesh_arenas_)
+    {
+        glBindVertexArray(arena->vao());
+        for (GLuint column = 0; column < 4; ++column)
+        {
+            glEnableVertexAttribArray(kInstanceModelLocation + column);
+            glVertexAttribDivisor(kInstanceModelLocation + column, 1);
+        }
+        glEnableVertexAttribArray(kInstanceMaterialLocation);
+        glVertexAttribDivisor(kInstanceMaterialLocation, 1);
+        glEnableVertexAttribArray(kInstanceEntityLocation);
+        glVertexAttribDivisor(kInstanceEntityLocation, 1);
+        setInstanceAttributes(0);
+    }
+    glBindVertexArray(0);
+
+#ifndef __APPLE__
+    GLint major = 0;
+    GLint minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    const bool core_mdi = major > 4 || (major == 4 && minor >= 3);
+    const bool ext_mdi = glfwExtensionSupported("GL_ARB_multi_draw_indirect") && glfwExtensionSupported("GL_ARB_base_instance");
+    if (core_mdi || ext_mdi)
+        multi_draw_elements_indirect_ = glfwGetProcAddress("glMultiDrawElementsIndirect");
+#endif
+    if (multi_draw_elements_indirect_)
+    {
+        glGenBuffers(1, &indirect_buffer_);
+        std::clog << "[renderer] submission: glMultiDrawElementsIndirect" << std::endl;
+    }
+    else
+    {
+        std::clog << "[renderer] submission: glDrawElementsInstancedBaseVertex per batch" << std::endl;
+    }
+    state_cache_.invalidate();
+}
+
+void Renderer::setInstanceAttributes(std::size_t first_instance)
+{
+    // GL 3.3에는 base instance가 없으므로 fallback 경로에서는 attribute 시작 위치를 옮겨 대신한다
+    const std::size_t base = first_instance * sizeof(InstanceData);
+    constexpr GLsizei stride = sizeof(InstanceData);
+    state_cache_.bindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+    for (GLuint column = 0; column < 4; ++column)
+    {
+        const std::size_t offset = base + offsetof(InstanceData, model) + column * sizeof(glm::vec4);
+        glVertexAttribPointer(kInstanceModelLocation + column, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(offset));
+    }
+    glVertexAttribIPointer(kInstanceMaterialLocation, 1, GL_UNSIGNED_INT, stride,
+                           reinterpret_cast<void *>(base + offsetof(InstanceData, material)));
+    glVertexAttribIPointer(kInstanceEntityLocation, 1, GL_UNSIGNED_INT, stride,
+                           reinterpret_cast<void *>(base + offsetof(InstanceData, entity)));
+}
+
+void Renderer::appendBatches(const RenderBucket &bucket, bool group_by_format, std::vector<DrawBatch> &out, const BatchFilter &filter)
+{
+    // 같은 variant에서 같은 메시의 같은 LOD가 연속되면 instance_count만 늘린다
+    const std::size_t first_command = draw_commands_.size();
+    const Mesh *last_mesh = nullptr;
+    std::uint8_t last_lod = 0;
+    ShaderVariant last_variant = 0;
+    command_groups_.resize(first_command);
+    bucket.forEachSorted([&](const RenderItem &item)
+                         {
+        if ((item.flags & filter.flag_mask) != filter.flag_value)
+            return;
+        const Mesh *mesh = getMeshFromId(static_cast<int>(item.mesh_handle));
+        if (!mesh)
+            return;
+        const ShaderVariant variant = filter.split_variants ? item.shader_variant : 0;
+
+        const GLuint instance = static_cast<GLuint>(instances_.size());
+        instances_.push_back(InstanceData{item.model, material_table_->resolve(item.material_handle), item.entity});
+
+        if (mesh == last_mesh && item.lod == last_lod && variant == last_variant &&
+            draw_commands_.size() > first_command)
+        {
+            ++draw_commands_.back().instance_count;
+            return;
+        }
+
+        const MeshRange range = mesh->getRange(item.lod);
+        draw_commands_.push_back(DrawElementsIndirectCommand{range.index_count, 1, range.first_index, range.base_vertex, instance});
+        command_groups_.push_back(static_cast<std::uint8_t>(batchGroupOf(variant, mesh->getArena(), range.index_type)));
+        last_mesh = mesh;
+        last_lod = item.lod;
+        last_variant = variant; });
+
+    const std::size_t end = draw_commands_.size();
+    if (first_command == end)
+        return;
+
+    if (group_by_format)
+    {
+        // 그룹 id(variant, arena, index type) 기준 stable counting sort.
+        // instance는 base_instance로 참조하므로 명령 순서만 바뀐다
+        std::array<std::size_t, kBatchGroupCount + 1> offsets{};
+        for (std::size_t i = first_command; i < end; ++i)
+            ++offsets[command_groups_[i] + 1];
+        for (std::size_t group = 0; group < kBatchGroupCount; ++group)
+            offsets[group + 1] += offsets[group];
+
+        grouped_commands_.resize(end - first_command);
+        for (std::size_t i = first_command; i < end; ++i)
+            grouped_commands_[offsets[command_groups_[i]]++] = draw_commands_[i];
+        std::copy(grouped_commands_.begin(), grouped_commands_.end(), draw_commands_.begin() + static_cast<std::ptrdiff_t>(first_command));
+        std::sort(command_groups_.begin() + static_cast<std::ptrdiff_t>(first_command), command_groups_.end());
+    }
+
+    for (std::size_t i = first_command; i < end;)
+    {
+        const std::uint8_t group = command_groups_[i];
+        std::size_t run_end = i + 1;
+        while (run_end < end && command_groups_[run_end] == group)
+            ++run_end;
+
+        const std::size_t arena_group = group % kArenaGroupCount;
+        const auto variant = static_cast<ShaderVariant>(group / kArenaGroupCount);
+        const MeshArena *arena = mesh_arenas_[arena_group / 2].get();
+        const GLenum index_type = (arena_group % 2) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        out.push_back(DrawBatch{variant, arena, index_type, i, run_end - i});
+        i = run_end;
+    }
+}
+
+void Renderer::uploadBatches()
+{
+    // per-item 경로는 instance 데이터를 uniform으로 넘기므로 버퍼가 필요 없다
+    if (!config_.instancing)
+        return;
+
+    state_cache_.bindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+    if (instances_.size() > instance_capacity_)
+        instance_capacity_ = std::max(instances_.size(), instance_capacity_ * 2);
+    // 이전 프레임이 아직 읽는 중일 수 있으므로 orphaning 후 채운다
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instance_capacity_ * sizeof(InstanceData)), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(instances_.size() * sizeof(InstanceData)), instances_.data());
+
+    if (!multi_draw_elements_indirect_)
+        return;
+
+    state_cache_.bindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer_);
+    if (draw_commands_.size() > indirect_capacity_)
+        indirect_capacity_ = std::max(draw_commands_.size(), indirect_capacity_ * 2);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(indirect_capacity_ * sizeof(DrawElementsIndirectCommand)), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, static_cast<GLsizeiptr>(draw_commands_.size() * sizeof(DrawElementsIndirectCommand)), draw_commands_.data());
+}
+
+void Renderer::submitBatch(const DrawBatch &batch)
+{
+    state_cache_.bindVertexArray(batch.arena->vao());
+
+#ifndef __APPLE__
+    if (multi_draw_elements_indirect_)
+    {
+        auto multi_draw = reinterpret_cast<MultiDrawElementsIndirectFn>(multi_draw_elements_indirect_);
+        ++render_stats_.draw_calls;
+        for (std::size_t i = batch.first_command; i < batch.first_command + batch.command_count; ++i)
+        {
+            render_stats_.instances += draw_commands_[i].instance_count;
+            render_stats_.triangles += static_cast<std::uint64_t>(draw_commands_[i].count / 3) * draw_commands_[i].instance_count;
+        }
+        multi_draw(GL_TRIANGLES,
+                   batch.index_type,
+                   reinterpret_cast<const void *>(batch.first_command * sizeof(DrawElementsIndirectCommand)),
+                   static_cast<GLsizei>(batch.command_count),
+                   sizeof(DrawElementsIndirectCommand));
+        return;
+    }
+#endif
+
+    const std::size_t index_size = indexSize(batch.index_type);
+    for (std::size_t i = batch.first_command; i < batch.first_command + batch.command_count; ++i)
+    {
+        const DrawElementsIndirectCommand &command = draw_commands_[i];
+        setInstanceAttributes(command.base_instance);
+        ++render_stats_.draw_calls;
+        render_stats_.instances += command.instance_count;
+        render_stats_.triangles += static_cast<std::uint64_t>(command.count / 3) * command.instance_count;
+        glDrawElementsInstancedBaseVertex(GL_TRIANGLES,
+                                          static_cast<GLsizei>(command.count),
+                                          batch.index_type,
+                                          reinterpret_cast<const void *>(command.first_index * index_size),
+                                          static_cast<GLsizei>(command.instance_count),
+                                          command.base_vertex);
+    }
+}
+
+void Renderer::submitBatchPerItem(const DrawBatch &batch, const ProgramVariant &program)
+{
+    state_cache_.bindVertexArray(batch.arena->vao());
+
+    const std::size_t index_size = indexSize(batch.index_type);
+    for (std::size_t i = batch.first_command; i < batch.first_command + batch.command_count; ++i)
+    {
+        const DrawElementsIndirectCommand &command = draw_commands_[i];
+        render_stats_.draw_calls += command.instance_count;
+        render_stats_.instances += command.instance_count;
+        render_stats_.triangles += static_cast<std::uint64_t>(command.count / 3) * command.instance_count;
+        for (GLuint instance = 0; instance < command.instance_count; ++instance)
+        {
+            const InstanceData &data = instances_[command.base_instance + instance];
+            state_cache_.setUniform(program.model_loc, data.model);
+            state_cache_.setUniform(program.material_loc, static_cast<int>(data.material));
+            state_cache_.setUniform(program.entity_loc, static_cast<int>(data.entity));
+            glDrawElementsBaseVertex(GL_TRIANGLES,
+                                     static_cast<GLsizei>(command.count),
+                                     batch.index_type,
+                                     reinterpret_cast<const void *>(command.first_index * index_size),
+                                     command.base_vertex);
+        }
+    }
+}
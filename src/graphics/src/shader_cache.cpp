@@ -0,0 +1,260 @@
+#include "shader_cache.hpp"
+#include "shader.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+constexpr std::uint32_t kCacheMagic = 0x53484243; // "SHBC"
+constexpr std::uint32_t kCacheVersion = 1;
+
+struct CacheHeader
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint64_t key;
+    std::uint32_t binary_format;
+    std::uint32_t binary_size;
+    std::uint64_t checksum;
+};
+
+std::uint64_t fnv1a(const void *data, std::size_t size, std::uint64_t hash = 0xCBF29CE484222325ull)
+{
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ull;
+    }
+    return hash;
+}
+
+std::uint64_t fnv1a(const std::string &text, std::uint64_t hash)
+{
+    // 구분자를 넣어 "ab"+"c"와 "a"+"bc"가 같은 키가 되지 않게 한다
+    hash = fnv1a(text.data(), text.size(), hash);
+    const char separator = '\0';
+    return fnv1a(&separator, 1, hash);
+}
+
+std::string glString(GLenum name)
+{
+    const auto *value = reinterpret_cast<const char *>(glGetString(name));
+    return value ? value : "";
+}
+
+// #version 줄 바로 다음에 #define 을 넣는다
+std::string injectDefines(const std::string &source, const std::vector<std::string> &defines)
+{
+    if (defines.empty())
+        return source;
+
+    std::string block;
+    for (const std::string &define : defines)
+        block += "#define " + define + "\n";
+
+    std::size_t insert_at = 0;
+    if (source.compare(0, 8, "#version") == 0)
+    {
+        const std::size_t line_end = source.find('\n');
+        insert_at = line_end == std::string::npos ? source.size() : line_end + 1;
+    }
+    std::string out = source;
+    out.insert(insert_at, block);
+    return out;
+}
+
+GLuint linkProgram(const std::string &vertex_source, const std::string &fragment_source, bool retrievable)
+{
+    GLuint vertex_shader = compileShader(GL_VERTEX_SHADER, vertex_source);
+    GLuint fragment_shader = 0;
+    try
+    {
+        fragment_shader = compileShader(GL_FRAGMENT_SHADER, fragment_source);
+    }
+    catch (...)
+    {
+        glDeleteShader(vertex_shader);
+        throw;
+    }
+
+    GLuint program = glCreateProgram();
+    if (retrievable)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program, vertex_shader);
+    glAttachShader(program, fragment_shader);
+    glLinkProgram(program);
+    glDetachShader(program, vertex_shader);
+    glDetachShader(program, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked != GL_TRUE)
+    {
+        char log[1024];
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        glDeleteProgram(program);
+        throw std::runtime_error(std::string("Program link failed: ") + log);
+    }
+    return program;
+}
+} // namespace
+
+ShaderCache::ShaderCache(std::string directory)
+    : directory_(std::move(directory))
+{
+    driver_ = glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION);
+
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    binary_supported_ = format_count > 0;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error)
+    {
+        std::clog << "[shader-cache] cannot create " << directory_ << ": " << error.message() << "\n";
+        binary_supported_ = false;
+    }
+}
+
+GLuint ShaderCache::loadProgram(const std::string &name,
+                                const std::string &vertex_source,
+                                const std::string &fragment_source,
+                                const std::vector<std::string> &defines)
+{
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+
+    GLuint program = 0;
+    const std::uint64_t key = makeKey(vertex_source, fragment_source, defines);
+    const std::string path = cachePath(name, key);
+    if (binary_supported_)
+        program = loadBinary(path, key);
+
+    if (program != 0)
+    {
+        ++stats_.hits;
+    }
+    else
+    {
+        ++stats_.misses;
+        program = linkProgram(injectDefines(vertex_source, defines), injectDefines(fragment_source, defines), binary_supported_);
+        if (binary_supported_)
+            storeBinary(path, key, program);
+    }
+
+    stats_.total_ms += std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    return program;
+}
+
+std::uint64_t ShaderCache::makeKey(const std::string &vertex_source,
+                                   const std::string &fragment_source,
+                                   const std::vector<std::string> &defines) const
+{
+    std::uint64_t hash = fnv1a(vertex_source, 0xCBF29CE484222325ull);
+    hash = fnv1a(fragment_source, hash);
+    for (const std::string &define : defines)
+        hash = fnv1a(define, hash);
+    return fnv1a(driver_, hash);
+}
+
+std::string ShaderCache::cachePath(const std::string &name, std::uint64_t key) const
+{
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+    return directory_ + "/" + name + "-" + hex + ".bin";
+}
+
+GLuint ShaderCache::loadBinary(const std::string &path, std::uint64_t key)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return 0;
+
+    CacheHeader header{};
+    std::vector<char> binary;
+    bool valid = static_cast<bool>(file.read(reinterpret_cast<char *>(&header), sizeof(header))) &&
+                 header.magic == kCacheMagic && header.version == kCacheVersion && header.key == key &&
+                 header.binary_size > 0;
+    if (valid)
+    {
+        binary.resize(header.binary_size);
+        valid = static_cast<bool>(file.read(binary.data(), static_cast<std::streamsize>(binary.size()))) &&
+                fnv1a(binary.data(), binary.size()) == header.checksum;
+    }
+
+    GLuint program = 0;
+    if (valid)
+    {
+        program = glCreateProgram();
+        glProgramBinary(program, header.binary_format, binary.data(), static_cast<GLsizei>(binary.size()));
+        GLint linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked != GL_TRUE)
+        {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+
+    if (program == 0)
+    {
+        // 손상됐거나 드라이버가 거부한 캐시는 지우고 소스에서 다시 만든다
+        ++stats_.rejected;
+        file.close();
+        std::error_code error;
+        std::filesystem::remove(path, error);
+        std::clog << "[shader-cache] rejected " << path << ", recompiling\n";
+    }
+    return program;
+}
+
+void ShaderCache::storeBinary(const std::string &path, std::uint64_t key, GLuint program) const
+{
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(static_cast<std::size_t>(length));
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    if (written <= 0)
+        return;
+    binary.resize(static_cast<std::size_t>(written));
+
+    CacheHeader header{};
+    header.magic = kCacheMagic;
+    header.version = kCacheVersion;
+    header.key = key;
+    header.binary_format = format;
+    header.binary_size = static_cast<std::uint32_t>(binary.size());
+    header.checksum = fnv1a(binary.data(), binary.size());
+
+    // 다른 프로세스가 반쯤 쓴 파일을 읽지 않도록 임시 파일에 쓴 뒤 rename 한다
+    const std::string temp_path = path + ".tmp";
+    bool written_ok = false;
+    {
+        std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return;
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(binary.data(), static_cast<std::streamsize>(binary.size()));
+        written_ok = static_cast<bool>(file);
+    }
+    std::error_code error;
+    if (written_ok)
+        std::filesystem::rename(temp_path, path, error);
+    if (!written_ok || error)
+        std::filesystem::remove(temp_path, error);
+}
@@ -0,0 +1,194 @@
+#include "shadow_map.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+#include <utility>
+
+namespace
+{
+// 이 거리 밖은 그림자를 그리지 않는다
+constexpr float kShadowDistance = 150.0f;
+// 로그/균등 분할 혼합 비율 (practical split scheme)
+constexpr float kSplitLambda = 0.7f;
+// 캐시 영역을 cascade 구보다 넓게 잡아 카메라가 조금 움직여도 다시 그리지 않는다
+constexpr float kCacheMargin = 0.25f;
+// 캐시 영역 밖에서 빛 방향으로 그림자를 드리우는 물체까지 포함하도록 depth 범위를 늘린다
+constexpr float kCasterDistance = 200.0f;
+// 광원 방향이 이보다 덜 바뀌면 같은 광원으로 본다
+constexpr float kLightChangeCos = 0.99999f;
+} // namespace
+
+CascadedShadowMap::CascadedShadowMap()
+{
+    static_texture_ = createDepthArray();
+    dynamic_texture_ = createDepthArray();
+
+    // 합성본만 비교 샘플링한다. 셰이더의 3x3 PCF 각 탭이 2x2 비교 결과를 보간하도록 linear
+    glBindTexture(GL_TEXTURE_2D_ARRAY, dynamic_texture_);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    glGenFramebuffers(kCascadeCount, static_fbos_.data());
+    glGenFramebuffers(kCascadeCount, dynamic_fbos_.data());
+    for (int cascade = 0; cascade < kCascadeCount; ++cascade)
+    {
+        const std::pair<GLuint, GLuint> targets[] = {{static_fbos_[cascade], static_texture_},
+                                                     {dynamic_fbos_[cascade], dynamic_texture_}};
+        for (const auto &[fbo, texture] : targets)
+        {
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0, cascade);
+            glDrawBuffer(GL_NONE);
+            glReadBuffer(GL_NONE);
+        }
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+CascadedShadowMap::~CascadedShadowMap()
+{
+    glDeleteFramebuffers(kCascadeCount, static_fbos_.data());
+    glDeleteFramebuffers(kCascadeCount, dynamic_fbos_.data());
+    glDeleteTextures(1, &static_texture_);
+    glDeleteTextures(1, &dynamic_texture_);
+}
+
+GLuint CascadedShadowMap::createDepthArray() const
+{
+    // blit으로 복사하므로 두 배열의 포맷이 같아야 한다
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_DEPTH_COMPONENT32F, kResolution, kResolution, kCascadeCount, 0,
+                 GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    return texture;
+}
+
+ShadowCasterBounds CascadedShadowMap::casterBounds(const glm::mat4 &projection)
+{
+    const float far_plane = std::min(projection[3][2] / (projection[2][2] + 1.0f), kShadowDistance);
+    const float tan_x = 1.0f / projection[0][0];
+    const float tan_y = 1.0f / projection[1][1];
+    const float k2 = tan_x * tan_x + tan_y * tan_y;
+
+    // 가장 큰 (마지막) cascade 구의 상한. 구 중심은 카메라에서 far_plane 안에 있고, 캐시 영역은
+    // 중심에서 extent만큼(정사각형이라 대각선은 sqrt(2)배), 다시 놓이기 전까지 slack만큼 뒤처지며 texel 하나만큼 어긋난다
+    constexpr float kSqrt2 = 1.41421356f;
+    const float radius = std::ceil(far_plane * std::sqrt(1.0f + k2) * 16.0f) / 16.0f;
+    const float extent = radius * (1.0f + kCacheMargin);
+    const float slack = extent - radius;
+    const float texel = 2.0f * extent / static_cast<float>(kResolution);
+    ShadowCasterBounds bounds;
+    bounds.radius = far_plane + slack + (extent + texel) * kSqrt2;
+    bounds.depth = far_plane + slack + extent + kCasterDistance;
+    return bounds;
+}
+
+std::uint32_t CascadedShadowMap::update(const glm::mat4 &view,
+                                        const glm::mat4 &projection,
+                                        const glm::vec3 &light_direction,
+                                        std::uint64_t static_signature)
+{
+    const glm::vec3 direction = glm::normalize(light_direction);
+    std::uint32_t dirty = 0;
+    if (!cache_valid_ || glm::dot(direction, light_direction_) < kLightChangeCos || static_signature != static_signature_)
+    {
+        dirty = (1u << kCascadeCount) - 1;
+        cache_valid_ = true;
+        light_direction_ = direction;
+        static_signature_ = static_signature;
+
+        const glm::vec3 up_hint = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        light_right_ = glm::normalize(glm::cross(direction, up_hint));
+        light_up_ = glm::cross(light_right_, direction);
+    }
+
+    // 원근 투영 행렬에서 near/far와 시야각을 꺼낸다
+    const float near_plane = projection[3][2] / (projection[2][2] - 1.0f);
+    const float far_plane = std::min(projection[3][2] / (projection[2][2] + 1.0f), kShadowDistance);
+    const float tan_x = 1.0f / projection[0][0];
+    const float tan_y = 1.0f / projection[1][1];
+    const float k2 = tan_x * tan_x + tan_y * tan_y;
+
+    const glm::mat4 camera_to_world = glm::inverse(view);
+    const glm::vec3 camera_position = glm::vec3(camera_to_world[3]);
+    const glm::vec3 camera_forward = -glm::normalize(glm::vec3(camera_to_world[2]));
+
+    float split_near = near_plane;
+    for (int index = 0; index < kCascadeCount; ++index)
+    {
+        const float t = static_cast<float>(index + 1) / static_cast<float>(kCascadeCount);
+        const float log_split = near_plane * std::pow(far_plane / near_plane, t);
+        const float uniform_split = near_plane + (far_plane - near_plane) * t;
+        const float split_far = kSplitLambda * log_split + (1.0f - kSplitLambda) * uniform_split;
+        splits_[index] = split_far;
+
+        // frustum 조각 [split_near, split_far]를 감싸는 최소 구. 반지름은 카메라 회전과 무관하다
+        const float center_distance = std::min((split_far + split_near) * (1.0f + k2) * 0.5f, split_far);
+        const float far_offset = split_far - center_distance;
+        float radius = std::sqrt(far_offset * far_offset + split_far * split_far * k2);
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+        const glm::vec3 center = camera_position + camera_forward * center_distance;
+
+        Cascade &cascade = cascades_[index];
+        const bool resized = radius != cascade.radius;
+        const glm::vec3 offset = center - cascade.center;
+        const float slack = cascade.extent - radius;
+        // 빛 축 방향도 slack 안에 둬야 casterBounds가 depth 범위를 덮는다
+        const bool escaped = std::abs(glm::dot(offset, light_right_)) > slack || std::abs(glm::dot(offset, light_up_)) > slack ||
+                             std::abs(glm::dot(offset, light_direction_)) > slack;
+        if ((dirty & (1u << index)) || resized || escaped)
+        {
+            placeCascade(cascade, center, radius);
+            dirty |= 1u << index;
+        }
+        split_near = split_far;
+    }
+    return dirty;
+}
+
+void CascadedShadowMap::placeCascade(Cascade &cascade, const glm::vec3 &center, float radius) const
+{
+    cascade.radius = radius;
+    cascade.extent = radius * (1.0f + kCacheMargin);
+
+    // 광원 평면에서 texel 단위로 중심을 맞춘다
+    const float texel = 2.0f * cascade.extent / static_cast<float>(kResolution);
+    const float x = std::floor(glm::dot(center, light_right_) / texel) * texel;
+    const float y = std::floor(glm::dot(center, light_up_) / texel) * texel;
+    const float z = glm::dot(center, light_direction_);
+    cascade.center = light_right_ * x + light_up_ * y + light_direction_ * z;
+
+    const float depth = cascade.extent + kCasterDistance;
+    cascade.view = glm::lookAt(cascade.center - light_direction_ * depth, cascade.center, light_up_);
+    cascade.projection = glm::ortho(-cascade.extent, cascade.extent, -cascade.extent, cascade.extent, 0.0f, 2.0f * depth);
+
+    glm::mat4 bias(0.5f);
+    bias[3] = glm::vec4(0.5f, 0.5f, 0.5f, 1.0f);
+    cascade.shadow_matrix = bias * cascade.projection * cascade.view;
+}
+
+void CascadedShadowMap::beginStatic(int cascade)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, static_fbos_[cascade]);
+    glViewport(0, 0, kResolution, kResolution);
+    glClear(GL_DEPTH_BUFFER_BIT);
+}
+
+void CascadedShadowMap::beginDynamic(int cascade)
+{
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_fbos_[cascade]);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dynamic_fbos_[cascade]);
+    glBlitFramebuffer(0, 0, kResolution, kResolution, 0, 0, kResolution, kResolution, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, dynamic_fbos_[cascade]);
+    glViewport(0, 0, kResolution, kResolution);
+}
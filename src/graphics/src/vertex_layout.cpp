@@ -0,0 +1,85 @@
+#include "vertex_layout.hpp"
+#include "mesh.hpp"
+
+#include <cstring>
+#include <glm/gtc/packing.hpp>
+
+namespace
+{
+VertexLayout makeFloatLayout()
+{
+    return VertexLayout{
+        VertexFormat::Float,
+        sizeof(Vertex),
+        {
+            {0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, position)},           // 위치
+            {1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, normal)},             // 법선
+            {2, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, texture_coordinates)}, // 텍스처 좌표
+        },
+    };
+}
+
+VertexLayout makePackedLayout()
+{
+    return VertexLayout{
+        VertexFormat::Packed,
+        sizeof(PackedVertex),
+        {
+            {0, 3, GL_FLOAT, GL_FALSE, offsetof(PackedVertex, position)},
+            {1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PackedVertex, normal)},
+            {2, 2, GL_HALF_FLOAT, GL_FALSE, offsetof(PackedVertex, uv)},
+        },
+    };
+}
+
+PackedVertex packVertex(const Vertex &vertex)
+{
+    PackedVertex packed{};
+    packed.position[0] = vertex.position.x;
+    packed.position[1] = vertex.position.y;
+    packed.position[2] = vertex.position.z;
+    packed.normal = glm::packSnorm3x10_1x2(glm::vec4(vertex.normal, 0.0f));
+    packed.uv = glm::packHalf2x16(vertex.texture_coordinates);
+    return packed;
+}
+} // namespace
+
+void VertexLayout::apply() const
+{
+    for (const VertexAttribute &attribute : attributes)
+    {
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribPointer(attribute.location,
+                              attribute.components,
+                              attribute.type,
+                              attribute.normalized,
+                              stride,
+                              reinterpret_cast<void *>(attribute.offset));
+    }
+}
+
+std::vector<std::byte> VertexLayout::encode(const Vertex *vertices, std::size_t count) const
+{
+    std::vector<std::byte> bytes(count * static_cast<std::size_t>(stride));
+    switch (format)
+    {
+    case VertexFormat::Float:
+        std::memcpy(bytes.data(), vertices, bytes.size());
+        break;
+    case VertexFormat::Packed:
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const PackedVertex packed = packVertex(vertices[i]);
+            std::memcpy(bytes.data() + i * sizeof(PackedVertex), &packed, sizeof(PackedVertex));
+        }
+        break;
+    }
+    return bytes;
+}
+
+const VertexLayout &VertexLayout::get(VertexFormat format)
+{
+    static const VertexLayout kFloat = makeFloatLayout();
+    static const VertexLayout kPacked = makePackedLayout();
+    return format == VertexFormat::Packed ? kPacked : kFloat;
+}
@@ -1,12 +1,69 @@
 #include <iostream>
+#include <stdexcept>
+#include <string>
 
 #include "engine.hpp"
 
-int main()
+namespace
+{
+FramePacing parsePacing(const std::string &name)
+{
+    if (name == "vsync")
+        return FramePacing::Vsync;
+    if (name == "uncapped")
+        return FramePacing::Uncapped;
+    if (name == "capped")
+        return FramePacing::Capped;
+    if (name == "low-latency")
+        return FramePacing::LowLatency;
+    throw std::invalid_argument("unknown --pacing mode: " + name);
+}
+
+bool parsePicking(const std::string &name)
+{
+    if (name == "gpu")
+        return true;
+    if (name == "cpu")
+        return false;
+    throw std::invalid_argument("unknown --picking mode: " + name);
+}
+
+// --pacing vsync|uncapped|capped|low-latency, --fps N, --agents N, --lidars N, --cameras N, --picking gpu|cpu,
+// --mesh PATH (여러 번 줄 수 있다)
+EngineConfig parseArgs(int argc, char **argv)
+{
+    EngineConfig config;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (i + 1 >= argc)
+            throw std::invalid_argument("missing value for " + arg);
+        if (arg == "--pacing")
+            config.pacing.mode = parsePacing(argv[++i]);
+        else if (arg == "--fps")
+            config.pacing.target_fps = std::stod(argv[++i]);
+        else if (arg == "--agents")
+            config.traffic_agents = static_cast<std::size_t>(std::stoull(argv[++i]));
+        else if (arg == "--lidars")
+            config.lidar_sensors = static_cast<std::size_t>(std::stoull(argv[++i]));
+        else if (arg == "--cameras")
+            config.camera_sensors = static_cast<std::size_t>(std::stoull(argv[++i]));
+        else if (arg == "--picking")
+            config.gpu_picking = parsePicking(argv[++i]);
+        else if (arg == "--mesh")
+            config.mesh_files.emplace_back(argv[++i]);
+        else
+            throw std::invalid_argument("unknown argument: " + arg);
+    }
+    return config;
+}
+} // namespace
+
+int main(int argc, char **argv)
 {
     try
     {
-        Engine engine;
+        Engine engine(parseArgs(argc, argv));
         engine.run();
     }
     catch (const std::exception &e)
@@ -15,4 +72,4 @@ int main()
         return -1;
     }
     return 0;
-}
\ No newline at end of file
+}
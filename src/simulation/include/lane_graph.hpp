@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+using lane_id = std::uint32_t;
+inline constexpr lane_id kInvalidLane = std::numeric_limits<lane_id>::max();
+
+struct LaneHit
+{
+    lane_id lane = kInvalidLane;
+    // 가장 가까운 점까지의 거리와 그 점의 lane 시작점부터의 길이
+    float distance = std::numeric_limits<float>::max();
+    float offset = 0.0f;
+    glm::vec3 point{0.0f};
+};
+
+// 방향이 있는 차로(lane)와 차로 간 연결의 읽기 전용 그래프.
+// 중심선 점, 후속 차로, 비용을 모두 lane 순서의 평탄한 배열(CSR)에 두어 경로 탐색이 연속 메모리만 읽는다.
+// 최근접 차로 검색용으로 xz 평면 균일 격자에 중심선 선분을 색인한다. LaneGraphBuilder로 만든다
+class LaneGraph
+{
+public:
+    std::size_t laneCount() const { return lengths_.size(); }
+    std::size_t connectionCount() const { return edge_targets_.size(); }
+
+    float laneLength(lane_id lane) const { return lengths_[lane]; }
+    std::span<const glm::vec3> centerline(lane_id lane) const;
+    const glm::vec3 &laneStart(lane_id lane) const { return points_[point_offsets_[lane]]; }
+    const glm::vec3 &laneEnd(lane_id lane) const { return points_[point_offsets_[lane + 1] - 1]; }
+    // 시작점에서 offset 만큼 중심선을 따라간 위치 (범위 밖이면 끝점)
+    glm::vec3 pointAt(lane_id lane, float offset) const;
+    // offset 위치 선분의 진행 방향 (단위 벡터)
+    glm::vec3 directionAt(lane_id lane, float offset) const;
+
+    // lane 끝에서 이어지는 차로와, 그 차로 시작점까지 가는 비용 (lane 길이 + 끝점 사이 간격)
+    std::span<const lane_id> successors(lane_id lane) const;
+    std::span<const float> successorCosts(lane_id lane) const;
+
+    // max_distance 안에서 가장 가까운 차로. 없으면 lane이 kInvalidLane
+    LaneHit nearestLane(const glm::vec3 &position, float max_distance) const;
+
+private:
+    friend class LaneGraphBuilder;
+
+    struct SegmentRef
+    {
+        lane_id lane;
+        std::uint32_t point; // 선분 시작점의 points_ 인덱스
+    };
+
+    // offset이 속한 선분의 끝점 인덱스 (points_ 기준)
+    std::uint32_t segmentEnd(lane_id lane, float offset) const;
+    void buildSpatialIndex(float cell_size);
+    std::size_t cellIndex(int cell_x, int cell_z) const
+    {
+        return static_cast<std::size_t>(cell_z) * static_cast<std::size_t>(grid_width_) + static_cast<std::size_t>(cell_x);
+    }
+
+    // 중심선: lane i의 점은 [point_offsets_[i], point_offsets_[i + 1])
+    std::vector<std::uint32_t> point_offsets_;
+    std::vector<glm::vec3> points_;
+    // 각 점까지의 lane 시작점 기준 누적 길이
+    std::vector<float> arc_lengths_;
+    std::vector<float> lengths_;
+
+    // 연결: lane i의 후속은 [edge_offsets_[i], edge_offsets_[i + 1])
+    std::vector<std::uint32_t> edge_offsets_;
+    std::vector<lane_id> edge_targets_;
+    std::vector<float> edge_costs_;
+
+    // 격자 셀 c의 선분은 [cell_offsets_[c], cell_offsets_[c + 1])
+    glm::vec2 grid_origin_{0.0f};
+    float cell_size_ = 1.0f;
+    int grid_width_ = 0;
+    int grid_height_ = 0;
+    std::vector<std::uint32_t> cell_offsets_;
+    std::vector<SegmentRef> cell_segments_;
+};
+
+class LaneGraphBuilder
+{
+public:
+    // 점이 두 개 이상인 중심선. 진행 방향은 점 순서
+    lane_id addLane(std::span<const glm::vec3> centerline);
+    // from의 끝에서 to의 시작으로 갈 수 있다
+    void connect(lane_id from, lane_id to);
+
+    std::size_t laneCount() const { return lanes_.size(); }
+
+    // cell_size는 최근접 검색 격자의 셀 크기 (m)
+    LaneGraph build(float cell_size = 16.0f) const;
+
+private:
+    std::vector<std::vector<glm::vec3>> lanes_;
+    std::vector<std::pair<lane_id, lane_id>> connections_;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "lane_graph.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class ThreadPool;
+
+struct RouteRequest
+{
+    lane_id from = kInvalidLane;
+    lane_id to = kInvalidLane;
+};
+
+struct Route
+{
+    bool found = false;
+    // from 시작점에서 to 끝점까지 차로를 따라간 길이
+    float cost = 0.0f;
+    // from부터 to까지 지나는 차로. 재탐색 때 같은 Route를 넘기면 용량을 재사용한다
+    std::vector<lane_id> lanes;
+    // 탐색에서 꺼낸 노드 수
+    std::uint32_t expanded = 0;
+};
+
+// LaneGraph 위의 A* 경로 탐색. 휴리스틱은 목표 차로 끝점까지의 직선거리라서 최단 경로를 보장한다.
+// 탐색 상태는 generation 값으로 무효화해 재사용하므로 쿼리마다 lane 수만큼 초기화하지 않는다.
+// findRoutes는 요청을 구간으로 나눠 스레드풀에서 병렬로 처리한다. graph는 router보다 오래 살아야 한다
+class LaneRouter
+{
+public:
+    explicit LaneRouter(const LaneGraph &graph);
+    ~LaneRouter();
+
+    LaneRouter(const LaneRouter &) = delete;
+    LaneRouter &operator=(const LaneRouter &) = delete;
+
+    // 호출 스레드에서 경로 하나를 찾는다
+    bool findRoute(const RouteRequest &request, Route &route);
+    // routes[i]에 requests[i]의 결과를 쓴다. routes는 requests 이상의 크기여야 한다
+    void findRoutes(const std::vector<RouteRequest> &requests, std::vector<Route> &routes, ThreadPool &pool);
+
+private:
+    struct SearchScratch;
+
+    // 스레드마다 하나씩 빌려 쓰는 탐색 상태. 동시에 도는 작업 수만큼만 만들어진다
+    std::unique_ptr<SearchScratch> acquireScratch();
+    void releaseScratch(std::unique_ptr<SearchScratch> scratch);
+    bool search(const RouteRequest &request, Route &route, SearchScratch &scratch) const;
+
+    const LaneGraph &graph_;
+    std::mutex scratch_mutex_;
+    std::vector<std::unique_ptr<SearchScratch>> free_scratch_;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "ray_bvh.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <span>
+#include <vector>
+
+class ThreadPool;
+
+enum class LidarBeamLayout : std::uint8_t
+{
+    Uniform,      // 고도각을 fov 안에 같은 간격으로
+    HorizonDense, // 지평선 근처에 빔을 모아 먼 거리의 세로 해상도를 높인다
+};
+
+// 회전식 LiDAR의 스캔 패턴. 한 바퀴에 columns번 발사하고, 한 번에 channels개의 빔이 세로로 나간다
+struct LidarScanConfig
+{
+    std::uint32_t channels = 128;
+    std::uint32_t columns = 1024;
+    float elevation_min_deg = -25.0f;
+    float elevation_max_deg = 15.0f;
+    LidarBeamLayout layout = LidarBeamLayout::Uniform;
+};
+
+// 점 하나. 스캔 버퍼는 channels x columns 격자라 방향은 인덱스로 LidarScanPattern에서 얻는다
+struct LidarPoint
+{
+    float range = 0.0f;     // 0이면 max_range 안에 맞은 것이 없다
+    float intensity = 0.0f; // 0..1. 입사각 코사인 x 거리 감쇠
+    std::uint32_t entity = kNoRayUser;
+};
+
+// 센서 로컬 빔 방향 표 (+z 앞, +y 위). column 0이 +z이고 column이 늘수록 +x 쪽으로 돈다.
+// 한 column의 channel이 이어지도록 [column * channels + channel]로 저장해 column 하나가 packet 묶음이 된다
+class LidarScanPattern
+{
+public:
+    explicit LidarScanPattern(const LidarScanConfig &config);
+
+    const LidarScanConfig &config() const { return config_; }
+    std::size_t rayCount() const { return directions_.size(); }
+    std::span<const glm::vec3> directions() const { return directions_; }
+    std::span<const glm::vec3> column(std::uint32_t column) const;
+    float elevationDeg(std::uint32_t channel) const { return elevations_deg_[channel]; }
+
+private:
+    LidarScanConfig config_;
+    std::vector<float> elevations_deg_;
+    std::vector<glm::vec3> directions_;
+};
+
+struct LidarCastParams
+{
+    glm::vec3 origin{0.0f};
+    glm::quat orientation{1.0f, 0.0f, 0.0f, 0.0f};
+    float min_range = 0.5f;
+    float max_range = 120.0f;
+    // 센서가 달린 물체의 user id. 자기 몸체에 맞지 않게 한다
+    std::uint32_t ignore_entity = kNoRayUser;
+    std::size_t packet_width = 8;
+};
+
+// column [first_column, first_column + column_count)를 쏴서 points의 같은 격자 위치에 쓴다.
+// 한 바퀴를 넘는 구간은 column 0으로 감싼다. points는 pattern.rayCount() 크기로 미리 잡아 둔다.
+// column 묶음을 스레드풀에서 병렬로 처리하고 할당은 하지 않는다
+void castLidarColumns(const RayBvh &bvh,
+                      const LidarScanPattern &pattern,
+                      const LidarCastParams &params,
+                      std::uint32_t first_column,
+                      std::uint32_t column_count,
+                      std::span<LidarPoint> points,
+                      ThreadPool &pool);
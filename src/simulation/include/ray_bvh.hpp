@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <span>
+#include <vector>
+
+constexpr std::uint32_t kNoPrimitive = 0xffffffffu;
+// RayQuery::ignore_user가 이 값이면 아무것도 건너뛰지 않는다
+constexpr std::uint32_t kNoRayUser = 0xffffffffu;
+
+// 축에 나란한 성분(|d| < 1e-6)은 부호를 지킨 아주 큰 값으로 바꾼 1 / direction.
+// slab test에서 0 * inf = NaN이 생기지 않는다
+glm::vec3 safeInverseDirection(const glm::vec3 &direction);
+
+// 레이 하나의 slab test. [t_min, t_max]와 상자가 겹치면 true이고 t_enter에 들어가는 거리를 쓴다
+// (origin이 상자 안이면 t_min)
+bool intersectRayAabb(const glm::vec3 &origin,
+                      const glm::vec3 &inv_direction,
+                      const glm::vec3 &aabb_min,
+                      const glm::vec3 &aabb_max,
+                      float t_min,
+                      float t_max,
+                      float &t_enter);
+
+struct RayQuery
+{
+    float t_min = 0.0f;
+    float t_max = std::numeric_limits<float>::max();
+    // 센서를 단 entity처럼 맞으면 안 되는 primitive의 user id
+    std::uint32_t ignore_user = kNoRayUser;
+};
+
+struct RayHit
+{
+    float distance = 0.0f;
+    std::uint32_t primitive = kNoPrimitive;
+};
+
+// 상자(월드 AABB)와 삼각형을 섞어 담는 BVH. binned SAH로 만들고, 같은 원점에서 나가는 레이 묶음을
+// packet 단위로 순회한다. 노드 slab test와 primitive 교차를 packet의 레이 4개(SSE2) 또는 8개(AVX 빌드)에
+// 한꺼번에 계산하고, 레이가 하나라도 노드와 겹치면 내려간다. LiDAR처럼 인접한 빔은 같은 노드를 지나므로
+// 노드 하나를 읽는 비용이 packet 폭만큼 나뉜다. primitive는 build()에서 순서가 바뀐다
+class RayBvh
+{
+public:
+    // 이 빌드에서 쓸 수 있는 가장 넓은 packet. SIMD가 없으면 1
+    static std::size_t maxPacketWidth();
+
+    void clear();
+    void reserve(std::size_t primitive_count);
+    void addBox(const glm::vec3 &aabb_min, const glm::vec3 &aabb_max, std::uint32_t user_id);
+    // a, b, c가 반시계로 보이는 쪽이 바깥
+    void addTriangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c, std::uint32_t user_id);
+    // 추가한 primitive로 트리를 다시 만든다. 이전 트리와 primitive 인덱스는 무효가 된다
+    void build();
+
+    bool empty() const { return nodes_.empty(); }
+    std::size_t primitiveCount() const { return primitives_.size(); }
+    std::size_t nodeCount() const { return nodes_.size(); }
+    std::uint32_t userId(std::uint32_t primitive) const { return primitives_[primitive].user_id; }
+    // primitive 표면의 point에서 바깥쪽 단위 법선
+    glm::vec3 normalAt(std::uint32_t primitive, const glm::vec3 &point) const;
+
+    // hits[i]에 origin에서 directions[i] 방향으로 가장 가까운 교차를 쓴다. distance는 direction 길이 단위.
+    // packet_width개(maxPacketWidth()로 잘린다)씩 묶어 순회하고, 1이면 레이를 하나씩 따라간다.
+    // hits는 directions 이상의 크기여야 한다. 여러 스레드에서 동시에 불러도 된다
+    void intersect(const glm::vec3 &origin,
+                   std::span<const glm::vec3> directions,
+                   const RayQuery &query,
+                   std::span<RayHit> hits,
+                   std::size_t packet_width) const;
+
+private:
+    enum class PrimitiveKind : std::uint32_t
+    {
+        Box,
+        Triangle,
+    };
+
+    // Box: p0 = min, p1 = max. Triangle: p0 = a, p1 = b - a, p2 = c - a
+    struct Primitive
+    {
+        glm::vec3 p0{0.0f};
+        std::uint32_t user_id = kNoRayUser;
+        glm::vec3 p1{0.0f};
+        PrimitiveKind kind = PrimitiveKind::Box;
+        glm::vec3 p2{0.0f};
+    };
+
+    struct Node
+    {
+        glm::vec3 bounds_min{0.0f};
+        // leaf: 첫 primitive. 내부 노드: 왼쪽 자식 (오른쪽은 first + 1)
+        std::uint32_t first = 0;
+        glm::vec3 bounds_max{0.0f};
+        std::uint16_t count = 0; // 0이면 내부 노드
+        std::uint16_t axis = 0;  // 내부 노드를 나눈 축
+    };
+
+    struct BuildTask
+    {
+        std::uint32_t node;
+        std::uint32_t begin;
+        std::uint32_t end;
+        std::uint32_t depth;
+    };
+
+    void primitiveBounds(const Primitive &primitive, glm::vec3 &bounds_min, glm::vec3 &bounds_max) const;
+    // [begin, end)를 나눌 위치. 나누지 않는 편이 싸면 end
+    std::uint32_t splitSah(std::uint32_t begin, std::uint32_t end, int axis, const glm::vec3 &centroid_min, const glm::vec3 &centroid_max);
+    void intersectSingle(const glm::vec3 &origin, const glm::vec3 &direction, const RayQuery &query, RayHit &hit) const;
+    template <typename Lanes>
+    void intersectPacket(const glm::vec3 &origin, const glm::vec3 *directions, std::size_t count, const RayQuery &query, RayHit *hits) const;
+
+    std::vector<Primitive> primitives_;
+    std::vector<Node> nodes_;
+
+    // build() 중간 데이터. 다시 만들 때 용량을 재사용한다
+    std::vector<std::uint32_t> order_;
+    std::vector<glm::vec3> centroids_;
+    std::vector<glm::vec3> bounds_min_;
+    std::vector<glm::vec3> bounds_max_;
+    std::vector<Primitive> reordered_;
+    std::vector<BuildTask> tasks_;
+};
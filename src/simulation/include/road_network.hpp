@@ -0,0 +1,21 @@
+#pragma once
+
+#include "lane_graph.hpp"
+
+#include <glm/glm.hpp>
+
+struct GridRoadConfig
+{
+    // 교차로 격자: (blocks_x + 1) x (blocks_z + 1) 개의 교차로
+    int blocks_x = 16;
+    int blocks_z = 16;
+    float block_size = 12.0f;
+    // 도로 중앙선에서 차로 중심까지 (우측 통행)
+    float lane_offset = 1.0f;
+    // 교차로 (0, 0)의 위치
+    glm::vec3 origin{0.0f};
+};
+
+// 격자 도로망. 이웃 교차로 사이마다 방향별 차로가 하나씩 있고, 교차로에서는 유턴을 뺀 모든 방향으로 이어진다.
+// 길이 하나뿐인 막다른 교차로에서만 유턴을 허용한다
+LaneGraph buildGridRoadNetwork(const GridRoadConfig &config);
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "lane_graph.hpp"
+#include "lane_router.hpp"
+#include "radix_sort.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class ThreadPool;
+
+// Intelligent Driver Model 상수. 모든 에이전트가 같은 값을 쓰고 원하는 속도만 에이전트마다 다르다
+struct IdmParams
+{
+    float max_acceleration = 1.5f;         // a (m/s^2)
+    float comfortable_deceleration = 2.0f; // b (m/s^2)
+    float min_gap = 2.0f;                  // s0 (m)
+    float time_headway = 1.2f;             // T (s)
+    float vehicle_length = 4.0f;
+    // 물리적으로 낼 수 있는 최대 감속 (m/s^2). 겹쳐 생성된 차량이 발산하지 않게 막는다
+    float max_braking = 9.0f;
+};
+
+struct TrafficStepStats
+{
+    std::size_t lane_changes = 0;
+    std::size_t reroutes = 0;
+};
+
+// 차로를 따라 달리는 에이전트 집합. 상태(lane, s, v, a, leader)는 에이전트 인덱스 순서의 SoA 배열이다.
+// 한 스텝은
+//   1. (lane, s) 키를 radix sort해 같은 차로의 바로 앞차를 찾고, 차로 끝이면 경로상 다음 차로의 맨 뒤 차를 본다
+//   2. IDM 가속도와 적분을 4개씩 SIMD로 병렬 계산한다
+//   3. 차로 끝을 넘은 에이전트를 다음 차로로 옮기고, 경로가 끝난 에이전트는 모아서 LaneRouter로 일괄 재탐색한다
+// 교차로의 우선순위/신호는 아직 없다. graph는 model보다 오래 살아야 한다
+class TrafficModel
+{
+public:
+    explicit TrafficModel(const LaneGraph &graph, const IdmParams &params = {}, std::uint32_t seed = 0x5eed);
+
+    // 에이전트 인덱스를 돌려준다. 첫 스텝에서 무작위 목적지로 경로를 찾는다
+    std::uint32_t addAgent(lane_id lane, float offset, float desired_speed);
+    std::size_t agentCount() const { return lane_.size(); }
+
+    void step(float dt, ThreadPool &pool);
+
+    const std::vector<lane_id> &lanes() const { return lane_; }
+    const std::vector<float> &offsets() const { return s_; }
+    // 직전 스텝 시작 시점의 offset. 차로를 옮긴 에이전트는 새 차로 기준이라 음수일 수 있다
+    const std::vector<float> &previousOffsets() const { return previous_s_; }
+    const std::vector<float> &speeds() const { return v_; }
+    const std::vector<float> &accelerations() const { return a_; }
+    // 앞차의 에이전트 인덱스. 없으면 kNoLeader
+    const std::vector<std::int32_t> &leaders() const { return leader_; }
+    const TrafficStepStats &lastStepStats() const { return stats_; }
+
+    static constexpr std::int32_t kNoLeader = -1;
+
+private:
+    lane_id nextLane(std::uint32_t agent) const;
+    void findLeaders(ThreadPool &pool);
+    void integrate(float dt, ThreadPool &pool);
+    void advanceLanes(ThreadPool &pool);
+    void reroute(ThreadPool &pool);
+    lane_id randomLane();
+
+    const LaneGraph &graph_;
+    IdmParams params_;
+    LaneRouter router_;
+    std::uint32_t rng_state_;
+
+    // 에이전트 상태 (SoA)
+    std::vector<lane_id> lane_;
+    std::vector<float> s_;
+    std::vector<float> previous_s_;
+    std::vector<float> v_;
+    std::vector<float> a_;
+    std::vector<float> desired_v_;
+    std::vector<std::int32_t> leader_;
+    // 앞차 탐색 결과. IDM 커널의 입력
+    std::vector<float> gap_;
+    std::vector<float> leader_v_;
+
+    // 경로는 차로를 옮길 때만 읽으므로 따로 둔다
+    std::vector<Route> routes_;
+    std::vector<std::uint32_t> route_position_;
+    std::vector<std::uint8_t> needs_route_;
+    std::vector<std::uint32_t> reroute_agents_;
+    std::vector<RouteRequest> route_requests_;
+    std::vector<Route> route_results_;
+
+    std::vector<SortKeyIndex> sort_keys_;
+    std::vector<SortKeyIndex> sort_scratch_;
+    // 차로별로 정렬 순서상 맨 뒤(가장 작은 s) 에이전트의 위치
+    std::vector<std::uint32_t> lane_first_;
+
+    TrafficStepStats stats_;
+};
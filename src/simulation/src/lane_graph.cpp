@@ -0,0 +1,245 @@
+#include "lane_graph.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+// 점 p에서 선분 ab까지 가장 가까운 점의 매개변수 t (0..1)
+float closestParameter(const glm::vec3 &p, const glm::vec3 &a, const glm::vec3 &b)
+{
+    const glm::vec3 ab = b - a;
+    const float length_squared = glm::dot(ab, ab);
+    if (length_squared <= 1e-12f)
+        return 0.0f;
+    return std::clamp(glm::dot(p - a, ab) / length_squared, 0.0f, 1.0f);
+}
+} // namespace
+
+std::span<const glm::vec3> LaneGraph::centerline(lane_id lane) const
+{
+    const std::uint32_t begin = point_offsets_[lane];
+    return {points_.data() + begin, point_offsets_[lane + 1] - begin};
+}
+
+std::uint32_t LaneGraph::segmentEnd(lane_id lane, float offset) const
+{
+    // offset을 넘는 첫 점. 범위 밖이면 첫/마지막 선분
+    const auto first = arc_lengths_.begin() + point_offsets_[lane];
+    const auto last = arc_lengths_.begin() + point_offsets_[lane + 1];
+    const auto upper = std::min(std::upper_bound(first + 1, last, offset), last - 1);
+    return static_cast<std::uint32_t>(upper - arc_lengths_.begin());
+}
+
+glm::vec3 LaneGraph::pointAt(lane_id lane, float offset) const
+{
+    if (offset <= 0.0f)
+        return laneStart(lane);
+    if (offset >= lengths_[lane])
+        return laneEnd(lane);
+
+    const std::uint32_t index = segmentEnd(lane, offset);
+    const float segment_begin = arc_lengths_[index - 1];
+    const float segment_length = arc_lengths_[index] - segment_begin;
+    const float t = segment_length > 0.0f ? (offset - segment_begin) / segment_length : 0.0f;
+    return points_[index - 1] + (points_[index] - points_[index - 1]) * t;
+}
+
+glm::vec3 LaneGraph::directionAt(lane_id lane, float offset) const
+{
+    const std::uint32_t index = segmentEnd(lane, offset);
+    const glm::vec3 segment = points_[index] - points_[index - 1];
+    const float length = glm::length(segment);
+    return length > 1e-6f ? segment / length : glm::vec3(0.0f, 0.0f, 1.0f);
+}
+
+std::span<const lane_id> LaneGraph::successors(lane_id lane) const
+{
+    const std::uint32_t begin = edge_offsets_[lane];
+    return {edge_targets_.data() + begin, edge_offsets_[lane + 1] - begin};
+}
+
+std::span<const float> LaneGraph::successorCosts(lane_id lane) const
+{
+    const std::uint32_t begin = edge_offsets_[lane];
+    return {edge_costs_.data() + begin, edge_offsets_[lane + 1] - begin};
+}
+
+LaneHit LaneGraph::nearestLane(const glm::vec3 &position, float max_distance) const
+{
+    LaneHit hit;
+    if (cell_segments_.empty())
+        return hit;
+
+    // 격자 밖의 점은 가장 가까운 가장자리 셀부터 찾는다
+    const int center_x = std::clamp(static_cast<int>(std::floor((position.x - grid_origin_.x) / cell_size_)), 0, grid_width_ - 1);
+    const int center_z = std::clamp(static_cast<int>(std::floor((position.z - grid_origin_.y) / cell_size_)), 0, grid_height_ - 1);
+
+    auto visit_cell = [&](int cell_x, int cell_z)
+    {
+        const std::size_t cell = cellIndex(cell_x, cell_z);
+        for (std::uint32_t i = cell_offsets_[cell]; i < cell_offsets_[cell + 1]; ++i)
+        {
+            const SegmentRef &segment = cell_segments_[i];
+            const glm::vec3 &a = points_[segment.point];
+            const glm::vec3 &b = points_[segment.point + 1];
+            const float t = closestParameter(position, a, b);
+            const glm::vec3 point = a + (b - a) * t;
+            const float distance = glm::length(position - point);
+            if (distance < hit.distance)
+            {
+                hit.lane = segment.lane;
+                hit.distance = distance;
+                hit.point = point;
+                hit.offset = arc_lengths_[segment.point] + (arc_lengths_[segment.point + 1] - arc_lengths_[segment.point]) * t;
+            }
+        }
+    };
+
+    // 중심 셀에서 링을 넓혀 가며, 아직 안 본 셀까지의 거리가 현재 최근접보다 멀어지면 멈춘다
+    for (int ring = 0;; ++ring)
+    {
+        const int min_x = center_x - ring;
+        const int max_x = center_x + ring;
+        const int min_z = center_z - ring;
+        const int max_z = center_z + ring;
+        for (int cell_z = std::max(min_z, 0); cell_z <= std::min(max_z, grid_height_ - 1); ++cell_z)
+        {
+            const bool edge_row = cell_z == min_z || cell_z == max_z;
+            for (int cell_x = std::max(min_x, 0); cell_x <= std::min(max_x, grid_width_ - 1); ++cell_x)
+            {
+                if (edge_row || cell_x == min_x || cell_x == max_x)
+                    visit_cell(cell_x, cell_z);
+            }
+        }
+
+        // 본 정사각 영역 밖(격자 안)의 선분까지의 최소 거리. 격자 전체를 덮었으면 무한대
+        float unvisited = std::numeric_limits<float>::max();
+        if (min_x > 0)
+            unvisited = std::min(unvisited, position.x - (grid_origin_.x + static_cast<float>(min_x) * cell_size_));
+        if (max_x < grid_width_ - 1)
+            unvisited = std::min(unvisited, grid_origin_.x + static_cast<float>(max_x + 1) * cell_size_ - position.x);
+        if (min_z > 0)
+            unvisited = std::min(unvisited, position.z - (grid_origin_.y + static_cast<float>(min_z) * cell_size_));
+        if (max_z < grid_height_ - 1)
+            unvisited = std::min(unvisited, grid_origin_.y + static_cast<float>(max_z + 1) * cell_size_ - position.z);
+        if (hit.distance <= unvisited || unvisited > max_distance)
+            break;
+    }
+
+    if (hit.distance > max_distance)
+        return LaneHit{};
+    return hit;
+}
+
+void LaneGraph::buildSpatialIndex(float cell_size)
+{
+    cell_size_ = std::max(cell_size, 1e-3f);
+    glm::vec2 bounds_min(std::numeric_limits<float>::max());
+    glm::vec2 bounds_max(std::numeric_limits<float>::lowest());
+    for (const glm::vec3 &point : points_)
+    {
+        bounds_min = glm::min(bounds_min, glm::vec2(point.x, point.z));
+        bounds_max = glm::max(bounds_max, glm::vec2(point.x, point.z));
+    }
+    grid_origin_ = bounds_min;
+    grid_width_ = std::max(1, static_cast<int>(std::floor((bounds_max.x - bounds_min.x) / cell_size_)) + 1);
+    grid_height_ = std::max(1, static_cast<int>(std::floor((bounds_max.y - bounds_min.y) / cell_size_)) + 1);
+
+    // 선분의 xz AABB가 걸치는 셀마다 한 번씩 넣는다. 먼저 세고, 누적한 뒤 채운다
+    const std::size_t cell_count = static_cast<std::size_t>(grid_width_) * static_cast<std::size_t>(grid_height_);
+    cell_offsets_.assign(cell_count + 1, 0);
+    auto for_each_cell = [&](const glm::vec3 &a, const glm::vec3 &b, auto &&func)
+    {
+        const int x0 = std::clamp(static_cast<int>(std::floor((std::min(a.x, b.x) - grid_origin_.x) / cell_size_)), 0, grid_width_ - 1);
+        const int x1 = std::clamp(static_cast<int>(std::floor((std::max(a.x, b.x) - grid_origin_.x) / cell_size_)), 0, grid_width_ - 1);
+        const int z0 = std::clamp(static_cast<int>(std::floor((std::min(a.z, b.z) - grid_origin_.y) / cell_size_)), 0, grid_height_ - 1);
+        const int z1 = std::clamp(static_cast<int>(std::floor((std::max(a.z, b.z) - grid_origin_.y) / cell_size_)), 0, grid_height_ - 1);
+        for (int z = z0; z <= z1; ++z)
+        {
+            for (int x = x0; x <= x1; ++x)
+                func(cellIndex(x, z));
+        }
+    };
+
+    const auto lane_count = static_cast<lane_id>(laneCount());
+    for (lane_id lane = 0; lane < lane_count; ++lane)
+    {
+        for (std::uint32_t point = point_offsets_[lane]; point + 1 < point_offsets_[lane + 1]; ++point)
+            for_each_cell(points_[point], points_[point + 1], [&](std::size_t cell)
+                          { ++cell_offsets_[cell + 1]; });
+    }
+    for (std::size_t cell = 0; cell < cell_count; ++cell)
+        cell_offsets_[cell + 1] += cell_offsets_[cell];
+
+    cell_segments_.resize(cell_offsets_[cell_count]);
+    std::vector<std::uint32_t> cursor(cell_offsets_.begin(), cell_offsets_.end() - 1);
+    for (lane_id lane = 0; lane < lane_count; ++lane)
+    {
+        for (std::uint32_t point = point_offsets_[lane]; point + 1 < point_offsets_[lane + 1]; ++point)
+            for_each_cell(points_[point], points_[point + 1], [&](std::size_t cell)
+                          { cell_segments_[cursor[cell]++] = SegmentRef{lane, point}; });
+    }
+}
+
+lane_id LaneGraphBuilder::addLane(std::span<const glm::vec3> centerline)
+{
+    if (centerline.size() < 2)
+        throw std::invalid_argument("lane centerline needs at least two points");
+    lanes_.emplace_back(centerline.begin(), centerline.end());
+    return static_cast<lane_id>(lanes_.size() - 1);
+}
+
+void LaneGraphBuilder::connect(lane_id from, lane_id to)
+{
+    if (from >= lanes_.size() || to >= lanes_.size())
+        throw std::out_of_range("lane connection references an unknown lane");
+    connections_.emplace_back(from, to);
+}
+
+LaneGraph LaneGraphBuilder::build(float cell_size) const
+{
+    LaneGraph graph;
+    const std::size_t lane_count = lanes_.size();
+
+    graph.point_offsets_.reserve(lane_count + 1);
+    graph.lengths_.reserve(lane_count);
+    graph.point_offsets_.push_back(0);
+    for (const std::vector<glm::vec3> &centerline : lanes_)
+    {
+        float length = 0.0f;
+        for (std::size_t i = 0; i < centerline.size(); ++i)
+        {
+            if (i > 0)
+                length += glm::length(centerline[i] - centerline[i - 1]);
+            graph.points_.push_back(centerline[i]);
+            graph.arc_lengths_.push_back(length);
+        }
+        graph.point_offsets_.push_back(static_cast<std::uint32_t>(graph.points_.size()));
+        graph.lengths_.push_back(length);
+    }
+
+    // 출발 lane 순으로 모으되 같은 lane 안에서는 추가한 순서를 지킨다
+    std::vector<std::pair<lane_id, lane_id>> connections = connections_;
+    std::stable_sort(connections.begin(), connections.end(), [](const auto &a, const auto &b)
+                     { return a.first < b.first; });
+    connections.erase(std::unique(connections.begin(), connections.end()), connections.end());
+
+    graph.edge_offsets_.assign(lane_count + 1, 0);
+    graph.edge_targets_.reserve(connections.size());
+    graph.edge_costs_.reserve(connections.size());
+    for (const auto &[from, to] : connections)
+    {
+        ++graph.edge_offsets_[from + 1];
+        graph.edge_targets_.push_back(to);
+        // 끝점과 다음 시작점 사이 간격까지 더해야 직선거리 휴리스틱이 과대평가하지 않는다
+        const float gap = glm::length(graph.laneStart(to) - graph.laneEnd(from));
+        graph.edge_costs_.push_back(graph.lengths_[from] + gap);
+    }
+    for (std::size_t lane = 0; lane < lane_count; ++lane)
+        graph.edge_offsets_[lane + 1] += graph.edge_offsets_[lane];
+
+    graph.buildSpatialIndex(cell_size);
+    return graph;
+}
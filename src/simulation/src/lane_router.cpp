@@ -0,0 +1,175 @@
+#include "lane_router.hpp"
+
+#include "profiler.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+// 한 작업이 맡는 최소 요청 수
+constexpr std::size_t kMinRequestsPerTask = 16;
+} // namespace
+
+struct LaneRouter::SearchScratch
+{
+    struct HeapEntry
+    {
+        float f;
+        float g;
+        lane_id lane;
+    };
+
+    // lane_count번째 칸은 목표 차로 끝에 붙인 가상 목표 노드
+    std::vector<float> g;
+    std::vector<lane_id> parent;
+    std::vector<std::uint32_t> generation;
+    std::uint32_t current = 0;
+    std::vector<HeapEntry> heap;
+
+    explicit SearchScratch(std::size_t lane_count)
+        : g(lane_count + 1, 0.0f),
+          parent(lane_count + 1, kInvalidLane),
+          generation(lane_count + 1, 0)
+    {
+    }
+
+    void begin()
+    {
+        // generation이 한 바퀴 돌면 한 번만 지운다
+        if (++current == 0)
+        {
+            std::fill(generation.begin(), generation.end(), 0u);
+            current = 1;
+        }
+        heap.clear();
+    }
+
+    bool visited(lane_id node) const { return generation[node] == current; }
+
+    void push(float f, float cost, lane_id node)
+    {
+        heap.push_back(HeapEntry{f, cost, node});
+        std::push_heap(heap.begin(), heap.end(), [](const HeapEntry &a, const HeapEntry &b)
+                       { return a.f > b.f; });
+    }
+
+    HeapEntry pop()
+    {
+        std::pop_heap(heap.begin(), heap.end(), [](const HeapEntry &a, const HeapEntry &b)
+                      { return a.f > b.f; });
+        const HeapEntry entry = heap.back();
+        heap.pop_back();
+        return entry;
+    }
+};
+
+LaneRouter::LaneRouter(const LaneGraph &graph)
+    : graph_(graph)
+{
+}
+
+LaneRouter::~LaneRouter() = default;
+
+bool LaneRouter::findRoute(const RouteRequest &request, Route &route)
+{
+    std::unique_ptr<SearchScratch> scratch = acquireScratch();
+    const bool found = search(request, route, *scratch);
+    releaseScratch(std::move(scratch));
+    return found;
+}
+
+void LaneRouter::findRoutes(const std::vector<RouteRequest> &requests, std::vector<Route> &routes, ThreadPool &pool)
+{
+    PROFILE_SCOPE("LaneRouter::findRoutes");
+    if (routes.size() < requests.size())
+        routes.resize(requests.size());
+
+    pool.parallelForRange(requests.size(), kMinRequestsPerTask, [&](std::size_t begin, std::size_t end)
+                          {
+        std::unique_ptr<SearchScratch> scratch = acquireScratch();
+        for (std::size_t i = begin; i < end; ++i)
+            search(requests[i], routes[i], *scratch);
+        releaseScratch(std::move(scratch)); });
+}
+
+std::unique_ptr<LaneRouter::SearchScratch> LaneRouter::acquireScratch()
+{
+    {
+        std::lock_guard<std::mutex> lock(scratch_mutex_);
+        if (!free_scratch_.empty())
+        {
+            std::unique_ptr<SearchScratch> scratch = std::move(free_scratch_.back());
+            free_scratch_.pop_back();
+            return scratch;
+        }
+    }
+    return std::make_unique<SearchScratch>(graph_.laneCount());
+}
+
+void LaneRouter::releaseScratch(std::unique_ptr<SearchScratch> scratch)
+{
+    std::lock_guard<std::mutex> lock(scratch_mutex_);
+    free_scratch_.push_back(std::move(scratch));
+}
+
+bool LaneRouter::search(const RouteRequest &request, Route &route, SearchScratch &scratch) const
+{
+    route.found = false;
+    route.cost = 0.0f;
+    route.lanes.clear();
+    route.expanded = 0;
+
+    const auto lane_count = static_cast<lane_id>(graph_.laneCount());
+    if (request.from >= lane_count || request.to >= lane_count)
+        return false;
+
+    // 비용은 차로 시작점 기준. 목표 차로를 꺼내면 그 길이만큼 더해 가상 목표 노드로 보낸다
+    const lane_id goal = lane_count;
+    const glm::vec3 target = graph_.laneEnd(request.to);
+    auto heuristic = [&](lane_id lane)
+    { return glm::length(target - graph_.laneStart(lane)); };
+    auto relax = [&](lane_id node, lane_id from, float cost, float h)
+    {
+        if (scratch.visited(node) && scratch.g[node] <= cost)
+            return;
+        scratch.generation[node] = scratch.current;
+        scratch.g[node] = cost;
+        scratch.parent[node] = from;
+        scratch.push(cost + h, cost, node);
+    };
+
+    scratch.begin();
+    relax(request.from, kInvalidLane, 0.0f, heuristic(request.from));
+    while (!scratch.heap.empty())
+    {
+        const SearchScratch::HeapEntry entry = scratch.pop();
+        // 더 싼 경로로 다시 넣은 노드의 낡은 항목
+        if (entry.g > scratch.g[entry.lane])
+            continue;
+        ++route.expanded;
+
+        if (entry.lane == goal)
+        {
+            route.found = true;
+            route.cost = entry.g;
+            for (lane_id lane = scratch.parent[goal]; lane != kInvalidLane; lane = scratch.parent[lane])
+                route.lanes.push_back(lane);
+            std::reverse(route.lanes.begin(), route.lanes.end());
+            return true;
+        }
+
+        if (entry.lane == request.to)
+            relax(goal, entry.lane, entry.g + graph_.laneLength(entry.lane), 0.0f);
+
+        const std::span<const lane_id> successors = graph_.successors(entry.lane);
+        const std::span<const float> costs = graph_.successorCosts(entry.lane);
+        for (std::size_t i = 0; i < successors.size(); ++i)
+        {
+            const lane_id next = successors[i];
+            relax(next, entry.lane, entry.g + costs[i], heuristic(next));
+        }
+    }
+    return false;
+}
@@ -0,0 +1,114 @@
+#include "lidar_scan.hpp"
+
+#include "profiler.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace
+{
+constexpr float kPi = 3.14159265358979f;
+// 병렬 작업 하나가 맡는 최소 column 수
+constexpr std::size_t kMinColumnsPerTask = 8;
+// 한 번에 BVH에 넘기는 레이 수. 스택 배열 크기
+constexpr std::size_t kRaysPerBatch = 64;
+// 이 거리보다 멀면 intensity가 거리 제곱에 반비례해 줄어든다
+constexpr float kIntensityReferenceRange = 10.0f;
+
+float channelElevationDeg(const LidarScanConfig &config, std::uint32_t channel)
+{
+    const float t = config.channels > 1 ? static_cast<float>(channel) / static_cast<float>(config.channels - 1) : 0.5f;
+    const bool spans_horizon = config.elevation_min_deg < 0.0f && config.elevation_max_deg > 0.0f;
+    if (config.layout == LidarBeamLayout::Uniform || !spans_horizon)
+        return config.elevation_min_deg + (config.elevation_max_deg - config.elevation_min_deg) * t;
+
+    // [-1, 1]을 s * |s|로 눌러 0 근처 간격을 좁히고 양 끝은 fov 경계에 맞춘다
+    const float s = 2.0f * t - 1.0f;
+    const float curved = s * std::abs(s);
+    return curved < 0.0f ? -curved * config.elevation_min_deg : curved * config.elevation_max_deg;
+}
+} // namespace
+
+LidarScanPattern::LidarScanPattern(const LidarScanConfig &config)
+    : config_(config)
+{
+    config_.channels = std::max(config_.channels, 1u);
+    config_.columns = std::max(config_.columns, 1u);
+
+    elevations_deg_.resize(config_.channels);
+    for (std::uint32_t channel = 0; channel < config_.channels; ++channel)
+        elevations_deg_[channel] = channelElevationDeg(config_, channel);
+
+    directions_.resize(static_cast<std::size_t>(config_.channels) * config_.columns);
+    for (std::uint32_t column = 0; column < config_.columns; ++column)
+    {
+        const float azimuth = 2.0f * kPi * static_cast<float>(column) / static_cast<float>(config_.columns);
+        for (std::uint32_t channel = 0; channel < config_.channels; ++channel)
+        {
+            const float elevation = elevations_deg_[channel] * kPi / 180.0f;
+            directions_[static_cast<std::size_t>(column) * config_.channels + channel] =
+                glm::vec3(std::cos(elevation) * std::sin(azimuth), std::sin(elevation), std::cos(elevation) * std::cos(azimuth));
+        }
+    }
+}
+
+std::span<const glm::vec3> LidarScanPattern::column(std::uint32_t column) const
+{
+    return std::span<const glm::vec3>(directions_).subspan(static_cast<std::size_t>(column) * config_.channels, config_.channels);
+}
+
+void castLidarColumns(const RayBvh &bvh,
+                      const LidarScanPattern &pattern,
+                      const LidarCastParams &params,
+                      std::uint32_t first_column,
+                      std::uint32_t column_count,
+                      std::span<LidarPoint> points,
+                      ThreadPool &pool)
+{
+    PROFILE_SCOPE("castLidarColumns");
+    const std::uint32_t columns = pattern.config().columns;
+    const std::uint32_t channels = pattern.config().channels;
+    column_count = std::min(column_count, columns);
+    if (column_count == 0 || points.size() < pattern.rayCount())
+        return;
+
+    const RayQuery query{params.min_range, params.max_range, params.ignore_entity};
+    const glm::mat3 rotation = glm::mat3_cast(params.orientation);
+    pool.parallelForRange(column_count, kMinColumnsPerTask, [&](std::size_t begin, std::size_t end)
+                          {
+        std::array<glm::vec3, kRaysPerBatch> directions;
+        std::array<RayHit, kRaysPerBatch> hits;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const auto column = static_cast<std::uint32_t>((first_column + i) % columns);
+            const std::span<const glm::vec3> local = pattern.column(column);
+            LidarPoint *out = &points[static_cast<std::size_t>(column) * channels];
+            for (std::size_t base = 0; base < local.size(); base += kRaysPerBatch)
+            {
+                const std::size_t count = std::min(kRaysPerBatch, local.size() - base);
+                for (std::size_t k = 0; k < count; ++k)
+                    directions[k] = rotation * local[base + k];
+                bvh.intersect(params.origin, std::span<const glm::vec3>(directions.data(), count), query,
+                              std::span<RayHit>(hits.data(), count), params.packet_width);
+
+                for (std::size_t k = 0; k < count; ++k)
+                {
+                    LidarPoint &point = out[base + k];
+                    const RayHit &hit = hits[k];
+                    if (hit.primitive == kNoPrimitive)
+                    {
+                        point = LidarPoint{};
+                        continue;
+                    }
+                    const glm::vec3 normal = bvh.normalAt(hit.primitive, params.origin + directions[k] * hit.distance);
+                    const float cosine = std::abs(glm::dot(normal, directions[k]));
+                    const float falloff = std::min(1.0f, (kIntensityReferenceRange * kIntensityReferenceRange) / (hit.distance * hit.distance));
+                    point.range = hit.distance;
+                    point.intensity = cosine * falloff;
+                    point.entity = bvh.userId(hit.primitive);
+                }
+            }
+        } });
+}
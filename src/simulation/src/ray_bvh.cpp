@@ -0,0 +1,612 @@
+#include "ray_bvh.hpp"
+
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RAY_BVH_SSE2 1
+#endif
+
+// 기본 빌드는 SSE2까지만 가정한다. -mavx 등으로 빌드하면 8개 packet을 쓸 수 있다
+#if defined(__AVX__)
+#include <immintrin.h>
+#define RAY_BVH_AVX 1
+#endif
+
+namespace
+{
+constexpr float kParallelEpsilon = 1e-6f;
+constexpr float kHugeInverse = 1e30f;
+// 삼각형 평면과 거의 나란한 레이는 맞지 않은 것으로 본다
+constexpr float kDeterminantEpsilon = 1e-9f;
+constexpr std::uint32_t kMaxLeafSize = 4;
+// SAH가 나누지 않는 편이 싸다고 해도 이보다 많으면 나눈다
+constexpr std::uint32_t kMaxLeafSizeForced = 16;
+constexpr int kBinCount = 16;
+// 이 깊이부터는 개수 중앙값으로 나눠 순회 스택을 넘지 않게 한다
+constexpr std::uint32_t kMedianSplitDepth = 40;
+constexpr std::size_t kTraversalStackSize = 96;
+// SAH 비용의 노드 순회 / primitive 교차 비율
+constexpr float kTraversalCost = 1.0f;
+
+float halfArea(const glm::vec3 &bounds_min, const glm::vec3 &bounds_max)
+{
+    const glm::vec3 size = bounds_max - bounds_min;
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+struct Bin
+{
+    glm::vec3 bounds_min{std::numeric_limits<float>::max()};
+    glm::vec3 bounds_max{std::numeric_limits<float>::lowest()};
+    std::uint32_t count = 0;
+
+    void grow(const glm::vec3 &other_min, const glm::vec3 &other_max)
+    {
+        bounds_min = glm::min(bounds_min, other_min);
+        bounds_max = glm::max(bounds_max, other_max);
+    }
+
+    float area() const { return count > 0 ? halfArea(bounds_min, bounds_max) : 0.0f; }
+};
+
+#ifdef RAY_BVH_SSE2
+struct Lanes4
+{
+    using Float = __m128;
+    static constexpr std::size_t kWidth = 4;
+
+    static Float set(float value) { return _mm_set1_ps(value); }
+    static Float load(const float *values) { return _mm_loadu_ps(values); }
+    static void store(float *values, Float v) { _mm_storeu_ps(values, v); }
+    static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+    static Float div(Float a, Float b) { return _mm_div_ps(a, b); }
+    static Float min(Float a, Float b) { return _mm_min_ps(a, b); }
+    static Float max(Float a, Float b) { return _mm_max_ps(a, b); }
+    static Float abs(Float v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+    static Float less(Float a, Float b) { return _mm_cmplt_ps(a, b); }
+    static Float lessEqual(Float a, Float b) { return _mm_cmple_ps(a, b); }
+    static Float greater(Float a, Float b) { return _mm_cmpgt_ps(a, b); }
+    static Float bitAnd(Float a, Float b) { return _mm_and_ps(a, b); }
+    // mask가 켜진 칸은 b, 아니면 a
+    static Float blend(Float a, Float b, Float mask) { return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a)); }
+    static int bits(Float mask) { return _mm_movemask_ps(mask); }
+};
+#endif
+
+#ifdef RAY_BVH_AVX
+struct Lanes8
+{
+    using Float = __m256;
+    static constexpr std::size_t kWidth = 8;
+
+    static Float set(float value) { return _mm256_set1_ps(value); }
+    static Float load(const float *values) { return _mm256_loadu_ps(values); }
+    static void store(float *values, Float v) { _mm256_storeu_ps(values, v); }
+    static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+    static Float div(Float a, Float b) { return _mm256_div_ps(a, b); }
+    static Float min(Float a, Float b) { return _mm256_min_ps(a, b); }
+    static Float max(Float a, Float b) { return _mm256_max_ps(a, b); }
+    static Float abs(Float v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+    static Float less(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static Float lessEqual(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+    static Float greater(Float a, Float b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+    static Float bitAnd(Float a, Float b) { return _mm256_and_ps(a, b); }
+    static Float blend(Float a, Float b, Float mask) { return _mm256_blendv_ps(a, b, mask); }
+    static int bits(Float mask) { return _mm256_movemask_ps(mask); }
+};
+#endif
+} // namespace
+
+glm::vec3 safeInverseDirection(const glm::vec3 &direction)
+{
+    glm::vec3 inverse;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float d = direction[axis];
+        inverse[axis] = std::abs(d) < kParallelEpsilon ? std::copysign(kHugeInverse, d) : 1.0f / d;
+    }
+    return inverse;
+}
+
+bool intersectRayAabb(const glm::vec3 &origin,
+                      const glm::vec3 &inv_direction,
+                      const glm::vec3 &aabb_min,
+                      const glm::vec3 &aabb_max,
+                      float t_min,
+                      float t_max,
+                      float &t_enter)
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float t1 = (aabb_min[axis] - origin[axis]) * inv_direction[axis];
+        const float t2 = (aabb_max[axis] - origin[axis]) * inv_direction[axis];
+        t_min = std::max(t_min, std::min(t1, t2));
+        t_max = std::min(t_max, std::max(t1, t2));
+        if (t_max < t_min)
+            return false;
+    }
+    t_enter = t_min;
+    return true;
+}
+
+std::size_t RayBvh::maxPacketWidth()
+{
+#if defined(RAY_BVH_AVX)
+    return 8;
+#elif defined(RAY_BVH_SSE2)
+    return 4;
+#else
+    return 1;
+#endif
+}
+
+void RayBvh::clear()
+{
+    primitives_.clear();
+    nodes_.clear();
+}
+
+void RayBvh::reserve(std::size_t primitive_count)
+{
+    primitives_.reserve(primitive_count);
+}
+
+void RayBvh::addBox(const glm::vec3 &aabb_min, const glm::vec3 &aabb_max, std::uint32_t user_id)
+{
+    Primitive primitive;
+    primitive.p0 = glm::min(aabb_min, aabb_max);
+    primitive.p1 = glm::max(aabb_min, aabb_max);
+    primitive.user_id = user_id;
+    primitive.kind = PrimitiveKind::Box;
+    primitives_.push_back(primitive);
+}
+
+void RayBvh::addTriangle(const glm::vec3 &a, const glm::vec3 &b, const glm::vec3 &c, std::uint32_t user_id)
+{
+    Primitive primitive;
+    primitive.p0 = a;
+    primitive.p1 = b - a;
+    primitive.p2 = c - a;
+    primitive.user_id = user_id;
+    primitive.kind = PrimitiveKind::Triangle;
+    primitives_.push_back(primitive);
+}
+
+void RayBvh::primitiveBounds(const Primitive &primitive, glm::vec3 &bounds_min, glm::vec3 &bounds_max) const
+{
+    if (primitive.kind == PrimitiveKind::Box)
+    {
+        bounds_min = primitive.p0;
+        bounds_max = primitive.p1;
+        return;
+    }
+    const glm::vec3 b = primitive.p0 + primitive.p1;
+    const glm::vec3 c = primitive.p0 + primitive.p2;
+    bounds_min = glm::min(primitive.p0, glm::min(b, c));
+    bounds_max = glm::max(primitive.p0, glm::max(b, c));
+}
+
+void RayBvh::build()
+{
+    PROFILE_SCOPE("RayBvh::build");
+    nodes_.clear();
+    const auto count = static_cast<std::uint32_t>(primitives_.size());
+    if (count == 0)
+        return;
+
+    order_.resize(count);
+    centroids_.resize(count);
+    bounds_min_.resize(count);
+    bounds_max_.resize(count);
+    for (std::uint32_t i = 0; i < count; ++i)
+    {
+        order_[i] = i;
+        primitiveBounds(primitives_[i], bounds_min_[i], bounds_max_[i]);
+        centroids_[i] = (bounds_min_[i] + bounds_max_[i]) * 0.5f;
+    }
+
+    // 이진 트리라 노드는 최대 2n - 1개. 미리 잡아 두면 작업 중 노드 참조가 무효화되지 않는다
+    nodes_.reserve(static_cast<std::size_t>(count) * 2);
+    nodes_.emplace_back();
+    tasks_.clear();
+    tasks_.push_back(BuildTask{0, 0, count, 0});
+    while (!tasks_.empty())
+    {
+        const BuildTask task = tasks_.back();
+        tasks_.pop_back();
+
+        glm::vec3 node_min(std::numeric_limits<float>::max());
+        glm::vec3 node_max(std::numeric_limits<float>::lowest());
+        glm::vec3 centroid_min(std::numeric_limits<float>::max());
+        glm::vec3 centroid_max(std::numeric_limits<float>::lowest());
+        for (std::uint32_t i = task.begin; i < task.end; ++i)
+        {
+            const std::uint32_t primitive = order_[i];
+            node_min = glm::min(node_min, bounds_min_[primitive]);
+            node_max = glm::max(node_max, bounds_max_[primitive]);
+            centroid_min = glm::min(centroid_min, centroids_[primitive]);
+            centroid_max = glm::max(centroid_max, centroids_[primitive]);
+        }
+
+        Node &node = nodes_[task.node];
+        node.bounds_min = node_min;
+        node.bounds_max = node_max;
+
+        const std::uint32_t size = task.end - task.begin;
+        const glm::vec3 extent = centroid_max - centroid_min;
+        const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+        auto median_split = [&]()
+        {
+            const std::uint32_t middle = task.begin + size / 2;
+            std::nth_element(order_.begin() + task.begin, order_.begin() + middle, order_.begin() + task.end,
+                             [&](std::uint32_t a, std::uint32_t b)
+                             { return centroids_[a][axis] < centroids_[b][axis]; });
+            return middle;
+        };
+
+        std::uint32_t middle = task.end;
+        if (size > kMaxLeafSize)
+        {
+            if (extent[axis] <= 0.0f)
+                middle = size > kMaxLeafSizeForced ? task.begin + size / 2 : task.end; // 중심이 모두 같다
+            else if (task.depth >= kMedianSplitDepth)
+                middle = median_split();
+            else
+            {
+                middle = splitSah(task.begin, task.end, axis, centroid_min, centroid_max);
+                if (middle == task.end && size > kMaxLeafSizeForced)
+                    middle = median_split();
+            }
+        }
+
+        if (middle == task.begin || middle == task.end)
+        {
+            node.first = task.begin;
+            node.count = static_cast<std::uint16_t>(size);
+            continue;
+        }
+
+        const auto left = static_cast<std::uint32_t>(nodes_.size());
+        node.first = left;
+        node.count = 0;
+        node.axis = static_cast<std::uint16_t>(axis);
+        nodes_.emplace_back();
+        nodes_.emplace_back();
+        tasks_.push_back(BuildTask{left, task.begin, middle, task.depth + 1});
+        tasks_.push_back(BuildTask{left + 1, middle, task.end, task.depth + 1});
+    }
+
+    // leaf가 연속 구간을 가리키도록 primitive를 트리 순서로 옮긴다
+    reordered_.resize(count);
+    for (std::uint32_t i = 0; i < count; ++i)
+        reordered_[i] = primitives_[order_[i]];
+    primitives_.swap(reordered_);
+}
+
+std::uint32_t RayBvh::splitSah(std::uint32_t begin, std::uint32_t end, int axis, const glm::vec3 &centroid_min, const glm::vec3 &centroid_max)
+{
+    const float low = centroid_min[axis];
+    const float scale = static_cast<float>(kBinCount) / (centroid_max[axis] - low);
+    auto bin_of = [&](std::uint32_t primitive)
+    { return std::min(kBinCount - 1, static_cast<int>((centroids_[primitive][axis] - low) * scale)); };
+
+    std::array<Bin, kBinCount> bins{};
+    for (std::uint32_t i = begin; i < end; ++i)
+    {
+        const std::uint32_t primitive = order_[i];
+        Bin &bin = bins[bin_of(primitive)];
+        bin.grow(bounds_min_[primitive], bounds_max_[primitive]);
+        ++bin.count;
+    }
+
+    // 오른쪽에서부터 누적한 면적과 개수. 경계 b는 bin [0, b]와 [b + 1, kBinCount) 사이
+    std::array<float, kBinCount - 1> right_area{};
+    std::array<std::uint32_t, kBinCount - 1> right_count{};
+    Bin right;
+    for (int b = kBinCount - 1; b > 0; --b)
+    {
+        right.grow(bins[b].bounds_min, bins[b].bounds_max);
+        right.count += bins[b].count;
+        right_area[b - 1] = right.area();
+        right_count[b - 1] = right.count;
+    }
+
+    Bin left;
+    float best_cost = std::numeric_limits<float>::max();
+    int best_split = -1;
+    for (int b = 0; b < kBinCount - 1; ++b)
+    {
+        left.grow(bins[b].bounds_min, bins[b].bounds_max);
+        left.count += bins[b].count;
+        if (left.count == 0 || right_count[b] == 0)
+            continue;
+        const float cost = left.area() * static_cast<float>(left.count) + right_area[b] * static_cast<float>(right_count[b]);
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best_split = b;
+        }
+    }
+    if (best_split < 0)
+        return end;
+
+    left.grow(bins[kBinCount - 1].bounds_min, bins[kBinCount - 1].bounds_max);
+    left.count += bins[kBinCount - 1].count;
+    const float parent_area = left.area();
+    const float leaf_cost = parent_area * static_cast<float>(end - begin);
+    if (end - begin <= kMaxLeafSizeForced && kTraversalCost * parent_area + best_cost >= leaf_cost)
+        return end;
+
+    const auto middle = std::partition(order_.begin() + begin, order_.begin() + end, [&](std::uint32_t primitive)
+                                       { return bin_of(primitive) <= best_split; });
+    return static_cast<std::uint32_t>(middle - order_.begin());
+}
+
+glm::vec3 RayBvh::normalAt(std::uint32_t primitive, const glm::vec3 &point) const
+{
+    const Primitive &p = primitives_[primitive];
+    if (p.kind == PrimitiveKind::Triangle)
+        return glm::normalize(glm::cross(p.p1, p.p2));
+
+    // 중심에서 반 크기로 나눈 좌표가 가장 큰 축의 면
+    const glm::vec3 center = (p.p0 + p.p1) * 0.5f;
+    const glm::vec3 half = glm::max((p.p1 - p.p0) * 0.5f, glm::vec3(1e-6f));
+    const glm::vec3 local = (point - center) / half;
+    int axis = 0;
+    for (int i = 1; i < 3; ++i)
+    {
+        if (std::abs(local[i]) > std::abs(local[axis]))
+            axis = i;
+    }
+    glm::vec3 normal(0.0f);
+    normal[axis] = local[axis] < 0.0f ? -1.0f : 1.0f;
+    return normal;
+}
+
+void RayBvh::intersect(const glm::vec3 &origin,
+                       std::span<const glm::vec3> directions,
+                       const RayQuery &query,
+                       std::span<RayHit> hits,
+                       std::size_t packet_width) const
+{
+    const std::size_t count = std::min(directions.size(), hits.size());
+    if (nodes_.empty())
+    {
+        std::fill(hits.begin(), hits.begin() + static_cast<std::ptrdiff_t>(count), RayHit{});
+        return;
+    }
+
+    const std::size_t width = std::min(std::max<std::size_t>(packet_width, 1), maxPacketWidth());
+    std::size_t i = 0;
+#ifdef RAY_BVH_AVX
+    if (width >= Lanes8::kWidth)
+    {
+        for (; i < count; i += Lanes8::kWidth)
+            intersectPacket<Lanes8>(origin, &directions[i], std::min(Lanes8::kWidth, count - i), query, &hits[i]);
+    }
+#endif
+#ifdef RAY_BVH_SSE2
+    if (width >= Lanes4::kWidth)
+    {
+        for (; i < count; i += Lanes4::kWidth)
+            intersectPacket<Lanes4>(origin, &directions[i], std::min(Lanes4::kWidth, count - i), query, &hits[i]);
+    }
+#endif
+    for (; i < count; ++i)
+        intersectSingle(origin, directions[i], query, hits[i]);
+}
+
+void RayBvh::intersectSingle(const glm::vec3 &origin, const glm::vec3 &direction, const RayQuery &query, RayHit &hit) const
+{
+    const glm::vec3 inv_direction = safeInverseDirection(direction);
+    float best = query.t_max;
+    std::uint32_t best_primitive = kNoPrimitive;
+
+    std::array<std::uint32_t, kTraversalStackSize> stack;
+    std::size_t stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const Node &node = nodes_[stack[--stack_size]];
+        float t_enter;
+        if (!intersectRayAabb(origin, inv_direction, node.bounds_min, node.bounds_max, query.t_min, best, t_enter))
+            continue;
+
+        if (node.count == 0)
+        {
+            // 가까운 자식을 나중에 넣어 먼저 꺼낸다
+            const std::uint32_t near_offset = direction[node.axis] > 0.0f ? 0u : 1u;
+            stack[stack_size++] = node.first + (1u - near_offset);
+            stack[stack_size++] = node.first + near_offset;
+            continue;
+        }
+
+        for (std::uint32_t index = node.first; index < node.first + node.count; ++index)
+        {
+            const Primitive &primitive = primitives_[index];
+            if (query.ignore_user != kNoRayUser && primitive.user_id == query.ignore_user)
+                continue;
+
+            if (primitive.kind == PrimitiveKind::Box)
+            {
+                if (intersectRayAabb(origin, inv_direction, primitive.p0, primitive.p1, query.t_min, best, t_enter))
+                {
+                    best = t_enter;
+                    best_primitive = index;
+                }
+                continue;
+            }
+
+            // Moller-Trumbore
+            const glm::vec3 pvec = glm::cross(direction, primitive.p2);
+            const float det = glm::dot(primitive.p1, pvec);
+            if (std::abs(det) <= kDeterminantEpsilon)
+                continue;
+            const float inv_det = 1.0f / det;
+            const glm::vec3 tvec = origin - primitive.p0;
+            const float u = glm::dot(tvec, pvec) * inv_det;
+            if (u < 0.0f || u > 1.0f)
+                continue;
+            const glm::vec3 qvec = glm::cross(tvec, primitive.p1);
+            const float v = glm::dot(direction, qvec) * inv_det;
+            if (v < 0.0f || u + v > 1.0f)
+                continue;
+            const float t = glm::dot(primitive.p2, qvec) * inv_det;
+            if (t > query.t_min && t < best)
+            {
+                best = t;
+                best_primitive = index;
+            }
+        }
+    }
+
+    hit.primitive = best_primitive;
+    hit.distance = best_primitive == kNoPrimitive ? 0.0f : best;
+}
+
+template <typename Lanes>
+void RayBvh::intersectPacket(const glm::vec3 &origin, const glm::vec3 *directions, std::size_t count, const RayQuery &query, RayHit *hits) const
+{
+    using Float = typename Lanes::Float;
+    constexpr std::size_t kWidth = Lanes::kWidth;
+
+    alignas(32) float dx[kWidth], dy[kWidth], dz[kWidth], ix[kWidth], iy[kWidth], iz[kWidth];
+    glm::vec3 direction_sum(0.0f);
+    for (std::size_t lane = 0; lane < kWidth; ++lane)
+    {
+        // 남는 칸은 마지막 레이를 복제해 채우고 결과는 버린다
+        const glm::vec3 &direction = directions[std::min(lane, count - 1)];
+        const glm::vec3 inverse = safeInverseDirection(direction);
+        dx[lane] = direction.x;
+        dy[lane] = direction.y;
+        dz[lane] = direction.z;
+        ix[lane] = inverse.x;
+        iy[lane] = inverse.y;
+        iz[lane] = inverse.z;
+        direction_sum += direction;
+    }
+    const Float dir_x = Lanes::load(dx);
+    const Float dir_y = Lanes::load(dy);
+    const Float dir_z = Lanes::load(dz);
+    const Float inv_x = Lanes::load(ix);
+    const Float inv_y = Lanes::load(iy);
+    const Float inv_z = Lanes::load(iz);
+    const Float t_min = Lanes::set(query.t_min);
+    const Float zero = Lanes::set(0.0f);
+    const Float one = Lanes::set(1.0f);
+    const Float det_epsilon = Lanes::set(kDeterminantEpsilon);
+    Float t_best = Lanes::set(query.t_max);
+    std::array<std::uint32_t, kWidth> best_primitive;
+    best_primitive.fill(kNoPrimitive);
+
+    // 원점이 모든 레이에 공통이라 (경계 - 원점)은 스칼라 하나로 충분하다
+    auto slab = [&](const glm::vec3 &low, const glm::vec3 &high, Float &t_enter) -> Float
+    {
+        const Float x0 = Lanes::mul(Lanes::set(low.x - origin.x), inv_x);
+        const Float x1 = Lanes::mul(Lanes::set(high.x - origin.x), inv_x);
+        const Float y0 = Lanes::mul(Lanes::set(low.y - origin.y), inv_y);
+        const Float y1 = Lanes::mul(Lanes::set(high.y - origin.y), inv_y);
+        const Float z0 = Lanes::mul(Lanes::set(low.z - origin.z), inv_z);
+        const Float z1 = Lanes::mul(Lanes::set(high.z - origin.z), inv_z);
+        t_enter = Lanes::max(Lanes::max(Lanes::min(x0, x1), Lanes::min(y0, y1)), Lanes::max(Lanes::min(z0, z1), t_min));
+        const Float t_exit = Lanes::min(Lanes::min(Lanes::max(x0, x1), Lanes::max(y0, y1)), Lanes::min(Lanes::max(z0, z1), t_best));
+        return Lanes::lessEqual(t_enter, t_exit);
+    };
+    auto record = [&](int bits, std::uint32_t primitive)
+    {
+        for (std::size_t lane = 0; lane < kWidth; ++lane)
+        {
+            if (bits & (1 << lane))
+                best_primitive[lane] = primitive;
+        }
+    };
+
+    std::array<std::uint32_t, kTraversalStackSize> stack;
+    std::size_t stack_size = 0;
+    stack[stack_size++] = 0;
+    while (stack_size > 0)
+    {
+        const Node &node = nodes_[stack[--stack_size]];
+        Float t_enter;
+        if (Lanes::bits(slab(node.bounds_min, node.bounds_max, t_enter)) == 0)
+            continue;
+
+        if (node.count == 0)
+        {
+            // packet 방향의 합으로 가까운 자식을 고른다. 인접 빔끼리는 부호가 거의 같다
+            const std::uint32_t near_offset = direction_sum[node.axis] > 0.0f ? 0u : 1u;
+            stack[stack_size++] = node.first + (1u - near_offset);
+            stack[stack_size++] = node.first + near_offset;
+            continue;
+        }
+
+        for (std::uint32_t index = node.first; index < node.first + node.count; ++index)
+        {
+            const Primitive &primitive = primitives_[index];
+            if (query.ignore_user != kNoRayUser && primitive.user_id == query.ignore_user)
+                continue;
+
+            if (primitive.kind == PrimitiveKind::Box)
+            {
+                const Float hit = slab(primitive.p0, primitive.p1, t_enter);
+                const int bits = Lanes::bits(hit);
+                if (bits != 0)
+                {
+                    t_best = Lanes::blend(t_best, t_enter, hit);
+                    record(bits, index);
+                }
+                continue;
+            }
+
+            const glm::vec3 &edge1 = primitive.p1;
+            const glm::vec3 &edge2 = primitive.p2;
+            const glm::vec3 tvec = origin - primitive.p0;
+            const glm::vec3 qvec = glm::cross(tvec, edge1);
+            // pvec = direction x edge2
+            const Float px = Lanes::sub(Lanes::mul(dir_y, Lanes::set(edge2.z)), Lanes::mul(dir_z, Lanes::set(edge2.y)));
+            const Float py = Lanes::sub(Lanes::mul(dir_z, Lanes::set(edge2.x)), Lanes::mul(dir_x, Lanes::set(edge2.z)));
+            const Float pz = Lanes::sub(Lanes::mul(dir_x, Lanes::set(edge2.y)), Lanes::mul(dir_y, Lanes::set(edge2.x)));
+            const Float det = Lanes::add(Lanes::add(Lanes::mul(Lanes::set(edge1.x), px), Lanes::mul(Lanes::set(edge1.y), py)),
+                                         Lanes::mul(Lanes::set(edge1.z), pz));
+            const Float inv_det = Lanes::div(one, det);
+            const Float u = Lanes::mul(Lanes::add(Lanes::add(Lanes::mul(Lanes::set(tvec.x), px), Lanes::mul(Lanes::set(tvec.y), py)),
+                                                  Lanes::mul(Lanes::set(tvec.z), pz)),
+                                       inv_det);
+            const Float v = Lanes::mul(Lanes::add(Lanes::add(Lanes::mul(dir_x, Lanes::set(qvec.x)), Lanes::mul(dir_y, Lanes::set(qvec.y))),
+                                                  Lanes::mul(dir_z, Lanes::set(qvec.z))),
+                                       inv_det);
+            const Float t = Lanes::mul(Lanes::set(glm::dot(edge2, qvec)), inv_det);
+
+            // det가 0이면 u, v가 NaN이 되어 비교에서 모두 떨어진다
+            Float hit = Lanes::greater(Lanes::abs(det), det_epsilon);
+            hit = Lanes::bitAnd(hit, Lanes::lessEqual(zero, u));
+            hit = Lanes::bitAnd(hit, Lanes::lessEqual(zero, v));
+            hit = Lanes::bitAnd(hit, Lanes::lessEqual(Lanes::add(u, v), one));
+            hit = Lanes::bitAnd(hit, Lanes::greater(t, t_min));
+            hit = Lanes::bitAnd(hit, Lanes::less(t, t_best));
+            const int bits = Lanes::bits(hit);
+            if (bits != 0)
+            {
+                t_best = Lanes::blend(t_best, t, hit);
+                record(bits, index);
+            }
+        }
+    }
+
+    alignas(32) float distances[kWidth];
+    Lanes::store(distances, t_best);
+    for (std::size_t lane = 0; lane < count; ++lane)
+    {
+        hits[lane].primitive = best_primitive[lane];
+        hits[lane].distance = best_primitive[lane] == kNoPrimitive ? 0.0f : distances[lane];
+    }
+}
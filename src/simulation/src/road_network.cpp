@@ -0,0 +1,70 @@
+#include "road_network.hpp"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+LaneGraph buildGridRoadNetwork(const GridRoadConfig &config)
+{
+    const int nodes_x = std::max(1, config.blocks_x) + 1;
+    const int nodes_z = std::max(1, config.blocks_z) + 1;
+    auto node_index = [&](int x, int z)
+    { return static_cast<std::size_t>(z) * static_cast<std::size_t>(nodes_x) + static_cast<std::size_t>(x); };
+    auto node_position = [&](int x, int z)
+    { return config.origin + glm::vec3(static_cast<float>(x) * config.block_size, 0.0f, static_cast<float>(z) * config.block_size); };
+
+    const std::size_t node_count = static_cast<std::size_t>(nodes_x) * static_cast<std::size_t>(nodes_z);
+    // 교차로마다 들어오는/나가는 차로와 그 반대 방향 차로
+    struct LaneEnd
+    {
+        lane_id lane;
+        lane_id reverse;
+    };
+    std::vector<std::vector<LaneEnd>> incoming(node_count);
+    std::vector<std::vector<lane_id>> outgoing(node_count);
+
+    LaneGraphBuilder builder;
+    auto add_road = [&](int ax, int az, int bx, int bz)
+    {
+        const glm::vec3 a = node_position(ax, az);
+        const glm::vec3 b = node_position(bx, bz);
+        const glm::vec3 direction = glm::normalize(b - a);
+        // y가 위인 오른손 좌표계에서 진행 방향의 오른쪽
+        const glm::vec3 right(-direction.z, 0.0f, direction.x);
+        const glm::vec3 forward_offset = right * config.lane_offset;
+
+        const std::array<glm::vec3, 2> forward{a + forward_offset, b + forward_offset};
+        const std::array<glm::vec3, 2> backward{b - forward_offset, a - forward_offset};
+        const lane_id ab = builder.addLane(forward);
+        const lane_id ba = builder.addLane(backward);
+        outgoing[node_index(ax, az)].push_back(ab);
+        incoming[node_index(bx, bz)].push_back(LaneEnd{ab, ba});
+        outgoing[node_index(bx, bz)].push_back(ba);
+        incoming[node_index(ax, az)].push_back(LaneEnd{ba, ab});
+    };
+
+    for (int z = 0; z < nodes_z; ++z)
+    {
+        for (int x = 0; x < nodes_x; ++x)
+        {
+            if (x + 1 < nodes_x)
+                add_road(x, z, x + 1, z);
+            if (z + 1 < nodes_z)
+                add_road(x, z, x, z + 1);
+        }
+    }
+
+    for (std::size_t node = 0; node < node_count; ++node)
+    {
+        const bool dead_end = outgoing[node].size() == 1;
+        for (const LaneEnd &in : incoming[node])
+        {
+            for (const lane_id out : outgoing[node])
+            {
+                if (out != in.reverse || dead_end)
+                    builder.connect(in.lane, out);
+            }
+        }
+    }
+    return builder.build(config.block_size);
+}
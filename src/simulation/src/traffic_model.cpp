@@ -0,0 +1,299 @@
+#include "traffic_model.hpp"
+
+#include "profiler.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TRAFFIC_MODEL_SSE2 1
+#endif
+
+namespace
+{
+// 병렬 작업 하나가 맡는 최소 에이전트 수
+constexpr std::size_t kMinAgentsPerTask = 4096;
+// 앞차가 없을 때의 간격. 상호작용 항이 사실상 0이 된다
+constexpr float kFreeRoadGap = 1.0e4f;
+// 겹친 차량의 간격이 0 이하로 가서 나눗셈이 터지지 않게 한다
+constexpr float kMinGap = 0.1f;
+// 정렬 키의 s 해상도 (1/256 m)
+constexpr float kOffsetKeyScale = 256.0f;
+constexpr std::uint32_t kNoPosition = 0xffffffffu;
+constexpr std::uint32_t kNoAgent = 0xffffffffu;
+// 길이가 0에 가까운 차로가 이어져도 한 스텝에 넘어갈 수 있는 차로 수
+constexpr int kMaxLaneChangesPerStep = 8;
+
+struct IdmConstants
+{
+    float a;
+    float s0;
+    float t;
+    float inv_two_sqrt_ab;
+    float max_braking;
+};
+
+// 가속도 한 개. SIMD 경로와 같은 식
+inline float idmAcceleration(const IdmConstants &idm, float v, float leader_v, float gap, float desired_v)
+{
+    const float dynamic_gap = std::max(0.0f, v * idm.t + v * (v - leader_v) * idm.inv_two_sqrt_ab);
+    const float desired_gap = idm.s0 + dynamic_gap;
+    const float speed_ratio = v / desired_v;
+    const float speed_ratio_squared = speed_ratio * speed_ratio;
+    const float gap_ratio = desired_gap / gap;
+    const float acceleration = idm.a * (1.0f - speed_ratio_squared * speed_ratio_squared - gap_ratio * gap_ratio);
+    return std::max(acceleration, -idm.max_braking);
+}
+} // namespace
+
+TrafficModel::TrafficModel(const LaneGraph &graph, const IdmParams &params, std::uint32_t seed)
+    : graph_(graph),
+      params_(params),
+      router_(graph),
+      rng_state_(seed ? seed : 1u)
+{
+}
+
+std::uint32_t TrafficModel::addAgent(lane_id lane, float offset, float desired_speed)
+{
+    const auto agent = static_cast<std::uint32_t>(lane_.size());
+    lane_.push_back(lane);
+    s_.push_back(std::clamp(offset, 0.0f, graph_.laneLength(lane)));
+    previous_s_.push_back(s_.back());
+    v_.push_back(0.0f);
+    a_.push_back(0.0f);
+    // 0이면 v / v0가 발산한다
+    desired_v_.push_back(std::max(desired_speed, 0.1f));
+    leader_.push_back(kNoLeader);
+    gap_.push_back(kFreeRoadGap);
+    leader_v_.push_back(0.0f);
+    routes_.emplace_back();
+    route_position_.push_back(0);
+    needs_route_.push_back(1);
+    return agent;
+}
+
+void TrafficModel::step(float dt, ThreadPool &pool)
+{
+    PROFILE_SCOPE("TrafficModel::step");
+    stats_ = TrafficStepStats{};
+    if (lane_.empty() || dt <= 0.0f)
+        return;
+
+    reroute(pool);
+    previous_s_ = s_;
+    findLeaders(pool);
+    integrate(dt, pool);
+    advanceLanes(pool);
+}
+
+lane_id TrafficModel::nextLane(std::uint32_t agent) const
+{
+    const std::vector<lane_id> &route = routes_[agent].lanes;
+    const std::uint32_t next = route_position_[agent] + 1;
+    return next < route.size() ? route[next] : kInvalidLane;
+}
+
+void TrafficModel::findLeaders(ThreadPool &pool)
+{
+    PROFILE_SCOPE("TrafficModel::findLeaders");
+    const std::size_t count = lane_.size();
+    sort_keys_.resize(count);
+    sort_scratch_.resize(count);
+    pool.parallelForRange(count, kMinAgentsPerTask, [&](std::size_t begin, std::size_t end)
+                          {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const auto offset_key = static_cast<std::uint32_t>(std::clamp(s_[i] * kOffsetKeyScale, 0.0f, 4.0e9f));
+            sort_keys_[i] = SortKeyIndex{(static_cast<std::uint64_t>(lane_[i]) << 32) | offset_key, static_cast<std::uint32_t>(i)};
+        } });
+    // 차로 순, 같은 차로 안에서는 s가 작은(뒤) 차부터
+    parallelRadixSortKeyIndex(sort_keys_.data(), sort_scratch_.data(), count, pool);
+
+    lane_first_.assign(graph_.laneCount(), kNoPosition);
+    auto lane_of = [&](std::size_t position)
+    { return static_cast<lane_id>(sort_keys_[position].key >> 32); };
+    pool.parallelForRange(count, kMinAgentsPerTask, [&](std::size_t begin, std::size_t end)
+                          {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            if (i == 0 || lane_of(i - 1) != lane_of(i))
+                lane_first_[lane_of(i)] = static_cast<std::uint32_t>(i);
+        } });
+
+    const float vehicle_length = params_.vehicle_length;
+    pool.parallelForRange(count, kMinAgentsPerTask, [&](std::size_t begin, std::size_t end)
+                          {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const std::uint32_t agent = sort_keys_[i].index;
+            const lane_id lane = lane_of(i);
+            std::uint32_t leader = kNoAgent;
+            float gap = kFreeRoadGap;
+            if (i + 1 < count && lane_of(i + 1) == lane)
+            {
+                leader = sort_keys_[i + 1].index;
+                gap = s_[leader] - s_[agent] - vehicle_length;
+            }
+            else
+            {
+                // 차로의 맨 앞 차는 경로상 다음 차로의 맨 뒤 차를 따라간다
+                const lane_id next = nextLane(agent);
+                if (next != kInvalidLane && lane_first_[next] != kNoPosition)
+                {
+                    const std::uint32_t candidate = sort_keys_[lane_first_[next]].index;
+                    if (candidate != agent)
+                    {
+                        leader = candidate;
+                        gap = graph_.laneLength(lane) - s_[agent] + s_[leader] - vehicle_length;
+                    }
+                }
+            }
+            leader_[agent] = leader == kNoAgent ? kNoLeader : static_cast<std::int32_t>(leader);
+            gap_[agent] = std::max(gap, kMinGap);
+            leader_v_[agent] = leader == kNoAgent ? v_[agent] : v_[leader];
+        } });
+}
+
+void TrafficModel::integrate(float dt, ThreadPool &pool)
+{
+    PROFILE_SCOPE("TrafficModel::integrate");
+    const IdmConstants idm{params_.max_acceleration,
+                           params_.min_gap,
+                           params_.time_headway,
+                           1.0f / (2.0f * std::sqrt(params_.max_acceleration * params_.comfortable_deceleration)),
+                           params_.max_braking};
+
+    pool.parallelForRange(lane_.size(), kMinAgentsPerTask, [&](std::size_t begin, std::size_t end)
+                          {
+        std::size_t i = begin;
+#ifdef TRAFFIC_MODEL_SSE2
+        const __m128 a = _mm_set1_ps(idm.a);
+        const __m128 s0 = _mm_set1_ps(idm.s0);
+        const __m128 headway = _mm_set1_ps(idm.t);
+        const __m128 inv_two_sqrt_ab = _mm_set1_ps(idm.inv_two_sqrt_ab);
+        const __m128 min_acceleration = _mm_set1_ps(-idm.max_braking);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 step = _mm_set1_ps(dt);
+        const __m128 half_step = _mm_set1_ps(0.5f * dt);
+        for (; i + 4 <= end; i += 4)
+        {
+            const __m128 v = _mm_loadu_ps(&v_[i]);
+            const __m128 leader_v = _mm_loadu_ps(&leader_v_[i]);
+            const __m128 gap = _mm_loadu_ps(&gap_[i]);
+            const __m128 desired_v = _mm_loadu_ps(&desired_v_[i]);
+
+            const __m128 closing = _mm_mul_ps(_mm_mul_ps(v, _mm_sub_ps(v, leader_v)), inv_two_sqrt_ab);
+            const __m128 dynamic_gap = _mm_max_ps(zero, _mm_add_ps(_mm_mul_ps(v, headway), closing));
+            const __m128 gap_ratio = _mm_div_ps(_mm_add_ps(s0, dynamic_gap), gap);
+            const __m128 speed_ratio = _mm_div_ps(v, desired_v);
+            const __m128 speed_ratio_squared = _mm_mul_ps(speed_ratio, speed_ratio);
+            const __m128 free_term = _mm_mul_ps(speed_ratio_squared, speed_ratio_squared);
+            const __m128 acceleration = _mm_max_ps(min_acceleration,
+                                                   _mm_mul_ps(a, _mm_sub_ps(_mm_sub_ps(one, free_term),
+                                                                            _mm_mul_ps(gap_ratio, gap_ratio))));
+
+            const __m128 new_v = _mm_max_ps(zero, _mm_add_ps(v, _mm_mul_ps(acceleration, step)));
+            const __m128 s = _mm_add_ps(_mm_loadu_ps(&s_[i]), _mm_mul_ps(_mm_add_ps(v, new_v), half_step));
+            _mm_storeu_ps(&a_[i], acceleration);
+            _mm_storeu_ps(&v_[i], new_v);
+            _mm_storeu_ps(&s_[i], s);
+        }
+#endif
+        for (; i < end; ++i)
+        {
+            const float acceleration = idmAcceleration(idm, v_[i], leader_v_[i], gap_[i], desired_v_[i]);
+            const float new_v = std::max(0.0f, v_[i] + acceleration * dt);
+            s_[i] += (v_[i] + new_v) * 0.5f * dt;
+            a_[i] = acceleration;
+            v_[i] = new_v;
+        } });
+}
+
+void TrafficModel::advanceLanes(ThreadPool &pool)
+{
+    PROFILE_SCOPE("TrafficModel::advanceLanes");
+    std::atomic<std::size_t> lane_changes{0};
+    pool.parallelForRange(lane_.size(), kMinAgentsPerTask, [&](std::size_t begin, std::size_t end)
+                          {
+        std::size_t changes = 0;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const auto agent = static_cast<std::uint32_t>(i);
+            for (int hop = 0; hop < kMaxLaneChangesPerStep && s_[i] >= graph_.laneLength(lane_[i]); ++hop)
+            {
+                const float length = graph_.laneLength(lane_[i]);
+                lane_id next = nextLane(agent);
+                if (next != kInvalidLane)
+                {
+                    ++route_position_[i];
+                }
+                else
+                {
+                    // 경로가 끝났다. 다음 스텝에 새 경로를 받을 때까지 아무 후속 차로로 간다
+                    const std::span<const lane_id> successors = graph_.successors(lane_[i]);
+                    needs_route_[i] = 1;
+                    routes_[i].lanes.clear();
+                    route_position_[i] = 0;
+                    if (successors.empty())
+                    {
+                        s_[i] = length;
+                        v_[i] = 0.0f;
+                        break;
+                    }
+                    next = successors[(agent * 2654435761u ^ lane_[i]) % successors.size()];
+                }
+                s_[i] -= length;
+                previous_s_[i] -= length;
+                lane_[i] = next;
+                ++changes;
+            }
+        }
+        lane_changes.fetch_add(changes, std::memory_order_relaxed); });
+    stats_.lane_changes = lane_changes.load(std::memory_order_relaxed);
+}
+
+void TrafficModel::reroute(ThreadPool &pool)
+{
+    reroute_agents_.clear();
+    for (std::size_t i = 0; i < needs_route_.size(); ++i)
+    {
+        if (needs_route_[i])
+            reroute_agents_.push_back(static_cast<std::uint32_t>(i));
+    }
+    if (reroute_agents_.empty())
+        return;
+
+    PROFILE_SCOPE("TrafficModel::reroute");
+    route_requests_.resize(reroute_agents_.size());
+    for (std::size_t k = 0; k < reroute_agents_.size(); ++k)
+        route_requests_[k] = RouteRequest{lane_[reroute_agents_[k]], randomLane()};
+    router_.findRoutes(route_requests_, route_results_, pool);
+
+    for (std::size_t k = 0; k < reroute_agents_.size(); ++k)
+    {
+        // 못 찾은 에이전트는 다음 스텝에 다른 목적지로 다시 시도한다
+        if (!route_results_[k].found)
+            continue;
+        const std::uint32_t agent = reroute_agents_[k];
+        // vector째 바꿔 두 쪽 모두 용량을 재사용한다
+        std::swap(routes_[agent], route_results_[k]);
+        route_position_[agent] = 0;
+        needs_route_[agent] = 0;
+        ++stats_.reroutes;
+    }
+}
+
+lane_id TrafficModel::randomLane()
+{
+    // xorshift32
+    rng_state_ ^= rng_state_ << 13;
+    rng_state_ ^= rng_state_ >> 17;
+    rng_state_ ^= rng_state_ << 5;
+    return static_cast<lane_id>(rng_state_ % graph_.laneCount());
+}